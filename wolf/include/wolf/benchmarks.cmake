@@ -0,0 +1,45 @@
+# wolf_benchmarks is the micro benchmark executable of wolf which is built on
+# top of google benchmark. each module adds its own sources via its
+# benchmarks/module.cmake, the same way tests are added to TEST_PROJECT_NAME.
+set(BENCHMARK_PROJECT_NAME wolf_benchmarks)
+
+vcpkg_install(benchmark)
+find_package(benchmark CONFIG REQUIRED)
+
+add_executable(${BENCHMARK_PROJECT_NAME}
+    ${CMAKE_CURRENT_SOURCE_DIR}/wolf/benchmarks.cpp
+)
+
+target_link_libraries(${BENCHMARK_PROJECT_NAME}
+    PRIVATE
+        ${PROJECT_NAME}
+        benchmark::benchmark
+)
+
+target_compile_definitions(${BENCHMARK_PROJECT_NAME} PRIVATE WOLF_BENCHMARKS)
+
+include(${CMAKE_CURRENT_SOURCE_DIR}/wolf/system/benchmarks/module.cmake)
+
+if (WOLF_MEDIA_FFMPEG)
+    target_sources(${BENCHMARK_PROJECT_NAME}
+        PRIVATE
+            ${CMAKE_CURRENT_SOURCE_DIR}/wolf/media/benchmarks/ffmpeg.cpp
+    )
+endif()
+
+if (WOLF_ML_OCR OR WOLF_ML_NUDITY_DETECTION)
+    target_sources(${BENCHMARK_PROJECT_NAME}
+        PRIVATE
+            ${CMAKE_CURRENT_SOURCE_DIR}/wolf/ml/benchmarks/utilities.cpp
+    )
+endif()
+
+# run all benchmarks and write a json report, two reports of different
+# releases can be compared via tools/compare.py of google benchmark
+add_custom_target(${BENCHMARK_PROJECT_NAME}_json
+    COMMAND ${BENCHMARK_PROJECT_NAME}
+        --benchmark_out=${CMAKE_BINARY_DIR}/${BENCHMARK_PROJECT_NAME}.json
+        --benchmark_out_format=json
+    DEPENDS ${BENCHMARK_PROJECT_NAME}
+    USES_TERMINAL
+)
@@ -0,0 +1,21 @@
+/*
+  Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+  https://github.com/WolfSource/wolf
+*/
+
+#include <wolf/wolf.hpp>
+
+// NOLINTBEGIN
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : ALL_CODE_ANALYSIS_WARNINGS)
+#endif
+
+#include <benchmark/benchmark.h>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+// NOLINTEND
+
+BENCHMARK_MAIN();
@@ -0,0 +1,13 @@
+# wolf_loadgen is an open-loop load generator for the tcp and websocket echo
+# servers of wolf, it reports the latency percentiles of a constant request
+# rate and may write them in the hgrm format of HdrHistogram.
+set(LOADGEN_PROJECT_NAME wolf_loadgen)
+
+add_executable(${LOADGEN_PROJECT_NAME}
+    ${CMAKE_CURRENT_SOURCE_DIR}/wolf/loadgen.cpp
+)
+
+target_link_libraries(${LOADGEN_PROJECT_NAME}
+    PRIVATE
+        ${PROJECT_NAME}
+)
@@ -0,0 +1,671 @@
+/*
+  Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+  https://github.com/WolfSource/wolf
+*/
+
+#include <wolf/wolf.hpp>
+
+#include <charconv>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <wolf/system/socket/w_io_context_pool.hpp>
+#include <wolf/system/socket/w_tcp_client.hpp>
+#include <wolf/system/socket/w_tcp_server.hpp>
+#include <wolf/system/w_histogram.hpp>
+
+#ifdef WOLF_SYSTEM_HTTP_WS
+#include <wolf/system/socket/w_ws_client.hpp>
+#include <wolf/system/socket/w_ws_server.hpp>
+#endif
+
+/*
+ * wolf_loadgen opens many connections to an echo server and sends requests
+ * at a fixed rate. the requests of a connection are sent on a schedule which
+ * does not wait for the responses, and the latency of a response is measured
+ * from the time its request should have been sent. so a stalled server is
+ * charged for every request which it delayed, instead of hiding the stall
+ * by sending less (coordinated omission).
+ */
+
+namespace {
+
+using steady_clock = std::chrono::steady_clock;
+using tcp = boost::asio::ip::tcp;
+using w_histogram = wolf::system::w_histogram;
+using w_io_backend = wolf::system::socket::w_io_backend;
+using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+using w_socket_options = wolf::system::socket::w_socket_options;
+using w_tcp_client = wolf::system::socket::w_tcp_client;
+
+enum class loadgen_protocol { tcp, ws };
+
+struct loadgen_options {
+  loadgen_protocol protocol = loadgen_protocol::tcp;
+  boost::asio::ip::address address = boost::asio::ip::make_address("127.0.0.1");
+  uint16_t port = 8080;
+  size_t connections = 64;
+  // the requests per second of all connections
+  double rate = 10'000.0;
+  steady_clock::duration duration = std::chrono::seconds(10);
+  // the requests of the warmup are sent but not measured
+  steady_clock::duration warmup = std::chrono::seconds(1);
+  // the time to wait for the responses after the last request
+  steady_clock::duration drain = std::chrono::seconds(2);
+  // the sizes of the requests, which are sent in turn
+  std::vector<size_t> sizes = {64};
+  // zero means hardware concurrency
+  size_t threads = 0;
+  // run an echo server in this process
+  bool serve = false;
+  size_t server_threads = 1;
+  bool io_uring = false;
+  // write the percentile distribution of the latencies
+  std::filesystem::path histogram_path = {};
+};
+
+constexpr auto s_usage = R"(usage: wolf_loadgen [options]
+  --protocol=tcp|ws     the protocol of the echo server (tcp)
+  --host=ADDRESS        the address of the server (127.0.0.1)
+  --port=PORT           the port of the server (8080)
+  --connections=N       the concurrent connections (64)
+  --rate=N              the requests per second of all connections (10000)
+  --duration=SECONDS    the measured time (10)
+  --warmup=SECONDS      the time before measuring (1)
+  --drain=SECONDS       the wait for the responses after the last request (2)
+  --sizes=N[,N...]      the payload sizes in bytes, sent in turn (64)
+  --threads=N           the client threads, zero means all cpus (0)
+  --serve               run a wolf echo server on the port in this process
+  --server-threads=N    the threads of that server (1)
+  --io-uring            use the io_uring backend for that tcp server
+  --histogram=PATH      write the latency percentiles in hgrm format
+)";
+
+template <class T>
+boost::leaf::result<T> s_parse_number(_In_ std::string_view p_name,
+                                       _In_ std::string_view p_value) {
+  T _number = {};
+  const auto *const _end = p_value.data() + p_value.size();
+  const auto [_ptr, _error] =
+      std::from_chars(p_value.data(), _end, _number);
+  if (_error != std::errc() || _ptr != _end) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     wolf::format("invalid value of {}: {}", p_name, p_value));
+  }
+  return _number;
+}
+
+boost::leaf::result<steady_clock::duration> s_parse_seconds(
+    _In_ std::string_view p_name, _In_ std::string_view p_value) {
+  BOOST_LEAF_AUTO(_seconds, s_parse_number<double>(p_name, p_value));
+  if (_seconds < 0.0) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     wolf::format("{} must not be negative", p_name));
+  }
+  return std::chrono::duration_cast<steady_clock::duration>(
+      std::chrono::duration<double>(_seconds));
+}
+
+boost::leaf::result<loadgen_options> s_parse_options(_In_ int p_argc,
+                                                      _In_ char **p_argv) {
+  loadgen_options _options = {};
+  for (auto i = 1; i < p_argc; ++i) {
+    const auto _arg = std::string_view(p_argv[i]);
+    const auto _equal = _arg.find('=');
+    const auto _name = _arg.substr(0, _equal);
+    const auto _value = _equal == std::string_view::npos
+                            ? std::string_view()
+                            : _arg.substr(_equal + 1);
+
+    if (_name == "--protocol") {
+      if (_value == "tcp") {
+        _options.protocol = loadgen_protocol::tcp;
+      } else if (_value == "ws") {
+        _options.protocol = loadgen_protocol::ws;
+      } else {
+        return W_FAILURE(std::errc::invalid_argument,
+                         wolf::format("unknown protocol: {}", _value));
+      }
+    } else if (_name == "--host") {
+      boost::system::error_code _error;
+      _options.address =
+          boost::asio::ip::make_address(std::string(_value), _error);
+      if (_error) {
+        return W_FAILURE(std::errc::invalid_argument,
+                         wolf::format("invalid address: {}", _value));
+      }
+    } else if (_name == "--port") {
+      BOOST_LEAF_AUTO(_port, s_parse_number<uint16_t>(_name, _value));
+      _options.port = _port;
+    } else if (_name == "--connections") {
+      BOOST_LEAF_AUTO(_connections, s_parse_number<size_t>(_name, _value));
+      _options.connections = _connections;
+    } else if (_name == "--rate") {
+      BOOST_LEAF_AUTO(_rate, s_parse_number<double>(_name, _value));
+      _options.rate = _rate;
+    } else if (_name == "--duration") {
+      BOOST_LEAF_AUTO(_duration, s_parse_seconds(_name, _value));
+      _options.duration = _duration;
+    } else if (_name == "--warmup") {
+      BOOST_LEAF_AUTO(_warmup, s_parse_seconds(_name, _value));
+      _options.warmup = _warmup;
+    } else if (_name == "--drain") {
+      BOOST_LEAF_AUTO(_drain, s_parse_seconds(_name, _value));
+      _options.drain = _drain;
+    } else if (_name == "--sizes") {
+      _options.sizes.clear();
+      auto _rest = _value;
+#ifdef __clang__
+#pragma unroll
+#endif
+      while (!_rest.empty()) {
+        const auto _comma = _rest.find(',');
+        BOOST_LEAF_AUTO(_size,
+                        s_parse_number<size_t>(_name, _rest.substr(0, _comma)));
+        _options.sizes.push_back(_size);
+        _rest = _comma == std::string_view::npos ? std::string_view()
+                                                 : _rest.substr(_comma + 1);
+      }
+    } else if (_name == "--threads") {
+      BOOST_LEAF_AUTO(_threads, s_parse_number<size_t>(_name, _value));
+      _options.threads = _threads;
+    } else if (_name == "--serve") {
+      _options.serve = true;
+    } else if (_name == "--server-threads") {
+      BOOST_LEAF_AUTO(_threads, s_parse_number<size_t>(_name, _value));
+      _options.server_threads = _threads;
+    } else if (_name == "--io-uring") {
+      _options.io_uring = true;
+    } else if (_name == "--histogram") {
+      _options.histogram_path = _value;
+    } else {
+      return W_FAILURE(std::errc::invalid_argument,
+                       wolf::format("unknown option: {}", _arg));
+    }
+  }
+
+  if (_options.connections == 0 || _options.rate <= 0.0 ||
+      _options.sizes.empty() ||
+      std::find(_options.sizes.cbegin(), _options.sizes.cend(), 0) !=
+          _options.sizes.cend()) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "connections, rate and sizes must be positive");
+  }
+#ifndef WOLF_SYSTEM_HTTP_WS
+  if (_options.protocol == loadgen_protocol::ws) {
+    return W_FAILURE(std::errc::not_supported,
+                     "wolf was built without WOLF_SYSTEM_HTTP_WS");
+  }
+#endif
+  return _options;
+}
+
+// the counters of the connections of an io context, which are only touched
+// by its thread. a histogram is big, so there is one per thread instead of
+// one per connection
+struct loadgen_stats {
+  w_histogram latency{};
+  uint64_t sent = 0;
+  uint64_t received = 0;
+  uint64_t measured = 0;
+  uint64_t bytes_sent = 0;
+  uint64_t bytes_received = 0;
+  uint64_t errors = 0;
+
+  void merge(_In_ const loadgen_stats &p_other) {
+    this->latency.merge(p_other.latency);
+    this->sent += p_other.sent;
+    this->received += p_other.received;
+    this->measured += p_other.measured;
+    this->bytes_sent += p_other.bytes_sent;
+    this->bytes_received += p_other.bytes_received;
+    this->errors += p_other.errors;
+  }
+};
+
+// the schedule of all connections
+struct loadgen_schedule {
+  steady_clock::time_point start;
+  steady_clock::time_point measure_begin;
+  steady_clock::time_point end;
+  steady_clock::time_point drain_end;
+  steady_clock::duration interval;
+};
+
+struct loadgen_request {
+  steady_clock::time_point intended;
+  size_t size;
+};
+
+/*
+ * a connection with a sender and a receiver coroutine on the same thread.
+ * the sender keeps the schedule and the receiver matches the responses to
+ * the requests in order. it counts itself as finished once both coroutines
+ * released it.
+ */
+template <class C>
+class loadgen_connection
+    : public std::enable_shared_from_this<loadgen_connection<C>> {
+ public:
+  loadgen_connection(_Inout_ boost::asio::io_context &p_io_context,
+                     _Inout_ loadgen_stats &p_stats,
+                     _Inout_ std::atomic<size_t> &p_finished)
+      : client(p_io_context),
+        timer(p_io_context),
+        stats(p_stats),
+        finished(p_finished) {}
+
+  ~loadgen_connection() noexcept {
+    this->finished.fetch_add(1, std::memory_order_release);
+  }
+
+  C client;
+  boost::asio::steady_timer timer;
+  std::deque<loadgen_request> in_flight;
+  bool sending = true;
+  bool closed = false;
+  loadgen_stats &stats;
+  std::atomic<size_t> &finished;
+};
+
+template <class C>
+boost::asio::awaitable<void> s_connect(_Inout_ C &p_client,
+                                       _In_ const tcp::endpoint &p_endpoint) {
+  auto _options = w_socket_options{};
+  _options.no_delay = true;
+  co_await p_client.async_connect(p_endpoint, _options);
+}
+
+boost::asio::awaitable<size_t> s_write(_Inout_ w_tcp_client &p_client,
+                                       _In_ const w_buffer &p_payload) {
+  co_return co_await p_client.async_write(p_payload);
+}
+
+// a tcp echo may split or merge the responses, so they are counted in bytes
+boost::asio::awaitable<size_t> s_read_responses(
+    _Inout_ w_tcp_client &p_client, _Inout_ w_buffer &p_buffer,
+    _Inout_ std::deque<loadgen_request> &p_in_flight,
+    _Inout_ size_t &p_pending_bytes,
+    _Inout_ std::vector<loadgen_request> &p_mut_answered) {
+  const auto _bytes = co_await p_client.async_read(p_buffer);
+  p_pending_bytes += _bytes;
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (!p_in_flight.empty() &&
+         p_pending_bytes >= p_in_flight.front().size) {
+    p_pending_bytes -= p_in_flight.front().size;
+    p_mut_answered.push_back(p_in_flight.front());
+    p_in_flight.pop_front();
+  }
+  co_return _bytes;
+}
+
+#ifdef WOLF_SYSTEM_HTTP_WS
+using w_ws_client = wolf::system::socket::w_ws_client;
+
+boost::asio::awaitable<size_t> s_write(_Inout_ w_ws_client &p_client,
+                                       _In_ const w_buffer &p_payload) {
+  co_return co_await p_client.async_write(p_payload, true);
+}
+
+// a websocket message is one response
+boost::asio::awaitable<size_t> s_read_responses(
+    _Inout_ w_ws_client &p_client, _Inout_ w_buffer &p_buffer,
+    _Inout_ std::deque<loadgen_request> &p_in_flight,
+    _Inout_ size_t &p_pending_bytes,
+    _Inout_ std::vector<loadgen_request> &p_mut_answered) {
+  const auto _bytes = co_await p_client.async_read(p_buffer);
+  if (!p_in_flight.empty()) {
+    p_mut_answered.push_back(p_in_flight.front());
+    p_in_flight.pop_front();
+  }
+  co_return _bytes;
+}
+#endif
+
+template <class C>
+void s_close(_Inout_ loadgen_connection<C> &p_connection) {
+  // the pending operations of the other coroutine fail without an error
+  p_connection.closed = true;
+  p_connection.timer.cancel();
+  p_connection.client.close();
+}
+
+template <class C>
+boost::asio::awaitable<void> s_send(
+    _In_ std::shared_ptr<loadgen_connection<C>> p_connection,
+    _In_ loadgen_schedule p_schedule, _In_ steady_clock::duration p_offset,
+    _In_ const std::vector<w_buffer> &p_payloads) {
+  auto &_connection = *p_connection;
+  try {
+#ifdef __clang__
+#pragma unroll
+#endif
+    for (size_t i = 0; !_connection.closed; ++i) {
+      const auto _intended = p_schedule.start + p_offset +
+                             gsl::narrow_cast<int64_t>(i) * p_schedule.interval;
+      if (_intended >= p_schedule.end) {
+        break;
+      }
+      if (_intended > steady_clock::now()) {
+        _connection.timer.expires_at(_intended);
+        co_await _connection.timer.async_wait(boost::asio::use_awaitable);
+      }
+
+      // a late request goes out right away, its latency still counts from
+      // the time it was due
+      const auto &_payload = p_payloads[i % p_payloads.size()];
+      _connection.in_flight.push_back(
+          loadgen_request{_intended, _payload.size()});
+      _connection.stats.sent++;
+      _connection.stats.bytes_sent +=
+          co_await s_write(_connection.client, _payload);
+    }
+  } catch (const boost::system::system_error &) {
+    if (!_connection.closed) {
+      _connection.stats.errors++;
+    }
+  }
+  _connection.sending = false;
+
+  if (!_connection.closed && !_connection.in_flight.empty()) {
+    // the receiver cancels the wait once every response arrived
+    boost::system::error_code _ignore;
+    _connection.timer.expires_at(p_schedule.drain_end);
+    co_await _connection.timer.async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+  }
+  s_close(_connection);
+}
+
+template <class C>
+boost::asio::awaitable<void> s_receive(
+    _In_ std::shared_ptr<loadgen_connection<C>> p_connection,
+    _In_ loadgen_schedule p_schedule) {
+  auto &_connection = *p_connection;
+  w_buffer _buffer(W_MAX_BUFFER_SIZE);
+  std::vector<loadgen_request> _answered;
+  size_t _pending_bytes = 0;
+  try {
+#ifdef __clang__
+#pragma unroll
+#endif
+    while (_connection.sending || !_connection.in_flight.empty()) {
+      _connection.stats.bytes_received +=
+          co_await s_read_responses(_connection.client, _buffer,
+                                    _connection.in_flight, _pending_bytes,
+                                    _answered);
+
+      const auto _now = steady_clock::now();
+      for (const auto &_request : _answered) {
+        _connection.stats.received++;
+        if (_request.intended >= p_schedule.measure_begin) {
+          _connection.stats.measured++;
+          _connection.stats.latency.record(gsl::narrow_cast<uint64_t>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  _now - _request.intended)
+                  .count()));
+        }
+      }
+      _answered.clear();
+    }
+  } catch (const boost::system::system_error &) {
+    if (!_connection.closed) {
+      _connection.stats.errors++;
+    }
+  }
+  // every response arrived or the connection failed
+  s_close(_connection);
+}
+
+template <class C>
+boost::asio::awaitable<void> s_run_connection(
+    _In_ std::shared_ptr<loadgen_connection<C>> p_connection,
+    _In_ tcp::endpoint p_endpoint, _In_ loadgen_schedule p_schedule,
+    _In_ steady_clock::duration p_offset,
+    _In_ const std::vector<w_buffer> &p_payloads) {
+  try {
+    co_await s_connect(p_connection->client, p_endpoint);
+  } catch (const boost::system::system_error &) {
+    p_connection->stats.errors++;
+    co_return;
+  }
+
+  const auto _executor = co_await boost::asio::this_coro::executor;
+  boost::asio::co_spawn(_executor, s_receive(p_connection, p_schedule),
+                        boost::asio::detached);
+  co_await s_send(std::move(p_connection), p_schedule, p_offset, p_payloads);
+}
+
+template <class C>
+void s_spawn_connections(_Inout_ w_io_context_pool &p_pool,
+                         _In_ const loadgen_options &p_options,
+                         _In_ const loadgen_schedule &p_schedule,
+                         _In_ const std::vector<w_buffer> &p_payloads,
+                         _Inout_ std::vector<loadgen_stats> &p_stats,
+                         _Inout_ std::atomic<size_t> &p_finished) {
+  const auto _endpoint = tcp::endpoint(p_options.address, p_options.port);
+  for (size_t i = 0; i < p_options.connections; ++i) {
+    // the stats of the io context, which get uses round robin as well
+    auto &_io_context = p_pool.get(i);
+    auto _connection = std::make_shared<loadgen_connection<C>>(
+        _io_context, p_stats[i % p_pool.size()], p_finished);
+    // spread the requests of the connections over the interval
+    const auto _offset =
+        p_schedule.interval * gsl::narrow_cast<int64_t>(i) /
+        gsl::narrow_cast<int64_t>(p_options.connections);
+    boost::asio::co_spawn(_io_context,
+                          s_run_connection(std::move(_connection), _endpoint,
+                                           p_schedule, _offset, p_payloads),
+                          boost::asio::detached);
+  }
+}
+
+boost::leaf::result<int> s_serve(_Inout_ w_io_context_pool &p_pool,
+                                 _In_ const loadgen_options &p_options) {
+  const auto _endpoint = tcp::endpoint(p_options.address, p_options.port);
+  const auto _on_error = [](const std::string &,
+                            const boost::system::system_error &) {};
+
+#ifdef WOLF_SYSTEM_HTTP_WS
+  if (p_options.protocol == loadgen_protocol::ws) {
+    using w_ws_server = wolf::system::socket::w_ws_server;
+    return w_ws_server::run(
+        p_pool.get(0), tcp::endpoint(_endpoint),
+        boost::beast::websocket::stream_base::timeout::suggested(
+            boost::beast::role_type::server),
+        w_socket_options{},
+        [](const std::string &, w_buffer &, bool &) -> auto {
+          return boost::beast::websocket::close_code::none;
+        },
+        _on_error);
+  }
+#endif
+
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+  auto _socket_options = w_socket_options{};
+  _socket_options.io_backend =
+      p_options.io_uring ? w_io_backend::io_uring : w_io_backend::epoll;
+  return w_tcp_server::run(
+      p_pool, tcp::endpoint(_endpoint), std::chrono::seconds(60),
+      std::move(_socket_options),
+      [](const std::string &, w_buffer &) -> auto {
+        return boost::system::errc::success;
+      },
+      _on_error);
+}
+
+double s_to_us(_In_ uint64_t p_ns) {
+  return gsl::narrow_cast<double>(p_ns) / 1000.0;
+}
+
+/*
+ * write the percentile distribution in the hgrm text format of HdrHistogram,
+ * which the HdrHistogram plotter reads. every half of the remaining
+ * percentiles gets five more ticks
+ */
+boost::leaf::result<int> s_write_distribution(
+    _In_ const std::filesystem::path &p_path,
+    _In_ const w_histogram &p_histogram) {
+  std::ofstream _file(p_path);
+  if (!_file) {
+    return W_FAILURE(std::errc::io_error,
+                     "could not open " + p_path.string());
+  }
+
+  constexpr auto _ticks_per_half = 5;
+  const auto _count = gsl::narrow_cast<double>(p_histogram.get_count());
+  _file << wolf::format("{:>12} {:>14} {:>10} {:>14}\n\n", "Value",
+                        "Percentile", "TotalCount", "1/(1-Percentile)");
+  for (auto _half = 0; _half < 64; ++_half) {
+    const auto _from = 1.0 - std::ldexp(1.0, -_half);
+    const auto _step = std::ldexp(1.0, -_half - 1) / _ticks_per_half;
+    for (auto _tick = 0; _tick < _ticks_per_half; ++_tick) {
+      const auto _percentile = _from + _step * _tick;
+      _file << wolf::format(
+          "{:12.3f} {:2.12f} {:10} {:14.2f}\n",
+          s_to_us(p_histogram.get_value_at_percentile(_percentile * 100.0)),
+          _percentile,
+          gsl::narrow_cast<uint64_t>(std::ceil(_percentile * _count)),
+          1.0 / (1.0 - _percentile));
+    }
+    // the next ticks would be finer than one value
+    if (std::ldexp(1.0, _half + 1) > _count) {
+      break;
+    }
+  }
+  _file << wolf::format("{:12.3f} {:2.12f} {:10}\n",
+                        s_to_us(p_histogram.get_max()), 1.0,
+                        p_histogram.get_count());
+  _file << wolf::format("#[Mean    = {:12.3f}, Max         = {:12.3f}]\n",
+                        p_histogram.get_mean() / 1000.0,
+                        s_to_us(p_histogram.get_max()));
+  _file << wolf::format("#[Total count    = {:12}]\n",
+                        p_histogram.get_count());
+  return 0;
+}
+
+void s_report(_In_ const loadgen_options &p_options,
+              _In_ const loadgen_stats &p_stats) {
+  const auto _seconds =
+      std::chrono::duration<double>(p_options.duration).count();
+  const auto &_latency = p_stats.latency;
+  std::cout << wolf::format(
+      "requests: {} sent, {} answered, {} unanswered, {} errors\n",
+      p_stats.sent, p_stats.received, p_stats.sent - p_stats.received,
+      p_stats.errors);
+  std::cout << wolf::format(
+      "throughput: {:.1f} requests/s of {:.1f} requested, {:.2f} MB/s out, "
+      "{:.2f} MB/s in\n",
+      gsl::narrow_cast<double>(p_stats.measured) / _seconds, p_options.rate,
+      gsl::narrow_cast<double>(p_stats.bytes_sent) / 1e6 /
+          (_seconds + std::chrono::duration<double>(p_options.warmup).count()),
+      gsl::narrow_cast<double>(p_stats.bytes_received) / 1e6 /
+          (_seconds +
+           std::chrono::duration<double>(p_options.warmup).count()));
+  std::cout << wolf::format(
+      "latency (us): min {:.1f}, mean {:.1f}, p50 {:.1f}, p90 {:.1f}, "
+      "p99 {:.1f}, p999 {:.1f}, max {:.1f}\n",
+      s_to_us(_latency.get_min()), _latency.get_mean() / 1000.0,
+      s_to_us(_latency.get_value_at_percentile(50.0)),
+      s_to_us(_latency.get_value_at_percentile(90.0)),
+      s_to_us(_latency.get_value_at_percentile(99.0)),
+      s_to_us(_latency.get_value_at_percentile(99.9)),
+      s_to_us(_latency.get_max()));
+}
+
+boost::leaf::result<int> s_run(_In_ const loadgen_options &p_options) {
+  w_io_context_pool _server_pool({.size = p_options.server_threads});
+  if (p_options.serve) {
+    BOOST_LEAF_CHECK(s_serve(_server_pool, p_options));
+    BOOST_LEAF_CHECK(_server_pool.run());
+  }
+
+  std::vector<w_buffer> _payloads;
+  for (const auto _size : p_options.sizes) {
+    _payloads.emplace_back(std::string(_size, 'w'));
+  }
+
+  // the connections connect during the first interval and the warmup
+  const auto _interval = std::chrono::duration_cast<steady_clock::duration>(
+      std::chrono::duration<double>(
+          gsl::narrow_cast<double>(p_options.connections) / p_options.rate));
+  loadgen_schedule _schedule = {};
+  _schedule.start = steady_clock::now() + std::chrono::milliseconds(100);
+  _schedule.measure_begin = _schedule.start + p_options.warmup;
+  _schedule.end = _schedule.measure_begin + p_options.duration;
+  _schedule.drain_end = _schedule.end + p_options.drain;
+  _schedule.interval = std::max(_interval, steady_clock::duration{1});
+
+  std::cout << wolf::format(
+      "wolf_loadgen: {} {}:{}, {} connections, {} requests/s, {:.1f}s after "
+      "{:.1f}s of warmup\n",
+      p_options.protocol == loadgen_protocol::ws ? "ws" : "tcp",
+      p_options.address.to_string(), p_options.port, p_options.connections,
+      p_options.rate, std::chrono::duration<double>(p_options.duration).count(),
+      std::chrono::duration<double>(p_options.warmup).count());
+
+  std::vector<loadgen_stats> _stats;
+  std::atomic<size_t> _finished = 0;
+  {
+    w_io_context_pool _pool({.size = p_options.threads});
+    _stats.resize(_pool.size());
+#ifdef WOLF_SYSTEM_HTTP_WS
+    if (p_options.protocol == loadgen_protocol::ws) {
+      s_spawn_connections<w_ws_client>(_pool, p_options, _schedule, _payloads,
+                                       _stats, _finished);
+    } else
+#endif
+    {
+      s_spawn_connections<w_tcp_client>(_pool, p_options, _schedule,
+                                        _payloads, _stats, _finished);
+    }
+    BOOST_LEAF_CHECK(_pool.run());
+
+#ifdef __clang__
+#pragma unroll
+#endif
+    while (_finished.load(std::memory_order_acquire) <
+           p_options.connections) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    _pool.stop();
+  }
+  _server_pool.stop();
+
+  auto _total = loadgen_stats{};
+  for (const auto &_thread_stats : _stats) {
+    _total.merge(_thread_stats);
+  }
+  s_report(p_options, _total);
+  if (!p_options.histogram_path.empty()) {
+    BOOST_LEAF_CHECK(
+        s_write_distribution(p_options.histogram_path, _total.latency));
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int p_argc, char **p_argv) {
+  return boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<int> {
+        BOOST_LEAF_AUTO(_options, s_parse_options(p_argc, p_argv));
+        return s_run(_options);
+      },
+      [](const w_trace &p_trace) {
+        std::cerr << "wolf_loadgen got an error: " << p_trace.to_string()
+                  << std::endl
+                  << s_usage;
+        return EXIT_FAILURE;
+      },
+      [] {
+        std::cerr << "wolf_loadgen got an error" << std::endl << s_usage;
+        return EXIT_FAILURE;
+      });
+}
@@ -0,0 +1,248 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_BENCHMARKS) && defined(WOLF_MEDIA_FFMPEG)
+
+#include <benchmark/benchmark.h>
+
+#include <wolf/media/ffmpeg/w_av_converter.hpp>
+#include <wolf/media/ffmpeg/w_av_frame.hpp>
+#include <wolf/media/ffmpeg/w_ffmpeg.hpp>
+#include <wolf/wolf.hpp>
+
+namespace {
+
+using w_av_config = wolf::media::ffmpeg::w_av_config;
+using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+using w_av_packet = wolf::media::ffmpeg::w_av_packet;
+using w_decoder = wolf::media::ffmpeg::w_decoder;
+using w_encoder = wolf::media::ffmpeg::w_encoder;
+using w_ffmpeg = wolf::media::ffmpeg::w_ffmpeg;
+
+constexpr auto s_gop_frames = 64;
+
+boost::leaf::result<w_av_frame> s_make_video_frame(_In_ AVPixelFormat p_format,
+                                                   _In_ int p_width,
+                                                   _In_ int p_height) {
+  auto _frame = w_av_frame(w_av_config(p_format, p_width, p_height));
+  BOOST_LEAF_CHECK(_frame.init());
+  BOOST_LEAF_CHECK(_frame.set_video_frame(std::vector<uint8_t>()));
+  return _frame;
+}
+
+// the codec parameters of a native codec, so no external library is needed
+AVCodecParameters *s_make_codec_params(_In_ int p_width, _In_ int p_height) {
+  auto *_params = avcodec_parameters_alloc();
+  if (_params != nullptr) {
+    _params->codec_type = AVMEDIA_TYPE_VIDEO;
+    _params->codec_id = AV_CODEC_ID_MPEG4;
+    _params->format = AV_PIX_FMT_YUV420P;
+    _params->width = p_width;
+    _params->height = p_height;
+    _params->bit_rate = 4'000'000;
+  }
+  return _params;
+}
+
+// run the body and stop the benchmark with the reason of the first failure
+template <class F>
+void s_run(_Inout_ benchmark::State &p_state, _In_ F &&p_body) {
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> { return p_body(); },
+      [&](const w_trace &p_trace) {
+        p_state.SkipWithError(p_trace.to_string().c_str());
+      },
+      [&] { p_state.SkipWithError("unknown error"); });
+}
+
+void s_convert_video(benchmark::State &p_state) {
+  const auto _width = gsl::narrow_cast<int>(p_state.range(0));
+  const auto _height = gsl::narrow_cast<int>(p_state.range(1));
+
+  s_run(p_state, [&]() -> boost::leaf::result<void> {
+    BOOST_LEAF_AUTO(_src, s_make_video_frame(AVPixelFormat::AV_PIX_FMT_RGBA,
+                                             _width, _height));
+    for (auto _ : p_state) {
+      BOOST_LEAF_AUTO(_dst, _src.convert_video(w_av_config(
+                                AVPixelFormat::AV_PIX_FMT_YUV420P, _width,
+                                _height)));
+      benchmark::DoNotOptimize(_dst);
+    }
+    return {};
+  });
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()));
+}
+
+// a stereo frame of float planar samples at 48khz
+boost::leaf::result<w_av_frame> s_make_audio_frame(_In_ int p_nb_samples) {
+  auto _frame =
+      w_av_frame(w_av_config(2, AVSampleFormat::AV_SAMPLE_FMT_FLTP, 48'000));
+  BOOST_LEAF_CHECK(_frame.init());
+
+  auto *_av_frame = _frame.get_frame();
+  _av_frame->format = AVSampleFormat::AV_SAMPLE_FMT_FLTP;
+  _av_frame->nb_samples = p_nb_samples;
+  if (av_frame_get_buffer(_av_frame, 0) < 0) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not allocate the audio samples");
+  }
+  return _frame;
+}
+
+void s_convert_video_cached(benchmark::State &p_state) {
+  const auto _width = gsl::narrow_cast<int>(p_state.range(0));
+  const auto _height = gsl::narrow_cast<int>(p_state.range(1));
+
+  s_run(p_state, [&]() -> boost::leaf::result<void> {
+    BOOST_LEAF_AUTO(_src, s_make_video_frame(AVPixelFormat::AV_PIX_FMT_RGBA,
+                                             _width, _height));
+    auto _converter = w_av_converter(
+        w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, _width, _height));
+    auto _dst = w_av_frame(w_av_config(_converter.get_dst_config()));
+    BOOST_LEAF_CHECK(_dst.init());
+    for (auto _ : p_state) {
+      BOOST_LEAF_AUTO(_rows, _converter.convert_video(_src, _dst));
+      benchmark::DoNotOptimize(_rows);
+    }
+    return {};
+  });
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()));
+}
+
+void s_convert_audio(benchmark::State &p_state) {
+  constexpr auto _nb_samples = 1024;
+
+  s_run(p_state, [&]() -> boost::leaf::result<void> {
+    BOOST_LEAF_AUTO(_src, s_make_audio_frame(_nb_samples));
+    for (auto _ : p_state) {
+      BOOST_LEAF_AUTO(_dst, _src.convert_audio(w_av_config(
+                                2, AVSampleFormat::AV_SAMPLE_FMT_S16, 44'100)));
+      benchmark::DoNotOptimize(_dst);
+    }
+    return {};
+  });
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            _nb_samples);
+}
+
+void s_convert_audio_cached(benchmark::State &p_state) {
+  constexpr auto _nb_samples = 1024;
+
+  s_run(p_state, [&]() -> boost::leaf::result<void> {
+    BOOST_LEAF_AUTO(_src, s_make_audio_frame(_nb_samples));
+    auto _converter = w_av_converter(
+        w_av_config(2, AVSampleFormat::AV_SAMPLE_FMT_S16, 44'100));
+    auto _dst = w_av_frame(w_av_config(_converter.get_dst_config()));
+    BOOST_LEAF_CHECK(_dst.init());
+    for (auto _ : p_state) {
+      BOOST_LEAF_AUTO(_samples, _converter.convert_audio(_src, _dst));
+      benchmark::DoNotOptimize(_samples);
+    }
+    return {};
+  });
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            _nb_samples);
+}
+
+boost::leaf::result<std::vector<w_av_packet>> s_encode_gop(
+    _Inout_ w_encoder &p_encoder, _Inout_ w_av_frame &p_frame) {
+  std::vector<w_av_packet> _packets;
+  for (auto i = 0; i < s_gop_frames; ++i) {
+    p_frame.set_pts(i);
+    auto _packet = w_av_packet();
+    BOOST_LEAF_CHECK(p_encoder.encode(p_frame, _packet, false));
+    if (_packet.get_size() > 0) {
+      _packets.push_back(std::move(_packet));
+    }
+  }
+  return _packets;
+}
+
+void s_encode(benchmark::State &p_state) {
+  const auto _width = gsl::narrow_cast<int>(p_state.range(0));
+  const auto _height = gsl::narrow_cast<int>(p_state.range(1));
+
+  s_run(p_state, [&]() -> boost::leaf::result<void> {
+    auto *_params = s_make_codec_params(_width, _height);
+    DEFER { avcodec_parameters_free(&_params); });
+
+    BOOST_LEAF_AUTO(_encoder,
+                    w_ffmpeg::create_encoder(_params, AV_CODEC_ID_MPEG4));
+    BOOST_LEAF_AUTO(_frame, s_make_video_frame(AVPixelFormat::AV_PIX_FMT_YUV420P,
+                                               _width, _height));
+    int64_t _pts = 0;
+    for (auto _ : p_state) {
+      _frame.set_pts(_pts++);
+      auto _packet = w_av_packet();
+      BOOST_LEAF_CHECK(_encoder.encode(_frame, _packet, false));
+      benchmark::DoNotOptimize(_packet);
+    }
+    return {};
+  });
+  // frames per second
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()));
+}
+
+void s_decode(benchmark::State &p_state) {
+  const auto _width = gsl::narrow_cast<int>(p_state.range(0));
+  const auto _height = gsl::narrow_cast<int>(p_state.range(1));
+
+  s_run(p_state, [&]() -> boost::leaf::result<void> {
+    auto *_params = s_make_codec_params(_width, _height);
+    DEFER { avcodec_parameters_free(&_params); });
+
+    // encode one gop up front, then decode it in a loop
+    BOOST_LEAF_AUTO(_encoder,
+                    w_ffmpeg::create_encoder(_params, AV_CODEC_ID_MPEG4));
+    BOOST_LEAF_AUTO(_src, s_make_video_frame(AVPixelFormat::AV_PIX_FMT_YUV420P,
+                                             _width, _height));
+    BOOST_LEAF_AUTO(_packets, s_encode_gop(_encoder, _src));
+    if (_packets.empty()) {
+      return W_FAILURE(std::errc::no_message, "the encoder did not output");
+    }
+
+    BOOST_LEAF_AUTO(_decoder,
+                    w_ffmpeg::create_decoder(_params, AV_CODEC_ID_MPEG4));
+    BOOST_LEAF_AUTO(_dst, s_make_video_frame(AVPixelFormat::AV_PIX_FMT_YUV420P,
+                                             _width, _height));
+    size_t _index = 0;
+    for (auto _ : p_state) {
+      BOOST_LEAF_CHECK(_decoder.decode(_packets[_index], _dst, false));
+      _index = (_index + 1) % _packets.size();
+    }
+    return {};
+  });
+  // frames per second
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()));
+}
+
+}  // namespace
+
+BENCHMARK(s_convert_video)
+    ->Name("w_av_frame/convert_video_rgba_to_yuv420p")
+    ->Args({640, 360})
+    ->Args({1280, 720})
+    ->Args({1920, 1080});
+BENCHMARK(s_convert_video_cached)
+    ->Name("w_av_converter/convert_video_rgba_to_yuv420p")
+    ->Args({640, 360})
+    ->Args({1280, 720})
+    ->Args({1920, 1080});
+BENCHMARK(s_convert_audio)->Name("w_av_frame/convert_audio_fltp_to_s16");
+BENCHMARK(s_convert_audio_cached)
+    ->Name("w_av_converter/convert_audio_fltp_to_s16");
+BENCHMARK(s_encode)
+    ->Name("w_encoder/encode_mpeg4")
+    ->Args({640, 360})
+    ->Args({1280, 720})
+    ->UseRealTime();
+BENCHMARK(s_decode)
+    ->Name("w_decoder/decode_mpeg4")
+    ->Args({640, 360})
+    ->Args({1280, 720})
+    ->UseRealTime();
+
+#endif  // WOLF_BENCHMARKS
@@ -0,0 +1,229 @@
+#ifdef WOLF_MEDIA_FFMPEG
+
+#include "w_av_converter.hpp"
+
+#include "w_ffmpeg_ctx.hpp"
+
+#include <wolf/system/w_profiler.hpp>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
+using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+using w_av_config = wolf::media::ffmpeg::w_av_config;
+using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+using w_ffmpeg_ctx = wolf::media::ffmpeg::w_ffmpeg_ctx;
+
+w_av_converter::w_av_converter(_In_ w_av_config p_dst_config,
+                               _In_ int p_sws_flags) noexcept
+    : _dst_config(std::move(p_dst_config)), _sws_flags(p_sws_flags) {}
+
+boost::leaf::result<int> w_av_converter::convert_video(
+    _In_ const w_av_frame &p_src, _Inout_ w_av_frame &p_dst) noexcept {
+  W_PROFILE_SCOPE("w_av_converter::convert_video");
+
+  const auto *_src = p_src._av_frame;
+  if (_src == nullptr || _src->data[0] == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the source frame of w_av_converter has no image");
+  }
+  if (p_dst._av_frame == nullptr ||
+      p_dst._av_frame->width != this->_dst_config.width ||
+      p_dst._av_frame->height != this->_dst_config.height ||
+      p_dst._av_frame->format != this->_dst_config.format) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination frame does not match the destination "
+                     "config of w_av_converter");
+  }
+
+  // the buffer of the destination is made once and reused afterwards
+  if (p_dst._av_frame->data[0] == nullptr) {
+    BOOST_LEAF_CHECK(p_dst.set_video_frame(std::vector<uint8_t>()));
+  }
+
+  // reuses the context as long as the source does not change
+  this->_sws = sws_getCachedContext(
+      this->_sws, _src->width, _src->height,
+      gsl::narrow_cast<AVPixelFormat>(_src->format), this->_dst_config.width,
+      this->_dst_config.height, this->_dst_config.format, this->_sws_flags,
+      nullptr, nullptr, nullptr);
+  if (this->_sws == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not create sws context");
+  }
+
+  auto _dst_frame_nn = gsl::not_null<AVFrame *>(p_dst._av_frame);
+  const auto _height = sws_scale(
+      this->_sws, gsl::narrow_cast<const uint8_t *const *>(_src->data),
+      gsl::narrow_cast<const int *>(_src->linesize), 0, _src->height,
+      gsl::narrow_cast<uint8_t *const *>(_dst_frame_nn->data),
+      gsl::narrow_cast<const int *>(_dst_frame_nn->linesize));
+  if (_height < 0) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "w_av_converter sws_scale failed because: \"" +
+                         w_ffmpeg_ctx::get_av_error_str(_height) + "\"");
+  }
+
+  const auto _buffer_size = av_image_get_buffer_size(
+      this->_dst_config.format, this->_dst_config.width,
+      this->_dst_config.height, 4);
+  if (_buffer_size < 0) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "could not get image buffer size");
+  }
+
+  p_dst._data_size = _buffer_size;
+  return _height;
+}
+
+boost::leaf::result<int> w_av_converter::convert_audio(
+    _In_ const w_av_frame &p_src, _Inout_ w_av_frame &p_dst) noexcept {
+  W_PROFILE_SCOPE("w_av_converter::convert_audio");
+
+  const auto *_src = p_src._av_frame;
+  if (_src == nullptr || _src->extended_data == nullptr ||
+      _src->nb_samples <= 0) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the source frame of w_av_converter has no samples");
+  }
+  BOOST_LEAF_CHECK(_init_swr(*_src));
+
+  // the delayed samples of the previous calls come out first
+  const auto _nb_samples = gsl::narrow_cast<int>(av_rescale_rnd(
+      swr_get_delay(this->_swr, _src->sample_rate) + _src->nb_samples,
+      this->_dst_config.sample_rate, _src->sample_rate, AV_ROUND_UP));
+
+  return _resample(
+      p_dst, _nb_samples,
+      const_cast<const uint8_t **>(_src->extended_data), _src->nb_samples);
+}
+
+boost::leaf::result<int> w_av_converter::flush_audio(
+    _Inout_ w_av_frame &p_dst) noexcept {
+  if (this->_swr == nullptr) {
+    return 0;
+  }
+  const auto _nb_samples = gsl::narrow_cast<int>(
+      swr_get_delay(this->_swr, this->_dst_config.sample_rate));
+  if (_nb_samples <= 0) {
+    return 0;
+  }
+  return _resample(p_dst, _nb_samples, nullptr, 0);
+}
+
+boost::leaf::result<int> w_av_converter::_init_swr(
+    _In_ const AVFrame &p_src) noexcept {
+  const auto _key = audio_key{p_src.format, p_src.sample_rate,
+                              p_src.ch_layout.nb_channels};
+  if (this->_swr != nullptr && this->_swr_key == _key) {
+    return 0;
+  }
+  if (_key.format < 0 || _key.sample_rate <= 0 || _key.nb_channels <= 0) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the source frame of w_av_converter has no sample "
+                     "format, sample rate or channels");
+  }
+
+  // the source changed, so the delayed samples of the old one are dropped
+  swr_free(&this->_swr);
+  this->_swr_key = {};
+
+  AVChannelLayout _dst_layout = {};
+  av_channel_layout_default(&_dst_layout, this->_dst_config.nb_channels);
+  DEFER { av_channel_layout_uninit(&_dst_layout); });
+
+  auto _ret = swr_alloc_set_opts2(
+      &this->_swr, &_dst_layout, this->_dst_config.sample_fmts,
+      this->_dst_config.sample_rate, &p_src.ch_layout,
+      gsl::narrow_cast<AVSampleFormat>(p_src.format), p_src.sample_rate, 0,
+      nullptr);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not allocate resampler context because: " +
+                         w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+
+  _ret = swr_init(this->_swr);
+  if (_ret < 0) {
+    swr_free(&this->_swr);
+    return W_FAILURE(std::errc::operation_canceled,
+                     "failed to initialize the resampling context because: " +
+                         w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+
+  this->_swr_key = _key;
+  return 0;
+}
+
+boost::leaf::result<int> w_av_converter::_reserve_samples(
+    _Inout_ AVFrame &p_dst, _In_ int p_nb_samples) noexcept {
+  const auto _format = this->_dst_config.sample_fmts;
+  const auto _nb_channels = this->_dst_config.nb_channels;
+
+  // the samples per channel which fit in the current buffer
+  auto _capacity = 0;
+  if (p_dst.data[0] != nullptr && p_dst.format == _format) {
+    const auto _bytes_per_sample = av_get_bytes_per_sample(_format) *
+                                   (av_sample_fmt_is_planar(_format) != 0
+                                        ? 1
+                                        : _nb_channels);
+    if (_bytes_per_sample > 0) {
+      _capacity = p_dst.linesize[0] / _bytes_per_sample;
+    }
+  }
+  if (_capacity >= p_nb_samples) {
+    return _capacity;
+  }
+
+  // unref resets the frame, so its audio properties are restored
+  av_frame_unref(&p_dst);
+  p_dst.format = _format;
+  p_dst.sample_rate = this->_dst_config.sample_rate;
+  av_channel_layout_default(&p_dst.ch_layout, _nb_channels);
+  p_dst.nb_samples = p_nb_samples;
+
+  const auto _ret = av_frame_get_buffer(&p_dst, 0);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not allocate avframe samples because: " +
+                         w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+  return p_nb_samples;
+}
+
+boost::leaf::result<int> w_av_converter::_resample(
+    _Inout_ w_av_frame &p_dst, _In_ int p_nb_samples,
+    _In_opt_ const uint8_t **p_src, _In_ int p_src_nb_samples) noexcept {
+  if (p_dst._av_frame == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination frame of w_av_converter is not "
+                     "initialized");
+  }
+  auto _dst_frame_nn = gsl::not_null<AVFrame *>(p_dst._av_frame);
+
+  BOOST_LEAF_AUTO(_capacity, _reserve_samples(*_dst_frame_nn, p_nb_samples));
+
+  const auto _size =
+      swr_convert(this->_swr, _dst_frame_nn->extended_data, _capacity, p_src,
+                  p_src_nb_samples);
+  if (_size < 0) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "error while audio converting because: " +
+                         w_ffmpeg_ctx::get_av_error_str(_size));
+  }
+  _dst_frame_nn->nb_samples = _size;
+
+  const auto _buffer_size = av_samples_get_buffer_size(
+      nullptr, this->_dst_config.nb_channels, _size,
+      this->_dst_config.sample_fmts, 1);
+  if (_buffer_size < 0) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "could not get sample buffer size");
+  }
+
+  p_dst._data_size = _buffer_size;
+  return _size;
+}
+
+#endif  // WOLF_MEDIA_FFMPEG
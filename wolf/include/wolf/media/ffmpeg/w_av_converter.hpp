@@ -0,0 +1,142 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#ifdef WOLF_MEDIA_FFMPEG
+
+#pragma once
+
+#include <wolf.hpp>
+
+#include "w_av_config.hpp"
+#include "w_av_frame.hpp"
+
+extern "C" {
+#include <libswresample/swresample.h>
+#include <libswscale/swscale.h>
+}
+
+namespace wolf::media::ffmpeg {
+
+/*
+ * converts the frames of a stream to a destination config with one swscale
+ * or swresample context. the context is made for the first frame and kept
+ * while the source frames have the same format, size, sample rate and
+ * channels, so a stream pays for it once instead of per frame. the resampler
+ * keeps its delayed samples between the calls, they are drained by
+ * flush_audio. the destination frames belong to the caller and keep their
+ * buffers, which are only reallocated if they are too small.
+ */
+class w_av_converter {
+ public:
+  /**
+   * constructor the converter to a destination config
+   * @param p_dst_config, the config of the destination frames
+   * @param p_sws_flags, the scaling algorithm of the video frames
+   */
+  W_API explicit w_av_converter(_In_ w_av_config p_dst_config,
+                                _In_ int p_sws_flags = SWS_BICUBIC) noexcept;
+
+  // destructor
+  W_API virtual ~w_av_converter() noexcept { release(); }
+
+  // move constructor.
+  W_API w_av_converter(w_av_converter &&p_other) noexcept {
+    move(std::forward<w_av_converter &&>(p_other));
+  }
+  // move assignment operator.
+  W_API w_av_converter &operator=(w_av_converter &&p_other) noexcept {
+    move(std::forward<w_av_converter &&>(p_other));
+    return *this;
+  }
+
+  /**
+   * convert a video frame into a destination frame, whose buffer is made on
+   * the first call if it has none
+   * @param p_src, the source frame
+   * @param p_dst, the initialized destination frame of the destination config
+   * @returns the height of the converted image
+   */
+  W_API boost::leaf::result<int> convert_video(
+      _In_ const w_av_frame &p_src, _Inout_ w_av_frame &p_dst) noexcept;
+
+  /**
+   * resample an audio frame into a destination frame. the samples which the
+   * resampler delays are returned by one of the next calls
+   * @param p_src, the source frame
+   * @param p_dst, the initialized destination frame of the destination config
+   * @returns the number of samples per channel in the destination frame
+   */
+  W_API boost::leaf::result<int> convert_audio(
+      _In_ const w_av_frame &p_src, _Inout_ w_av_frame &p_dst) noexcept;
+
+  /**
+   * drain the samples which the resampler delayed, at the end of a stream
+   * @param p_dst, the initialized destination frame of the destination config
+   * @returns the number of samples per channel in the destination frame
+   */
+  W_API boost::leaf::result<int> flush_audio(
+      _Inout_ w_av_frame &p_dst) noexcept;
+
+  // returns the config of the destination frames
+  W_API const w_av_config &get_dst_config() const noexcept {
+    return this->_dst_config;
+  }
+
+  void release() noexcept {
+    if (this->_sws != nullptr) {
+      sws_freeContext(this->_sws);
+      this->_sws = nullptr;
+    }
+    if (this->_swr != nullptr) {
+      swr_free(&this->_swr);
+    }
+    this->_swr_key = {};
+  }
+
+  void move(w_av_converter &&p_other) noexcept {
+    if (this == &p_other) {
+      return;
+    }
+    release();
+    this->_dst_config = std::move(p_other._dst_config);
+    this->_sws_flags = p_other._sws_flags;
+    this->_sws = std::exchange(p_other._sws, nullptr);
+    this->_swr = std::exchange(p_other._swr, nullptr);
+    this->_swr_key = std::exchange(p_other._swr_key, {});
+  }
+
+ private:
+  // copy constructor.
+  w_av_converter(const w_av_converter &) = delete;
+  // copy assignment operator.
+  w_av_converter &operator=(const w_av_converter &) = delete;
+
+  // the source of the resampler, which is remade once it changes
+  struct audio_key {
+    int format = -1;
+    int sample_rate = 0;
+    int nb_channels = 0;
+
+    bool operator==(const audio_key &) const noexcept = default;
+  };
+
+  boost::leaf::result<int> _init_swr(_In_ const AVFrame &p_src) noexcept;
+  boost::leaf::result<int> _reserve_samples(_Inout_ AVFrame &p_dst,
+                                            _In_ int p_nb_samples) noexcept;
+  boost::leaf::result<int> _resample(_Inout_ w_av_frame &p_dst,
+                                     _In_ int p_nb_samples,
+                                     _In_opt_ const uint8_t **p_src,
+                                     _In_ int p_src_nb_samples) noexcept;
+
+  // the config of the destination frames
+  w_av_config _dst_config = {};
+  int _sws_flags = SWS_BICUBIC;
+  gsl::owner<SwsContext *> _sws = nullptr;
+  gsl::owner<SwrContext *> _swr = nullptr;
+  audio_key _swr_key = {};
+};
+}  // namespace wolf::media::ffmpeg
+
+#endif  // WOLF_MEDIA_FFMPEG
@@ -2,13 +2,10 @@
 
 #include "w_av_frame.hpp"
 
-#include "w_ffmpeg_ctx.hpp"
+#include "w_av_converter.hpp"
 
 extern "C" {
 #include <libavutil/imgutils.h>
-#include <libswresample/swresample.h>
-#include <libswscale/swscale.h>
-#include <libavutil/opt.h>
 }
 
 #ifdef WOLF_MEDIA_STB
@@ -16,6 +13,7 @@ extern "C" {
 #include <stb_image_write.h>
 #endif  // WOLF_MEDIA_STB
 
+using w_av_converter = wolf::media::ffmpeg::w_av_converter;
 using w_av_frame = wolf::media::ffmpeg::w_av_frame;
 using w_av_config = wolf::media::ffmpeg::w_av_config;
 
@@ -104,162 +102,19 @@ w_av_config w_av_frame::get_config() const noexcept { return this->_config; }
 
 boost::leaf::result<std::shared_ptr<w_av_frame>> w_av_frame::convert_audio(
     _In_ w_av_config &&p_dst_config) {
-  auto _ret = 0;
-  int dst_nb_samples, max_dst_nb_samples, dst_nb_channels = 0;
-  int dst_linesize;
-  uint8_t **dst_data = NULL;
-
-  SwrContext *swr = nullptr;
+  auto _converter = w_av_converter(p_dst_config);
   auto _dst_frame = std::make_shared<w_av_frame>(std::move(p_dst_config));
-  _dst_frame->init();
-
-  DEFER {
-    if (_ret) {
-      if (swr) {
-        if (swr_is_initialized(swr)) {
-          swr_close(swr);
-        }
-        swr_free(&swr);
-      }
-    }
-  });
-
-  /* create resampler context */
-  swr = swr_alloc();
-  if (!swr) {
-    return W_FAILURE(
-        std::errc::operation_canceled,
-        "could not allocate resampler context because: " + w_ffmpeg_ctx::get_av_error_str(_ret));
-  }
-
-  /* set options */
-  av_opt_set_chlayout(swr, "in_chlayout", &this->_av_frame->ch_layout, 0);
-  av_opt_set_int(swr, "in_sample_rate", this->_av_frame->sample_rate, 0);
-  av_opt_set_sample_fmt(swr, "in_sample_fmt", 
-      gsl::narrow_cast<AVSampleFormat>(this->_av_frame->format), 0);
-
-  av_opt_set_chlayout(swr, "out_chlayout", &_dst_frame->_av_frame->ch_layout, 0);
-  av_opt_set_int(swr, "out_sample_rate", _dst_frame->_av_frame->sample_rate, 0);
-  av_opt_set_sample_fmt(swr, "out_sample_fmt", 
-      p_dst_config.sample_fmts, 0);
-
-  /* initialize the resampling context */
-  if ((_ret = swr_init(swr)) < 0) {
-    fprintf(stderr, "Failed to initialize the resampling context\n");
-    return W_FAILURE(
-        std::errc::operation_canceled,
-        "failed to initialize the resampling context because: " + w_ffmpeg_ctx::get_av_error_str(_ret));
-  }
-
-   /* compute the number of converted samples: buffering is avoided
-   * ensuring that the output buffer will contain at least all the
-   * converted input samples */
-  max_dst_nb_samples = dst_nb_samples = av_rescale_rnd(this->_av_frame->nb_samples, _dst_frame->_av_frame->sample_rate,
-                     this->_av_frame->sample_rate, AV_ROUND_UP);
-
-  /* buffer is going to be directly written to a rawaudio file, no alignment */
-  dst_nb_channels = _dst_frame->_av_frame->ch_layout.nb_channels;
-  _ret = av_samples_alloc_array_and_samples(&dst_data, &dst_linesize,
-                                            dst_nb_channels,
-                                            dst_nb_samples, 
-      p_dst_config.sample_fmts, 0);
-  
-  _dst_frame->_av_frame->data[0] = std::move(dst_data[0]);
-  if (_ret < 0) {
-    auto tmp = w_ffmpeg_ctx::get_av_error_str(_ret);
-    return W_FAILURE(
-        std::errc::operation_canceled,
-        "could not allocate destination array because: " + w_ffmpeg_ctx::get_av_error_str(_ret));
-  }
-
-  /* compute destination number of samples */
-  dst_nb_samples =
-      av_rescale_rnd(swr_get_delay(swr, this->_av_frame->sample_rate) + this->_av_frame->nb_samples,
-                     _dst_frame->_av_frame->sample_rate, this->_av_frame->sample_rate, AV_ROUND_UP);
-  if (dst_nb_samples > max_dst_nb_samples) {
-    av_freep(&_dst_frame->_av_frame->data);
-    _ret = av_samples_alloc(_dst_frame->_av_frame->data, &dst_linesize, dst_nb_channels,
-                            dst_nb_samples, p_dst_config.sample_fmts,
-                           1);
-    if (_ret < 0)
-    {
-      auto tmp = w_ffmpeg_ctx::get_av_error_str(_ret);
-      return W_FAILURE(
-          std::errc::operation_canceled,
-          "could not allocate avframe samples because: " + w_ffmpeg_ctx::get_av_error_str(_ret));
-    }
-
-    max_dst_nb_samples = dst_nb_samples;
-  }
-
-  /* convert to destination format */
-  auto size =
-      swr_convert(swr, _dst_frame->_av_frame->data, dst_nb_samples,
-      (const uint8_t **)(&this->_av_frame->data[0]),
-      this->_av_frame->nb_samples);
-
-  if (size < 0) {
-    _ret = -1;
-    return W_FAILURE(std::errc::operation_canceled,
-                     "error while audio converting\n");
-  }
-
-  const auto _buffer_size =
-      av_samples_get_buffer_size(&dst_linesize, dst_nb_channels, size, p_dst_config.sample_fmts, 1);
-
-  if (_buffer_size < 0) {
-    _ret = -1;
-    return W_FAILURE(std::errc::operation_canceled,
-                     "could not get sample buffer size\n");
-  }
-
-  _dst_frame->_data_size = _buffer_size;
+  BOOST_LEAF_CHECK(_dst_frame->init());
+  BOOST_LEAF_CHECK(_converter.convert_audio(*this, *_dst_frame));
   return _dst_frame;
 }
 
 boost::leaf::result<std::shared_ptr<w_av_frame>> w_av_frame::convert_video(
     _In_ w_av_config &&p_dst_config) {
-  // create a buffer and dst frame
-  auto _video_buffer = std::vector<uint8_t>();
+  auto _converter = w_av_converter(p_dst_config);
   auto _dst_frame = std::make_shared<w_av_frame>(std::move(p_dst_config));
   BOOST_LEAF_CHECK(_dst_frame->init());
-  BOOST_LEAF_CHECK(_dst_frame->set_video_frame(std::move(_video_buffer)));
-
-  auto *_context = sws_getContext(
-      this->_config.width, this->_config.height, this->_config.format,
-                     _dst_frame->_config.width, _dst_frame->_config.height,
-                     _dst_frame->_config.format, SWS_BICUBIC, nullptr, nullptr, nullptr);
-  if (_context == nullptr) {
-    return W_FAILURE(std::errc::not_enough_memory,
-                     "could not create sws context");
-  }
-
-  auto _dst_frame_nn = gsl::not_null<AVFrame *>(_dst_frame->_av_frame);
-  const auto _height = sws_scale(
-      _context, gsl::narrow_cast<const uint8_t *const *>(this->_av_frame->data),
-      gsl::narrow_cast<const int *>(this->_av_frame->linesize), 0,
-      this->_config.height,
-      gsl::narrow_cast<uint8_t *const *>(_dst_frame_nn->data),
-      gsl::narrow_cast<const int *>(_dst_frame_nn->linesize));
-
-  // free context
-  sws_freeContext(_context);
-
-  if (_height < 0) {
-    return W_FAILURE(std::errc::invalid_argument,
-                     "w_av_frame sws_scale failed because: \"" +
-                         w_ffmpeg_ctx::get_av_error_str(_height) + "\"");
-  }
-
-  const auto _buffer_size =
-      av_image_get_buffer_size(gsl::narrow_cast<AVPixelFormat>(_dst_frame->_av_frame->format),
-                               _dst_frame->_av_frame->width, _dst_frame->_av_frame->height, 4);
-
- if (_buffer_size < 0) {
-    return W_FAILURE(std::errc::operation_canceled, "could not get sample buffer size\n");
-  }
-
-  _dst_frame->_data_size = _buffer_size;
+  BOOST_LEAF_CHECK(_converter.convert_video(*this, *_dst_frame));
   return _dst_frame;
 }
 
@@ -20,10 +20,12 @@ extern "C" {
 
 namespace wolf::media::ffmpeg {
 
+class w_av_converter;
 class w_decoder;
 class w_encoder;
 
 class w_av_frame {
+  friend w_av_converter;
   friend w_decoder;
   friend w_encoder;
 
@@ -87,7 +89,8 @@ class w_av_frame {
   std::tuple<uint8_t *, int> get_v_plane() const noexcept;
 
   /**
-   * convert the ffmpeg video AVFrame
+   * convert the ffmpeg video AVFrame. it makes a context and a frame per
+   * call, use w_av_converter to convert a stream of frames
    * @returns the converted instance of AVFrame
    */
   W_API
@@ -95,7 +98,9 @@ class w_av_frame {
       _In_ w_av_config &&p_dst_config);
 
   /**
-   * convert the ffmpeg audio AVFrame
+   * convert the ffmpeg audio AVFrame. it makes a context and a frame per
+   * call and drops the samples which the resampler delays, use
+   * w_av_converter to convert a stream of frames
    * @returns the converted instance of AVFrame
    */
   W_API
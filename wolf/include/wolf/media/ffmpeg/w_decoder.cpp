@@ -2,6 +2,8 @@
 
 #include "w_decoder.hpp"
 
+#include <wolf/system/w_profiler.hpp>
+
 using w_decoder = wolf::media::ffmpeg::w_decoder;
 
 boost::leaf::result<int> w_decoder::decode_frame_from_packet(
@@ -31,6 +33,8 @@ boost::leaf::result<int> w_decoder::decode_frame_from_packet(
 boost::leaf::result<int> w_decoder::decode(_In_ const w_av_packet &p_packet,
                                            _Inout_ w_av_frame &p_frame,
                                            _In_ bool p_flush) noexcept {
+  W_PROFILE_SCOPE("w_decoder::decode");
+
   auto _dst_packet = w_av_packet();
   _dst_packet.init();
 
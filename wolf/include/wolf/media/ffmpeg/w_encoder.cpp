@@ -2,6 +2,8 @@
 
 #include "w_encoder.hpp"
 
+#include <wolf/system/w_profiler.hpp>
+
 using w_encoder = wolf::media::ffmpeg::w_encoder;
 using w_av_packet = wolf::media::ffmpeg::w_av_packet;
 
@@ -46,6 +48,8 @@ boost::leaf::result<int> w_encoder::_encode_frame_to_packet(
 boost::leaf::result<int> w_encoder::encode(_In_ const w_av_frame &p_frame,
                                            _Inout_ w_av_packet &p_packet,
                                            _In_ bool p_flush) noexcept {
+  W_PROFILE_SCOPE("w_encoder::encode");
+
   std::vector<uint8_t> _packet_data;
 
   // encode frame to packet
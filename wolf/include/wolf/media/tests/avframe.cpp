@@ -6,6 +6,7 @@
 #if defined(WOLF_TEST) && defined(WOLF_MEDIA_FFMPEG) && defined(WOLF_MEDIA_STB)
 
 #include <boost/test/unit_test.hpp>
+#include <media/ffmpeg/w_av_converter.hpp>
 #include <media/ffmpeg/w_av_frame.hpp>
 #include <media/ffmpeg/w_av_packet.hpp>
 #include <system/w_leak_detector.hpp>
@@ -53,4 +54,83 @@ BOOST_AUTO_TEST_CASE(avframe_test)
   std::cout << "leaving test case 'avframe_test'" << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(avframe_converter_test)
+{
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'avframe_converter_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void>
+      {
+        using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+        using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+        using w_av_config = wolf::media::ffmpeg::w_av_config;
+
+        // the video frames reuse the buffer of the destination
+        const std::filesystem::path path = wolf::get_content_path("texture/rgb.png");
+        BOOST_LEAF_AUTO(_src_frame, w_av_frame::load_video_frame_from_img_file(
+                                        path, AVPixelFormat::AV_PIX_FMT_RGBA));
+        const auto _config = _src_frame.get_config();
+
+        auto _video_converter = w_av_converter(w_av_config(
+            AVPixelFormat::AV_PIX_FMT_BGRA, _config.width, _config.height));
+        auto _dst_frame =
+            w_av_frame(w_av_config(_video_converter.get_dst_config()));
+        BOOST_LEAF_CHECK(_dst_frame.init());
+
+        BOOST_LEAF_AUTO(_rows, _video_converter.convert_video(_src_frame, _dst_frame));
+        BOOST_REQUIRE(_rows == _config.height);
+        auto *_buffer = _dst_frame.get_frame()->data[0];
+        BOOST_LEAF_CHECK(_video_converter.convert_video(_src_frame, _dst_frame));
+        BOOST_REQUIRE(_dst_frame.get_frame()->data[0] == _buffer);
+
+        // the audio frames keep the delay of the resampler, so all samples
+        // come out once the converter is flushed
+        constexpr auto _nb_frames = 8;
+        constexpr auto _nb_samples = 1024;
+        auto _audio_src =
+            w_av_frame(w_av_config(2, AVSampleFormat::AV_SAMPLE_FMT_FLTP, 48'000));
+        BOOST_LEAF_CHECK(_audio_src.init());
+        auto *_audio_src_frame = _audio_src.get_frame();
+        _audio_src_frame->format = AVSampleFormat::AV_SAMPLE_FMT_FLTP;
+        _audio_src_frame->nb_samples = _nb_samples;
+        BOOST_REQUIRE(av_frame_get_buffer(_audio_src_frame, 0) == 0);
+        BOOST_REQUIRE(av_samples_set_silence(_audio_src_frame->extended_data, 0,
+                                             _nb_samples, 2,
+                                             AVSampleFormat::AV_SAMPLE_FMT_FLTP) == 0);
+
+        auto _audio_converter = w_av_converter(
+            w_av_config(2, AVSampleFormat::AV_SAMPLE_FMT_S16, 44'100));
+        auto _audio_dst =
+            w_av_frame(w_av_config(_audio_converter.get_dst_config()));
+        BOOST_LEAF_CHECK(_audio_dst.init());
+
+        auto _total = 0;
+        for (auto i = 0; i < _nb_frames; ++i)
+        {
+          BOOST_LEAF_AUTO(_samples,
+                          _audio_converter.convert_audio(_audio_src, _audio_dst));
+          _total += _samples;
+        }
+        BOOST_LEAF_AUTO(_flushed, _audio_converter.flush_audio(_audio_dst));
+        _total += _flushed;
+
+        const auto _expected = _nb_frames * _nb_samples * 44'100 / 48'000;
+        BOOST_REQUIRE(std::abs(_total - _expected) <= 2);
+
+        return {};
+      },
+      [](const w_trace &p_trace)
+      {
+        const auto _msg = wolf::format("avframe_converter_test got an error: {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      []
+      { BOOST_ERROR("avframe_converter_test got an error!"); });
+
+  std::cout << "leaving test case 'avframe_converter_test'" << std::endl;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_BENCHMARKS) && \
+    (defined(WOLF_ML_OCR) || defined(WOLF_ML_NUDITY_DETECTION))
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <wolf/ml/w_utilities.hpp>
+
+namespace {
+
+std::string s_make_word(_Inout_ std::mt19937 &p_rand, _In_ size_t p_size) {
+  std::uniform_int_distribution<int> _dist('a', 'z');
+  std::string _word(p_size, ' ');
+  for (auto &_c : _word) {
+    _c = gsl::narrow_cast<char>(_dist(p_rand));
+  }
+  return _word;
+}
+
+// the ocr compares short names, e.g. team names, against a list of candidates
+void s_normalized_levenshtein_similarity(benchmark::State &p_state) {
+  const auto _size = gsl::narrow_cast<size_t>(p_state.range(0));
+
+  std::mt19937 _rand(gsl::narrow_cast<uint32_t>(_size));
+  const auto _lhs = s_make_word(_rand, _size);
+  const auto _rhs = s_make_word(_rand, _size);
+
+  for (auto _ : p_state) {
+    benchmark::DoNotOptimize(
+        wolf::ml::normalized_levenshtein_similarity(_lhs, _rhs));
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()));
+}
+
+}  // namespace
+
+BENCHMARK(s_normalized_levenshtein_similarity)
+    ->Name("ml/normalized_levenshtein_similarity")
+    ->RangeMultiplier(4)
+    ->Range(4, 256);
+
+#endif  // WOLF_BENCHMARKS
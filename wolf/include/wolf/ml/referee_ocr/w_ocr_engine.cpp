@@ -8,6 +8,8 @@
 #include <cstring>
 #include <filesystem>
 
+#include <wolf/system/w_profiler.hpp>
+
 #include "../w_utilities.hpp"
 
 namespace fs = std::filesystem;
@@ -249,6 +251,8 @@ w_ocr_engine::filter_chars_by_contour_size(
 std::vector<w_ocr_engine::characters_struct>
 w_ocr_engine::image_to_char_structs(_In_ cv::Mat &image_box,
                                     _In_ config_for_ocr_struct &ocr_config) {
+  W_PROFILE_SCOPE("w_ocr_engine::image_to_char_structs");
+
   cv::Mat filtered_image =
       prepare_image_for_contour_detection(image_box, ocr_config);
 
@@ -276,6 +280,8 @@ std::vector<w_ocr_engine::character_and_center> w_ocr_engine::char_vec_to_string
     _In_ std::vector<w_ocr_engine::characters_struct> char_vector,
     _In_ cv::Mat &frame, _In_ config_for_ocr_struct &ocr_config)
 {
+  W_PROFILE_SCOPE("w_ocr_engine::char_vec_to_string");
+
   std::vector<w_ocr_engine::characters_struct> labeled_characters =
       label_chars_in_char_structs(char_vector, frame, ocr_config);
   std::vector<std::vector<w_ocr_engine::characters_struct>>
@@ -290,6 +296,8 @@ std::vector<w_ocr_engine::character_and_center> w_ocr_engine::char_vec_to_string
 std::vector<w_ocr_engine::character_and_center>
 w_ocr_engine::image_to_string(_In_ cv::Mat &image,
                               _In_ config_for_ocr_struct &ocr_config) {
+  W_PROFILE_SCOPE("w_ocr_engine::image_to_string");
+
   std::vector<characters_struct> characters =
       image_to_char_structs(image, ocr_config);
   std::vector<characters_struct> labeled_characters =
@@ -306,6 +314,8 @@ std::vector<w_ocr_engine::characters_struct>
 w_ocr_engine::label_chars_in_char_structs(
     _In_ std::vector<w_ocr_engine::characters_struct> &characters,
     _In_ cv::Mat &image_box, _In_ config_for_ocr_struct &ocr_config) {
+  W_PROFILE_SCOPE("w_ocr_engine::label_chars_in_char_structs");
+
   std::vector<characters_struct> labeled_chars;
   tesseract::TessBaseAPI *tess_api;
   if (ocr_config.is_digit) {
@@ -487,6 +497,8 @@ std::vector<std::vector<w_ocr_engine::characters_struct>>
 w_ocr_engine::cluster_char_structs(
     std::vector<w_ocr_engine::characters_struct> characters,
     config_for_ocr_struct &ocr_config) {
+  W_PROFILE_SCOPE("w_ocr_engine::cluster_char_structs");
+
   std::vector<std::vector<characters_struct>> clustered_characters;
 
   if (characters.size() == 0) {
@@ -0,0 +1,427 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_BENCHMARKS) && \
+    (defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA))
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <wolf/wolf.hpp>
+
+#include <wolf/system/compression/w_chunked.hpp>
+#include <wolf/system/compression/w_compressor.hpp>
+
+#ifdef WOLF_SYSTEM_LZ4
+#include <wolf/system/compression/w_lz4.hpp>
+#endif
+
+#ifdef WOLF_SYSTEM_LZMA
+#include <wolf/system/compression/w_lzma.hpp>
+#endif
+
+namespace {
+
+// a text like input, which is neither random nor trivially compressible
+std::vector<std::byte> s_make_input(_In_ size_t p_size) {
+  constexpr std::array<std::string_view, 8> _words = {
+      "wolf ", "engine ", "frame ", "packet ", "socket ", "stream ", "\n",
+      "0123456789 "};
+
+  std::mt19937 _rand(p_size);
+  std::uniform_int_distribution<size_t> _dist(0, _words.size() - 1);
+
+  std::vector<std::byte> _input;
+  _input.reserve(p_size);
+  while (_input.size() < p_size) {
+    const auto _word = gsl::at(_words, _dist(_rand));
+    for (const auto _c : _word) {
+      if (_input.size() == p_size) {
+        break;
+      }
+      _input.push_back(static_cast<std::byte>(_c));
+    }
+  }
+  return _input;
+}
+
+template <class F>
+void s_run(_Inout_ benchmark::State &p_state,
+           _In_ const std::vector<std::byte> &p_src, _In_ F &&p_func) {
+  for (auto _ : p_state) {
+    auto _res = p_func(p_src);
+    if (!_res) {
+      p_state.SkipWithError("compression failed");
+      break;
+    }
+    benchmark::DoNotOptimize(_res.value().data());
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            p_state.range(0));
+}
+
+}  // namespace
+
+#ifdef WOLF_SYSTEM_LZ4
+
+namespace {
+
+using w_lz4 = wolf::system::compression::w_lz4;
+
+void s_lz4_compress_default(benchmark::State &p_state) {
+  const auto _src = s_make_input(gsl::narrow_cast<size_t>(p_state.range(0)));
+  s_run(p_state, _src, [](const auto &p_src) {
+    return w_lz4::compress_default(p_src);
+  });
+}
+
+void s_lz4_compress_fast(benchmark::State &p_state) {
+  const auto _src = s_make_input(gsl::narrow_cast<size_t>(p_state.range(0)));
+  s_run(p_state, _src, [](const auto &p_src) {
+    return w_lz4::compress_fast(p_src, 8);
+  });
+}
+
+void s_lz4_decompress(benchmark::State &p_state) {
+  const auto _src = s_make_input(gsl::narrow_cast<size_t>(p_state.range(0)));
+  auto _compressed = w_lz4::compress_default(_src);
+  if (!_compressed) {
+    p_state.SkipWithError("compression failed");
+    return;
+  }
+  const auto _dst = std::move(_compressed.value());
+  for (auto _ : p_state) {
+    auto _res = w_lz4::decompress(_dst, 10);
+    if (!_res) {
+      p_state.SkipWithError("decompression failed");
+      break;
+    }
+    benchmark::DoNotOptimize(_res.value().data());
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            p_state.range(0));
+}
+
+// a single pass into a reused buffer, the size comes from the header
+void s_lz4_decompress_sized(benchmark::State &p_state) {
+  const auto _src = s_make_input(gsl::narrow_cast<size_t>(p_state.range(0)));
+  auto _compressed = w_lz4::compress_sized(_src);
+  if (!_compressed) {
+    p_state.SkipWithError("compression failed");
+    return;
+  }
+  const auto _block = std::move(_compressed.value());
+  auto _dst = std::vector<std::byte>(_src.size());
+  for (auto _ : p_state) {
+    auto _res = w_lz4::decompress_sized(_block, _dst);
+    if (!_res) {
+      p_state.SkipWithError("decompression failed");
+      break;
+    }
+    benchmark::DoNotOptimize(_dst.data());
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            p_state.range(0));
+}
+
+// streams the input through a reused, block sized output buffer
+void s_lz4_frame_compress(benchmark::State &p_state) {
+  using w_lz4_frame_compressor =
+      wolf::system::compression::w_lz4_frame_compressor;
+
+  const auto _src = s_make_input(gsl::narrow_cast<size_t>(p_state.range(0)));
+  constexpr auto _chunk_size = size_t{64} * 1024;
+
+  auto _compressor = w_lz4_frame_compressor();
+  auto _out = std::vector<std::byte>(
+      _compressor.get_compress_bound(_chunk_size));
+  for (auto _ : p_state) {
+    size_t _total = 0;
+    auto _res = _compressor.begin(_out);
+    for (size_t i = 0; _res && i < _src.size(); i += _chunk_size) {
+      _total += _res.value();
+      _res = _compressor.update(
+          gsl::span<const std::byte>(_src).subspan(
+              i, std::min(_chunk_size, _src.size() - i)),
+          _out);
+    }
+    if (_res) {
+      _total += _res.value();
+      _res = _compressor.finish(_out);
+    }
+    if (!_res) {
+      p_state.SkipWithError("compression failed");
+      break;
+    }
+    benchmark::DoNotOptimize(_total += _res.value());
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            p_state.range(0));
+}
+
+// control packets of a chatty channel, which share keys but not values
+std::vector<std::string> s_make_messages(_In_ size_t p_count) {
+  std::vector<std::string> _messages;
+  _messages.reserve(p_count);
+  for (size_t i = 0; i < p_count; ++i) {
+    _messages.push_back(wolf::format(
+        R"({{"type":"state","session_id":"{:08x}","sequence":{},)"
+        R"("timestamp":{},"status":"connected","position":[{},{},{}]}})",
+        i * 2654435761U, i, 1700000000000 + i * 37, i % 101, i % 13, i % 7));
+  }
+  return _messages;
+}
+
+auto s_as_bytes(_In_ const std::string &p_str) noexcept
+    -> gsl::span<const std::byte> {
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  return {reinterpret_cast<const std::byte *>(p_str.data()), p_str.size()};
+  // NOLINTEND
+}
+
+// the argument is zero for plain lz4 and one for the trained dictionary
+void s_lz4_small_messages(benchmark::State &p_state) {
+  using w_lz4_dictionary = wolf::system::compression::w_lz4_dictionary;
+
+  const auto _training = s_make_messages(1000);
+  std::vector<gsl::span<const std::byte>> _samples;
+  for (const auto &_msg : _training) {
+    _samples.push_back(s_as_bytes(_msg));
+  }
+  auto _trained = w_lz4_dictionary::train(_samples);
+  if (!_trained) {
+    p_state.SkipWithError("training failed");
+    return;
+  }
+  const auto _dictionary = std::move(_trained.value());
+  const auto _use_dictionary = p_state.range(0) != 0;
+
+  auto _messages = s_make_messages(2000);
+  _messages.erase(_messages.begin(), _messages.begin() + 1000);
+
+  auto _dst = std::vector<std::byte>(1024);
+  size_t _i = 0;
+  int64_t _in = 0;
+  int64_t _out = 0;
+  for (auto _ : p_state) {
+    const auto _src = s_as_bytes(_messages[_i++ % _messages.size()]);
+    auto _res = _use_dictionary ? _dictionary.compress(_src, _dst)
+                                : w_lz4::compress_default(_src, _dst);
+    if (!_res) {
+      p_state.SkipWithError("compression failed");
+      break;
+    }
+    _in += gsl::narrow_cast<int64_t>(_src.size());
+    _out += gsl::narrow_cast<int64_t>(_res.value());
+    benchmark::DoNotOptimize(_dst.data());
+  }
+  p_state.SetBytesProcessed(_in);
+  p_state.counters["ratio"] =
+      _out == 0 ? 0.0 : static_cast<double>(_in) / static_cast<double>(_out);
+}
+
+}  // namespace
+
+BENCHMARK(s_lz4_compress_default)
+    ->Name("compress/lz4_default")
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK(s_lz4_compress_fast)
+    ->Name("compress/lz4_fast")
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK(s_lz4_decompress)
+    ->Name("compress/lz4_decompress")
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK(s_lz4_small_messages)
+    ->Name("compress/lz4_small_messages")
+    ->Arg(0)
+    ->Arg(1);
+BENCHMARK(s_lz4_decompress_sized)
+    ->Name("compress/lz4_decompress_sized")
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK(s_lz4_frame_compress)
+    ->Name("compress/lz4_frame")
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 22);
+
+#endif  // WOLF_SYSTEM_LZ4
+
+#ifdef WOLF_SYSTEM_LZMA
+
+namespace {
+
+using w_lzma = wolf::system::compression::w_lzma;
+
+void s_lzma1_compress(benchmark::State &p_state) {
+  const auto _src = s_make_input(gsl::narrow_cast<size_t>(p_state.range(0)));
+  s_run(p_state, _src, [](const auto &p_src) {
+    return w_lzma::compress_lzma1(p_src, 5);
+  });
+}
+
+void s_lzma2_compress(benchmark::State &p_state) {
+  const auto _src = s_make_input(gsl::narrow_cast<size_t>(p_state.range(0)));
+  s_run(p_state, _src, [](const auto &p_src) {
+    return w_lzma::compress_lzma2(p_src, 5);
+  });
+}
+
+void s_lzma2_decompress(benchmark::State &p_state) {
+  const auto _src = s_make_input(gsl::narrow_cast<size_t>(p_state.range(0)));
+  auto _compressed = w_lzma::compress_lzma2(_src, 5);
+  if (!_compressed) {
+    p_state.SkipWithError("compression failed");
+    return;
+  }
+  const auto _dst = std::move(_compressed.value());
+  for (auto _ : p_state) {
+    auto _res = w_lzma::decompress_lzma2(_dst);
+    if (!_res) {
+      p_state.SkipWithError("decompression failed");
+      break;
+    }
+    benchmark::DoNotOptimize(_res.value().data());
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            p_state.range(0));
+}
+
+}  // namespace
+
+// lzma is slow, so keep the biggest input smaller than lz4
+BENCHMARK(s_lzma1_compress)
+    ->Name("compress/lzma1")
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 19);
+BENCHMARK(s_lzma2_compress)
+    ->Name("compress/lzma2")
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 19);
+BENCHMARK(s_lzma2_decompress)
+    ->Name("compress/lzma2_decompress")
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 19);
+
+#endif  // WOLF_SYSTEM_LZMA
+
+namespace {
+
+using w_chunked = wolf::system::compression::w_chunked;
+using w_chunked_codec = wolf::system::compression::w_chunked_codec;
+using w_chunked_options = wolf::system::compression::w_chunked_options;
+
+// 64 MB in 1 MB blocks, the argument is the number of threads
+constexpr size_t s_chunked_input_size = size_t{64} * 1024 * 1024;
+
+auto s_chunked_options(_In_ const benchmark::State &p_state) noexcept
+    -> w_chunked_options {
+  w_chunked_options _opts = {};
+#ifdef WOLF_SYSTEM_LZ4
+  _opts.codec = w_chunked_codec::LZ4;
+#else
+  _opts.codec = w_chunked_codec::LZMA2;
+  _opts.level = 1;
+#endif
+  _opts.threads = gsl::narrow_cast<size_t>(p_state.range(0));
+  return _opts;
+}
+
+void s_chunked_compress(benchmark::State &p_state) {
+  const auto _src = s_make_input(s_chunked_input_size);
+  const auto _opts = s_chunked_options(p_state);
+  for (auto _ : p_state) {
+    auto _res = w_chunked::compress(_src, _opts);
+    if (!_res) {
+      p_state.SkipWithError("compression failed");
+      break;
+    }
+    benchmark::DoNotOptimize(_res.value().data());
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_src.size()));
+}
+
+void s_chunked_decompress(benchmark::State &p_state) {
+  const auto _src = s_make_input(s_chunked_input_size);
+  auto _compressed = w_chunked::compress(_src, s_chunked_options(p_state));
+  if (!_compressed) {
+    p_state.SkipWithError("compression failed");
+    return;
+  }
+  const auto _container = std::move(_compressed.value());
+  const auto _threads = gsl::narrow_cast<size_t>(p_state.range(0));
+  for (auto _ : p_state) {
+    auto _res = w_chunked::decompress(_container, _threads);
+    if (!_res) {
+      p_state.SkipWithError("decompression failed");
+      break;
+    }
+    benchmark::DoNotOptimize(_res.value().data());
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_src.size()));
+}
+
+}  // namespace
+
+namespace {
+
+using w_compressor = wolf::system::compression::w_compressor;
+using w_compressor_options = wolf::system::compression::w_compressor_options;
+using w_compression_target = wolf::system::compression::w_compression_target;
+
+// the first argument is the target, the second one is zero for the text and
+// one for a noise, which stands for an already compressed payload
+void s_adaptive_compress(benchmark::State &p_state) {
+  constexpr auto _size = size_t{1} << 20;
+  auto _src = s_make_input(_size);
+  if (p_state.range(1) != 0) {
+    std::mt19937 _rand(42);
+    for (auto &_byte : _src) {
+      _byte = gsl::narrow_cast<std::byte>(_rand() & 0xFF);
+    }
+  }
+
+  w_compressor_options _opts = {};
+  _opts.target = static_cast<w_compression_target>(p_state.range(0));
+
+  size_t _compressed = 0;
+  for (auto _ : p_state) {
+    auto _res = w_compressor::compress(_src, _opts);
+    if (!_res) {
+      p_state.SkipWithError("compression failed");
+      break;
+    }
+    _compressed = _res.value().size();
+    benchmark::DoNotOptimize(_res.value().data());
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_size));
+  p_state.counters["ratio"] =
+      _compressed == 0 ? 0.0
+                       : static_cast<double>(_size) /
+                             static_cast<double>(_compressed);
+}
+
+}  // namespace
+
+BENCHMARK(s_adaptive_compress)
+    ->Name("compress/adaptive")
+    ->ArgsProduct({{0, 1, 2}, {0, 1}});
+BENCHMARK(s_chunked_compress)
+    ->Name("compress/chunked")
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->UseRealTime();
+BENCHMARK(s_chunked_decompress)
+    ->Name("compress/chunked_decompress")
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->UseRealTime();
+
+#endif  // WOLF_BENCHMARKS
@@ -0,0 +1,70 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#ifdef WOLF_BENCHMARKS
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <memory>
+#include <wolf/wolf.hpp>
+
+namespace {
+
+// a typical socket callback captures a few pointers and a shared state
+auto s_make_callback(_In_ int *p_counter,
+                     _In_ const std::shared_ptr<int> &p_state) {
+  const auto *_self = p_counter;
+  return [p_counter, _self, p_state](int p_value) noexcept -> int {
+    *p_counter += p_value + *p_state;
+    return *_self;
+  };
+}
+
+template <class F>
+void s_construct(benchmark::State &p_state) {
+  int _counter = 0;
+  const auto _shared = std::make_shared<int>(1);
+  for (auto _ : p_state) {
+    F _func = s_make_callback(&_counter, _shared);
+    benchmark::DoNotOptimize(_func);
+  }
+}
+
+template <class F>
+void s_move(benchmark::State &p_state) {
+  int _counter = 0;
+  const auto _shared = std::make_shared<int>(1);
+  F _func = s_make_callback(&_counter, _shared);
+  for (auto _ : p_state) {
+    F _moved = std::move(_func);
+    benchmark::DoNotOptimize(_moved);
+    _func = std::move(_moved);
+  }
+}
+
+template <class F>
+void s_call(benchmark::State &p_state) {
+  int _counter = 0;
+  const auto _shared = std::make_shared<int>(1);
+  F _func = s_make_callback(&_counter, _shared);
+  for (auto _ : p_state) {
+    benchmark::DoNotOptimize(_func(1));
+  }
+}
+
+using w_callback = wolf::w_function<int(int)>;
+using std_callback = std::function<int(int)>;
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(s_construct, w_callback)->Name("w_function/construct");
+BENCHMARK_TEMPLATE(s_construct, std_callback)->Name("std_function/construct");
+BENCHMARK_TEMPLATE(s_move, w_callback)->Name("w_function/move");
+BENCHMARK_TEMPLATE(s_move, std_callback)->Name("std_function/move");
+BENCHMARK_TEMPLATE(s_call, w_callback)->Name("w_function/call");
+BENCHMARK_TEMPLATE(s_call, std_callback)->Name("std_function/call");
+
+#endif  // WOLF_BENCHMARKS
@@ -0,0 +1,60 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_BENCHMARKS) && defined(WOLF_SYSTEM_LOG)
+
+#include <benchmark/benchmark.h>
+
+#include <wolf/system/log/w_log.hpp>
+#include <wolf/wolf.hpp>
+
+namespace {
+
+using w_log = wolf::system::log::w_log;
+using w_log_config = wolf::system::log::w_log_config;
+using w_log_sink = wolf::system::log::w_log_sink;
+
+// write into an async file sink, the console would measure the terminal
+void s_log_write(benchmark::State &p_state) {
+  // spdlog registers loggers by the file name, so each run needs a new one
+  static int s_run = 0;
+  const auto _path = std::filesystem::temp_directory_path() /
+                     "wolf_benchmarks" / wolf::format("log_{}.txt", s_run++);
+
+  w_log_config _config = {
+      // create an async logger
+      true,
+      // enable multi-threaded feature
+      p_state.range(0) != 0,
+      // the path of log file
+      _path,
+      // the log level
+      spdlog::level::level_enum::debug,
+      // the flush level
+      spdlog::level::level_enum::err,
+      // the sinks of log
+      w_log_sink::ASYNC_FILE};
+
+  w_log _log(std::move(_config));
+  if (!_log.init()) {
+    p_state.SkipWithError("could not initialize w_log");
+    return;
+  }
+
+  int64_t _frame = 0;
+  for (auto _ : p_state) {
+    _log.write(spdlog::level::level_enum::info,
+               "frame {} took {} ms and sent {} bytes", _frame, 16.6, 1024);
+    ++_frame;
+  }
+  _log.flush();
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()));
+}
+
+}  // namespace
+
+BENCHMARK(s_log_write)->Name("w_log/write_async_file")->Arg(0)->Arg(1);
+
+#endif  // WOLF_BENCHMARKS
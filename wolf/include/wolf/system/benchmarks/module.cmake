@@ -0,0 +1,8 @@
+target_sources(${BENCHMARK_PROJECT_NAME}
+    PRIVATE
+        ${SYSTEM_PATH}/benchmarks/compress.cpp
+        ${SYSTEM_PATH}/benchmarks/invocable.cpp
+        ${SYSTEM_PATH}/benchmarks/log.cpp
+        ${SYSTEM_PATH}/benchmarks/socket.cpp
+        ${SYSTEM_PATH}/benchmarks/trace.cpp
+)
@@ -0,0 +1,866 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_BENCHMARKS) && defined(WOLF_SYSTEM_SOCKET)
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <thread>
+#include <wolf/system/socket/w_io_context_pool.hpp>
+#include <wolf/system/socket/w_tcp_client_pool.hpp>
+#include <wolf/system/socket/w_tcp_server.hpp>
+#include <wolf/system/socket/w_timer_wheel.hpp>
+#include <wolf/system/socket/w_udp_server.hpp>
+#include <wolf/wolf.hpp>
+
+#ifdef WOLF_SYSTEM_HTTP_WS
+#include <wolf/system/socket/w_ws_server.hpp>
+#endif
+
+namespace {
+
+using tcp = boost::asio::ip::tcp;
+using w_socket_options = wolf::system::socket::w_socket_options;
+
+constexpr auto s_connect_retries = 50;
+
+// report the tail latency of the round trips as counters
+void s_report_latency(_Inout_ benchmark::State &p_state,
+                      _Inout_ std::vector<uint64_t> &p_latencies_ns) {
+  if (p_latencies_ns.empty()) {
+    return;
+  }
+  std::sort(p_latencies_ns.begin(), p_latencies_ns.end());
+  const auto _percentile = [&](_In_ double p_percent) {
+    const auto _index = std::min(
+        p_latencies_ns.size() - 1,
+        gsl::narrow_cast<size_t>(p_percent * p_latencies_ns.size() / 100.0));
+    return gsl::narrow_cast<double>(p_latencies_ns[_index]) / 1000.0;
+  };
+  p_state.counters["p50_us"] = _percentile(50.0);
+  p_state.counters["p99_us"] = _percentile(99.0);
+  p_state.counters["p999_us"] = _percentile(99.9);
+  p_state.counters["max_us"] =
+      gsl::narrow_cast<double>(p_latencies_ns.back()) / 1000.0;
+}
+
+// run a round trip per iteration and collect its latency
+template <class F>
+void s_echo_loop(_Inout_ benchmark::State &p_state, _In_ F &&p_round_trip) {
+  std::vector<uint64_t> _latencies_ns;
+  _latencies_ns.reserve(1024 * 1024);
+  for (auto _ : p_state) {
+    const auto _begin = std::chrono::steady_clock::now();
+    if (!p_round_trip()) {
+      p_state.SkipWithError("echo failed");
+      break;
+    }
+    _latencies_ns.push_back(gsl::narrow_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _begin)
+            .count()));
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            p_state.range(0) * 2);
+  s_report_latency(p_state, _latencies_ns);
+}
+
+template <class S>
+bool s_connect(_Inout_ S &p_socket, _In_ const tcp::endpoint &p_endpoint) {
+  // the acceptor is opened once the io_context starts running
+  for (auto i = 0; i < s_connect_retries; ++i) {
+    boost::system::error_code _error;
+    p_socket.connect(p_endpoint, _error);
+    if (!_error) {
+      return true;
+    }
+    p_socket.close();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  return false;
+}
+
+void s_tcp_echo(benchmark::State &p_state) {
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28080);
+
+  boost::asio::io_context _io;
+  auto _run = w_tcp_server::run(
+      _io, tcp::endpoint(_endpoint), std::chrono::seconds(10),
+      w_socket_options{},
+      [](const std::string &, w_buffer &) -> auto {
+        return boost::system::errc::success;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run tcp server");
+    return;
+  }
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  tcp::socket _socket(_client_io);
+  if (!s_connect(_socket, _endpoint)) {
+    _io.stop();
+    p_state.SkipWithError("could not connect to tcp server");
+    return;
+  }
+  _socket.set_option(tcp::no_delay(true));
+
+  const auto _size = gsl::narrow_cast<size_t>(p_state.range(0));
+  const auto _payload = std::string(_size, 'w');
+  auto _echo = std::string(_size, '\0');
+
+  s_echo_loop(p_state, [&]() {
+    boost::system::error_code _error;
+    boost::asio::write(_socket, boost::asio::buffer(_payload), _error);
+    if (!_error) {
+      boost::asio::read(_socket, boost::asio::buffer(_echo), _error);
+    }
+    return !_error;
+  });
+
+  _socket.close();
+  _io.stop();
+}
+
+// a request which is answered by many small responses, the session gathers
+// the queued responses into one write
+void s_tcp_session_fanout(benchmark::State &p_state) {
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+  using w_tcp_session = wolf::system::socket::w_tcp_session;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28083);
+  const auto _responses = gsl::narrow_cast<size_t>(p_state.range(0));
+  constexpr size_t _size = 64;
+  const auto _response = w_buffer(std::string(_size, 'w'));
+
+  boost::asio::io_context _io;
+  auto _run = w_tcp_server::run(
+      _io, tcp::endpoint(_endpoint), std::chrono::seconds(10),
+      w_socket_options{},
+      [&](w_tcp_session &p_session, w_buffer &) -> auto {
+        for (size_t i = 0; i < _responses; ++i) {
+          p_session.send(_response);
+        }
+        return boost::system::errc::success;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run tcp server");
+    return;
+  }
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  tcp::socket _socket(_client_io);
+  if (!s_connect(_socket, _endpoint)) {
+    _io.stop();
+    p_state.SkipWithError("could not connect to tcp server");
+    return;
+  }
+  _socket.set_option(tcp::no_delay(true));
+
+  auto _echo = std::string(_size * _responses, '\0');
+  for (auto _ : p_state) {
+    boost::system::error_code _error;
+    boost::asio::write(_socket, boost::asio::buffer("w", 1), _error);
+    if (!_error) {
+      boost::asio::read(_socket, boost::asio::buffer(_echo), _error);
+    }
+    if (_error) {
+      p_state.SkipWithError("fan out failed");
+      break;
+    }
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_responses));
+
+  _socket.close();
+  _io.stop();
+}
+
+// small frames which arrive together, the session splits all frames of a
+// receive in place and answers each one
+void s_tcp_framed_batch(benchmark::State &p_state) {
+  using w_frame_reader = wolf::system::socket::w_frame_reader;
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+  using w_tcp_session = wolf::system::socket::w_tcp_session;
+  using w_varint_frame_codec = wolf::system::socket::w_varint_frame_codec;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28084);
+  const auto _frames = gsl::narrow_cast<size_t>(p_state.range(0));
+  constexpr size_t _size = 32;
+  const auto _codec = std::make_shared<w_varint_frame_codec>();
+
+  boost::asio::io_context _io;
+  auto _run = w_tcp_server::run(
+      _io, tcp::endpoint(_endpoint), std::chrono::seconds(10),
+      w_socket_options{}, _codec,
+      [](w_tcp_session &p_session, gsl::span<const std::byte> p_frame)
+          -> auto {
+        p_session.send_frame(p_frame);
+        return boost::system::errc::success;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run tcp server");
+    return;
+  }
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  tcp::socket _socket(_client_io);
+  if (!s_connect(_socket, _endpoint)) {
+    _io.stop();
+    p_state.SkipWithError("could not connect to tcp server");
+    return;
+  }
+  _socket.set_option(tcp::no_delay(true));
+
+  // all frames of an iteration go out in one write
+  const auto _payload = std::vector<std::byte>(_size, std::byte{'w'});
+  std::string _batch;
+  for (size_t i = 0; i < _frames; ++i) {
+    _batch += _codec->encode(_payload).value().to_string();
+  }
+
+  w_frame_reader _reader(_codec);
+  for (auto _ : p_state) {
+    boost::system::error_code _error;
+    boost::asio::write(_socket, boost::asio::buffer(_batch), _error);
+
+    size_t _received = 0;
+    while (!_error && _received < _frames) {
+      const auto _space = _reader.prepare();
+      const auto _bytes = _socket.read_some(
+          boost::asio::buffer(_space.data(), _space.size()), _error);
+      _reader.commit(_bytes);
+      auto _count = _reader.read_frames([](auto) { return true; });
+      _received += _count ? _count.value() : _frames;
+    }
+    if (_error) {
+      p_state.SkipWithError("framed echo failed");
+      break;
+    }
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_frames));
+
+  _socket.close();
+  _io.stop();
+}
+
+// many connections, each one sends a message per iteration and the replies
+// are read after all messages were sent, so the server threads work together
+void s_tcp_pool_echo(benchmark::State &p_state) {
+  using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28082);
+  const auto _threads = gsl::narrow_cast<size_t>(p_state.range(0));
+  const auto _connections = gsl::narrow_cast<size_t>(p_state.range(1));
+  constexpr size_t _size = 64;
+
+  w_io_context_pool _pool({.size = _threads});
+  auto _run = w_tcp_server::run(
+      _pool, tcp::endpoint(_endpoint), std::chrono::seconds(10),
+      w_socket_options{},
+      [](const std::string &, w_buffer &) -> auto {
+        return boost::system::errc::success;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run || !_pool.run()) {
+    p_state.SkipWithError("could not run tcp server");
+    return;
+  }
+
+  boost::asio::io_context _client_io;
+  std::vector<tcp::socket> _sockets;
+  _sockets.reserve(_connections);
+  for (size_t i = 0; i < _connections; ++i) {
+    auto &_socket = _sockets.emplace_back(_client_io);
+    if (!s_connect(_socket, _endpoint)) {
+      p_state.SkipWithError("could not connect to tcp server");
+      return;
+    }
+    _socket.set_option(tcp::no_delay(true));
+  }
+
+  const auto _payload = std::string(_size, 'w');
+  auto _echo = std::string(_size, '\0');
+
+  for (auto _ : p_state) {
+    boost::system::error_code _error;
+    for (auto &_socket : _sockets) {
+      boost::asio::write(_socket, boost::asio::buffer(_payload), _error);
+    }
+    for (auto &_socket : _sockets) {
+      if (!_error) {
+        boost::asio::read(_socket, boost::asio::buffer(_echo), _error);
+      }
+    }
+    if (_error) {
+      p_state.SkipWithError("echo failed");
+      break;
+    }
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_connections));
+
+  for (auto &_socket : _sockets) {
+    _socket.close();
+  }
+  _pool.stop();
+}
+
+// a request per iteration, either on a new connection or on a pooled one
+void s_tcp_client_pool(benchmark::State &p_state) {
+  using w_tcp_client_pool = wolf::system::socket::w_tcp_client_pool;
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28087);
+  const auto _pooled = p_state.range(0) != 0;
+
+  boost::asio::io_context _io;
+  auto _run = w_tcp_server::run(
+      _io, tcp::endpoint(_endpoint), std::chrono::seconds(10),
+      w_socket_options{},
+      [](const std::string &, w_buffer &) -> auto {
+        return boost::system::errc::success;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run tcp server");
+    return;
+  }
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  tcp::socket _socket(_client_io);
+  if (!s_connect(_socket, _endpoint)) {
+    _io.stop();
+    p_state.SkipWithError("could not connect to tcp server");
+    return;
+  }
+  _socket.close();
+
+  // without the background probe the client io context runs out of work
+  // after each request
+  auto _pool = std::make_shared<w_tcp_client_pool>(
+      _client_io, wolf::system::socket::w_tcp_client_pool_options{
+                      .probe_interval = std::chrono::seconds(0)});
+
+  const auto _request = w_buffer(std::string(64, 'w'));
+  std::vector<uint64_t> _latencies_ns;
+  _latencies_ns.reserve(1024 * 1024);
+  for (auto _ : p_state) {
+    const auto _begin = std::chrono::steady_clock::now();
+    auto _done = false;
+    boost::asio::co_spawn(
+        _client_io,
+        [&]() -> boost::asio::awaitable<void> {
+          auto _lease = co_await _pool->acquire("127.0.0.1", 28087);
+          w_buffer _response{};
+          co_await _lease.client->async_write(_request);
+          co_await _lease.client->async_read(_response);
+          _pool->release(std::move(_lease), _pooled);
+          _done = true;
+        },
+        [](std::exception_ptr) {});
+    _client_io.run();
+    _client_io.restart();
+    if (!_done) {
+      p_state.SkipWithError("request failed");
+      break;
+    }
+    _latencies_ns.push_back(gsl::narrow_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _begin)
+            .count()));
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()));
+  s_report_latency(p_state, _latencies_ns);
+
+  _pool.reset();
+  _io.stop();
+}
+
+// a request on every connection per iteration, answered by a server on the
+// epoll or the io_uring backend. io_uring reaps the receives and submits the
+// sends of all connections with one system call per wake up
+void s_tcp_backend_echo(benchmark::State &p_state) {
+  using w_io_backend = wolf::system::socket::w_io_backend;
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28089);
+  const auto _connections = gsl::narrow_cast<size_t>(p_state.range(0));
+  const auto _backend =
+      p_state.range(1) != 0 ? w_io_backend::io_uring : w_io_backend::epoll;
+
+  boost::asio::io_context _io;
+  auto _run = w_tcp_server::run(
+      _io, tcp::endpoint(_endpoint), std::chrono::seconds(10),
+      w_socket_options{.io_backend = _backend},
+      [](const std::string &, w_buffer &) -> auto {
+        return boost::system::errc::success;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run tcp server on this backend");
+    return;
+  }
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  std::vector<tcp::socket> _sockets;
+  for (size_t i = 0; i < _connections; ++i) {
+    auto &_socket = _sockets.emplace_back(_client_io);
+    if (!s_connect(_socket, _endpoint)) {
+      _io.stop();
+      p_state.SkipWithError("could not connect to tcp server");
+      return;
+    }
+    _socket.set_option(tcp::no_delay(true));
+  }
+
+  constexpr size_t _size = 64;
+  const auto _payload = std::string(_size, 'w');
+  auto _echo = std::string(_size, '\0');
+
+  for (auto _ : p_state) {
+    boost::system::error_code _error;
+    for (auto &_socket : _sockets) {
+      boost::asio::write(_socket, boost::asio::buffer(_payload), _error);
+    }
+    for (auto &_socket : _sockets) {
+      if (!_error) {
+        boost::asio::read(_socket, boost::asio::buffer(_echo), _error);
+      }
+    }
+    if (_error) {
+      p_state.SkipWithError("echo failed");
+      break;
+    }
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_connections));
+
+  _sockets.clear();
+  _io.stop();
+}
+
+// a batch of small packets per iteration is echoed by a udp server. a batch
+// of one costs a system call per packet on both sides
+void s_udp_echo(benchmark::State &p_state) {
+  using udp = boost::asio::ip::udp;
+  using w_udp_options = wolf::system::socket::w_udp_options;
+  using w_udp_packet = wolf::system::socket::w_udp_packet;
+  using w_udp_server = wolf::system::socket::w_udp_server;
+  using w_udp_socket = wolf::system::socket::w_udp_socket;
+
+  const auto _endpoint =
+      udp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28088);
+  const auto _batch_size = gsl::narrow_cast<size_t>(p_state.range(0));
+  const auto _options = w_udp_options{.max_batch = _batch_size,
+                                      .gso = p_state.range(1) != 0};
+  constexpr size_t _size = 64;
+
+  boost::asio::io_context _io;
+  auto _run = w_udp_server::run(
+      _io, udp::endpoint(_endpoint), w_udp_options(_options),
+      [](w_udp_socket &p_socket, gsl::span<const w_udp_packet> p_packets) {
+        boost::system::error_code _error;
+        std::ignore = p_socket.send(p_packets, _error);
+      },
+      [](const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run udp server");
+    return;
+  }
+  auto _work = boost::asio::make_work_guard(_io);
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  w_udp_socket _client(_client_io, _options);
+  if (!_client.connect(_endpoint)) {
+    _io.stop();
+    p_state.SkipWithError("could not connect to udp server");
+    return;
+  }
+
+  const auto _payload = std::vector<std::byte>(_size, std::byte{'w'});
+  const auto _packets =
+      std::vector<w_udp_packet>(_batch_size, w_udp_packet{_payload, {}});
+  auto _batch = _client.make_batch();
+
+  for (auto _ : p_state) {
+    boost::system::error_code _error;
+    size_t _sent = 0;
+    while (_sent < _batch_size && (!_error || _error ==
+                                   boost::asio::error::would_block)) {
+      _sent += _client.send(gsl::span(_packets).subspan(_sent), _error);
+    }
+
+    size_t _received = 0;
+    while (_received < _batch_size) {
+      _received += _client.receive(_batch, _error);
+      if (_error == boost::asio::error::would_block) {
+        // a lost packet fails the benchmark instead of hanging it
+        if (boost::asio::detail::socket_ops::poll_read(
+                _client.get_socket().native_handle(), 0, 1000, _error) <= 0) {
+          break;
+        }
+      } else if (_error) {
+        break;
+      }
+    }
+    if (_received < _batch_size) {
+      p_state.SkipWithError("packets were lost");
+      break;
+    }
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_batch_size));
+
+  _work.reset();
+  _io.stop();
+}
+
+// one of many armed idle timeouts is refreshed per iteration, as a session
+// does on every receive. a steady_timer per session cancels and queues a wait
+// per refresh, while the wheel mostly stores the new expiry
+void s_idle_timeouts(benchmark::State &p_state) {
+  using w_timer_wheel = wolf::system::socket::w_timer_wheel;
+
+  const auto _count = gsl::narrow_cast<size_t>(p_state.range(0));
+  const auto _use_wheel = p_state.range(1) != 0;
+  constexpr auto _timeout = std::chrono::seconds(30);
+
+  boost::asio::io_context _io;
+  std::vector<std::unique_ptr<boost::asio::steady_timer>> _timers;
+  std::vector<std::unique_ptr<w_timer_wheel::entry>> _entries;
+  auto &_wheel = w_timer_wheel::get(_io);
+  for (size_t i = 0; i < _count; ++i) {
+    if (_use_wheel) {
+      _entries.push_back(std::make_unique<w_timer_wheel::entry>(_wheel, [] {}));
+      _entries.back()->expires_after(_timeout);
+    } else {
+      _timers.push_back(std::make_unique<boost::asio::steady_timer>(_io));
+      _timers.back()->expires_after(_timeout);
+      _timers.back()->async_wait([](const boost::system::error_code &) {});
+    }
+  }
+
+  size_t _next = 0;
+  for (auto _ : p_state) {
+    if (_use_wheel) {
+      _entries[_next]->expires_after(_timeout);
+    } else {
+      auto &_timer = *_timers[_next];
+      _timer.expires_after(_timeout);
+      _timer.async_wait([](const boost::system::error_code &) {});
+      // run the handler of the canceled wait
+      _io.poll_one();
+    }
+    _next = (_next + 1) % _count;
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()));
+
+  _entries.clear();
+  _timers.clear();
+  _io.poll();
+}
+
+#ifdef WOLF_SYSTEM_HTTP_WS
+
+void s_ws_echo(benchmark::State &p_state) {
+  namespace websocket = boost::beast::websocket;
+  using w_ws_server = wolf::system::socket::w_ws_server;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28081);
+
+  boost::asio::io_context _io;
+  auto _run = w_ws_server::run(
+      _io, tcp::endpoint(_endpoint),
+      websocket::stream_base::timeout::suggested(boost::beast::role_type::server),
+      w_socket_options{},
+      [](const std::string &, w_buffer &, bool &) -> auto {
+        return websocket::close_code::none;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run websocket server");
+    return;
+  }
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  websocket::stream<tcp::socket> _ws(_client_io);
+  if (!s_connect(_ws.next_layer(), _endpoint)) {
+    _io.stop();
+    p_state.SkipWithError("could not connect to websocket server");
+    return;
+  }
+  _ws.next_layer().set_option(tcp::no_delay(true));
+  _ws.handshake("127.0.0.1", "/");
+  _ws.binary(true);
+
+  const auto _size = gsl::narrow_cast<size_t>(p_state.range(0));
+  const auto _payload = std::string(_size, 'w');
+  boost::beast::flat_buffer _echo;
+
+  s_echo_loop(p_state, [&]() {
+    boost::system::error_code _error;
+    _ws.write(boost::asio::buffer(_payload), _error);
+    if (!_error) {
+      _echo.clear();
+      _ws.read(_echo, _error);
+    }
+    return !_error && _echo.size() == _size;
+  });
+
+  boost::system::error_code _ignore;
+  _ws.close(websocket::close_code::normal, _ignore);
+  _io.stop();
+}
+
+// one message is published to many subscribers per iteration, every session
+// queues the same buffer without a copy
+void s_ws_broadcast(benchmark::State &p_state) {
+  namespace websocket = boost::beast::websocket;
+  using w_ws_hub = wolf::system::socket::w_ws_hub;
+  using w_ws_server = wolf::system::socket::w_ws_server;
+  using w_ws_session = wolf::system::socket::w_ws_session;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28085);
+  const auto _subscribers = gsl::narrow_cast<size_t>(p_state.range(0));
+  const auto _size = gsl::narrow_cast<size_t>(p_state.range(1));
+
+  // the hub holds the sessions, so it goes away before the io context
+  boost::asio::io_context _io;
+  const auto _hub = std::make_shared<w_ws_hub>();
+  auto _run = w_ws_server::run(
+      _io, tcp::endpoint(_endpoint),
+      websocket::stream_base::timeout::suggested(boost::beast::role_type::server),
+      w_socket_options{}, _hub,
+      [&](w_ws_session &p_session, gsl::span<const std::byte>, bool) -> auto {
+        _hub->subscribe(p_session.shared_from_this(), "bench");
+        return websocket::close_code::none;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run websocket server");
+    return;
+  }
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  std::vector<websocket::stream<tcp::socket>> _clients;
+  _clients.reserve(_subscribers);
+  for (size_t i = 0; i < _subscribers; ++i) {
+    auto &_ws = _clients.emplace_back(_client_io);
+    if (!s_connect(_ws.next_layer(), _endpoint)) {
+      _io.stop();
+      p_state.SkipWithError("could not connect to websocket server");
+      return;
+    }
+    _ws.handshake("127.0.0.1", "/");
+    _ws.write(boost::asio::buffer("subscribe", 9));
+  }
+  while (_hub->get_subscriber_count("bench") < _subscribers) {
+    std::this_thread::yield();
+  }
+
+  const auto _message = w_buffer(std::string(_size, 'w'));
+  boost::beast::flat_buffer _received;
+  for (auto _ : p_state) {
+    _hub->publish("bench", _message, true);
+
+    boost::system::error_code _error;
+    for (auto &_ws : _clients) {
+      _received.clear();
+      _ws.read(_received, _error);
+      if (_error) {
+        break;
+      }
+    }
+    if (_error) {
+      p_state.SkipWithError("broadcast failed");
+      break;
+    }
+  }
+  p_state.SetItemsProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_subscribers));
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            gsl::narrow_cast<int64_t>(_subscribers * _size));
+
+  for (auto &_ws : _clients) {
+    boost::system::error_code _ignore;
+    _ws.next_layer().close(_ignore);
+  }
+  _io.stop();
+}
+
+// json messages with and without permessage-deflate, the counters show the
+// bandwidth which deflate saves and its cpu cost on the server
+void s_ws_deflate_echo(benchmark::State &p_state) {
+  namespace websocket = boost::beast::websocket;
+  using w_ws_deflate_stats = wolf::system::socket::w_ws_deflate_stats;
+  using w_ws_server = wolf::system::socket::w_ws_server;
+
+  const auto _endpoint =
+      tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 28086);
+  const auto _deflate = p_state.range(0) != 0;
+  const auto _size = gsl::narrow_cast<size_t>(p_state.range(1));
+
+  w_socket_options _opts = {};
+  _opts.ws_deflate.enabled = _deflate;
+  _opts.ws_deflate.stats = std::make_shared<w_ws_deflate_stats>();
+  const auto _stats = _opts.ws_deflate.stats;
+
+  boost::asio::io_context _io;
+  auto _run = w_ws_server::run(
+      _io, tcp::endpoint(_endpoint),
+      websocket::stream_base::timeout::suggested(boost::beast::role_type::server),
+      std::move(_opts),
+      [](const std::string &, w_buffer &, bool &) -> auto {
+        return websocket::close_code::none;
+      },
+      [](const std::string &, const boost::system::system_error &) {});
+  if (!_run) {
+    p_state.SkipWithError("could not run websocket server");
+    return;
+  }
+  auto _server = std::jthread([&]() { _io.run(); });
+
+  boost::asio::io_context _client_io;
+  websocket::stream<tcp::socket> _ws(_client_io);
+  if (!s_connect(_ws.next_layer(), _endpoint)) {
+    _io.stop();
+    p_state.SkipWithError("could not connect to websocket server");
+    return;
+  }
+  _ws.next_layer().set_option(tcp::no_delay(true));
+  websocket::permessage_deflate _pmd;
+  _pmd.client_enable = _deflate;
+  _ws.set_option(_pmd);
+  _ws.handshake("127.0.0.1", "/");
+
+  std::string _payload = "[";
+  for (auto i = 0; _payload.size() < _size; ++i) {
+    _payload += R"({"id":)" + std::to_string(i) +
+                R"(,"name":"wolf","tags":["engine","socket"]},)";
+  }
+  _payload.resize(_size - 1);
+  _payload += "]";
+  boost::beast::flat_buffer _echo;
+
+  for (auto _ : p_state) {
+    boost::system::error_code _error;
+    _ws.write(boost::asio::buffer(_payload), _error);
+    if (!_error) {
+      _echo.clear();
+      _ws.read(_echo, _error);
+    }
+    if (_error || _echo.size() != _size) {
+      p_state.SkipWithError("echo failed");
+      break;
+    }
+  }
+  p_state.SetBytesProcessed(gsl::narrow_cast<int64_t>(p_state.iterations()) *
+                            p_state.range(1) * 2);
+  p_state.counters["send_ratio"] = _stats->get_send_ratio();
+  p_state.counters["send_cpu_us"] =
+      _stats->get_send_cpu_time_per_message_ns() / 1000.0;
+
+  boost::system::error_code _ignore;
+  _ws.close(websocket::close_code::normal, _ignore);
+  _io.stop();
+}
+
+#endif  // WOLF_SYSTEM_HTTP_WS
+
+}  // namespace
+
+BENCHMARK(s_tcp_echo)
+    ->Name("socket/tcp_echo")
+    ->RangeMultiplier(16)
+    ->Range(64, 256 * 1024)
+    ->UseRealTime();
+
+BENCHMARK(s_tcp_session_fanout)
+    ->Name("socket/tcp_session_fanout")
+    ->RangeMultiplier(4)
+    ->Range(1, 256)
+    ->UseRealTime();
+
+BENCHMARK(s_tcp_framed_batch)
+    ->Name("socket/tcp_framed_batch")
+    ->RangeMultiplier(4)
+    ->Range(1, 1024)
+    ->UseRealTime();
+
+BENCHMARK(s_tcp_pool_echo)
+    ->Name("socket/tcp_pool_echo")
+    ->ArgNames({"threads", "connections"})
+    ->ArgsProduct({{1, 2, 4, 8}, {64}})
+    ->UseRealTime();
+
+BENCHMARK(s_tcp_client_pool)
+    ->Name("socket/tcp_client_pool")
+    ->ArgNames({"pooled"})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+
+BENCHMARK(s_tcp_backend_echo)
+    ->Name("socket/tcp_backend_echo")
+    ->ArgNames({"connections", "io_uring"})
+    ->ArgsProduct({{1, 64, 256}, {0, 1}})
+    ->UseRealTime();
+
+BENCHMARK(s_udp_echo)
+    ->Name("socket/udp_echo")
+    ->ArgNames({"batch", "gso"})
+    ->ArgsProduct({{1, 16, 64}, {0, 1}})
+    ->UseRealTime();
+
+BENCHMARK(s_idle_timeouts)
+    ->Name("socket/idle_timeouts")
+    ->ArgNames({"sessions", "wheel"})
+    ->ArgsProduct({{1000, 100000}, {0, 1}});
+
+#ifdef WOLF_SYSTEM_HTTP_WS
+BENCHMARK(s_ws_echo)
+    ->Name("socket/ws_echo")
+    ->RangeMultiplier(16)
+    ->Range(64, 256 * 1024)
+    ->UseRealTime();
+
+BENCHMARK(s_ws_broadcast)
+    ->Name("socket/ws_broadcast")
+    ->ArgNames({"subscribers", "size"})
+    ->ArgsProduct({{1, 16, 64}, {64, 4096}})
+    ->UseRealTime();
+
+BENCHMARK(s_ws_deflate_echo)
+    ->Name("socket/ws_deflate_echo")
+    ->ArgNames({"deflate", "size"})
+    ->ArgsProduct({{0, 1}, {1024, 16 * 1024}})
+    ->UseRealTime();
+#endif
+
+#endif  // WOLF_BENCHMARKS
@@ -0,0 +1,69 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#ifdef WOLF_BENCHMARKS
+
+#include <benchmark/benchmark.h>
+
+#include <wolf/wolf.hpp>
+
+namespace {
+
+// the failure path of a hot function, e.g. a socket timeout
+boost::leaf::result<int> s_fail_literal() noexcept {
+  return W_FAILURE(std::errc::timed_out, "the operation timed out");
+}
+
+boost::leaf::result<int> s_fail_deferred(_In_ size_t p_retry) noexcept {
+  return W_FAILURE(std::errc::timed_out,
+                   "the operation timed out after {} retries", p_retry);
+}
+
+// the way call sites used to build their messages
+boost::leaf::result<int> s_fail_eager(_In_ size_t p_retry) noexcept {
+  return W_FAILURE(
+      std::errc::timed_out,
+      wolf::format("the operation timed out after {} retries", p_retry));
+}
+
+template <class F>
+void s_run(_Inout_ benchmark::State &p_state, _In_ F &&p_func) {
+  for (auto _ : p_state) {
+    const auto _ret = boost::leaf::try_handle_all(
+        [&]() -> boost::leaf::result<int> { return p_func(); },
+        [](const w_trace &) { return -1; }, [] { return -2; });
+    benchmark::DoNotOptimize(_ret);
+  }
+}
+
+void s_failure_literal(benchmark::State &p_state) {
+  s_run(p_state, [] { return s_fail_literal(); });
+}
+
+void s_failure_deferred(benchmark::State &p_state) {
+  s_run(p_state, [] { return s_fail_deferred(3); });
+}
+
+void s_failure_eager_format(benchmark::State &p_state) {
+  s_run(p_state, [] { return s_fail_eager(3); });
+}
+
+void s_failure_to_string(benchmark::State &p_state) {
+  // the cost which is paid only when the error is reported
+  for (auto _ : p_state) {
+    const auto _trace = w_trace(std::errc::timed_out, W_TRACE_LOCATION,
+                                "the operation timed out after {} retries", 3);
+    benchmark::DoNotOptimize(_trace.to_string());
+  }
+}
+
+}  // namespace
+
+BENCHMARK(s_failure_literal)->Name("w_trace/failure_literal");
+BENCHMARK(s_failure_deferred)->Name("w_trace/failure_deferred");
+BENCHMARK(s_failure_eager_format)->Name("w_trace/failure_eager_format");
+BENCHMARK(s_failure_to_string)->Name("w_trace/to_string");
+
+#endif  // WOLF_BENCHMARKS
@@ -39,6 +39,15 @@ if (WOLF_SYSTEM_LZMA)
     target_link_libraries(${PROJECT_NAME} PUBLIC lzma)
 endif()
 
+if (WOLF_SYSTEM_LZ4 OR WOLF_SYSTEM_LZMA)
+    list(APPEND COMPRESSION_SRCS
+        ${COMPRESSION_PATH}/w_chunked.cpp
+        ${COMPRESSION_PATH}/w_chunked.hpp
+        ${COMPRESSION_PATH}/w_compressor.cpp
+        ${COMPRESSION_PATH}/w_compressor.hpp
+    )
+endif()
+
 target_sources(${PROJECT_NAME}
     PRIVATE
     ${COMPRESSION_SRCS}
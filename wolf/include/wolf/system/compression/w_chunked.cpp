@@ -0,0 +1,373 @@
+#include "w_chunked.hpp"
+
+#if defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
+
+#ifdef WOLF_SYSTEM_LZ4
+#include "w_lz4.hpp"
+#endif
+
+#ifdef WOLF_SYSTEM_LZMA
+#include "w_lzma.hpp"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <thread>
+
+using w_chunked = wolf::system::compression::w_chunked;
+using w_chunked_block = wolf::system::compression::w_chunked_block;
+using w_chunked_codec = wolf::system::compression::w_chunked_codec;
+using w_chunked_index = wolf::system::compression::w_chunked_index;
+using w_chunked_options = wolf::system::compression::w_chunked_options;
+
+namespace {
+
+constexpr std::array<std::byte, 4> s_magic = {
+    std::byte{'W'}, std::byte{'C'}, std::byte{'H'}, std::byte{'K'}};
+// keeps every size of a block inside an u32 and below LZ4_MAX_INPUT_SIZE
+constexpr size_t s_max_block_size = size_t{1} << 30;
+
+template <typename T>
+void s_store(_Inout_ gsl::span<std::byte> p_dst, _In_ size_t p_offset,
+             _In_ T p_value) noexcept {
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    p_dst[p_offset + i] = gsl::narrow_cast<std::byte>((p_value >> (8 * i)) & 0xFF);
+  }
+}
+
+template <typename T>
+auto s_load(_In_ gsl::span<const std::byte> p_src, _In_ size_t p_offset) noexcept
+    -> T {
+  T _value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    _value |= std::to_integer<T>(p_src[p_offset + i]) << (8 * i);
+  }
+  return _value;
+}
+
+auto s_block_count(_In_ uint64_t p_size, _In_ size_t p_block_size) noexcept
+    -> size_t {
+  return gsl::narrow_cast<size_t>((p_size + p_block_size - 1) / p_block_size);
+}
+
+auto s_thread_count(_In_ size_t p_threads, _In_ size_t p_jobs) noexcept
+    -> size_t {
+  auto _threads = p_threads;
+  if (_threads == 0) {
+    _threads = std::max(size_t{1},
+                        gsl::narrow_cast<size_t>(
+                            std::thread::hardware_concurrency()));
+  }
+  return std::max(size_t{1}, std::min(_threads, p_jobs));
+}
+
+/*
+ * run p_func(0) ... p_func(p_count - 1) on the calling thread plus worker
+ * threads, which pull the next job from a shared counter. the error objects
+ * of leaf are thread local, so the first error is carried over as a message.
+ */
+template <typename F>
+auto s_parallel_for(_In_ size_t p_count, _In_ size_t p_threads,
+                    _In_ F &&p_func) -> boost::leaf::result<void> {
+  std::atomic<size_t> _next = 0;
+  std::atomic<bool> _failed = false;
+  std::mutex _mutex;
+  std::string _error;
+
+  const auto _set_error = [&](std::string p_msg) {
+    std::scoped_lock _lock(_mutex);
+    if (!_failed.exchange(true)) {
+      _error = std::move(p_msg);
+    }
+  };
+
+  const auto _worker = [&]() {
+    for (;;) {
+      const auto _job = _next.fetch_add(1, std::memory_order_relaxed);
+      if (_job >= p_count || _failed.load(std::memory_order_relaxed)) {
+        return;
+      }
+      try {
+        boost::leaf::try_handle_all(
+            [&]() -> boost::leaf::result<void> {
+              BOOST_LEAF_CHECK(p_func(_job));
+              return {};
+            },
+            [&](const w_trace &p_trace) { _set_error(p_trace.to_string()); },
+            [&]() { _set_error(wolf::format("block {} failed", _job)); });
+      } catch (const std::exception &e) {
+        _set_error(wolf::format("block {} failed because: {}", _job, e.what()));
+      }
+    }
+  };
+
+  {
+    const auto _threads = s_thread_count(p_threads, p_count);
+    std::vector<std::jthread> _workers;
+    try {
+      _workers.reserve(_threads - 1);
+      for (size_t i = 1; i < _threads; ++i) {
+        _workers.emplace_back(_worker);
+      }
+    } catch (...) {
+      // continue with the threads which could be created
+    }
+    _worker();
+  }
+
+  if (_failed.load()) {
+    return W_FAILURE(std::errc::operation_canceled, _error);
+  }
+  return {};
+}
+
+auto s_compress_block(_In_ gsl::span<const std::byte> p_src,
+                      _In_ const w_chunked_options &p_options)
+    -> boost::leaf::result<std::vector<std::byte>> {
+  switch (p_options.codec) {
+    case w_chunked_codec::LZ4: {
+#ifdef WOLF_SYSTEM_LZ4
+      using w_lz4 = wolf::system::compression::w_lz4;
+      std::vector<std::byte> _dst(gsl::narrow_cast<size_t>(
+          w_lz4::get_compress_bound(gsl::narrow_cast<int>(p_src.size()))));
+      BOOST_LEAF_AUTO(_bytes, w_lz4::compress_fast(p_src, _dst,
+                                                   std::max(1, p_options.level)));
+      _dst.resize(_bytes);
+      return _dst;
+#else
+      break;
+#endif
+    }
+    case w_chunked_codec::LZMA2: {
+#ifdef WOLF_SYSTEM_LZMA
+      return wolf::system::compression::w_lzma::compress_lzma2(
+          p_src, p_options.level);
+#else
+      break;
+#endif
+    }
+  }
+  return W_FAILURE(std::errc::not_supported,
+                   "the codec {} of the chunked container is not enabled",
+                   static_cast<int>(p_options.codec));
+}
+
+auto s_decompress_block(_In_ gsl::span<const std::byte> p_src,
+                        _In_ w_chunked_codec p_codec,
+                        _Inout_ gsl::span<std::byte> p_dst)
+    -> boost::leaf::result<size_t> {
+  switch (p_codec) {
+    case w_chunked_codec::LZ4: {
+#ifdef WOLF_SYSTEM_LZ4
+      return wolf::system::compression::w_lz4::decompress(p_src, p_dst);
+#else
+      break;
+#endif
+    }
+    case w_chunked_codec::LZMA2: {
+#ifdef WOLF_SYSTEM_LZMA
+      // p_dst is capped at the original size of the index entry
+      return wolf::system::compression::w_lzma::decompress_lzma2(p_src, p_dst);
+#else
+      break;
+#endif
+    }
+  }
+  return W_FAILURE(std::errc::not_supported,
+                   "the codec {} of the chunked container is not enabled",
+                   static_cast<int>(p_codec));
+}
+
+}  // namespace
+
+auto w_chunked::compress(_In_ gsl::span<const std::byte> p_src,
+                         _In_ const w_chunked_options &p_options)
+    -> boost::leaf::result<std::vector<std::byte>> {
+  if (p_options.block_size == 0 || p_options.block_size > s_max_block_size) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the block size must be between 1 and {}",
+                     s_max_block_size);
+  }
+
+  const auto _block_size = p_options.block_size;
+  const auto _count = s_block_count(p_src.size(), _block_size);
+  if (_count > std::numeric_limits<uint32_t>::max()) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "too many blocks: {}, use a bigger block size", _count);
+  }
+
+  std::vector<std::vector<std::byte>> _blocks(_count);
+  BOOST_LEAF_CHECK(s_parallel_for(
+      _count, p_options.threads,
+      [&](size_t p_block) -> boost::leaf::result<size_t> {
+        const auto _offset = p_block * _block_size;
+        const auto _src = p_src.subspan(
+            _offset, std::min(_block_size, p_src.size() - _offset));
+        BOOST_LEAF_AUTO(_compressed, s_compress_block(_src, p_options));
+        if (_compressed.size() > std::numeric_limits<uint32_t>::max()) {
+          return W_FAILURE(std::errc::value_too_large,
+                           "the block {} is too big after compression",
+                           p_block);
+        }
+        _blocks[p_block] = std::move(_compressed);
+        return _blocks[p_block].size();
+      }));
+
+  const auto _data_offset = HEADER_SIZE + _count * INDEX_ENTRY_SIZE;
+  auto _total = _data_offset;
+  for (const auto &_block : _blocks) {
+    _total += _block.size();
+  }
+
+  std::vector<std::byte> _dst(_total);
+  std::copy(s_magic.cbegin(), s_magic.cend(), _dst.begin());
+  s_store<uint8_t>(_dst, 4, VERSION);
+  s_store<uint8_t>(_dst, 5, static_cast<uint8_t>(p_options.codec));
+  s_store<uint16_t>(_dst, 6, 0);
+  s_store<uint32_t>(_dst, 8, gsl::narrow_cast<uint32_t>(_block_size));
+  s_store<uint32_t>(_dst, 12, gsl::narrow_cast<uint32_t>(_count));
+  s_store<uint64_t>(_dst, 16, gsl::narrow_cast<uint64_t>(p_src.size()));
+
+  auto _offset = _data_offset;
+  for (size_t i = 0; i < _count; ++i) {
+    const auto &_block = _blocks[i];
+    const auto _entry = HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+    const auto _original =
+        std::min(_block_size, p_src.size() - i * _block_size);
+    s_store<uint64_t>(_dst, _entry, gsl::narrow_cast<uint64_t>(_offset));
+    s_store<uint32_t>(_dst, _entry + 8,
+                      gsl::narrow_cast<uint32_t>(_block.size()));
+    s_store<uint32_t>(_dst, _entry + 12,
+                      gsl::narrow_cast<uint32_t>(_original));
+
+    std::memcpy(&_dst[_offset], _block.data(), _block.size());
+    _offset += _block.size();
+  }
+  return _dst;
+}
+
+auto w_chunked::read_index(_In_ gsl::span<const std::byte> p_src)
+    -> boost::leaf::result<w_chunked_index> {
+  if (p_src.size() < HEADER_SIZE ||
+      !std::equal(s_magic.cbegin(), s_magic.cend(), p_src.begin())) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the source is not a chunked container");
+  }
+
+  const auto _version = s_load<uint8_t>(p_src, 4);
+  if (_version != VERSION) {
+    return W_FAILURE(std::errc::not_supported,
+                     "the version {} of the chunked container is not supported",
+                     _version);
+  }
+
+  w_chunked_index _index = {};
+  const auto _codec = s_load<uint8_t>(p_src, 5);
+  if (_codec != static_cast<uint8_t>(w_chunked_codec::LZ4) &&
+      _codec != static_cast<uint8_t>(w_chunked_codec::LZMA2)) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "unknown codec {} of the chunked container", _codec);
+  }
+  _index.codec = static_cast<w_chunked_codec>(_codec);
+  _index.block_size = s_load<uint32_t>(p_src, 8);
+  const auto _count = size_t{s_load<uint32_t>(p_src, 12)};
+  _index.original_size = s_load<uint64_t>(p_src, 16);
+
+  if (_index.block_size == 0 || _index.block_size > s_max_block_size ||
+      _count != s_block_count(_index.original_size, _index.block_size) ||
+      _count > (p_src.size() - HEADER_SIZE) / INDEX_ENTRY_SIZE) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the header of the chunked container is corrupted");
+  }
+
+  const auto _data_offset = HEADER_SIZE + _count * INDEX_ENTRY_SIZE;
+  _index.blocks.resize(_count);
+  for (size_t i = 0; i < _count; ++i) {
+    const auto _entry = HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+    auto &_block = _index.blocks[i];
+    _block.offset = s_load<uint64_t>(p_src, _entry);
+    _block.compressed_size = s_load<uint32_t>(p_src, _entry + 8);
+    _block.original_size = s_load<uint32_t>(p_src, _entry + 12);
+
+    const auto _expected = std::min<uint64_t>(
+        _index.block_size, _index.original_size - i * _index.block_size);
+    if (_block.offset < _data_offset || _block.offset > p_src.size() ||
+        _block.compressed_size > p_src.size() - _block.offset ||
+        _block.original_size != _expected) {
+      return W_FAILURE(std::errc::illegal_byte_sequence,
+                       "the index entry {} of the chunked container is "
+                       "corrupted",
+                       i);
+    }
+  }
+  return _index;
+}
+
+auto w_chunked::decompress_block(_In_ gsl::span<const std::byte> p_src,
+                                 _In_ const w_chunked_index &p_index,
+                                 _In_ size_t p_block,
+                                 _Inout_ gsl::span<std::byte> p_dst)
+    -> boost::leaf::result<size_t> {
+  if (p_block >= p_index.blocks.size()) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the block {} is out of range", p_block);
+  }
+
+  const auto &_block = p_index.blocks[p_block];
+  if (p_dst.size() < _block.original_size) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination is smaller than the block size: {}",
+                     _block.original_size);
+  }
+
+  BOOST_LEAF_AUTO(
+      _bytes,
+      s_decompress_block(
+          p_src.subspan(gsl::narrow_cast<size_t>(_block.offset),
+                        _block.compressed_size),
+          p_index.codec, p_dst.first(_block.original_size)));
+  if (_bytes != _block.original_size) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the block {} decompressed into {} bytes instead of {}",
+                     p_block, _bytes, _block.original_size);
+  }
+  return _bytes;
+}
+
+auto w_chunked::decompress(_In_ gsl::span<const std::byte> p_src,
+                           _In_ size_t p_threads, _In_ size_t p_max_output)
+    -> boost::leaf::result<std::vector<std::byte>> {
+  BOOST_LEAF_AUTO(_index, read_index(p_src));
+
+  if (_index.original_size > p_max_output) {
+    return W_FAILURE(std::errc::value_too_large,
+                     "the original size {} of the chunked container is bigger "
+                     "than the limit {}",
+                     _index.original_size, p_max_output);
+  }
+
+  // every block is decoded in place, straight into the output
+  std::vector<std::byte> _dst;
+  try {
+    _dst.resize(gsl::narrow_cast<size_t>(_index.original_size));
+  } catch (const std::bad_alloc &) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not allocate {} bytes for the chunked container",
+                     _index.original_size);
+  }
+  BOOST_LEAF_CHECK(s_parallel_for(
+      _index.blocks.size(), p_threads,
+      [&](size_t p_block) -> boost::leaf::result<size_t> {
+        const auto _dst_span = gsl::span<std::byte>(_dst).subspan(
+            p_block * _index.block_size, _index.blocks[p_block].original_size);
+        return decompress_block(p_src, _index, p_block, _dst_span);
+      }));
+  return _dst;
+}
+
+#endif  // defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
@@ -0,0 +1,117 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#if defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <wolf/wolf.hpp>
+
+namespace wolf::system::compression {
+
+// the codec of each block of a chunked container
+enum class w_chunked_codec : uint8_t {
+  LZ4 = 1,
+  LZMA2 = 2,
+};
+
+struct w_chunked_options {
+  w_chunked_codec codec = w_chunked_codec::LZ4;
+  // the uncompressed size of each block, smaller blocks give more parallelism
+  // and finer random access, bigger blocks compress better
+  size_t block_size = 1024 * 1024;
+  // the acceleration of lz4 (1 - 65536) or the level of lzma2 (0 - 9)
+  int level = 1;
+  // the number of worker threads, zero means hardware concurrency
+  size_t threads = 0;
+};
+
+struct w_chunked_block {
+  // the offset of the compressed block from the beginning of the container
+  uint64_t offset = 0;
+  uint32_t compressed_size = 0;
+  uint32_t original_size = 0;
+};
+
+// the parsed header and block index of a chunked container
+struct w_chunked_index {
+  w_chunked_codec codec = w_chunked_codec::LZ4;
+  size_t block_size = 0;
+  uint64_t original_size = 0;
+  std::vector<w_chunked_block> blocks;
+};
+
+/*
+ * a seekable container of independently compressed blocks. the input is split
+ * into blocks which are compressed and decompressed on worker threads, and a
+ * block index in the header allows decoding any block without its neighbours.
+ *
+ * layout, all integers are little endian:
+ *   "WCHK" | u8 version | u8 codec | u16 reserved | u32 block size |
+ *   u32 block count | u64 original size |
+ *   block count * (u64 offset | u32 compressed size | u32 original size) |
+ *   compressed blocks
+ */
+struct w_chunked {
+  static constexpr uint8_t VERSION = 1;
+  static constexpr size_t HEADER_SIZE = 24;
+  static constexpr size_t INDEX_ENTRY_SIZE = 16;
+  // the default limit of the output of decompress, the original size comes
+  // from the header, so it can not be trusted
+  static constexpr size_t DEFAULT_MAX_OUTPUT = size_t{1} << 30;
+
+  /*
+   * compress the source into a chunked container
+   * @param p_src, the input source
+   * @param p_options, the codec, block size, level and threads
+   * @returns the container
+   */
+  W_API static auto compress(_In_ gsl::span<const std::byte> p_src,
+                             _In_ const w_chunked_options &p_options = {})
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * decompress all blocks of a chunked container in parallel
+   * @param p_src, the container
+   * @param p_threads, the number of worker threads, zero means hardware
+   * concurrency
+   * @param p_max_output, the maximum original size which will be allocated,
+   * a bigger container fails with std::errc::value_too_large
+   * @returns the original data
+   */
+  W_API static auto decompress(_In_ gsl::span<const std::byte> p_src,
+                               _In_ size_t p_threads = 0,
+                               _In_ size_t p_max_output = DEFAULT_MAX_OUTPUT)
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * parse and validate the header and the block index of a container
+   * @param p_src, the container
+   * @returns the index
+   */
+  W_API static auto read_index(_In_ gsl::span<const std::byte> p_src)
+      -> boost::leaf::result<w_chunked_index>;
+
+  /*
+   * decompress one block of a container for random access
+   * @param p_src, the container
+   * @param p_index, the index which was read from p_src
+   * @param p_block, the zero based block number, which covers the original
+   * bytes from p_block * block_size
+   * @param p_dst, the output, which must hold the original size of the block
+   * @returns the number of bytes written into p_dst
+   */
+  W_API static auto decompress_block(_In_ gsl::span<const std::byte> p_src,
+                                     _In_ const w_chunked_index &p_index,
+                                     _In_ size_t p_block,
+                                     _Inout_ gsl::span<std::byte> p_dst)
+      -> boost::leaf::result<size_t>;
+};
+}  // namespace wolf::system::compression
+
+#endif  // defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
@@ -0,0 +1,354 @@
+#include "w_compressor.hpp"
+
+#if defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
+
+#ifdef WOLF_SYSTEM_LZ4
+#include "w_lz4.hpp"
+#endif
+
+#ifdef WOLF_SYSTEM_LZMA
+#include "w_lzma.hpp"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using w_codec = wolf::system::compression::w_codec;
+using w_codec_choice = wolf::system::compression::w_codec_choice;
+using w_compression_sample = wolf::system::compression::w_compression_sample;
+using w_compression_target = wolf::system::compression::w_compression_target;
+using w_compressor = wolf::system::compression::w_compressor;
+using w_compressor_options = wolf::system::compression::w_compressor_options;
+
+#ifdef WOLF_SYSTEM_LZ4
+using w_lz4 = wolf::system::compression::w_lz4;
+#endif
+
+#ifdef WOLF_SYSTEM_LZMA
+using w_lzma = wolf::system::compression::w_lzma;
+#endif
+
+namespace {
+
+// below this size the headers cost more than the codec saves
+constexpr size_t s_min_size = 64;
+// the entropy of compressed media and encrypted data is close to 8 bits
+constexpr double s_incompressible_entropy = 7.6;
+constexpr double s_high_entropy = 7.0;
+// the entropy of text and structured messages is usually below this
+constexpr double s_text_entropy = 5.5;
+
+constexpr size_t s_match_bits = 12;
+
+// count the positions, which repeat a 4 byte sequence of the slice
+auto s_count_matches(_In_ gsl::span<const std::byte> p_slice) noexcept
+    -> size_t {
+  std::array<uint32_t, size_t{1} << s_match_bits> _table = {};
+  std::array<bool, size_t{1} << s_match_bits> _used = {};
+
+  size_t _matches = 0;
+  for (size_t i = 0; i + 4 <= p_slice.size(); ++i) {
+    uint32_t _value = 0;
+    std::memcpy(&_value, &p_slice[i], sizeof(_value));
+    const auto _hash = (_value * 2654435761U) >> (32 - s_match_bits);
+    if (_used[_hash] && _table[_hash] == _value) {
+      ++_matches;
+    }
+    _table[_hash] = _value;
+    _used[_hash] = true;
+  }
+  return _matches;
+}
+
+auto s_is_available(_In_ w_codec p_codec) noexcept -> bool {
+  switch (p_codec) {
+    case w_codec::STORE:
+      return true;
+    case w_codec::LZ4_FAST:
+    case w_codec::LZ4_HC:
+#ifdef WOLF_SYSTEM_LZ4
+      return true;
+#else
+      return false;
+#endif
+    case w_codec::LZMA2:
+#ifdef WOLF_SYSTEM_LZMA
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+// returns true if the codec can compress and decompress p_size bytes
+auto s_fits(_In_ w_codec p_codec, _In_ size_t p_size) noexcept -> bool {
+  switch (p_codec) {
+    case w_codec::STORE:
+      return true;
+    case w_codec::LZ4_FAST:
+    case w_codec::LZ4_HC:
+#ifdef WOLF_SYSTEM_LZ4
+      return p_size < w_lz4::MAX_INPUT_SIZE;
+#else
+      return false;
+#endif
+    case w_codec::LZMA2:
+#ifdef WOLF_SYSTEM_LZMA
+      return p_size <= w_lzma::MAX_DECOMPRESS_SIZE;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+// fall back to the closest codec which was compiled in and can take the
+// input, or store it
+auto s_available(_In_ w_codec_choice p_choice, _In_ size_t p_size) noexcept
+    -> w_codec_choice {
+  if (s_is_available(p_choice.codec) && s_fits(p_choice.codec, p_size)) {
+    return p_choice;
+  }
+  const auto _fallback =
+      p_choice.codec == w_codec::LZMA2
+          ? w_codec_choice{w_codec::LZ4_HC, 12}
+          : w_codec_choice{w_codec::LZMA2,
+                           p_choice.codec == w_codec::LZ4_HC ? 5 : 1};
+  if (s_is_available(_fallback.codec) && s_fits(_fallback.codec, p_size)) {
+    return _fallback;
+  }
+  return {w_codec::STORE, 0};
+}
+
+}  // namespace
+
+auto w_compressor::analyze(_In_ gsl::span<const std::byte> p_src,
+                           _In_ size_t p_sample_size) noexcept
+    -> w_compression_sample {
+  // the beginning, the middle and the end, so a header of a file does not
+  // stand for its whole content
+  std::array<gsl::span<const std::byte>, 3> _slices = {};
+  if (p_src.size() <= p_sample_size || p_sample_size < 3) {
+    _slices[0] = p_src;
+  } else {
+    const auto _slice = p_sample_size / 3;
+    _slices[0] = p_src.first(_slice);
+    _slices[1] = p_src.subspan((p_src.size() - _slice) / 2, _slice);
+    _slices[2] = p_src.last(_slice);
+  }
+
+  std::array<size_t, 256> _histogram = {};
+  size_t _total = 0;
+  size_t _positions = 0;
+  size_t _matches = 0;
+  for (const auto &_slice : _slices) {
+    for (const auto _byte : _slice) {
+      _histogram[std::to_integer<size_t>(_byte)]++;
+    }
+    _total += _slice.size();
+    if (_slice.size() >= 4) {
+      _positions += _slice.size() - 3;
+      _matches += s_count_matches(_slice);
+    }
+  }
+
+  w_compression_sample _sample = {};
+  if (_total == 0) {
+    return _sample;
+  }
+
+  for (const auto _count : _histogram) {
+    if (_count != 0) {
+      const auto _p =
+          static_cast<double>(_count) / static_cast<double>(_total);
+      _sample.entropy -= _p * std::log2(_p);
+    }
+  }
+  if (_positions != 0) {
+    _sample.repetition =
+        static_cast<double>(_matches) / static_cast<double>(_positions);
+  }
+  return _sample;
+}
+
+auto w_compressor::choose(_In_ gsl::span<const std::byte> p_src,
+                          _In_ const w_compressor_options &p_options) noexcept
+    -> w_codec_choice {
+  if (p_src.size() < s_min_size) {
+    return {w_codec::STORE, 0};
+  }
+
+  const auto _sample = analyze(p_src, p_options.sample_size);
+  if (_sample.entropy >= s_incompressible_entropy &&
+      _sample.repetition < 0.02) {
+    return {w_codec::STORE, 0};
+  }
+
+  switch (p_options.target) {
+    case w_compression_target::THROUGHPUT: {
+      // the less there is to find, the faster lz4 should give up
+      auto _acceleration = 1;
+      if (_sample.entropy >= s_high_entropy) {
+        _acceleration = 16;
+      } else if (_sample.repetition < 0.2) {
+        _acceleration = 4;
+      }
+      return s_available({w_codec::LZ4_FAST, _acceleration}, p_src.size());
+    }
+    case w_compression_target::BALANCED: {
+      if (_sample.entropy < s_text_entropy) {
+        return s_available({w_codec::LZ4_HC, 6}, p_src.size());
+      }
+      return s_available({w_codec::LZ4_FAST, 1}, p_src.size());
+    }
+    case w_compression_target::RATIO: {
+      if (_sample.entropy >= s_high_entropy) {
+        return s_available({w_codec::LZ4_HC, 9}, p_src.size());
+      }
+      return s_available({w_codec::LZMA2, 7}, p_src.size());
+    }
+  }
+  return {w_codec::STORE, 0};
+}
+
+auto w_compressor::compress(_In_ gsl::span<const std::byte> p_src,
+                            _In_ const w_compressor_options &p_options)
+    -> boost::leaf::result<std::vector<std::byte>> {
+  const auto _choice = choose(p_src, p_options);
+  if (_choice.codec != w_codec::STORE) {
+    BOOST_LEAF_AUTO(_dst, compress(p_src, _choice));
+    const auto _ratio = static_cast<double>(p_src.size()) /
+                        static_cast<double>(_dst.size());
+    if (_ratio >= p_options.min_ratio) {
+      return std::move(_dst);
+    }
+  }
+  return compress(p_src, w_codec_choice{w_codec::STORE, 0});
+}
+
+auto w_compressor::compress(_In_ gsl::span<const std::byte> p_src,
+                            _In_ const w_codec_choice &p_choice)
+    -> boost::leaf::result<std::vector<std::byte>> {
+  if (!s_is_available(p_choice.codec)) {
+    return W_FAILURE(std::errc::not_supported,
+                     "the codec {} is not enabled",
+                     static_cast<int>(p_choice.codec));
+  }
+  if (!s_fits(p_choice.codec, p_src.size())) {
+    return W_FAILURE(std::errc::value_too_large,
+                     "the codec {} can not take an input of {} bytes",
+                     static_cast<int>(p_choice.codec), p_src.size());
+  }
+
+  try {
+    std::vector<std::byte> _dst;
+    switch (p_choice.codec) {
+      case w_codec::STORE: {
+        _dst.resize(HEADER_SIZE + p_src.size());
+        std::copy(p_src.begin(), p_src.end(), _dst.begin() + HEADER_SIZE);
+        break;
+      }
+#ifdef WOLF_SYSTEM_LZ4
+      case w_codec::LZ4_FAST: {
+        // both lz4 modes use a sized block, so they decompress in one pass
+        _dst.resize(HEADER_SIZE + w_lz4::get_compress_sized_bound(p_src.size()));
+        BOOST_LEAF_AUTO(_bytes,
+                        w_lz4::compress_sized(
+                            p_src, gsl::span(_dst).subspan(HEADER_SIZE),
+                            std::max(1, p_choice.level)));
+        _dst.resize(HEADER_SIZE + _bytes);
+        break;
+      }
+      case w_codec::LZ4_HC: {
+        constexpr auto _offset = HEADER_SIZE + w_lz4::SIZE_HEADER_BYTES;
+        _dst.resize(HEADER_SIZE + w_lz4::get_compress_sized_bound(p_src.size()));
+        BOOST_LEAF_AUTO(_bytes,
+                        w_lz4::compress_hc(p_src,
+                                           gsl::span(_dst).subspan(_offset),
+                                           p_choice.level));
+        const auto _size = gsl::narrow_cast<uint32_t>(p_src.size());
+        for (size_t i = 0; i < w_lz4::SIZE_HEADER_BYTES; ++i) {
+          _dst[HEADER_SIZE + i] =
+              gsl::narrow_cast<std::byte>((_size >> (8 * i)) & 0xFF);
+        }
+        _dst.resize(_offset + _bytes);
+        break;
+      }
+#endif
+#ifdef WOLF_SYSTEM_LZMA
+      case w_codec::LZMA2: {
+        BOOST_LEAF_AUTO(_payload, w_lzma::compress_lzma2(
+                                      p_src, std::clamp(p_choice.level, 0, 9)));
+        _dst.resize(HEADER_SIZE + _payload.size());
+        std::copy(_payload.cbegin(), _payload.cend(),
+                  _dst.begin() + HEADER_SIZE);
+        break;
+      }
+#endif
+      default:
+        break;
+    }
+    _dst[0] = static_cast<std::byte>(p_choice.codec);
+    return _dst;
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("w_compressor compress was failed. An "
+                                  "exception just happened: {}",
+                                  e.what()));
+  }
+}
+
+auto w_compressor::get_codec(_In_ gsl::span<const std::byte> p_src) noexcept
+    -> boost::leaf::result<w_codec> {
+  if (p_src.size() < HEADER_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+
+  const auto _codec = std::to_integer<uint8_t>(p_src[0]);
+  if (_codec > static_cast<uint8_t>(w_codec::LZMA2)) {
+    return W_FAILURE(std::errc::illegal_byte_sequence, "unknown codec {}",
+                     _codec);
+  }
+  return static_cast<w_codec>(_codec);
+}
+
+auto w_compressor::decompress(_In_ gsl::span<const std::byte> p_src)
+    -> boost::leaf::result<std::vector<std::byte>> {
+  BOOST_LEAF_AUTO(_codec, get_codec(p_src));
+  if (!s_is_available(_codec)) {
+    return W_FAILURE(std::errc::not_supported, "the codec {} is not enabled",
+                     static_cast<int>(_codec));
+  }
+
+  const auto _payload = p_src.subspan(HEADER_SIZE);
+  switch (_codec) {
+    case w_codec::STORE: {
+      try {
+        return std::vector<std::byte>(_payload.begin(), _payload.end());
+      } catch (const std::exception &e) {
+        return W_FAILURE(std::errc::not_enough_memory,
+                         wolf::format("w_compressor decompress was failed. "
+                                      "An exception just happened: {}",
+                                      e.what()));
+      }
+    }
+#ifdef WOLF_SYSTEM_LZ4
+    case w_codec::LZ4_FAST:
+    case w_codec::LZ4_HC:
+      return w_lz4::decompress_sized(_payload);
+#endif
+#ifdef WOLF_SYSTEM_LZMA
+    case w_codec::LZMA2:
+      return w_lzma::decompress_lzma2(_payload);
+#endif
+    default:
+      break;
+  }
+  return W_FAILURE(std::errc::not_supported, "the codec {} is not enabled",
+                   static_cast<int>(_codec));
+}
+
+#endif  // defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
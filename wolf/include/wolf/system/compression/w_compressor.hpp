@@ -0,0 +1,127 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#if defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <wolf/wolf.hpp>
+
+namespace wolf::system::compression {
+
+// the codec of a w_compressor output, which is stored in its first byte
+enum class w_codec : uint8_t {
+  STORE = 0,
+  LZ4_FAST = 1,
+  LZ4_HC = 2,
+  LZMA2 = 3,
+};
+
+// what the caller cares about more
+enum class w_compression_target {
+  // the cheapest codec which still compresses, e.g. for real time packets
+  THROUGHPUT,
+  // a good ratio at a low cost
+  BALANCED,
+  // the best ratio, e.g. for assets which are compressed once
+  RATIO,
+};
+
+struct w_compressor_options {
+  w_compression_target target = w_compression_target::BALANCED;
+  // the number of bytes which are sampled from the beginning, the middle and
+  // the end of the input
+  size_t sample_size = 4096;
+  // the output is stored, if the codec saves less than this ratio
+  double min_ratio = 1.05;
+};
+
+// the statistics of a sample
+struct w_compression_sample {
+  // the shannon entropy of the bytes, between 0 and 8 bits
+  double entropy = 0.0;
+  // the fraction of positions which repeat an earlier 4 byte sequence
+  double repetition = 0.0;
+};
+
+struct w_codec_choice {
+  w_codec codec = w_codec::STORE;
+  // the acceleration of lz4 fast or the level of lz4 hc and lzma2
+  int level = 0;
+};
+
+/*
+ * a facade which samples the input and picks a codec for the given target.
+ * the output is one byte of w_codec followed by the payload, so the caller
+ * does not need to know which codec was used.
+ */
+struct w_compressor {
+  static constexpr size_t HEADER_SIZE = 1;
+
+  /*
+   * sample the entropy and the repetition of the input
+   * @param p_src, the input source
+   * @param p_sample_size, the number of bytes to sample
+   * @returns the statistics
+   */
+  W_API static auto analyze(_In_ gsl::span<const std::byte> p_src,
+                            _In_ size_t p_sample_size) noexcept
+      -> w_compression_sample;
+
+  /*
+   * choose a codec for the input without compressing it. an input which is
+   * too big for every enabled codec is stored
+   * @param p_src, the input source
+   * @param p_options, the target and the sampling options
+   * @returns the codec and its level
+   */
+  W_API static auto choose(_In_ gsl::span<const std::byte> p_src,
+                           _In_ const w_compressor_options &p_options = {})
+      noexcept -> w_codec_choice;
+
+  /*
+   * compress with the chosen codec, or store the input if it does not
+   * compress
+   * @param p_src, the input source
+   * @param p_options, the target and the sampling options
+   * @returns the tagged output
+   */
+  W_API static auto compress(_In_ gsl::span<const std::byte> p_src,
+                             _In_ const w_compressor_options &p_options = {})
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * compress with an explicit codec, an input which is too big for the codec
+   * fails with std::errc::value_too_large
+   * @param p_src, the input source
+   * @param p_choice, the codec and its level
+   * @returns the tagged output
+   */
+  W_API static auto compress(_In_ gsl::span<const std::byte> p_src,
+                             _In_ const w_codec_choice &p_choice)
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * decompress an output of compress
+   * @param p_src, the tagged output
+   * @returns the original data
+   */
+  W_API static auto decompress(_In_ gsl::span<const std::byte> p_src)
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * read the codec of an output of compress
+   * @param p_src, the tagged output
+   * @returns the codec
+   */
+  W_API static auto get_codec(_In_ gsl::span<const std::byte> p_src) noexcept
+      -> boost::leaf::result<w_codec>;
+};
+}  // namespace wolf::system::compression
+
+#endif  // defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
@@ -9,13 +9,36 @@
 #endif
 
 #include <lz4.h>
+#include <lz4frame.h>
+#include <lz4hc.h>
 
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
 // NOLINTEND
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
 using w_lz4 = wolf::system::compression::w_lz4;
+using w_lz4_dictionary = wolf::system::compression::w_lz4_dictionary;
+using w_lz4_frame = wolf::system::compression::w_lz4_frame;
+using w_lz4_frame_compressor =
+    wolf::system::compression::w_lz4_frame_compressor;
+using w_lz4_frame_decompressor =
+    wolf::system::compression::w_lz4_frame_decompressor;
+using w_lz4_frame_options = wolf::system::compression::w_lz4_frame_options;
+using w_lz4_frame_progress = wolf::system::compression::w_lz4_frame_progress;
+
+static_assert(w_lz4::MAX_INPUT_SIZE == LZ4_MAX_INPUT_SIZE);
 
 namespace {
 auto s_check_input_len(_In_ const size_t p_src_size) noexcept
@@ -24,21 +47,160 @@ auto s_check_input_len(_In_ const size_t p_src_size) noexcept
     return 0;
   }
 
-  return W_FAILURE(
-      std::errc::invalid_argument,
-      wolf::format("source size is greater than LZ4_MAX_INPUT_SIZE: {}",
-                   LZ4_MAX_INPUT_SIZE));
+  return W_FAILURE(std::errc::invalid_argument,
+                   "source size is greater than LZ4_MAX_INPUT_SIZE: {}",
+                   LZ4_MAX_INPUT_SIZE);
+}
+
+void s_store_u32(_Inout_ gsl::span<std::byte> p_dst, _In_ size_t p_offset,
+                 _In_ uint32_t p_value) noexcept {
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    p_dst[p_offset + i] =
+        gsl::narrow_cast<std::byte>((p_value >> (8 * i)) & 0xFF);
+  }
+}
+
+auto s_load_u32(_In_ gsl::span<const std::byte> p_src,
+                _In_ size_t p_offset) noexcept -> uint32_t {
+  uint32_t _value = 0;
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    _value |= std::to_integer<uint32_t>(p_src[p_offset + i]) << (8 * i);
+  }
+  return _value;
+}
+
+auto s_compress(_In_ gsl::span<const std::byte> p_src,
+                _Inout_ gsl::span<std::byte> p_dst,
+                _In_ int p_acceleration) noexcept
+    -> boost::leaf::result<size_t> {
+  const auto _src_size = p_src.size();
+  if (_src_size == 0) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+
+  BOOST_LEAF_CHECK(s_check_input_len(_src_size));
+
+  const auto _dst_capacity = gsl::narrow_cast<int>(
+      std::min(p_dst.size(), size_t{LZ4_MAX_INPUT_SIZE}));
+
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto _bytes = LZ4_compress_fast(
+      reinterpret_cast<const char *>(p_src.data()),
+      reinterpret_cast<char *>(p_dst.data()), gsl::narrow_cast<int>(_src_size),
+      _dst_capacity, p_acceleration);
+  // NOLINTEND
+
+  if (_bytes > 0) {
+    return gsl::narrow_cast<size_t>(_bytes);
+  }
+  return W_FAILURE(std::errc::operation_canceled,
+                   "lz4 compress was failed, the destination might be smaller "
+                   "than the compress bound");
 }
 
-auto s_shrink_to_fit(_In_ const std::vector<std::byte> &p_src,
-                     _In_ const size_t p_shrink_size) noexcept
-    -> std::vector<std::byte> {
-  std::vector<std::byte> dst;
-  dst.resize(p_shrink_size);
+// compress into a vector of compress bound and cut it down without a copy
+auto s_compress(_In_ gsl::span<const std::byte> p_src,
+                _In_ int p_acceleration) noexcept
+    -> boost::leaf::result<std::vector<std::byte>> {
+  try {
+    BOOST_LEAF_CHECK(s_check_input_len(p_src.size()));
 
-  std::copy(p_src.begin(), p_src.begin() + gsl::narrow_cast<int>(p_shrink_size),
-            dst.begin());
-  return dst;
+    std::vector<std::byte> _dst(gsl::narrow_cast<size_t>(
+        LZ4_compressBound(gsl::narrow_cast<int>(p_src.size()))));
+    BOOST_LEAF_AUTO(_bytes, s_compress(p_src, _dst, p_acceleration));
+    _dst.resize(_bytes);
+    return _dst;
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("lz4 compress was failed. An exception "
+                                  "just happened: {}",
+                                  e.what()));
+  }
+}
+
+auto s_decompress(_In_ gsl::span<const std::byte> p_src,
+                  _Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<size_t> {
+  if (p_src.empty()) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+  BOOST_LEAF_CHECK(s_check_input_len(p_src.size()));
+
+  const auto _dst_capacity = gsl::narrow_cast<int>(
+      std::min(p_dst.size(), size_t{std::numeric_limits<int>::max()}));
+
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto _bytes = LZ4_decompress_safe(
+      reinterpret_cast<const char *>(p_src.data()),
+      reinterpret_cast<char *>(p_dst.data()),
+      gsl::narrow_cast<int>(p_src.size()), _dst_capacity);
+  // NOLINTEND
+
+  if (_bytes >= 0) {
+    return gsl::narrow_cast<size_t>(_bytes);
+  }
+  return W_FAILURE(std::errc::illegal_byte_sequence,
+                   "lz4 decompress was failed, the source is malformed or the "
+                   "destination is too small");
+}
+
+auto s_frame_error(_In_ const char *p_what, _In_ size_t p_code)
+    -> boost::leaf::result<size_t> {
+  return W_FAILURE(std::errc::operation_canceled,
+                   std::string(p_what) +
+                       " was failed because: " + LZ4F_getErrorName(p_code));
+}
+
+auto s_make_preferences(_In_ const w_lz4_frame_options &p_options) noexcept
+    -> LZ4F_preferences_t {
+  LZ4F_preferences_t _prefs = {};
+  _prefs.frameInfo.blockSizeID =
+      static_cast<LZ4F_blockSizeID_t>(p_options.block_size);
+  _prefs.frameInfo.blockMode = p_options.block_independent
+                                   ? LZ4F_blockIndependent
+                                   : LZ4F_blockLinked;
+  _prefs.frameInfo.contentChecksumFlag = p_options.content_checksum
+                                             ? LZ4F_contentChecksumEnabled
+                                             : LZ4F_noContentChecksum;
+  _prefs.frameInfo.blockChecksumFlag = p_options.block_checksum
+                                           ? LZ4F_blockChecksumEnabled
+                                           : LZ4F_noBlockChecksum;
+  _prefs.frameInfo.contentSize = p_options.content_size;
+  _prefs.compressionLevel = p_options.compression_level;
+  _prefs.autoFlush = p_options.auto_flush ? 1U : 0U;
+  return _prefs;
+}
+
+// the number of bytes of a block, e.g. 64 KB for MAX_64KB
+constexpr auto s_block_bytes(_In_ wolf::system::compression::w_lz4_block_size
+                                 p_block_size) noexcept -> size_t {
+  return size_t{1} << (8 + 2 * static_cast<int>(p_block_size));
+}
+
+auto s_write(_Inout_ std::ostream &p_dst, _In_ const std::vector<std::byte> &p_buf,
+             _In_ size_t p_size) -> boost::leaf::result<size_t> {
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  p_dst.write(reinterpret_cast<const char *>(p_buf.data()),
+              gsl::narrow_cast<std::streamsize>(p_size));
+  // NOLINTEND
+  if (!p_dst) {
+    return W_FAILURE(std::errc::io_error,
+                     "could not write into the output stream");
+  }
+  return p_size;
+}
+
+auto s_read(_Inout_ std::istream &p_src, _Inout_ std::vector<std::byte> &p_buf)
+    -> boost::leaf::result<size_t> {
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  p_src.read(reinterpret_cast<char *>(p_buf.data()),
+             gsl::narrow_cast<std::streamsize>(p_buf.size()));
+  // NOLINTEND
+  if (p_src.bad()) {
+    return W_FAILURE(std::errc::io_error,
+                     "could not read from the input stream");
+  }
+  return gsl::narrow_cast<size_t>(p_src.gcount());
 }
 }  // namespace
 
@@ -48,110 +210,860 @@ auto w_lz4::get_compress_bound(_In_ int p_size) noexcept -> int {
 
 auto w_lz4::compress_default(_In_ gsl::span<const std::byte> p_src) noexcept
     -> boost::leaf::result<std::vector<std::byte>> {
+  return s_compress(p_src, 1);
+}
+
+auto w_lz4::compress_fast(_In_ gsl::span<const std::byte> p_src,
+                          _In_ int p_acceleration) noexcept
+    -> boost::leaf::result<std::vector<std::byte>> {
+  return s_compress(p_src, p_acceleration);
+}
+
+auto w_lz4::compress_default(_In_ gsl::span<const std::byte> p_src,
+                             _Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<size_t> {
+  return s_compress(p_src, p_dst, 1);
+}
+
+auto w_lz4::compress_fast(_In_ gsl::span<const std::byte> p_src,
+                          _Inout_ gsl::span<std::byte> p_dst,
+                          _In_ int p_acceleration) noexcept
+    -> boost::leaf::result<size_t> {
+  return s_compress(p_src, p_dst, p_acceleration);
+}
+
+auto w_lz4::compress_hc(_In_ gsl::span<const std::byte> p_src,
+                        _In_ int p_level) noexcept
+    -> boost::leaf::result<std::vector<std::byte>> {
   try {
-    const auto src_size = p_src.size();
-    if (src_size == 0) {
-      return W_FAILURE(std::errc::invalid_argument, "the source is empty");
-    }
+    BOOST_LEAF_CHECK(s_check_input_len(p_src.size()));
+
+    std::vector<std::byte> _dst(gsl::narrow_cast<size_t>(
+        LZ4_compressBound(gsl::narrow_cast<int>(p_src.size()))));
+    BOOST_LEAF_AUTO(_bytes, compress_hc(p_src, _dst, p_level));
+    _dst.resize(_bytes);
+    return _dst;
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("lz4 compress 'hc mode' was failed. An "
+                                  "exception just happened: {}",
+                                  e.what()));
+  }
+}
+
+auto w_lz4::compress_hc(_In_ gsl::span<const std::byte> p_src,
+                        _Inout_ gsl::span<std::byte> p_dst,
+                        _In_ int p_level) noexcept
+    -> boost::leaf::result<size_t> {
+  const auto _src_size = p_src.size();
+  if (_src_size == 0) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+  BOOST_LEAF_CHECK(s_check_input_len(_src_size));
+
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto _bytes = LZ4_compress_HC(
+      reinterpret_cast<const char *>(p_src.data()),
+      reinterpret_cast<char *>(p_dst.data()), gsl::narrow_cast<int>(_src_size),
+      gsl::narrow_cast<int>(std::min(p_dst.size(), size_t{LZ4_MAX_INPUT_SIZE})),
+      std::clamp(p_level, 1, LZ4HC_CLEVEL_MAX));
+  // NOLINTEND
 
-    BOOST_LEAF_CHECK(s_check_input_len(src_size));
+  if (_bytes > 0) {
+    return gsl::narrow_cast<size_t>(_bytes);
+  }
+  return W_FAILURE(std::errc::operation_canceled,
+                   "lz4 compress 'hc mode' was failed, the destination might "
+                   "be smaller than the compress bound");
+}
 
-    const auto dst_capacity =
-        LZ4_compressBound(gsl::narrow_cast<int>(src_size));
+auto w_lz4::decompress(_In_ gsl::span<const std::byte> p_src,
+                       _In_ size_t p_max_retry) noexcept
+    -> boost::leaf::result<std::vector<std::byte>> {
+  const auto src_size = p_src.size();
+  if (src_size == 0) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+
+  try {
+    // we will increase our size per each step
     std::vector<std::byte> tmp;
-    tmp.resize(dst_capacity);
+    auto resize = src_size * 2;
 
-    // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
-    const auto _bytes =
-        LZ4_compress_default(reinterpret_cast<const char *>(p_src.data()),
-                             reinterpret_cast<char *>(tmp.data()),
-                             gsl::narrow_cast<int>(src_size), dst_capacity);
-    // NOLINTEND
-    if (_bytes > 0) {
-      return s_shrink_to_fit(tmp, _bytes);
+    for (size_t i = 0; i < p_max_retry; ++i) {
+      // resize it for next round
+      tmp.resize(resize);
+
+      // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+      const auto _bytes = LZ4_decompress_safe(
+          reinterpret_cast<const char *>(p_src.data()),
+          reinterpret_cast<char *>(tmp.data()),
+          gsl::narrow_cast<int>(src_size), gsl::narrow_cast<int>(tmp.size()));
+      // NOLINTEND
+
+      if (_bytes > 0) {
+        tmp.resize(gsl::narrow_cast<size_t>(_bytes));
+        return tmp;
+      }
+      resize *= 2;
     }
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("lz4 decompress was failed. An exception "
+                                  "just happened: {}",
+                                  e.what()));
+  }
+  return W_FAILURE(std::errc::operation_canceled,
+                   "could not decompress lz4 stream after {}", p_max_retry);
+}
 
-    return W_FAILURE(std::errc::operation_canceled,
-                     "lz4 compress 'default mode' was failed");
+auto w_lz4::decompress(_In_ gsl::span<const std::byte> p_src,
+                       _Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<size_t> {
+  return s_decompress(p_src, p_dst);
+}
+
+auto w_lz4::get_compress_sized_bound(_In_ size_t p_src_size) noexcept
+    -> size_t {
+  return SIZE_HEADER_BYTES +
+         gsl::narrow_cast<size_t>(
+             LZ4_compressBound(gsl::narrow_cast<int>(p_src_size)));
+}
+
+auto w_lz4::compress_sized(_In_ gsl::span<const std::byte> p_src,
+                           _In_ int p_acceleration) noexcept
+    -> boost::leaf::result<std::vector<std::byte>> {
+  try {
+    BOOST_LEAF_CHECK(s_check_input_len(p_src.size()));
+
+    std::vector<std::byte> _dst(get_compress_sized_bound(p_src.size()));
+    BOOST_LEAF_AUTO(_bytes, compress_sized(p_src, _dst, p_acceleration));
+    _dst.resize(_bytes);
+    return _dst;
   } catch (const std::exception &e) {
-    return W_FAILURE(std::errc::invalid_argument,
-                     wolf::format("lz4 compress 'default mode' was failed. An "
-                                  "exception just happened: {} ",
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("lz4 compress sized was failed. An "
+                                  "exception just happened: {}",
                                   e.what()));
   }
 }
 
-auto w_lz4::compress_fast(_In_ gsl::span<const std::byte> p_src,
-                          _In_ int p_acceleration) noexcept
+auto w_lz4::compress_sized(_In_ gsl::span<const std::byte> p_src,
+                           _Inout_ gsl::span<std::byte> p_dst,
+                           _In_ int p_acceleration) noexcept
+    -> boost::leaf::result<size_t> {
+  if (p_dst.size() <= SIZE_HEADER_BYTES) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination is too small for a sized block");
+  }
+
+  BOOST_LEAF_AUTO(_bytes, s_compress(p_src, p_dst.subspan(SIZE_HEADER_BYTES),
+                                     p_acceleration));
+
+  // s_compress already checked the size against LZ4_MAX_INPUT_SIZE
+  s_store_u32(p_dst, 0, gsl::narrow_cast<uint32_t>(p_src.size()));
+  return SIZE_HEADER_BYTES + _bytes;
+}
+
+auto w_lz4::get_decompressed_size(_In_ gsl::span<const std::byte> p_src) noexcept
+    -> boost::leaf::result<size_t> {
+  if (p_src.size() <= SIZE_HEADER_BYTES) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the source is too small for a sized block");
+  }
+
+  const auto _size = s_load_u32(p_src, 0);
+  if (_size >= LZ4_MAX_INPUT_SIZE) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the size header of the sized block is corrupted");
+  }
+  return size_t{_size};
+}
+
+auto w_lz4::decompress_sized(_In_ gsl::span<const std::byte> p_src) noexcept
     -> boost::leaf::result<std::vector<std::byte>> {
+  BOOST_LEAF_AUTO(_size, get_decompressed_size(p_src));
   try {
-    const auto src_size = p_src.size();
-    if (src_size == 0) {
-      return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+    std::vector<std::byte> _dst(_size);
+    BOOST_LEAF_CHECK(decompress_sized(p_src, _dst));
+    return _dst;
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("lz4 decompress sized was failed. An "
+                                  "exception just happened: {}",
+                                  e.what()));
+  }
+}
+
+auto w_lz4::decompress_sized(_In_ gsl::span<const std::byte> p_src,
+                             _Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<size_t> {
+  BOOST_LEAF_AUTO(_size, get_decompressed_size(p_src));
+  if (p_dst.size() < _size) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination is smaller than the original size: {}",
+                     _size);
+  }
+
+  BOOST_LEAF_AUTO(_bytes, s_decompress(p_src.subspan(SIZE_HEADER_BYTES),
+                                       p_dst.first(_size)));
+  if (_bytes != _size) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the sized block decompressed into {} bytes instead of {}",
+                     _bytes, _size);
+  }
+  return _bytes;
+}
+
+w_lz4_frame_compressor::w_lz4_frame_compressor(
+    _In_ const w_lz4_frame_options &p_options) noexcept
+    : _options(p_options) {}
+
+w_lz4_frame_compressor::~w_lz4_frame_compressor() noexcept { _release(); }
+
+w_lz4_frame_compressor::w_lz4_frame_compressor(
+    w_lz4_frame_compressor &&p_other) noexcept
+    : _options(p_other._options),
+      _ctx(std::exchange(p_other._ctx, nullptr)),
+      _in_frame(std::exchange(p_other._in_frame, false)) {}
+
+w_lz4_frame_compressor &w_lz4_frame_compressor::operator=(
+    w_lz4_frame_compressor &&p_other) noexcept {
+  if (this != &p_other) {
+    _release();
+    this->_options = p_other._options;
+    this->_ctx = std::exchange(p_other._ctx, nullptr);
+    this->_in_frame = std::exchange(p_other._in_frame, false);
+  }
+  return *this;
+}
+
+void w_lz4_frame_compressor::_release() noexcept {
+  if (this->_ctx != nullptr) {
+    LZ4F_freeCompressionContext(this->_ctx);
+    this->_ctx = nullptr;
+  }
+  this->_in_frame = false;
+}
+
+auto w_lz4_frame_compressor::get_compress_bound(
+    _In_ size_t p_src_size) const noexcept -> size_t {
+  const auto _prefs = s_make_preferences(this->_options);
+  return LZ4F_compressBound(p_src_size, &_prefs);
+}
+
+auto w_lz4_frame_compressor::begin(_Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<size_t> {
+  if (p_dst.size() < HEADER_SIZE_MAX) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination is smaller than HEADER_SIZE_MAX");
+  }
+  if (this->_ctx == nullptr) {
+    const auto _ret =
+        LZ4F_createCompressionContext(&this->_ctx, LZ4F_VERSION);
+    if (LZ4F_isError(_ret) != 0U) {
+      this->_ctx = nullptr;
+      return s_frame_error("lz4 create compression context", _ret);
     }
+  }
+
+  const auto _prefs = s_make_preferences(this->_options);
+  const auto _ret =
+      LZ4F_compressBegin(this->_ctx, p_dst.data(), p_dst.size(), &_prefs);
+  if (LZ4F_isError(_ret) != 0U) {
+    return s_frame_error("lz4 frame begin", _ret);
+  }
+  this->_in_frame = true;
+  return _ret;
+}
 
-    BOOST_LEAF_CHECK(s_check_input_len(src_size));
+auto w_lz4_frame_compressor::update(_In_ gsl::span<const std::byte> p_src,
+                                    _Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<size_t> {
+  if (!this->_in_frame) {
+    return W_FAILURE(std::errc::operation_not_permitted,
+                     "begin must be called before update");
+  }
+  if (p_dst.size() < get_compress_bound(p_src.size())) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination is smaller than the compress bound");
+  }
 
-    const auto _dst_capacity =
-        LZ4_compressBound(gsl::narrow_cast<int>(src_size));
-    std::vector<std::byte> tmp;
-    tmp.resize(_dst_capacity);
+  const auto _ret = LZ4F_compressUpdate(this->_ctx, p_dst.data(), p_dst.size(),
+                                        p_src.data(), p_src.size(), nullptr);
+  if (LZ4F_isError(_ret) != 0U) {
+    this->_in_frame = false;
+    return s_frame_error("lz4 frame update", _ret);
+  }
+  return _ret;
+}
 
-    // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
-    const auto bytes = LZ4_compress_fast(
-        reinterpret_cast<const char *>(p_src.data()),
-        reinterpret_cast<char *>(tmp.data()), gsl::narrow_cast<int>(src_size),
-        _dst_capacity, p_acceleration);
-    // NOLINTEND
+auto w_lz4_frame_compressor::flush(_Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<size_t> {
+  if (!this->_in_frame) {
+    return W_FAILURE(std::errc::operation_not_permitted,
+                     "begin must be called before flush");
+  }
+
+  const auto _ret =
+      LZ4F_flush(this->_ctx, p_dst.data(), p_dst.size(), nullptr);
+  if (LZ4F_isError(_ret) != 0U) {
+    return s_frame_error("lz4 frame flush", _ret);
+  }
+  return _ret;
+}
+
+auto w_lz4_frame_compressor::finish(_Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<size_t> {
+  if (!this->_in_frame) {
+    return W_FAILURE(std::errc::operation_not_permitted,
+                     "begin must be called before finish");
+  }
+
+  const auto _ret =
+      LZ4F_compressEnd(this->_ctx, p_dst.data(), p_dst.size(), nullptr);
+  this->_in_frame = false;
+  if (LZ4F_isError(_ret) != 0U) {
+    return s_frame_error("lz4 frame finish", _ret);
+  }
+  return _ret;
+}
 
-    if (bytes > 0) {
-      return s_shrink_to_fit(tmp, bytes);
+w_lz4_frame_decompressor::~w_lz4_frame_decompressor() noexcept {
+  if (this->_ctx != nullptr) {
+    LZ4F_freeDecompressionContext(this->_ctx);
+    this->_ctx = nullptr;
+  }
+}
+
+w_lz4_frame_decompressor::w_lz4_frame_decompressor(
+    w_lz4_frame_decompressor &&p_other) noexcept
+    : _ctx(std::exchange(p_other._ctx, nullptr)) {}
+
+w_lz4_frame_decompressor &w_lz4_frame_decompressor::operator=(
+    w_lz4_frame_decompressor &&p_other) noexcept {
+  if (this != &p_other) {
+    if (this->_ctx != nullptr) {
+      LZ4F_freeDecompressionContext(this->_ctx);
+    }
+    this->_ctx = std::exchange(p_other._ctx, nullptr);
+  }
+  return *this;
+}
+
+auto w_lz4_frame_decompressor::update(_In_ gsl::span<const std::byte> p_src,
+                                      _Inout_ gsl::span<std::byte> p_dst) noexcept
+    -> boost::leaf::result<w_lz4_frame_progress> {
+  if (this->_ctx == nullptr) {
+    const auto _ret =
+        LZ4F_createDecompressionContext(&this->_ctx, LZ4F_VERSION);
+    if (LZ4F_isError(_ret) != 0U) {
+      this->_ctx = nullptr;
+      BOOST_LEAF_CHECK(s_frame_error("lz4 create decompression context", _ret));
     }
+  }
 
-    return W_FAILURE(std::errc::operation_canceled,
-                     "lz4 compress fast mode was failed");
+  auto _src_size = p_src.size();
+  auto _dst_size = p_dst.size();
+  const auto _ret = LZ4F_decompress(this->_ctx, p_dst.data(), &_dst_size,
+                                    p_src.data(), &_src_size, nullptr);
+  if (LZ4F_isError(_ret) != 0U) {
+    // the state is undefined after an error
+    reset();
+    BOOST_LEAF_CHECK(s_frame_error("lz4 frame decompress", _ret));
+  }
+
+  return w_lz4_frame_progress{_src_size, _dst_size, _ret == 0};
+}
+
+void w_lz4_frame_decompressor::reset() noexcept {
+  if (this->_ctx != nullptr) {
+    LZ4F_resetDecompressionContext(this->_ctx);
+  }
+}
+
+auto w_lz4_frame::compress(_Inout_ std::istream &p_src,
+                           _Inout_ std::ostream &p_dst,
+                           _In_ const w_lz4_frame_options &p_options)
+    -> boost::leaf::result<uint64_t> {
+  auto _compressor = w_lz4_frame_compressor(p_options);
+
+  // read one block at a time, so the memory does not grow with the input
+  auto _in = std::vector<std::byte>(s_block_bytes(p_options.block_size));
+  auto _out = std::vector<std::byte>(std::max(
+      _compressor.get_compress_bound(_in.size()),
+      w_lz4_frame_compressor::HEADER_SIZE_MAX));
+
+  uint64_t _total = 0;
+  BOOST_LEAF_AUTO(_header, _compressor.begin(_out));
+  BOOST_LEAF_AUTO(_written, s_write(p_dst, _out, _header));
+  _total += _written;
+
+  for (;;) {
+    BOOST_LEAF_AUTO(_read, s_read(p_src, _in));
+    if (_read == 0) {
+      break;
+    }
+    BOOST_LEAF_AUTO(_bytes, _compressor.update(
+                                gsl::span<const std::byte>(_in).first(_read),
+                                _out));
+    BOOST_LEAF_AUTO(_chunk, s_write(p_dst, _out, _bytes));
+    _total += _chunk;
+  }
+
+  BOOST_LEAF_AUTO(_end, _compressor.finish(_out));
+  BOOST_LEAF_AUTO(_tail, s_write(p_dst, _out, _end));
+  _total += _tail;
+  return _total;
+}
+
+auto w_lz4_frame::decompress(_Inout_ std::istream &p_src,
+                             _Inout_ std::ostream &p_dst)
+    -> boost::leaf::result<uint64_t> {
+  auto _decompressor = w_lz4_frame_decompressor();
+
+  constexpr auto _chunk_size = size_t{64} * 1024;
+  auto _in = std::vector<std::byte>(_chunk_size);
+  auto _out = std::vector<std::byte>(_chunk_size);
+
+  uint64_t _total = 0;
+  bool _in_frame = false;
+  for (;;) {
+    BOOST_LEAF_AUTO(_read, s_read(p_src, _in));
+    if (_read == 0) {
+      break;
+    }
+
+    const auto _src = gsl::span<const std::byte>(_in).first(_read);
+    size_t _consumed = 0;
+    bool _output_full = false;
+    do {
+      BOOST_LEAF_AUTO(_progress,
+                      _decompressor.update(_src.subspan(_consumed), _out));
+      _consumed += _progress.consumed;
+      _in_frame = !_progress.finished;
+
+      BOOST_LEAF_AUTO(_written, s_write(p_dst, _out, _progress.produced));
+      _total += _written;
+      // keep draining while the output was full, the decoder might still
+      // hold decoded bytes of a block
+      _output_full = _progress.produced == _out.size();
+    } while (_consumed < _src.size() || _output_full);
+  }
+
+  if (_in_frame) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the lz4 frame is truncated");
+  }
+  return _total;
+}
+
+namespace {
+
+constexpr std::array<std::byte, 4> s_dictionary_magic = {
+    std::byte{'W'}, std::byte{'L'}, std::byte{'Z'}, std::byte{'D'}};
+
+// the length of the substrings which are counted by the trainer
+constexpr size_t s_kmer_size = 8;
+// the trainer picks segments of this size, which start every s_segment_step
+constexpr size_t s_segment_size = 64;
+constexpr size_t s_segment_step = 16;
+
+auto s_kmer(_In_ gsl::span<const std::byte> p_src, _In_ size_t p_offset) noexcept
+    -> uint64_t {
+  uint64_t _kmer = 0;
+  std::memcpy(&_kmer, &p_src[p_offset], s_kmer_size);
+  return _kmer;
+}
+
+// fnv-1a, which is stable across builds and platforms
+auto s_dictionary_id(_In_ gsl::span<const std::byte> p_content) noexcept
+    -> uint32_t {
+  uint32_t _hash = 2166136261U;
+  for (const auto _byte : p_content) {
+    _hash ^= std::to_integer<uint32_t>(_byte);
+    _hash *= 16777619U;
+  }
+  // zero means "derive the id"
+  return _hash == 0 ? 1 : _hash;
+}
+
+struct segment {
+  uint64_t score = 0;
+  size_t sample = 0;
+  size_t offset = 0;
+  size_t size = 0;
+};
+
+/*
+ * a greedy cover of the samples: every k-mer is weighted by the number of
+ * samples containing it, and the segments with the highest weight of not yet
+ * covered k-mers are picked until the dictionary is full
+ */
+auto s_train(_In_ const std::vector<gsl::span<const std::byte>> &p_samples,
+             _In_ size_t p_max_size) -> std::vector<std::byte> {
+  std::unordered_map<uint64_t, uint32_t> _frequency;
+  std::unordered_set<uint64_t> _seen;
+  for (const auto &_sample : p_samples) {
+    _seen.clear();
+    for (size_t i = 0; i + s_kmer_size <= _sample.size(); ++i) {
+      if (_seen.insert(s_kmer(_sample, i)).second) {
+        _frequency[s_kmer(_sample, i)]++;
+      }
+    }
+  }
+
+  const auto _score = [&](_In_ gsl::span<const std::byte> p_segment,
+                          _In_ const std::unordered_set<uint64_t> &p_covered) {
+    uint64_t _sum = 0;
+    for (size_t i = 0; i + s_kmer_size <= p_segment.size(); ++i) {
+      const auto _kmer = s_kmer(p_segment, i);
+      const auto _iter = _frequency.find(_kmer);
+      // a k-mer of a single sample can not help other messages
+      if (_iter != _frequency.end() && _iter->second > 1 &&
+          !p_covered.contains(_kmer)) {
+        _sum += _iter->second;
+      }
+    }
+    return _sum;
+  };
+
+  std::vector<segment> _segments;
+  const std::unordered_set<uint64_t> _none;
+  for (size_t s = 0; s < p_samples.size(); ++s) {
+    const auto &_sample = p_samples[s];
+    for (size_t i = 0; i + s_kmer_size <= _sample.size(); i += s_segment_step) {
+      const auto _size = std::min(s_segment_size, _sample.size() - i);
+      const auto _sum = _score(_sample.subspan(i, _size), _none);
+      if (_sum > 0) {
+        _segments.push_back({_sum, s, i, _size});
+      }
+    }
+  }
+  std::stable_sort(_segments.begin(), _segments.end(),
+                   [](const segment &p_a, const segment &p_b) {
+                     return p_a.score > p_b.score;
+                   });
+
+  // the scores shrink while k-mers get covered, so a segment is skipped once
+  // most of its score is already covered by the picked ones
+  std::vector<gsl::span<const std::byte>> _picked;
+  std::unordered_set<uint64_t> _covered;
+  size_t _total = 0;
+  for (const auto &_candidate : _segments) {
+    if (_total + s_kmer_size > p_max_size) {
+      break;
+    }
+    auto _span = p_samples[_candidate.sample].subspan(
+        _candidate.offset, std::min(_candidate.size, p_max_size - _total));
+    if (_score(_span, _covered) * 2 < _candidate.score) {
+      continue;
+    }
+    for (size_t i = 0; i + s_kmer_size <= _span.size(); ++i) {
+      _covered.insert(s_kmer(_span, i));
+    }
+    _picked.push_back(_span);
+    _total += _span.size();
+  }
+
+  // the best segments go last, closest to the message
+  std::vector<std::byte> _content;
+  _content.reserve(_total);
+  for (auto _iter = _picked.crbegin(); _iter != _picked.crend(); ++_iter) {
+    _content.insert(_content.end(), _iter->begin(), _iter->end());
+  }
+  return _content;
+}
+
+}  // namespace
+
+w_lz4_dictionary::~w_lz4_dictionary() noexcept { _release(); }
+
+w_lz4_dictionary::w_lz4_dictionary(w_lz4_dictionary &&p_other) noexcept
+    : _id(std::exchange(p_other._id, 0)),
+      _content(std::move(p_other._content)),
+      _stream(std::exchange(p_other._stream, nullptr)) {}
+
+w_lz4_dictionary &w_lz4_dictionary::operator=(
+    w_lz4_dictionary &&p_other) noexcept {
+  if (this != &p_other) {
+    _release();
+    this->_id = std::exchange(p_other._id, 0);
+    this->_content = std::move(p_other._content);
+    this->_stream = std::exchange(p_other._stream, nullptr);
+  }
+  return *this;
+}
+
+void w_lz4_dictionary::_release() noexcept {
+  if (this->_stream != nullptr) {
+    LZ4_freeStream(this->_stream);
+    this->_stream = nullptr;
+  }
+}
+
+auto w_lz4_dictionary::train(
+    _In_ const std::vector<gsl::span<const std::byte>> &p_samples,
+    _In_ size_t p_max_size, _In_ uint32_t p_id)
+    -> boost::leaf::result<w_lz4_dictionary> {
+  if (p_max_size < s_kmer_size || p_max_size > MAX_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the size of the dictionary must be between {} and {}",
+                     s_kmer_size, MAX_SIZE);
+  }
+
+  try {
+    const auto _content = s_train(p_samples, p_max_size);
+    if (_content.empty()) {
+      return W_FAILURE(std::errc::invalid_argument,
+                       "the samples do not share any content to train on");
+    }
+    return from_content(_content, p_id);
   } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("could not train the lz4 dictionary. An "
+                                  "exception just happened: {}",
+                                  e.what()));
+  }
+}
+
+auto w_lz4_dictionary::from_content(_In_ gsl::span<const std::byte> p_content,
+                                    _In_ uint32_t p_id)
+    -> boost::leaf::result<w_lz4_dictionary> {
+  if (p_content.empty()) {
     return W_FAILURE(std::errc::invalid_argument,
-                     wolf::format("lz4 compress 'fast mode' was failed. "
-                                  "An exception just happened: {}",
+                     "the content of the dictionary is empty");
+  }
+
+  try {
+    const auto _content =
+        p_content.last(std::min(p_content.size(), MAX_SIZE));
+
+    w_lz4_dictionary _dictionary;
+    _dictionary._content.assign(_content.begin(), _content.end());
+    _dictionary._id = p_id != 0 ? p_id : s_dictionary_id(_content);
+
+    _dictionary._stream = LZ4_createStream();
+    if (_dictionary._stream == nullptr) {
+      return W_FAILURE(std::errc::not_enough_memory,
+                       "could not create the lz4 stream");
+    }
+
+    // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+    LZ4_loadDict(
+        _dictionary._stream,
+        reinterpret_cast<const char *>(_dictionary._content.data()),
+        gsl::narrow_cast<int>(_dictionary._content.size()));
+    // NOLINTEND
+    return _dictionary;
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("could not create the lz4 dictionary. An "
+                                  "exception just happened: {}",
                                   e.what()));
   }
 }
 
-auto w_lz4::decompress(_In_ gsl::span<const std::byte> p_src,
-                       _In_ size_t p_max_retry) noexcept
+auto w_lz4_dictionary::serialize() const -> std::vector<std::byte> {
+  std::vector<std::byte> _dst(s_dictionary_magic.size() + 8 +
+                              this->_content.size());
+  std::copy(s_dictionary_magic.cbegin(), s_dictionary_magic.cend(),
+            _dst.begin());
+  s_store_u32(_dst, 4, this->_id);
+  s_store_u32(_dst, 8, gsl::narrow_cast<uint32_t>(this->_content.size()));
+  std::copy(this->_content.cbegin(), this->_content.cend(),
+            _dst.begin() + 12);
+  return _dst;
+}
+
+auto w_lz4_dictionary::deserialize(_In_ gsl::span<const std::byte> p_src)
+    -> boost::leaf::result<w_lz4_dictionary> {
+  if (p_src.size() < 12 ||
+      !std::equal(s_dictionary_magic.cbegin(), s_dictionary_magic.cend(),
+                  p_src.begin())) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the source is not a serialized lz4 dictionary");
+  }
+
+  const auto _id = s_load_u32(p_src, 4);
+  const auto _size = s_load_u32(p_src, 8);
+  if (_id == 0 || _size == 0 || _size > MAX_SIZE ||
+      _size != p_src.size() - 12) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the serialized lz4 dictionary is corrupted");
+  }
+  return from_content(p_src.subspan(12), _id);
+}
+
+auto w_lz4_dictionary::save(_In_ const std::filesystem::path &p_path) const
+    -> boost::leaf::result<int> {
+  std::ofstream _file(p_path, std::ios::binary | std::ios::trunc);
+  if (!_file.is_open()) {
+    return W_FAILURE(std::errc::io_error,
+                     "could not open the dictionary file: " + p_path.string());
+  }
+
+  const auto _bytes = serialize();
+  BOOST_LEAF_CHECK(s_write(_file, _bytes, _bytes.size()));
+  return 0;
+}
+
+auto w_lz4_dictionary::load(_In_ const std::filesystem::path &p_path)
+    -> boost::leaf::result<w_lz4_dictionary> {
+  std::ifstream _file(p_path, std::ios::binary);
+  if (!_file.is_open()) {
+    return W_FAILURE(std::errc::io_error,
+                     "could not open the dictionary file: " + p_path.string());
+  }
+
+  // the magic, id, size and the biggest content
+  std::vector<std::byte> _bytes(12 + MAX_SIZE + 1);
+  BOOST_LEAF_AUTO(_read, s_read(_file, _bytes));
+  return deserialize(gsl::span<const std::byte>(_bytes).first(_read));
+}
+
+auto w_lz4_dictionary::get_compress_bound(_In_ size_t p_src_size) noexcept
+    -> size_t {
+  return HEADER_SIZE + gsl::narrow_cast<size_t>(LZ4_compressBound(
+                           gsl::narrow_cast<int>(p_src_size)));
+}
+
+auto w_lz4_dictionary::get_dictionary_id(
+    _In_ gsl::span<const std::byte> p_src) noexcept
+    -> boost::leaf::result<uint32_t> {
+  if (p_src.size() <= HEADER_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the source is too small for a dictionary message");
+  }
+  return s_load_u32(p_src, 0);
+}
+
+auto w_lz4_dictionary::compress(_In_ gsl::span<const std::byte> p_src,
+                                _In_ int p_acceleration) const noexcept
     -> boost::leaf::result<std::vector<std::byte>> {
-  const auto src_size = p_src.size();
-  if (src_size == 0) {
+  try {
+    BOOST_LEAF_CHECK(s_check_input_len(p_src.size()));
+
+    std::vector<std::byte> _dst(get_compress_bound(p_src.size()));
+    BOOST_LEAF_AUTO(_bytes, compress(p_src, _dst, p_acceleration));
+    _dst.resize(_bytes);
+    return _dst;
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("lz4 dictionary compress was failed. An "
+                                  "exception just happened: {}",
+                                  e.what()));
+  }
+}
+
+auto w_lz4_dictionary::compress(_In_ gsl::span<const std::byte> p_src,
+                                _Inout_ gsl::span<std::byte> p_dst,
+                                _In_ int p_acceleration) const noexcept
+    -> boost::leaf::result<size_t> {
+  if (p_src.empty()) {
     return W_FAILURE(std::errc::invalid_argument, "the source is empty");
   }
+  BOOST_LEAF_CHECK(s_check_input_len(p_src.size()));
+  if (p_dst.size() <= HEADER_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination is too small for a dictionary message");
+  }
 
-  // we will increase our size per each step
-  std::vector<std::byte> tmp;
-  auto resize = src_size * 2;
+  // start from a copy of the preloaded state instead of hashing the
+  // dictionary again, the state is a plain union which refers to _content
+  LZ4_stream_t _working;
+  std::memcpy(&_working, this->_stream, sizeof(LZ4_stream_t));
 
-#ifdef __clang
-#pragma unroll
-#endif
-  for (auto i = 0; i < p_max_retry; ++i) {
-    // resize it for next round
-    tmp.resize(resize);
+  const auto _dst = p_dst.subspan(HEADER_SIZE);
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto _bytes = LZ4_compress_fast_continue(
+      &_working, reinterpret_cast<const char *>(p_src.data()),
+      reinterpret_cast<char *>(_dst.data()),
+      gsl::narrow_cast<int>(p_src.size()),
+      gsl::narrow_cast<int>(
+          std::min(_dst.size(), size_t{LZ4_MAX_INPUT_SIZE})),
+      p_acceleration);
+  // NOLINTEND
+  if (_bytes <= 0) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "lz4 dictionary compress was failed, the destination "
+                     "might be smaller than the compress bound");
+  }
 
-    // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
-    const auto _bytes = LZ4_decompress_safe(
-        reinterpret_cast<const char *>(p_src.data()),
-        reinterpret_cast<char *>(tmp.data()), gsl::narrow_cast<int>(src_size),
-        gsl::narrow_cast<int>(tmp.size()));
-    // NOLINTEND
+  s_store_u32(p_dst, 0, this->_id);
+  s_store_u32(p_dst, 4, gsl::narrow_cast<uint32_t>(p_src.size()));
+  return HEADER_SIZE + gsl::narrow_cast<size_t>(_bytes);
+}
 
-    if (_bytes > 0) {
-      return s_shrink_to_fit(tmp, _bytes);
-    }
-    resize *= 2;
+auto w_lz4_dictionary::decompress(
+    _In_ gsl::span<const std::byte> p_src) const noexcept
+    -> boost::leaf::result<std::vector<std::byte>> {
+  if (p_src.size() <= HEADER_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the source is too small for a dictionary message");
+  }
+
+  // a message of another dictionary is rejected before its size header is
+  // trusted for the allocation
+  const auto _id = s_load_u32(p_src, 0);
+  if (_id != this->_id) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the message was compressed with the dictionary {} "
+                     "instead of {}",
+                     _id, this->_id);
+  }
+
+  const auto _size = s_load_u32(p_src, 4);
+  if (_size >= LZ4_MAX_INPUT_SIZE) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the size header of the dictionary message is corrupted");
+  }
+
+  try {
+    std::vector<std::byte> _dst(_size);
+    BOOST_LEAF_CHECK(decompress(p_src, _dst));
+    return _dst;
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("lz4 dictionary decompress was failed. An "
+                                  "exception just happened: {}",
+                                  e.what()));
+  }
+}
+
+auto w_lz4_dictionary::decompress(_In_ gsl::span<const std::byte> p_src,
+                                  _Inout_ gsl::span<std::byte> p_dst) const
+    noexcept -> boost::leaf::result<size_t> {
+  BOOST_LEAF_AUTO(_id, get_dictionary_id(p_src));
+  if (_id != this->_id) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the message was compressed with the dictionary {} "
+                     "instead of {}",
+                     _id, this->_id);
+  }
+
+  const auto _size = s_load_u32(p_src, 4);
+  if (_size >= LZ4_MAX_INPUT_SIZE || p_dst.size() < _size) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the destination is smaller than the original size: {}",
+                     _size);
+  }
+
+  const auto _src = p_src.subspan(HEADER_SIZE);
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto _bytes = LZ4_decompress_safe_usingDict(
+      reinterpret_cast<const char *>(_src.data()),
+      reinterpret_cast<char *>(p_dst.data()),
+      gsl::narrow_cast<int>(_src.size()), gsl::narrow_cast<int>(_size),
+      reinterpret_cast<const char *>(this->_content.data()),
+      gsl::narrow_cast<int>(this->_content.size()));
+  // NOLINTEND
+  if (_bytes < 0 || gsl::narrow_cast<uint32_t>(_bytes) != _size) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "lz4 dictionary decompress was failed, the message is "
+                     "malformed");
   }
-  return W_FAILURE(
-      std::errc::operation_canceled,
-      wolf::format("could not decompress lz4 stream after {}", p_max_retry));
+  return gsl::narrow_cast<size_t>(_bytes);
 }
 
 #endif  // WOLF_SYSTEM_LZ4
@@ -8,12 +8,24 @@
 #ifdef WOLF_SYSTEM_LZ4
 
 #include <cstddef>
+#include <filesystem>
+#include <iosfwd>
 #include <vector>
 #include <wolf/wolf.hpp>
 
+// the opaque contexts of lz4.h and lz4frame.h
+union LZ4_stream_u;
+struct LZ4F_cctx_s;
+struct LZ4F_dctx_s;
+
 namespace wolf::system::compression {
 
 struct w_lz4 {
+  // the size of the little endian original size, which prefixes a sized block
+  static constexpr size_t SIZE_HEADER_BYTES = 4;
+  // the size of the biggest input, which is LZ4_MAX_INPUT_SIZE of lz4.h
+  static constexpr size_t MAX_INPUT_SIZE = 0x7E000000;
+
   /*
    * get the size of compress bound
    * @param p_size, the input size
@@ -41,14 +53,471 @@ struct w_lz4 {
       -> boost::leaf::result<std::vector<std::byte>>;
 
   /*
-   * decompress the compressed stream
+   * compress using the default mode of lz4 into a caller owned buffer
+   * @param p_src, the input source
+   * @param p_dst, the output, which should be at least get_compress_bound
+   * @returns the number of bytes written into p_dst
+   */
+  W_API static auto compress_default(_In_ gsl::span<const std::byte> p_src,
+                                     _Inout_ gsl::span<std::byte> p_dst) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * compress using the fast mode of lz4 into a caller owned buffer
+   * @param p_src, the input source
+   * @param p_dst, the output, which should be at least get_compress_bound
+   * @param p_acceleration, a value between 1 - 65536
+   * @returns the number of bytes written into p_dst
+   */
+  W_API static auto compress_fast(_In_ gsl::span<const std::byte> p_src,
+                                  _Inout_ gsl::span<std::byte> p_dst,
+                                  _In_ int p_acceleration) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * compress using the high compression mode of lz4, which is slower to
+   * compress but as fast to decompress
+   * @param p_src, the input source
+   * @param p_level, a value between 1 - 12
+   * @returns the vector of compressed stream
+   */
+  W_API static auto compress_hc(_In_ gsl::span<const std::byte> p_src,
+                                _In_ int p_level) noexcept
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * compress using the high compression mode of lz4 into a caller owned buffer
    * @param p_src, the input source
+   * @param p_dst, the output, which should be at least get_compress_bound
+   * @param p_level, a value between 1 - 12
+   * @returns the number of bytes written into p_dst
+   */
+  W_API static auto compress_hc(_In_ gsl::span<const std::byte> p_src,
+                                _Inout_ gsl::span<std::byte> p_dst,
+                                _In_ int p_level) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * decompress the compressed stream, the original size is unknown, so the
+   * output is grown and the decompression is retried. prefer the sized
+   * variants whenever the producer can be changed.
+   * @param p_src, the input source
+   * @param p_max_retry, the number of retries
    * @returns the vector of decompressed stream
    */
   W_API static auto decompress(_In_ gsl::span<const std::byte> p_src,
                                _In_ size_t p_max_retry) noexcept
       -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * decompress the compressed stream in one pass into a caller owned buffer
+   * @param p_src, the input source
+   * @param p_dst, the output, which must be able to hold the original data
+   * @returns the number of bytes written into p_dst
+   */
+  W_API static auto decompress(_In_ gsl::span<const std::byte> p_src,
+                               _Inout_ gsl::span<std::byte> p_dst) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * get the size of a sized block's output
+   * @param p_src_size, the input size
+   * @returns the size of bound, including SIZE_HEADER_BYTES
+   */
+  W_API static auto get_compress_sized_bound(_In_ size_t p_src_size) noexcept
+      -> size_t;
+
+  /*
+   * compress into a sized block, which is the original size followed by the
+   * lz4 block, so it can be decompressed in one pass
+   * @param p_src, the input source
+   * @param p_acceleration, a value between 1 - 65536, 1 is the default mode
+   * @returns the vector of the sized block
+   */
+  W_API static auto compress_sized(_In_ gsl::span<const std::byte> p_src,
+                                   _In_ int p_acceleration = 1) noexcept
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * compress into a sized block inside a caller owned buffer
+   * @param p_src, the input source
+   * @param p_dst, the output, which should be at least get_compress_sized_bound
+   * @param p_acceleration, a value between 1 - 65536, 1 is the default mode
+   * @returns the number of bytes written into p_dst
+   */
+  W_API static auto compress_sized(_In_ gsl::span<const std::byte> p_src,
+                                   _Inout_ gsl::span<std::byte> p_dst,
+                                   _In_ int p_acceleration = 1) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * read the original size from the header of a sized block
+   * @param p_src, the sized block
+   * @returns the original size
+   */
+  W_API static auto get_decompressed_size(
+      _In_ gsl::span<const std::byte> p_src) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * decompress a sized block in one pass with one allocation
+   * @param p_src, the sized block
+   * @returns the vector of decompressed stream
+   */
+  W_API static auto decompress_sized(
+      _In_ gsl::span<const std::byte> p_src) noexcept
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * decompress a sized block in one pass into a caller owned buffer
+   * @param p_src, the sized block
+   * @param p_dst, the output, which must be at least get_decompressed_size
+   * @returns the number of bytes written into p_dst
+   */
+  W_API static auto decompress_sized(_In_ gsl::span<const std::byte> p_src,
+                                     _Inout_ gsl::span<std::byte> p_dst) noexcept
+      -> boost::leaf::result<size_t>;
 };
+
+// the maximum size of an uncompressed block of the lz4 frame format
+enum class w_lz4_block_size {
+  MAX_64KB = 4,
+  MAX_256KB = 5,
+  MAX_1MB = 6,
+  MAX_4MB = 7,
+};
+
+struct w_lz4_frame_options {
+  // the size of blocks, the memory of the compressor grows with it
+  w_lz4_block_size block_size = w_lz4_block_size::MAX_64KB;
+  // independent blocks can be decoded separately, linked blocks compress
+  // better since each block may refer to the previous 64 KB
+  bool block_independent = true;
+  // append a xxhash32 of the whole content, checked by the decompressor
+  bool content_checksum = true;
+  // append a xxhash32 to each block
+  bool block_checksum = false;
+  // 0 is the fast mode, 3 - 12 are the high compression modes
+  int compression_level = 0;
+  // the size of the whole content, if it is known, otherwise zero
+  uint64_t content_size = 0;
+  // flush each update into the output instead of buffering a block
+  bool auto_flush = false;
+};
+
+/*
+ * an incremental compressor for the lz4 frame format. the memory is bounded
+ * by the block size, the input might be of any size and all the output is
+ * written into caller provided buffers.
+ */
+class w_lz4_frame_compressor {
+ public:
+  // the maximum size of the frame header which is written by begin
+  static constexpr size_t HEADER_SIZE_MAX = 19;
+
+  // constructor
+  W_API explicit w_lz4_frame_compressor(
+      _In_ const w_lz4_frame_options &p_options = {}) noexcept;
+
+  // destructor
+  W_API virtual ~w_lz4_frame_compressor() noexcept;
+
+  // move constructor.
+  W_API w_lz4_frame_compressor(w_lz4_frame_compressor &&p_other) noexcept;
+  // move assignment operator.
+  W_API w_lz4_frame_compressor &operator=(
+      w_lz4_frame_compressor &&p_other) noexcept;
+
+  /*
+   * get the worst case size of the output of one update plus finish
+   * @param p_src_size, the size of the input of the update
+   * @returns the required size of the destination buffer
+   */
+  W_API auto get_compress_bound(_In_ size_t p_src_size) const noexcept
+      -> size_t;
+
+  /*
+   * start a new frame and write its header
+   * @param p_dst, the destination with at least HEADER_SIZE_MAX bytes
+   * @returns the number of bytes which were written
+   */
+  W_API auto begin(_Inout_ gsl::span<std::byte> p_dst) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * compress the next part of the content
+   * @param p_src, the input
+   * @param p_dst, the destination with at least get_compress_bound bytes
+   * @returns the number of bytes which were written, which might be zero
+   * while a block is being buffered
+   */
+  W_API auto update(_In_ gsl::span<const std::byte> p_src,
+                    _Inout_ gsl::span<std::byte> p_dst) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * write the buffered data without closing the frame
+   * @param p_dst, the destination with at least get_compress_bound(0) bytes
+   * @returns the number of bytes which were written
+   */
+  W_API auto flush(_Inout_ gsl::span<std::byte> p_dst) noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * write the buffered data, the end mark and the checksum of the frame
+   * @param p_dst, the destination with at least get_compress_bound(0) bytes
+   * @returns the number of bytes which were written
+   */
+  W_API auto finish(_Inout_ gsl::span<std::byte> p_dst) noexcept
+      -> boost::leaf::result<size_t>;
+
+ private:
+  // copy constructor.
+  w_lz4_frame_compressor(const w_lz4_frame_compressor &) = delete;
+  // copy assignment operator.
+  w_lz4_frame_compressor &operator=(const w_lz4_frame_compressor &) = delete;
+
+  void _release() noexcept;
+
+  w_lz4_frame_options _options = {};
+  LZ4F_cctx_s *_ctx = nullptr;
+  bool _in_frame = false;
+};
+
+// the progress of one call of w_lz4_frame_decompressor::update
+struct w_lz4_frame_progress {
+  // the number of input bytes which were consumed
+  size_t consumed = 0;
+  // the number of bytes which were written into the destination
+  size_t produced = 0;
+  // true when the end of the frame was reached and its checksum was verified
+  bool finished = false;
+};
+
+/*
+ * an incremental decompressor for the lz4 frame format, which writes into
+ * caller provided buffers. the input might be fed in pieces of any size.
+ */
+class w_lz4_frame_decompressor {
+ public:
+  // constructor
+  W_API w_lz4_frame_decompressor() noexcept = default;
+
+  // destructor
+  W_API virtual ~w_lz4_frame_decompressor() noexcept;
+
+  // move constructor.
+  W_API w_lz4_frame_decompressor(w_lz4_frame_decompressor &&p_other) noexcept;
+  // move assignment operator.
+  W_API w_lz4_frame_decompressor &operator=(
+      w_lz4_frame_decompressor &&p_other) noexcept;
+
+  /*
+   * decompress the next part of the frame. call it again with the rest of
+   * the input while the destination is full or the input is not consumed
+   * @param p_src, the input
+   * @param p_dst, the destination
+   * @returns the progress
+   */
+  W_API auto update(_In_ gsl::span<const std::byte> p_src,
+                    _Inout_ gsl::span<std::byte> p_dst) noexcept
+      -> boost::leaf::result<w_lz4_frame_progress>;
+
+  // drop the state of the current frame, so a new frame can be decoded
+  W_API void reset() noexcept;
+
+ private:
+  // copy constructor.
+  w_lz4_frame_decompressor(const w_lz4_frame_decompressor &) = delete;
+  // copy assignment operator.
+  w_lz4_frame_decompressor &operator=(const w_lz4_frame_decompressor &) =
+      delete;
+
+  LZ4F_dctx_s *_ctx = nullptr;
+};
+
+struct w_lz4_frame {
+  /*
+   * compress a stream into a lz4 frame with a fixed memory footprint
+   * @param p_src, the input stream
+   * @param p_dst, the output stream
+   * @param p_options, the frame options
+   * @returns the number of bytes which were written
+   */
+  W_API static auto compress(_Inout_ std::istream &p_src,
+                             _Inout_ std::ostream &p_dst,
+                             _In_ const w_lz4_frame_options &p_options = {})
+      -> boost::leaf::result<uint64_t>;
+
+  /*
+   * decompress the lz4 frames of a stream with a fixed memory footprint
+   * @param p_src, the input stream
+   * @param p_dst, the output stream
+   * @returns the number of bytes which were written
+   */
+  W_API static auto decompress(_Inout_ std::istream &p_src,
+                               _Inout_ std::ostream &p_dst)
+      -> boost::leaf::result<uint64_t>;
+};
+
+/*
+ * a shared dictionary for small messages, which are too short to find matches
+ * in themselves. the dictionary is preloaded once and each compression starts
+ * from a copy of the preloaded state, so it costs no extra hashing per call.
+ * a message is the dictionary id and the original size, both u32 little
+ * endian, followed by the lz4 block. an instance is immutable after creation
+ * and can be shared between threads.
+ */
+class w_lz4_dictionary {
+ public:
+  // lz4 only refers to the last 64 KB of a dictionary
+  static constexpr size_t MAX_SIZE = 64 * 1024;
+  // the size of the id and the original size, which prefix a message
+  static constexpr size_t HEADER_SIZE = 8;
+
+  // destructor
+  W_API virtual ~w_lz4_dictionary() noexcept;
+
+  // move constructor.
+  W_API w_lz4_dictionary(w_lz4_dictionary &&p_other) noexcept;
+  // move assignment operator.
+  W_API w_lz4_dictionary &operator=(w_lz4_dictionary &&p_other) noexcept;
+
+  /*
+   * train a dictionary from sample messages. the segments which are shared by
+   * most samples are picked greedily until the dictionary is full.
+   * @param p_samples, the sample messages
+   * @param p_max_size, the maximum size of the dictionary, up to MAX_SIZE
+   * @param p_id, the id of the dictionary, zero derives it from the content
+   * @returns the dictionary
+   */
+  W_API static auto train(
+      _In_ const std::vector<gsl::span<const std::byte>> &p_samples,
+      _In_ size_t p_max_size = MAX_SIZE, _In_ uint32_t p_id = 0)
+      -> boost::leaf::result<w_lz4_dictionary>;
+
+  /*
+   * create a dictionary from a raw content
+   * @param p_content, the content, only the last MAX_SIZE bytes are used
+   * @param p_id, the id of the dictionary, zero derives it from the content
+   * @returns the dictionary
+   */
+  W_API static auto from_content(_In_ gsl::span<const std::byte> p_content,
+                                 _In_ uint32_t p_id = 0)
+      -> boost::leaf::result<w_lz4_dictionary>;
+
+  /*
+   * serialize the id and the content of the dictionary
+   * @returns the serialized dictionary
+   */
+  W_API auto serialize() const -> std::vector<std::byte>;
+
+  /*
+   * restore a dictionary from the output of serialize
+   * @param p_src, the serialized dictionary
+   * @returns the dictionary
+   */
+  W_API static auto deserialize(_In_ gsl::span<const std::byte> p_src)
+      -> boost::leaf::result<w_lz4_dictionary>;
+
+  /*
+   * save the serialized dictionary into a file
+   * @param p_path, the path of the file
+   * @returns zero on success
+   */
+  W_API auto save(_In_ const std::filesystem::path &p_path) const
+      -> boost::leaf::result<int>;
+
+  /*
+   * load a dictionary, which was saved by save
+   * @param p_path, the path of the file
+   * @returns the dictionary
+   */
+  W_API static auto load(_In_ const std::filesystem::path &p_path)
+      -> boost::leaf::result<w_lz4_dictionary>;
+
+  /*
+   * get the size of a compressed message's output
+   * @param p_src_size, the input size
+   * @returns the size of bound, including HEADER_SIZE
+   */
+  W_API static auto get_compress_bound(_In_ size_t p_src_size) noexcept
+      -> size_t;
+
+  /*
+   * read the dictionary id of a compressed message, so it can be routed to
+   * the matching dictionary
+   * @param p_src, the compressed message
+   * @returns the dictionary id
+   */
+  W_API static auto get_dictionary_id(
+      _In_ gsl::span<const std::byte> p_src) noexcept
+      -> boost::leaf::result<uint32_t>;
+
+  /*
+   * compress a message with the dictionary
+   * @param p_src, the input source
+   * @param p_acceleration, a value between 1 - 65536, 1 is the default mode
+   * @returns the compressed message
+   */
+  W_API auto compress(_In_ gsl::span<const std::byte> p_src,
+                      _In_ int p_acceleration = 1) const noexcept
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * compress a message with the dictionary into a caller owned buffer
+   * @param p_src, the input source
+   * @param p_dst, the output, which should be at least get_compress_bound
+   * @param p_acceleration, a value between 1 - 65536, 1 is the default mode
+   * @returns the number of bytes written into p_dst
+   */
+  W_API auto compress(_In_ gsl::span<const std::byte> p_src,
+                      _Inout_ gsl::span<std::byte> p_dst,
+                      _In_ int p_acceleration = 1) const noexcept
+      -> boost::leaf::result<size_t>;
+
+  /*
+   * decompress a message, which was compressed with this dictionary
+   * @param p_src, the compressed message
+   * @returns the original message
+   */
+  W_API auto decompress(_In_ gsl::span<const std::byte> p_src) const noexcept
+      -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * decompress a message into a caller owned buffer
+   * @param p_src, the compressed message
+   * @param p_dst, the output, which must hold the original message
+   * @returns the number of bytes written into p_dst
+   */
+  W_API auto decompress(_In_ gsl::span<const std::byte> p_src,
+                        _Inout_ gsl::span<std::byte> p_dst) const noexcept
+      -> boost::leaf::result<size_t>;
+
+  // returns the id of the dictionary
+  W_API auto get_id() const noexcept -> uint32_t { return this->_id; }
+
+  // returns the content of the dictionary
+  W_API auto get_content() const noexcept -> gsl::span<const std::byte> {
+    return this->_content;
+  }
+
+ private:
+  // constructor
+  w_lz4_dictionary() noexcept = default;
+  // copy constructor.
+  w_lz4_dictionary(const w_lz4_dictionary &) = delete;
+  // copy assignment operator.
+  w_lz4_dictionary &operator=(const w_lz4_dictionary &) = delete;
+
+  void _release() noexcept;
+
+  uint32_t _id = 0;
+  std::vector<std::byte> _content;
+  // the stream state after LZ4_loadDict, which refers to _content
+  LZ4_stream_u *_stream = nullptr;
+};
+
 }  // namespace wolf::system::compression
 
 #endif  // WOLF_SYSTEM_LZ4
@@ -18,10 +18,13 @@
 #endif
 // NOLINTEND
 
+#include <algorithm>
+#include <new>
+
 using w_lzma = wolf::system::compression::w_lzma;
 
 constexpr auto LZMA_HEADER_SRC_SIZE = 8;
-constexpr auto MAX_HEADER_SIZE = 256 * 1024 * 1024;
+constexpr auto MAX_HEADER_SIZE = w_lzma::MAX_DECOMPRESS_SIZE;
 
 namespace {
 
@@ -38,6 +41,16 @@ void s_lzma_free(ISzAllocPtr p_ptr, void *p_addr) noexcept {
 
 constexpr ISzAlloc s_alloc_funcs = {s_lzma_alloc, s_lzma_free};
 
+// read the uncompressed size which follows the property byte of lzma2
+auto s_lzma2_header_size(_In_ gsl::span<const std::byte> p_src) noexcept
+    -> uint64_t {
+  uint64_t _size = 0;
+  for (size_t i = 0; i < LZMA_HEADER_SRC_SIZE; ++i) {
+    _size |= std::to_integer<uint64_t>(p_src[sizeof(Byte) + i]) << (i * 8);
+  }
+  return _size;
+}
+
 // NOLINTBEGIN (bugprone-easily-swappable-parameters)
 void s_lzma_prop(_Inout_ CLzmaEncProps *p_prop, _In_ int p_level,
                  _In_ int p_src_size) noexcept {
@@ -196,9 +209,10 @@ auto w_lzma::compress_lzma2(_In_ const gsl::span<const std::byte> p_src,
     dst.push_back(std::byte(properties));
     constexpr auto uncompressed_byte_size = 8;
     constexpr auto oxff = 0xFF;
+    const auto _src_size_64 = gsl::narrow_cast<uint64_t>(src_size);
     for (int i = 0; i < LZMA_HEADER_SRC_SIZE; i++) {
       dst.push_back(
-          std::byte((src_size >> (i * uncompressed_byte_size)) & oxff));
+          std::byte((_src_size_64 >> (i * uncompressed_byte_size)) & oxff));
     }
 
     // copy the compressed size
@@ -258,79 +272,99 @@ auto w_lzma::decompress_lzma1(_In_ gsl::span<const std::byte> p_src)
 
 auto w_lzma::decompress_lzma2(_In_ gsl::span<const std::byte> p_src)
     -> boost::leaf::result<std::vector<std::byte>> {
+  if (p_src.size() < LZMA_HEADER_SRC_SIZE + sizeof(Byte)) {
+    return W_FAILURE(std::errc::invalid_argument, "invalid lzma2 header size");
+  }
+
+  const auto _size_from_header = s_lzma2_header_size(p_src);
+  if (_size_from_header > MAX_HEADER_SIZE) {
+    return W_FAILURE(std::errc::value_too_large,
+                     "the lzma2 header size {} is bigger than the limit {}",
+                     _size_from_header, MAX_HEADER_SIZE);
+  }
+
+  std::vector<std::byte> dst;
+  try {
+    dst.resize(gsl::narrow_cast<size_t>(_size_from_header));
+  } catch (const std::bad_alloc &) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not allocate {} bytes for lzma2 decompress",
+                     _size_from_header);
+  }
+  BOOST_LEAF_CHECK(decompress_lzma2(p_src, dst));
+  return dst;
+}
+
+auto w_lzma::decompress_lzma2(_In_ gsl::span<const std::byte> p_src,
+                              _Inout_ gsl::span<std::byte> p_dst)
+    -> boost::leaf::result<size_t> {
   const auto _src_size = p_src.size();
 
   if (_src_size < LZMA_HEADER_SRC_SIZE + sizeof(Byte)) {
     return W_FAILURE(std::errc::invalid_argument, "invalid lzma2 header size");
   }
 
-  // extract the size from the header
-  uint64_t _size_from_header = 0;
-  for (uint64_t i = 0; i < LZMA_HEADER_SRC_SIZE; i++) {
-    const auto _h1 = gsl::at(p_src, gsl::index(sizeof(Byte) + i));
-    const auto _h2 = i * 8;
-    const auto _h3 = gsl::narrow_cast<uint64_t>(_h1 << _h2);
-    if (_h3 < std::numeric_limits<uint64_t>::max()) {
-      _size_from_header |= _h3;
-    }
+  // the decoder never writes more than the destination can hold
+  const auto _size_from_header = s_lzma2_header_size(p_src);
+  if (_size_from_header > p_dst.size()) {
+    return W_FAILURE(std::errc::value_too_large,
+                     "the lzma2 stream of {} bytes does not fit into {} bytes",
+                     _size_from_header, p_dst.size());
   }
+  const auto _size = gsl::narrow_cast<size_t>(_size_from_header);
 
-  const auto _pre_out_size = _size_from_header * 2;
-  if (_size_from_header <= MAX_HEADER_SIZE) {
-    std::vector<std::byte> dst;
-    dst.resize(_size_from_header);
+  CLzma2Dec dec{};
+  Lzma2Dec_Construct(&dec);
+
+  // the property byte carries the dictionary size of the encoder
+  auto res = Lzma2Dec_Allocate(&dec, std::to_integer<Byte>(p_src[0]),
+                               &s_alloc_funcs);
+  if (res != SZ_OK) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "could not allocate memory for lzma2 decoder");
+  }
+
+  Lzma2Dec_Init(&dec);
+  size_t out_pos = 0;
+  auto in_pos = LZMA_HEADER_SRC_SIZE + sizeof(Byte);
 
-    CLzma2Dec dec{};
-    Lzma2Dec_Construct(&dec);
+  ELzmaStatus status = LZMA_STATUS_NOT_SPECIFIED;
+  constexpr size_t BUF_SIZE = 10240;
+
+  while (out_pos < _size) {
+    auto dest_len = std::min(BUF_SIZE, _size - out_pos);
+    auto src_len = std::min(BUF_SIZE, _src_size - in_pos);
+
+    // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+    res = Lzma2Dec_DecodeToBuf(
+        &dec, reinterpret_cast<Byte *>(p_dst.data() + out_pos), &dest_len,
+        reinterpret_cast<const Byte *>(p_src.data() + in_pos), &src_len,
+        (out_pos + dest_len == _size) ? LZMA_FINISH_END : LZMA_FINISH_ANY,
+        &status);
+    // NOLINTEND
 
-    auto res = Lzma2Dec_Allocate(&dec, 0, &s_alloc_funcs);
     if (res != SZ_OK) {
-      return W_FAILURE(std::errc::invalid_argument,
-                       "could not allocate memory for lzma2 decoder");
+      break;
     }
 
-    Lzma2Dec_Init(&dec);
-    size_t out_pos = 0;
-    auto in_pos = LZMA_HEADER_SRC_SIZE + sizeof(std::byte);
-
-    ELzmaStatus status = LZMA_STATUS_NOT_SPECIFIED;
-    constexpr uint32_t BUF_SIZE = 10240;
-
-    while (out_pos < _pre_out_size) {
-      auto dest_len = std::min(gsl::narrow_cast<uint64_t>(BUF_SIZE),
-                               _pre_out_size - out_pos);
-      auto src_len = std::min(gsl::narrow_cast<size_t>(BUF_SIZE),
-                              _src_size - gsl::narrow_cast<size_t>(in_pos));
-
-      // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
-      res = Lzma2Dec_DecodeToBuf(
-          &dec, reinterpret_cast<Byte *>(&gsl::at(dst, out_pos)), &dest_len,
-          reinterpret_cast<const Byte *>(&gsl::at(p_src, in_pos)), &src_len,
-          (out_pos + dest_len == _size_from_header) ? LZMA_FINISH_END
-                                                    : LZMA_FINISH_ANY,
-          &status);
-      // NOLINTEND
-
-      if (res != SZ_OK) {
-        return W_FAILURE(std::errc::invalid_argument,
-                         "Lzma2Dec_DecodeToBuf failed");
-      }
-
-      in_pos += src_len;
-      out_pos += dest_len;
-      if (status == LZMA_STATUS_FINISHED_WITH_MARK) {
-        break;
-      }
+    in_pos += src_len;
+    out_pos += dest_len;
+    if (status == LZMA_STATUS_FINISHED_WITH_MARK ||
+        (src_len == 0 && dest_len == 0)) {
+      break;
     }
+  }
 
-    Lzma2Dec_Free(&dec, &s_alloc_funcs);
+  Lzma2Dec_Free(&dec, &s_alloc_funcs);
 
-    if (out_pos == _size_from_header) {
-      return dst;
-    }
+  if (res != SZ_OK) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "Lzma2Dec_DecodeToBuf failed");
   }
-
-  return W_FAILURE(std::errc::operation_canceled, "lzma2 decompress failed");
+  if (out_pos != _size) {
+    return W_FAILURE(std::errc::operation_canceled, "lzma2 decompress failed");
+  }
+  return out_pos;
 }
 
 #endif  // WOLF_SYSTEM_LZMA
\ No newline at end of file
@@ -14,6 +14,9 @@
 namespace wolf::system::compression {
 
 struct w_lzma {
+  // the biggest original size, which the decompressors allocate
+  static constexpr size_t MAX_DECOMPRESS_SIZE = 256 * 1024 * 1024;
+
   /*
    * compress a stream via lzma1 algorithm
    * @param p_src, the input source
@@ -49,6 +52,16 @@ struct w_lzma {
    */
   W_API static auto decompress_lzma2(_In_ gsl::span<const std::byte> p_src)
       -> boost::leaf::result<std::vector<std::byte>>;
+
+  /*
+   * decompress a stream via lzma2 algorithm into a caller owned buffer
+   * @param p_src, the input source
+   * @param p_dst, the output, a bigger stream fails without being decoded
+   * @returns the number of bytes written into p_dst
+   */
+  W_API static auto decompress_lzma2(_In_ gsl::span<const std::byte> p_src,
+                                     _Inout_ gsl::span<std::byte> p_dst)
+      -> boost::leaf::result<size_t>;
 };
 }  // namespace wolf::system::compression
 
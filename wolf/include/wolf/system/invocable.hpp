@@ -56,25 +56,35 @@ namespace ofats {
 
 namespace any_detail {
 
-// using buffer = std::aligned_storage_t<sizeof(void*) * 2, alignof(void*)>;
+// the default inline capacity, large enough for a lambda which captures
+// four pointers (e.g. this, a reference and a shared_ptr)
+inline constexpr std::size_t default_buffer_size = sizeof(void*) * 4;
+
+template <std::size_t Size>
 struct buffer {
-  alignas(void*) std::byte t_buff[sizeof(sizeof(void*) * 2)];
+  static_assert(Size >= sizeof(void*),
+                "the inline buffer must be able to hold at least a pointer");
+  alignas(void*) std::byte t_buff[Size];
 };
 
-template <class T>
+template <class T, std::size_t Size>
 inline constexpr bool is_small_object_v =
-    sizeof(T) <= sizeof(buffer) && alignof(buffer) % alignof(T) == 0 &&
+    sizeof(T) <= sizeof(buffer<Size>) &&
+    alignof(buffer<Size>) % alignof(T) == 0 &&
     std::is_nothrow_move_constructible_v<T>;
 
+template <std::size_t Size>
 union storage {
   void* ptr_ = nullptr;
-  buffer buf_;
+  buffer<Size> buf_;
 };
 
 enum class action { destroy, move };
 
-template <class R, class... ArgTypes>
+template <std::size_t Size, class R, class... ArgTypes>
 struct handler_traits {
+  using storage = any_detail::storage<Size>;
+
   template <class Derived>
   struct handler_base {
     static void handle(action act, storage* current, storage* other = nullptr) {
@@ -133,8 +143,8 @@ struct handler_traits {
   };
 
   template <class T>
-  using handler = std::conditional_t<is_small_object_v<T>, small_handler<T>,
-                                     large_handler<T>>;
+  using handler = std::conditional_t<is_small_object_v<T, Size>,
+                                     small_handler<T>, large_handler<T>>;
 };
 
 template <class T>
@@ -146,17 +156,16 @@ struct is_in_place_type<std::in_place_type_t<T>> : std::true_type {};
 template <class T>
 inline constexpr auto is_in_place_type_v = is_in_place_type<T>::value;
 
-template <class R, bool is_noexcept, class... ArgTypes>
+template <class R, bool is_noexcept, std::size_t Size, class... ArgTypes>
 class any_invocable_impl {
   template <class T>
-  using handler =
-      typename any_detail::handler_traits<R, ArgTypes...>::template handler<T>;
+  using handler = typename any_detail::handler_traits<
+      Size, R, ArgTypes...>::template handler<T>;
 
-  using storage = any_detail::storage;
+  using storage = any_detail::storage<Size>;
   using action = any_detail::action;
-  using handle_func = void (*)(any_detail::action, any_detail::storage*,
-                               any_detail::storage*);
-  using call_func = R (*)(const any_detail::storage&, ArgTypes...);
+  using handle_func = void (*)(any_detail::action, storage*, storage*);
+  using call_func = R (*)(const storage&, ArgTypes...);
 
  public:
   using result_type = R;
@@ -173,7 +182,17 @@ class any_invocable_impl {
   }
 
   any_invocable_impl& operator=(any_invocable_impl&& rhs) noexcept {
-    any_invocable_impl{std::move(rhs)}.swap(*this);
+    // move straight into our storage instead of going through a temporary
+    // and a three way swap of the inline buffers
+    if (this != &rhs) {
+      destroy();
+      if (rhs.handle_) {
+        handle_ = rhs.handle_;
+        handle_(action::move, &storage_, &rhs.storage_);
+        call_ = rhs.call_;
+        rhs.handle_ = nullptr;
+      }
+    }
     return *this;
   }
   any_invocable_impl& operator=(std::nullptr_t) noexcept {
@@ -262,14 +281,17 @@ using can_convert = std::conjunction<
 
 }  // namespace any_detail
 
-template <class Signature>
+// Size is the capacity of the inline buffer. callables which fit in it and
+// are nothrow move constructible are stored without any heap allocation
+template <class Signature, std::size_t Size = any_detail::default_buffer_size>
 class any_invocable;
 
 #define __OFATS_ANY_INVOCABLE(cv, ref, noex, inv_quals)                        \
-  template <class R, class... ArgTypes>                                        \
-  class any_invocable<R(ArgTypes...) cv ref noexcept(noex)> final              \
-      : public any_detail::any_invocable_impl<R, noex, ArgTypes...> {          \
-    using base_type = any_detail::any_invocable_impl<R, noex, ArgTypes...>;    \
+  template <class R, std::size_t Size, class... ArgTypes>                     \
+  class any_invocable<R(ArgTypes...) cv ref noexcept(noex), Size> final        \
+      : public any_detail::any_invocable_impl<R, noex, Size, ArgTypes...> {    \
+    using base_type =                                                          \
+        any_detail::any_invocable_impl<R, noex, Size, ArgTypes...>;            \
                                                                                \
    public:                                                                     \
     using base_type::base_type;                                                \
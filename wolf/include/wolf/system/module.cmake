@@ -1,8 +1,14 @@
 set(SYSTEM_PATH ${CMAKE_CURRENT_SOURCE_DIR}/wolf/system/)
 
 file(GLOB_RECURSE SYSTEM_SRCS
+    ${SYSTEM_PATH}/w_buffer.cpp
+    ${SYSTEM_PATH}/w_buffer.hpp
     ${SYSTEM_PATH}/w_gametime.cpp
     ${SYSTEM_PATH}/w_gametime.hpp
+    ${SYSTEM_PATH}/w_histogram.cpp
+    ${SYSTEM_PATH}/w_histogram.hpp
+    ${SYSTEM_PATH}/w_profiler.cpp
+    ${SYSTEM_PATH}/w_profiler.hpp
     ${SYSTEM_PATH}/w_trace.cpp
     ${SYSTEM_PATH}/w_trace.hpp
 )
@@ -35,11 +41,20 @@ if (WOLF_SYSTEM_MIMALLOC)
     endif()
 endif()
 
+if (WOLF_SYSTEM_ALLOC_PROFILER)
+    if (WOLF_SYSTEM_MIMALLOC)
+        message(FATAL_ERROR "WOLF_SYSTEM_ALLOC_PROFILER can not be used with WOLF_SYSTEM_MIMALLOC")
+    endif()
+    target_compile_definitions(${PROJECT_NAME} PUBLIC WOLF_SYSTEM_ALLOC_PROFILER)
+    target_link_libraries(${PROJECT_NAME} PRIVATE ${CMAKE_DL_LIBS})
+endif()
+
 if (WOLF_SYSTEM_OPENSSL)
-    # no source codes, only link against openssl library.
     vcpkg_install(openssl)
     find_package(OpenSSL REQUIRED)
-    target_link_libraries(${PROJECT_NAME} PRIVATE OpenSSL::SSL OpenSSL::Crypto)
+    # the tls sessions of the sockets expose openssl in their headers
+    target_link_libraries(${PROJECT_NAME} PUBLIC OpenSSL::SSL OpenSSL::Crypto)
+    target_compile_definitions(${PROJECT_NAME} PUBLIC WOLF_SYSTEM_SSL)
 endif()
 
 if (WOLF_SYSTEM_POSTGRESQL OR WOLF_SYSTEM_REDIS)
@@ -0,0 +1,256 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_framing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+using w_delimiter_frame_codec = wolf::system::socket::w_delimiter_frame_codec;
+using w_fixed32_frame_codec = wolf::system::socket::w_fixed32_frame_codec;
+using w_frame_codec = wolf::system::socket::w_frame_codec;
+using w_frame_decode_result = wolf::system::socket::w_frame_decode_result;
+using w_frame_reader = wolf::system::socket::w_frame_reader;
+using w_ring_buffer = wolf::system::socket::w_ring_buffer;
+using w_varint_frame_codec = wolf::system::socket::w_varint_frame_codec;
+
+namespace {
+
+// split a complete frame, or report how many bytes it needs
+auto s_frame(_In_ gsl::span<const std::byte> p_data, _In_ size_t p_header_size,
+             _In_ size_t p_payload_size) noexcept -> w_frame_decode_result {
+  const auto _frame_size = p_header_size + p_payload_size;
+  if (p_data.size() < _frame_size) {
+    return {{}, 0, _frame_size};
+  }
+  return {p_data.subspan(p_header_size, p_payload_size), _frame_size, 0};
+}
+
+}  // namespace
+
+w_ring_buffer::w_ring_buffer(_In_ size_t p_capacity)
+    : _storage(std::max<size_t>(p_capacity, 1)) {}
+
+gsl::span<std::byte> w_ring_buffer::prepare(_In_ size_t p_size) {
+  if (this->_storage.size() - this->_tail < p_size) {
+    // move the partial frame to the front, which is usually a few bytes
+    const auto _size = size();
+    if (this->_head != 0) {
+      std::memmove(this->_storage.data(), this->_storage.data() + this->_head,
+                   _size);
+      this->_head = 0;
+      this->_tail = _size;
+    }
+    if (this->_storage.size() - this->_tail < p_size) {
+      this->_storage.resize(
+          std::max(this->_storage.size() * 2, _size + p_size));
+    }
+  }
+  return gsl::span(this->_storage).subspan(this->_tail);
+}
+
+void w_ring_buffer::commit(_In_ size_t p_size) noexcept {
+  this->_tail = std::min(this->_tail + p_size, this->_storage.size());
+}
+
+void w_ring_buffer::consume(_In_ size_t p_size) noexcept {
+  this->_head = std::min(this->_head + p_size, this->_tail);
+  if (this->_head == this->_tail) {
+    // all frames were read, start over without moving any byte
+    this->_head = 0;
+    this->_tail = 0;
+  }
+}
+
+auto w_frame_codec::encode(_In_ gsl::span<const std::byte> p_payload) const
+    -> boost::leaf::result<w_buffer> {
+  std::array<std::byte, MAX_HEADER_SIZE> _header = {};
+  BOOST_LEAF_AUTO(_header_size, encode_header(p_payload.size(), _header));
+  const auto _trailer = get_trailer();
+
+  try {
+    w_buffer _frame(_header_size + p_payload.size() + _trailer.size());
+    _frame.resize(_header_size + p_payload.size() + _trailer.size());
+
+    auto *_dst = _frame.data();
+    std::memcpy(_dst, _header.data(), _header_size);
+    if (!p_payload.empty()) {
+      std::memcpy(_dst + _header_size, p_payload.data(), p_payload.size());
+    }
+    if (!_trailer.empty()) {
+      std::memcpy(_dst + _header_size + p_payload.size(), _trailer.data(),
+                  _trailer.size());
+    }
+    return _frame;
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("could not encode a frame of {} bytes "
+                                  "because: {}",
+                                  p_payload.size(), e.what()));
+  }
+}
+
+auto w_varint_frame_codec::decode(
+    _In_ gsl::span<const std::byte> p_data, _In_ size_t p_scanned) const
+    noexcept -> boost::leaf::result<w_frame_decode_result> {
+  // the header is parsed again, it is at most a few bytes
+  std::ignore = p_scanned;
+
+  uint64_t _size = 0;
+  const auto _bytes = std::min(p_data.size(), MAX_HEADER_SIZE);
+  for (size_t i = 0; i < _bytes; ++i) {
+    const auto _byte = std::to_integer<uint64_t>(p_data[i]);
+    if (i == MAX_HEADER_SIZE - 1 && _byte > 1) {
+      return W_FAILURE(std::errc::value_too_large,
+                       "the varint frame size does not fit in 64 bits");
+    }
+    _size |= (_byte & 0x7F) << (7 * i);
+    if ((_byte & 0x80) == 0) {
+      if (_size > this->_max_frame_size) {
+        return W_FAILURE(std::errc::message_size,
+                         "the frame of {} bytes is bigger than the limit of "
+                         "{} bytes",
+                         _size, this->_max_frame_size);
+      }
+      return s_frame(p_data, i + 1, gsl::narrow_cast<size_t>(_size));
+    }
+  }
+
+  if (_bytes == MAX_HEADER_SIZE) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the varint frame size is not terminated");
+  }
+  return w_frame_decode_result{{}, 0, p_data.size() + 1};
+}
+
+auto w_varint_frame_codec::encode_header(
+    _In_ size_t p_payload_size, _Inout_ gsl::span<std::byte> p_header) const
+    noexcept -> boost::leaf::result<size_t> {
+  if (p_header.size() < MAX_HEADER_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the header needs {} bytes", MAX_HEADER_SIZE);
+  }
+
+  auto _size = static_cast<uint64_t>(p_payload_size);
+  size_t _bytes = 0;
+  while (_size >= 0x80) {
+    p_header[_bytes++] = gsl::narrow_cast<std::byte>((_size & 0x7F) | 0x80);
+    _size >>= 7;
+  }
+  p_header[_bytes++] = gsl::narrow_cast<std::byte>(_size);
+  return _bytes;
+}
+
+auto w_fixed32_frame_codec::decode(
+    _In_ gsl::span<const std::byte> p_data, _In_ size_t p_scanned) const
+    noexcept -> boost::leaf::result<w_frame_decode_result> {
+  // the header is parsed again, it is at most a few bytes
+  std::ignore = p_scanned;
+
+  if (p_data.size() < HEADER_SIZE) {
+    return w_frame_decode_result{{}, 0, HEADER_SIZE};
+  }
+
+  uint32_t _size = 0;
+  for (size_t i = 0; i < HEADER_SIZE; ++i) {
+    _size = (_size << 8) | std::to_integer<uint32_t>(p_data[i]);
+  }
+  if (_size > this->_max_frame_size) {
+    return W_FAILURE(std::errc::message_size,
+                     "the frame of {} bytes is bigger than the limit of {} "
+                     "bytes",
+                     _size, this->_max_frame_size);
+  }
+  return s_frame(p_data, HEADER_SIZE, _size);
+}
+
+auto w_fixed32_frame_codec::encode_header(
+    _In_ size_t p_payload_size, _Inout_ gsl::span<std::byte> p_header) const
+    noexcept -> boost::leaf::result<size_t> {
+  if (p_header.size() < HEADER_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the header needs {} bytes", HEADER_SIZE);
+  }
+  if (p_payload_size > UINT32_MAX) {
+    return W_FAILURE(std::errc::value_too_large,
+                     "the payload of {} bytes does not fit in 32 bits",
+                     p_payload_size);
+  }
+
+  const auto _size = gsl::narrow_cast<uint32_t>(p_payload_size);
+  for (size_t i = 0; i < HEADER_SIZE; ++i) {
+    const auto _shift = 8 * (HEADER_SIZE - 1 - i);
+    p_header[i] = gsl::narrow_cast<std::byte>((_size >> _shift) & 0xFF);
+  }
+  return HEADER_SIZE;
+}
+
+w_delimiter_frame_codec::w_delimiter_frame_codec(
+    _In_ std::string_view p_delimiter, _In_ size_t p_max_frame_size)
+    : w_frame_codec(p_max_frame_size) {
+  const auto _delimiter = p_delimiter.empty() ? std::string_view("\n")
+                                              : p_delimiter;
+  this->_delimiter.resize(_delimiter.size());
+  std::memcpy(this->_delimiter.data(), _delimiter.data(), _delimiter.size());
+}
+
+auto w_delimiter_frame_codec::decode(
+    _In_ gsl::span<const std::byte> p_data, _In_ size_t p_scanned) const
+    noexcept -> boost::leaf::result<w_frame_decode_result> {
+  const auto _delimiter_size = this->_delimiter.size();
+
+  // resume where the previous search stopped, a delimiter may straddle the
+  // end of the scanned bytes, so back off by its size minus one
+  const auto _scanned = std::min(p_scanned, p_data.size());
+  const auto _start =
+      _scanned >= _delimiter_size ? _scanned - _delimiter_size + 1 : 0;
+  const auto _rest = p_data.subspan(_start);
+
+  size_t _position = p_data.size();
+  if (_delimiter_size == 1) {
+    const auto *_found =
+        std::memchr(_rest.data(), std::to_integer<int>(this->_delimiter[0]),
+                    _rest.size());
+    if (_found != nullptr) {
+      _position = gsl::narrow_cast<size_t>(
+          static_cast<const std::byte *>(_found) - p_data.data());
+    }
+  } else {
+    const auto _found =
+        std::search(_rest.begin(), _rest.end(), this->_delimiter.cbegin(),
+                    this->_delimiter.cend());
+    _position = _start + gsl::narrow_cast<size_t>(_found - _rest.begin());
+  }
+
+  if (_position < p_data.size()) {
+    if (_position > this->_max_frame_size) {
+      return W_FAILURE(std::errc::message_size,
+                       "the frame of {} bytes is bigger than the limit of {} "
+                       "bytes",
+                       _position, this->_max_frame_size);
+    }
+    return w_frame_decode_result{p_data.first(_position),
+                                 _position + _delimiter_size, 0, 0};
+  }
+  if (p_data.size() > this->_max_frame_size + _delimiter_size) {
+    return W_FAILURE(std::errc::message_size,
+                     "no delimiter in {} bytes, the limit is {} bytes",
+                     p_data.size(), this->_max_frame_size);
+  }
+  return w_frame_decode_result{{}, 0, p_data.size() + 1, p_data.size()};
+}
+
+auto w_delimiter_frame_codec::encode_header(
+    _In_ size_t p_payload_size, _Inout_ gsl::span<std::byte> p_header) const
+    noexcept -> boost::leaf::result<size_t> {
+  std::ignore = p_payload_size;
+  std::ignore = p_header;
+  return 0;
+}
+
+w_frame_reader::w_frame_reader(
+    _In_ std::shared_ptr<const w_frame_codec> p_codec,
+    _In_ size_t p_capacity)
+    : _codec(std::move(p_codec)), _ring(p_capacity) {}
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,281 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <wolf.hpp>
+
+namespace wolf::system::socket {
+
+/*
+ * the receive buffer of a framed stream. the read and the write offsets chase
+ * each other like a ring, but instead of wrapping around, the unread bytes
+ * are moved to the front when the tail runs out of space. so a frame is
+ * always contiguous and can be handed out as a span without a copy.
+ */
+class w_ring_buffer {
+ public:
+  /*
+   * @param p_capacity, the initial capacity in bytes
+   */
+  W_API explicit w_ring_buffer(_In_ size_t p_capacity);
+
+  /*
+   * get the free space after the unread bytes. the unread bytes are moved to
+   * the front or the storage grows, if there are less than p_size free bytes
+   * @param p_size, the minimum number of free bytes
+   * @returns the free space
+   */
+  W_API gsl::span<std::byte> prepare(_In_ size_t p_size);
+
+  /*
+   * append the bytes which were written into the space of prepare
+   * @param p_size, the number of written bytes
+   */
+  W_API void commit(_In_ size_t p_size) noexcept;
+
+  /*
+   * drop bytes from the front of the unread bytes
+   * @param p_size, the number of bytes
+   */
+  W_API void consume(_In_ size_t p_size) noexcept;
+
+  // returns the unread bytes
+  gsl::span<const std::byte> data() const noexcept {
+    return gsl::span(this->_storage).subspan(this->_head,
+                                             this->_tail - this->_head);
+  }
+
+  // returns the number of unread bytes
+  size_t size() const noexcept { return this->_tail - this->_head; }
+
+  size_t capacity() const noexcept { return this->_storage.size(); }
+
+ private:
+  std::vector<std::byte> _storage;
+  size_t _head = 0;
+  size_t _tail = 0;
+};
+
+// the front of a stream after decoding
+struct w_frame_decode_result {
+  // the payload of the frame, which points into the decoded bytes
+  gsl::span<const std::byte> payload = {};
+  // the bytes of the whole frame, zero if the frame is not complete yet
+  size_t frame_size = 0;
+  // the number of bytes which are needed before decoding can make progress
+  size_t needed = 0;
+  // the bytes of an incomplete frame which were searched already, so the next
+  // decode can resume from there instead of scanning the front again
+  size_t scanned = 0;
+};
+
+/*
+ * the interface of a framing layer. a codec does not keep any state, so one
+ * instance can be shared by all sessions of a server.
+ */
+class w_frame_codec {
+ public:
+  // the biggest header of all codecs, a varint of 64 bits
+  static constexpr size_t MAX_HEADER_SIZE = 10;
+  static constexpr size_t DEFAULT_MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+  /*
+   * @param p_max_frame_size, the biggest payload which is accepted, so a
+   * broken or a hostile peer can not make the receiver allocate any size
+   */
+  W_API explicit w_frame_codec(_In_ size_t p_max_frame_size) noexcept
+      : _max_frame_size(p_max_frame_size) {}
+
+  // destructor
+  W_API virtual ~w_frame_codec() noexcept = default;
+
+  /*
+   * decode the first frame of the bytes
+   * @param p_data, the unread bytes of a stream
+   * @param p_scanned, the scanned bytes of the previous decode of the same
+   * incomplete frame, or zero
+   * @returns the frame, or the number of needed bytes if it is not complete
+   */
+  W_API virtual auto decode(_In_ gsl::span<const std::byte> p_data,
+                            _In_ size_t p_scanned) const noexcept
+      -> boost::leaf::result<w_frame_decode_result> = 0;
+
+  /*
+   * write the header of a frame
+   * @param p_payload_size, the size of the payload
+   * @param p_header, the destination with at least MAX_HEADER_SIZE bytes
+   * @returns the size of the header
+   */
+  W_API virtual auto encode_header(_In_ size_t p_payload_size,
+                                   _Inout_ gsl::span<std::byte> p_header) const
+      noexcept -> boost::leaf::result<size_t> = 0;
+
+  // returns the bytes which follow the payload of every frame
+  W_API virtual auto get_trailer() const noexcept
+      -> gsl::span<const std::byte> {
+    return {};
+  }
+
+  /*
+   * make a frame in a single buffer, e.g. for w_tcp_session::send
+   * @param p_payload, the payload
+   * @returns the frame
+   */
+  W_API auto encode(_In_ gsl::span<const std::byte> p_payload) const
+      -> boost::leaf::result<w_buffer>;
+
+  size_t get_max_frame_size() const noexcept { return this->_max_frame_size; }
+
+ protected:
+  size_t _max_frame_size;
+};
+
+// a LEB128 varint of the payload size followed by the payload
+class w_varint_frame_codec : public w_frame_codec {
+ public:
+  W_API explicit w_varint_frame_codec(
+      _In_ size_t p_max_frame_size = DEFAULT_MAX_FRAME_SIZE) noexcept
+      : w_frame_codec(p_max_frame_size) {}
+
+  W_API auto decode(_In_ gsl::span<const std::byte> p_data,
+                    _In_ size_t p_scanned) const noexcept
+      -> boost::leaf::result<w_frame_decode_result> override;
+
+  W_API auto encode_header(_In_ size_t p_payload_size,
+                           _Inout_ gsl::span<std::byte> p_header) const
+      noexcept -> boost::leaf::result<size_t> override;
+};
+
+// a 4 bytes big endian payload size followed by the payload
+class w_fixed32_frame_codec : public w_frame_codec {
+ public:
+  static constexpr size_t HEADER_SIZE = 4;
+
+  W_API explicit w_fixed32_frame_codec(
+      _In_ size_t p_max_frame_size = DEFAULT_MAX_FRAME_SIZE) noexcept
+      : w_frame_codec(p_max_frame_size) {}
+
+  W_API auto decode(_In_ gsl::span<const std::byte> p_data,
+                    _In_ size_t p_scanned) const noexcept
+      -> boost::leaf::result<w_frame_decode_result> override;
+
+  W_API auto encode_header(_In_ size_t p_payload_size,
+                           _Inout_ gsl::span<std::byte> p_header) const
+      noexcept -> boost::leaf::result<size_t> override;
+};
+
+/*
+ * a payload followed by a delimiter, e.g. a line of text. the payload must not
+ * contain the delimiter, it is not escaped.
+ */
+class w_delimiter_frame_codec : public w_frame_codec {
+ public:
+  W_API explicit w_delimiter_frame_codec(
+      _In_ std::string_view p_delimiter = "\n",
+      _In_ size_t p_max_frame_size = DEFAULT_MAX_FRAME_SIZE);
+
+  W_API auto decode(_In_ gsl::span<const std::byte> p_data,
+                    _In_ size_t p_scanned) const noexcept
+      -> boost::leaf::result<w_frame_decode_result> override;
+
+  W_API auto encode_header(_In_ size_t p_payload_size,
+                           _Inout_ gsl::span<std::byte> p_header) const
+      noexcept -> boost::leaf::result<size_t> override;
+
+  W_API auto get_trailer() const noexcept
+      -> gsl::span<const std::byte> override {
+    return this->_delimiter;
+  }
+
+ private:
+  std::vector<std::byte> _delimiter;
+};
+
+/*
+ * reassemble the frames of a stream. the bytes of a receive go into a ring
+ * buffer and all complete frames are handed out as spans into it, so a
+ * receive which holds many small frames costs one system call and no copy.
+ */
+class w_frame_reader {
+ public:
+  static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+  /*
+   * @param p_codec, the framing codec
+   * @param p_capacity, the initial capacity of the ring buffer
+   */
+  W_API explicit w_frame_reader(
+      _In_ std::shared_ptr<const w_frame_codec> p_codec,
+      _In_ size_t p_capacity = DEFAULT_CAPACITY);
+
+  /*
+   * get the space for the next receive, which also fits the rest of a pending
+   * frame
+   * @param p_size, the minimum number of free bytes
+   * @returns the free space
+   */
+  W_API gsl::span<std::byte> prepare(_In_ size_t p_size = W_MAX_BUFFER_SIZE) {
+    const auto _pending =
+        this->_needed > this->_ring.size() ? this->_needed - this->_ring.size()
+                                           : 0;
+    return this->_ring.prepare(std::max(p_size, _pending));
+  }
+
+  /*
+   * append the received bytes
+   * @param p_size, the number of received bytes
+   */
+  W_API void commit(_In_ size_t p_size) noexcept { this->_ring.commit(p_size); }
+
+  /*
+   * call p_on_frame for every complete frame. a frame is only valid during
+   * the call, p_on_frame returns false to stop reading
+   * @param p_on_frame, the callback which gets the payload of a frame
+   * @returns the number of frames
+   */
+  template <typename F>
+  auto read_frames(_In_ F &&p_on_frame) -> boost::leaf::result<size_t> {
+    size_t _frames = 0;
+    while (this->_ring.size() >= this->_needed) {
+      BOOST_LEAF_AUTO(_frame,
+                      this->_codec->decode(this->_ring.data(), this->_scanned));
+      if (_frame.frame_size == 0) {
+        this->_needed = _frame.needed;
+        this->_scanned = _frame.scanned;
+        break;
+      }
+      this->_needed = 1;
+      this->_scanned = 0;
+      ++_frames;
+      const auto _continue = p_on_frame(_frame.payload);
+      this->_ring.consume(_frame.frame_size);
+      if (!_continue) {
+        break;
+      }
+    }
+    return _frames;
+  }
+
+  const w_frame_codec &get_codec() const noexcept { return *this->_codec; }
+
+ private:
+  std::shared_ptr<const w_frame_codec> _codec;
+  w_ring_buffer _ring;
+  // the unread bytes which are needed before the next decode
+  size_t _needed = 1;
+  // the bytes of the pending frame which the codec searched already
+  size_t _scanned = 0;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
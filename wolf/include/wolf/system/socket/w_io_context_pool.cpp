@@ -0,0 +1,95 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_io_context_pool.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
+using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+using w_io_context_pool_options =
+    wolf::system::socket::w_io_context_pool_options;
+
+namespace {
+
+// pin the calling thread, it is a hint, so a failure is ignored
+void s_pin_thread(_In_ size_t p_cpu) noexcept {
+  const auto _cpus = std::max(1U, std::thread::hardware_concurrency());
+  const auto _cpu = p_cpu % _cpus;
+#if defined(__linux__)
+  cpu_set_t _set;
+  CPU_ZERO(&_set);
+  CPU_SET(_cpu, &_set);
+  std::ignore = pthread_setaffinity_np(pthread_self(), sizeof(_set), &_set);
+#elif defined(_WIN32)
+  std::ignore = SetThreadAffinityMask(GetCurrentThread(),
+                                      static_cast<DWORD_PTR>(1) << _cpu);
+#else
+  std::ignore = _cpu;
+#endif
+}
+
+}  // namespace
+
+w_io_context_pool::w_io_context_pool(
+    _In_ const w_io_context_pool_options &p_options)
+    : _options(p_options) {
+  auto _size = p_options.size;
+  if (_size == 0) {
+    _size = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  this->_contexts.reserve(_size);
+  for (size_t i = 0; i < _size; ++i) {
+    // tell asio that a single thread runs each io context
+    this->_contexts.push_back(std::make_unique<boost::asio::io_context>(1));
+  }
+}
+
+w_io_context_pool::~w_io_context_pool() noexcept { stop(); }
+
+boost::leaf::result<int> w_io_context_pool::run() noexcept {
+  if (!this->_threads.empty()) {
+    return W_FAILURE(std::errc::operation_in_progress,
+                     "the io context pool is already running");
+  }
+
+  try {
+    this->_guards.reserve(this->_contexts.size());
+    this->_threads.reserve(this->_contexts.size());
+    for (size_t i = 0; i < this->_contexts.size(); ++i) {
+      auto &_context = *this->_contexts[i];
+      _context.restart();
+      this->_guards.push_back(boost::asio::make_work_guard(_context));
+
+      const auto _pin = this->_options.pin_threads;
+      const auto _cpu = this->_options.first_cpu + i;
+      this->_threads.emplace_back([&_context, _pin, _cpu]() {
+        if (_pin) {
+          s_pin_thread(_cpu);
+        }
+        _context.run();
+      });
+    }
+    return 0;
+  } catch (const std::exception &p_ex) {
+    stop();
+    return W_FAILURE(std::errc::resource_unavailable_try_again,
+                     "could not run the io context pool because: " +
+                         std::string(p_ex.what()));
+  }
+}
+
+void w_io_context_pool::stop() noexcept {
+  this->_guards.clear();
+  for (auto &_context : this->_contexts) {
+    _context->stop();
+  }
+  // jthread joins on destruction
+  this->_threads.clear();
+}
+
+#endif  // WOLF_SYSTEM_SOCKET
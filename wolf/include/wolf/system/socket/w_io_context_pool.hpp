@@ -0,0 +1,93 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include <wolf.hpp>
+
+#include "w_socket_options.hpp"
+
+namespace wolf::system::socket {
+
+struct w_io_context_pool_options {
+  // the number of io contexts and threads, zero means hardware concurrency
+  size_t size = 0;
+  // pin the thread of the nth io context to the cpu (first_cpu + n)
+  bool pin_threads = false;
+  size_t first_cpu = 0;
+};
+
+/*
+ * a pool of io contexts, each one is run by a single thread. a server which
+ * accepts on every io context keeps each session on the thread that accepted
+ * it, so sessions never contend on a shared io context.
+ */
+class w_io_context_pool {
+ public:
+  /*
+   * create the io contexts, the threads are started by run
+   * @param p_options, the size and the affinity of the pool
+   */
+  W_API explicit w_io_context_pool(
+      _In_ const w_io_context_pool_options &p_options = {});
+
+  // stop and join the threads
+  W_API virtual ~w_io_context_pool() noexcept;
+
+  /*
+   * start a thread per io context, the io contexts keep running without work
+   * until stop is called
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> run() noexcept;
+
+  // stop all io contexts and join their threads
+  W_API void stop() noexcept;
+
+  // returns the number of io contexts
+  W_API size_t size() const noexcept { return this->_contexts.size(); }
+
+  /*
+   * get an io context of the pool
+   * @param p_index, the index of the io context
+   * @returns the io context
+   */
+  W_API boost::asio::io_context &get(_In_ size_t p_index) noexcept {
+    return *this->_contexts[p_index % this->_contexts.size()];
+  }
+
+  // returns the next io context in a round robin order
+  W_API boost::asio::io_context &next() noexcept {
+    return get(this->_next++);
+  }
+
+ private:
+  // copy constructor.
+  w_io_context_pool(const w_io_context_pool &) = delete;
+  // copy assignment operator.
+  w_io_context_pool &operator=(const w_io_context_pool &) = delete;
+  // move constructor.
+  w_io_context_pool(w_io_context_pool &&) = delete;
+  // move assignment operator.
+  w_io_context_pool &operator=(w_io_context_pool &&) = delete;
+
+  using work_guard =
+      boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+  w_io_context_pool_options _options;
+  std::vector<std::unique_ptr<boost::asio::io_context>> _contexts;
+  std::vector<work_guard> _guards;
+  std::vector<std::jthread> _threads;
+  size_t _next = 0;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
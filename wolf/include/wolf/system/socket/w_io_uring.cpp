@@ -0,0 +1,416 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_io_uring.hpp"
+
+#ifdef WOLF_SYSTEM_IO_URING
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+
+using w_io_uring = wolf::system::socket::w_io_uring;
+using w_io_uring_options = wolf::system::socket::w_io_uring_options;
+
+namespace {
+
+// the kernel buffer ring allows up to 32768 entries
+constexpr uint32_t s_max_buffer_count = 32768;
+// the buffer group of the receives
+constexpr uint16_t s_buffer_group = 0;
+
+int s_setup(_In_ uint32_t p_entries, _Inout_ io_uring_params &p_params) {
+  return gsl::narrow_cast<int>(syscall(__NR_io_uring_setup, p_entries,
+                                       &p_params));
+}
+
+int s_enter(_In_ int p_fd, _In_ uint32_t p_to_submit,
+            _In_ uint32_t p_min_complete, _In_ uint32_t p_flags) {
+  return gsl::narrow_cast<int>(syscall(__NR_io_uring_enter, p_fd, p_to_submit,
+                                       p_min_complete, p_flags, nullptr, 0));
+}
+
+// wait for a completion, or until the timeout
+int s_wait(_In_ int p_fd, _In_ std::chrono::nanoseconds p_timeout) {
+  __kernel_timespec _timeout = {};
+  _timeout.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(p_timeout)
+                        .count();
+  _timeout.tv_nsec = (p_timeout % std::chrono::seconds(1)).count();
+  io_uring_getevents_arg _arg = {};
+  _arg.ts = reinterpret_cast<uint64_t>(&_timeout);
+  return gsl::narrow_cast<int>(syscall(
+      __NR_io_uring_enter, p_fd, 0, 1,
+      IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &_arg, sizeof(_arg)));
+}
+
+int s_register(_In_ int p_fd, _In_ uint32_t p_opcode, _In_ const void *p_arg,
+               _In_ uint32_t p_count) {
+  return gsl::narrow_cast<int>(
+      syscall(__NR_io_uring_register, p_fd, p_opcode, p_arg, p_count));
+}
+
+template <class T>
+T *s_at(_In_ void *p_base, _In_ uint32_t p_offset) {
+  return reinterpret_cast<T *>(static_cast<std::byte *>(p_base) + p_offset);
+}
+
+}  // namespace
+
+w_io_uring::w_io_uring(_In_ boost::asio::io_context &p_io_context)
+    : _event(p_io_context) {}
+
+w_io_uring::~w_io_uring() noexcept { _close(); }
+
+boost::leaf::result<int> w_io_uring::open(
+    _In_ const w_io_uring_options &p_options) noexcept {
+  if (this->_fd != -1) {
+    return W_FAILURE(std::errc::operation_in_progress,
+                     "the io_uring was already opened");
+  }
+  if (p_options.buffer_count == 0 ||
+      p_options.buffer_count > s_max_buffer_count ||
+      (p_options.buffer_count & (p_options.buffer_count - 1)) != 0 ||
+      p_options.buffer_size == 0) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the io_uring buffer count must be a power of two up to "
+                     "32768 and the buffer size must not be zero");
+  }
+
+  // the ring stays disabled until the thread of the io context enables it,
+  // because a single issuer ring belongs to the thread which enabled it
+  io_uring_params _params = {};
+  _params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL |
+                  IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_R_DISABLED;
+  _params.cq_entries = p_options.entries * 4;
+  this->_fd = s_setup(p_options.entries, _params);
+  if (this->_fd < 0) {
+    this->_fd = -1;
+    return W_FAILURE(std::errc::not_supported,
+                     "could not create an io_uring, it needs linux 6.0 and "
+                     "must not be disabled, errno: " +
+                         std::to_string(errno));
+  }
+
+  const auto _fail = [this](_In_ const std::string &p_what) {
+    const auto _errno = errno;
+    _close();
+    return W_FAILURE(std::errc::not_supported,
+                     p_what + ", errno: " + std::to_string(_errno));
+  };
+
+  if ((_params.features & IORING_FEAT_SINGLE_MMAP) == 0 ||
+      (_params.features & IORING_FEAT_NODROP) == 0) {
+    return _fail("the io_uring of the kernel is too old");
+  }
+
+  // the submission and the completion rings share one mapping
+  this->_rings_size =
+      std::max<size_t>(_params.sq_off.array + _params.sq_entries * 4,
+                       _params.cq_off.cqes +
+                           _params.cq_entries * sizeof(io_uring_cqe));
+  this->_rings = mmap(nullptr, this->_rings_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, this->_fd, IORING_OFF_SQ_RING);
+  if (this->_rings == MAP_FAILED) {
+    this->_rings = nullptr;
+    return _fail("could not map the io_uring queues");
+  }
+  this->_sqes_size = _params.sq_entries * sizeof(io_uring_sqe);
+  auto *_sqes = mmap(nullptr, this->_sqes_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, this->_fd, IORING_OFF_SQES);
+  if (_sqes == MAP_FAILED) {
+    return _fail("could not map the io_uring submissions");
+  }
+  this->_sqes = static_cast<io_uring_sqe *>(_sqes);
+
+  using atomic_u32 = std::atomic<uint32_t>;
+  this->_sq_head = s_at<atomic_u32>(this->_rings, _params.sq_off.head);
+  this->_sq_tail = s_at<atomic_u32>(this->_rings, _params.sq_off.tail);
+  this->_sq_flags = s_at<atomic_u32>(this->_rings, _params.sq_off.flags);
+  this->_sq_array = s_at<uint32_t>(this->_rings, _params.sq_off.array);
+  this->_sq_mask = *s_at<uint32_t>(this->_rings, _params.sq_off.ring_mask);
+  this->_sq_entries = _params.sq_entries;
+  this->_sq_local_tail = this->_sq_tail->load(std::memory_order_relaxed);
+  this->_sq_submitted = this->_sq_local_tail;
+
+  this->_cq_head = s_at<atomic_u32>(this->_rings, _params.cq_off.head);
+  this->_cq_tail = s_at<atomic_u32>(this->_rings, _params.cq_off.tail);
+  this->_cqes = s_at<io_uring_cqe>(this->_rings, _params.cq_off.cqes);
+  this->_cq_mask = *s_at<uint32_t>(this->_rings, _params.cq_off.ring_mask);
+
+  // the buffer pool, which the kernel fills without a copy per receive
+  this->_buffer_ring_size = p_options.buffer_count * sizeof(io_uring_buf);
+  this->_buffer_ring =
+      mmap(nullptr, this->_buffer_ring_size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (this->_buffer_ring == MAP_FAILED) {
+    this->_buffer_ring = nullptr;
+    return _fail("could not map the io_uring buffer ring");
+  }
+  this->_buffer_ring_tail = s_at<std::atomic<uint16_t>>(
+      this->_buffer_ring, offsetof(io_uring_buf_ring, tail));
+  this->_buffer_mask = gsl::narrow_cast<uint16_t>(p_options.buffer_count - 1);
+  this->_buffer_size = p_options.buffer_size;
+  try {
+    this->_buffers = std::make_unique_for_overwrite<std::byte[]>(
+        size_t{p_options.buffer_count} * p_options.buffer_size);
+  } catch (const std::exception &p_ex) {
+    _close();
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not allocate the io_uring buffers: " +
+                         std::string(p_ex.what()));
+  }
+
+  io_uring_buf_reg _reg = {};
+  _reg.ring_addr = reinterpret_cast<uint64_t>(this->_buffer_ring);
+  _reg.ring_entries = p_options.buffer_count;
+  _reg.bgid = s_buffer_group;
+  if (s_register(this->_fd, IORING_REGISTER_PBUF_RING, &_reg, 1) < 0) {
+    return _fail("could not register the io_uring buffer ring");
+  }
+
+  auto *_bufs = static_cast<io_uring_buf *>(this->_buffer_ring);
+  for (uint32_t i = 0; i < p_options.buffer_count; ++i) {
+    _bufs[i].addr = reinterpret_cast<uint64_t>(this->_buffers.get() +
+                                               i * this->_buffer_size);
+    _bufs[i].len = this->_buffer_size;
+    _bufs[i].bid = gsl::narrow_cast<uint16_t>(i);
+  }
+  this->_buffer_ring_tail->store(
+      gsl::narrow_cast<uint16_t>(p_options.buffer_count),
+      std::memory_order_release);
+
+  // the completions wake up the io context
+  const auto _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (_event_fd < 0) {
+    return _fail("could not create the eventfd of the io_uring");
+  }
+  boost::system::error_code _error;
+  std::ignore = this->_event.assign(_event_fd, _error);
+  if (_error) {
+    ::close(_event_fd);
+    errno = _error.value();
+    return _fail("could not assign the eventfd of the io_uring");
+  }
+  if (s_register(this->_fd, IORING_REGISTER_EVENTFD, &_event_fd, 1) < 0) {
+    return _fail("could not register the eventfd of the io_uring");
+  }
+  return 0;
+}
+
+boost::leaf::result<int> w_io_uring::enable() noexcept {
+  if (s_register(this->_fd, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) < 0) {
+    return W_FAILURE(std::errc::not_supported,
+                     "could not enable the io_uring, errno: " +
+                         std::to_string(errno));
+  }
+  this->_owner = std::this_thread::get_id();
+  return 0;
+}
+
+bool w_io_uring::accept_multishot(_In_ int p_fd,
+                                  _In_ uint64_t p_user_data) noexcept {
+  auto *_sqe = _get_sqe();
+  if (_sqe == nullptr) {
+    return false;
+  }
+  _sqe->opcode = IORING_OP_ACCEPT;
+  _sqe->fd = p_fd;
+  _sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  _sqe->accept_flags = SOCK_CLOEXEC;
+  _sqe->user_data = p_user_data;
+  return true;
+}
+
+bool w_io_uring::receive_multishot(_In_ int p_fd,
+                                   _In_ uint64_t p_user_data) noexcept {
+  auto *_sqe = _get_sqe();
+  if (_sqe == nullptr) {
+    return false;
+  }
+  _sqe->opcode = IORING_OP_RECV;
+  _sqe->fd = p_fd;
+  _sqe->ioprio = IORING_RECV_MULTISHOT;
+  _sqe->flags = IOSQE_BUFFER_SELECT;
+  _sqe->buf_group = s_buffer_group;
+  _sqe->user_data = p_user_data;
+  return true;
+}
+
+bool w_io_uring::send_message(_In_ int p_fd, _In_ const msghdr *p_message,
+                              _In_ uint64_t p_user_data) noexcept {
+  auto *_sqe = _get_sqe();
+  if (_sqe == nullptr) {
+    return false;
+  }
+  _sqe->opcode = IORING_OP_SENDMSG;
+  _sqe->fd = p_fd;
+  _sqe->addr = reinterpret_cast<uint64_t>(p_message);
+  _sqe->len = 1;
+  _sqe->msg_flags = MSG_NOSIGNAL;
+  _sqe->user_data = p_user_data;
+  return true;
+}
+
+bool w_io_uring::cancel(_In_ uint64_t p_target,
+                        _In_ uint64_t p_user_data) noexcept {
+  auto *_sqe = _get_sqe();
+  if (_sqe == nullptr) {
+    return false;
+  }
+  _sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  _sqe->fd = -1;
+  _sqe->addr = p_target;
+  _sqe->user_data = p_user_data;
+  return true;
+}
+
+int w_io_uring::submit() noexcept {
+  const auto _count = this->_sq_local_tail - this->_sq_submitted;
+  if (_count == 0) {
+    return 0;
+  }
+  this->_sq_tail->store(this->_sq_local_tail, std::memory_order_release);
+  const auto _res = s_enter(this->_fd, _count, 0, 0);
+  if (_res < 0) {
+    return -errno;
+  }
+  this->_sq_submitted += gsl::narrow_cast<uint32_t>(_res);
+  this->_in_flight += gsl::narrow_cast<size_t>(_res);
+  return 0;
+}
+
+bool w_io_uring::cancel_all(_In_ std::chrono::milliseconds p_timeout) noexcept {
+  if (this->_fd == -1 || this->_in_flight == 0) {
+    return true;
+  }
+
+  // one cancel matches every request of the ring. the kernel refuses it
+  // with EEXIST on a thread which does not own the ring, then the requests
+  // only end when their sockets are shut down
+  auto *_sqe = is_owner() ? _get_sqe() : nullptr;
+  if (_sqe != nullptr) {
+    _sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    _sqe->fd = -1;
+    _sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+    _sqe->user_data = CANCEL_USER_DATA;
+    std::ignore = submit();
+  }
+
+  const auto _deadline = std::chrono::steady_clock::now() + p_timeout;
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (this->_in_flight != 0) {
+    if (reap([](_In_ const completion &) {}) != 0) {
+      continue;
+    }
+    const auto _left = _deadline - std::chrono::steady_clock::now();
+    if (_left <= std::chrono::steady_clock::duration::zero()) {
+      break;
+    }
+    if (s_wait(this->_fd, _left) < 0 && errno != ETIME && errno != EINTR) {
+      break;
+    }
+  }
+  return this->_in_flight == 0;
+}
+
+boost::asio::awaitable<void> w_io_uring::async_wait() {
+  std::ignore = submit();
+  if (has_completions()) {
+    co_return;
+  }
+  // a read is tried before asio waits for the eventfd, so a completion which
+  // arrived before the wait is not missed
+  uint64_t _count = 0;
+  co_await this->_event.async_read_some(
+      boost::asio::buffer(&_count, sizeof(_count)), boost::asio::use_awaitable);
+}
+
+gsl::span<const std::byte> w_io_uring::get_buffer(
+    _In_ const completion &p_completion) const noexcept {
+  const auto _id = p_completion.flags >> IORING_CQE_BUFFER_SHIFT;
+  return gsl::span(this->_buffers.get() + size_t{_id} * this->_buffer_size,
+                   gsl::narrow_cast<size_t>(std::max(p_completion.result, 0)));
+}
+
+void w_io_uring::recycle_buffer(_In_ const completion &p_completion) noexcept {
+  const auto _id =
+      gsl::narrow_cast<uint16_t>(p_completion.flags >> IORING_CQE_BUFFER_SHIFT);
+  const auto _tail = this->_buffer_ring_tail->load(std::memory_order_relaxed);
+
+  auto *_bufs = static_cast<io_uring_buf *>(this->_buffer_ring);
+  auto &_buf = _bufs[_tail & this->_buffer_mask];
+  _buf.addr = reinterpret_cast<uint64_t>(this->_buffers.get() +
+                                         size_t{_id} * this->_buffer_size);
+  _buf.len = this->_buffer_size;
+  _buf.bid = _id;
+  this->_buffer_ring_tail->store(gsl::narrow_cast<uint16_t>(_tail + 1),
+                                 std::memory_order_release);
+}
+
+io_uring_sqe *w_io_uring::_get_sqe() noexcept {
+  const auto _is_full = [this]() {
+    return this->_sq_local_tail -
+               this->_sq_head->load(std::memory_order_acquire) >=
+           this->_sq_entries;
+  };
+  // pass a full queue to the kernel first
+  if (_is_full() && (submit() != 0 || _is_full())) {
+    return nullptr;
+  }
+  const auto _index = this->_sq_local_tail & this->_sq_mask;
+  auto *_sqe = &this->_sqes[_index];
+  *_sqe = {};
+  this->_sq_array[_index] = _index;
+  ++this->_sq_local_tail;
+  return _sqe;
+}
+
+bool w_io_uring::_flush_overflow() noexcept {
+  if ((this->_sq_flags->load(std::memory_order_relaxed) &
+       IORING_SQ_CQ_OVERFLOW) == 0) {
+    return false;
+  }
+  std::ignore = s_enter(this->_fd, 0, 0, IORING_ENTER_GETEVENTS);
+  return has_completions();
+}
+
+void w_io_uring::_close() noexcept {
+  // the kernel drops the requests of a closed ring later, and a receive may
+  // still write into a provided buffer until then. so the requests must end
+  // before the buffers are freed, otherwise they are leaked
+  const auto _drained = cancel_all();
+
+  boost::system::error_code _ignore;
+  std::ignore = this->_event.close(_ignore);
+  if (this->_sqes != nullptr) {
+    munmap(this->_sqes, this->_sqes_size);
+    this->_sqes = nullptr;
+  }
+  if (this->_rings != nullptr) {
+    munmap(this->_rings, this->_rings_size);
+    this->_rings = nullptr;
+  }
+  if (this->_fd != -1) {
+    ::close(this->_fd);
+    this->_fd = -1;
+  }
+  if (!_drained) {
+    this->_buffer_ring = nullptr;
+    std::ignore = this->_buffers.release();
+    return;
+  }
+  if (this->_buffer_ring != nullptr) {
+    munmap(this->_buffer_ring, this->_buffer_ring_size);
+    this->_buffer_ring = nullptr;
+  }
+  this->_buffers.reset();
+}
+
+#endif  // WOLF_SYSTEM_IO_URING
+
+#endif  // WOLF_SYSTEM_SOCKET
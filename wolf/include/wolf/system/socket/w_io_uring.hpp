@@ -0,0 +1,263 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <wolf.hpp>
+
+#include "w_socket_options.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+// multishot receive and a single issuer ring need linux 6.0 headers
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_SETUP_SINGLE_ISSUER)
+#define WOLF_SYSTEM_IO_URING
+#endif
+#endif
+
+#ifdef WOLF_SYSTEM_IO_URING
+
+namespace wolf::system::socket {
+
+/*
+ * an io_uring instance which is driven by an asio io context. the completions
+ * wake up the io context through an eventfd, so timers and the other sockets
+ * of the io context keep working, and a wake up reaps every completion which
+ * arrived since the last one. the receives pick their buffers from a pool
+ * which is registered with the kernel as a provided buffer ring. a ring is
+ * only used by the thread which enabled it.
+ */
+class w_io_uring {
+ public:
+  // the user data of the cancel of cancel_all, which the other requests must
+  // not use. its completion is not passed to the handler of reap
+  static constexpr uint64_t CANCEL_USER_DATA =
+      std::numeric_limits<uint64_t>::max();
+
+  // a completion of the ring
+  struct completion {
+    uint64_t user_data;
+    int32_t result;
+    uint32_t flags;
+  };
+
+  /*
+   * @param p_io_context, the io context which waits for the completions
+   */
+  W_API explicit w_io_uring(_In_ boost::asio::io_context &p_io_context);
+
+  // destructor
+  W_API virtual ~w_io_uring() noexcept;
+
+  /*
+   * create the ring and register its buffers and its eventfd. the ring stays
+   * disabled until enable is called
+   * @param p_options, the sizes of the ring and of its buffers
+   * @returns zero on success, not_supported if the kernel is older than 6.0
+   * or io_uring is not allowed
+   */
+  W_API boost::leaf::result<int> open(
+      _In_ const w_io_uring_options &p_options) noexcept;
+
+  /*
+   * enable the ring, the calling thread becomes the only one which submits
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> enable() noexcept;
+
+  /*
+   * accept connections until the accept is canceled or fails
+   * @param p_fd, the listening socket
+   * @param p_user_data, the user data of the completions
+   * @returns false if the submission queue is full
+   */
+  W_API bool accept_multishot(_In_ int p_fd,
+                              _In_ uint64_t p_user_data) noexcept;
+
+  /*
+   * receive into the provided buffers until the receive is canceled, fails
+   * or the peer closes. a completion without IORING_CQE_F_MORE ends it
+   * @param p_fd, the connected socket
+   * @param p_user_data, the user data of the completions
+   * @returns false if the submission queue is full
+   */
+  W_API bool receive_multishot(_In_ int p_fd,
+                               _In_ uint64_t p_user_data) noexcept;
+
+  /*
+   * send a gathered message, the message and its buffers must live until the
+   * completion
+   * @param p_fd, the connected socket
+   * @param p_message, the message
+   * @param p_user_data, the user data of the completion
+   * @returns false if the submission queue is full
+   */
+  W_API bool send_message(_In_ int p_fd, _In_ const msghdr *p_message,
+                          _In_ uint64_t p_user_data) noexcept;
+
+  /*
+   * cancel the requests of a user data
+   * @param p_target, the user data of the requests
+   * @param p_user_data, the user data of the completion of the cancel
+   * @returns false if the submission queue is full
+   */
+  W_API bool cancel(_In_ uint64_t p_target, _In_ uint64_t p_user_data) noexcept;
+
+  /*
+   * cancel every request in flight and wait for their completions, which are
+   * dropped. closing the ring does not stop its requests right away, so the
+   * memory of the requests, e.g. the messages of send_message, may only be
+   * freed once it returns true. the cancel is only submitted on the thread
+   * which enabled the ring, because the kernel refuses it on any other one,
+   * where it just waits, so the sockets of the requests should be shut down
+   * first
+   * @param p_timeout, the longest wait
+   * @returns true if no request is in flight anymore
+   */
+  W_API bool cancel_all(_In_ std::chrono::milliseconds p_timeout =
+                            std::chrono::seconds(1)) noexcept;
+
+  /*
+   * pass the queued requests to the kernel with one system call
+   * @returns zero on success, otherwise a negative errno
+   */
+  W_API int submit() noexcept;
+
+  /*
+   * wait until there are completions, it submits the queued requests first
+   * @returns a coroutine
+   */
+  W_API boost::asio::awaitable<void> async_wait();
+
+  /*
+   * call a handler for every completion which is ready
+   * @param p_handler, a handler which gets a completion
+   * @returns the number of completions
+   */
+  template <class F>
+  size_t reap(_In_ F &&p_handler) {
+    size_t _count = 0;
+#ifdef __clang__
+#pragma unroll
+#endif
+    for (;;) {
+      auto _head = this->_cq_head->load(std::memory_order_relaxed);
+      const auto _tail = this->_cq_tail->load(std::memory_order_acquire);
+      if (_head == _tail) {
+        // the kernel keeps the completions which did not fit the queue
+        if (!_flush_overflow()) {
+          break;
+        }
+        continue;
+      }
+      for (; _head != _tail; ++_head, ++_count) {
+        const auto &_cqe = this->_cqes[_head & this->_cq_mask];
+        const auto _completion =
+            completion{_cqe.user_data, _cqe.res, _cqe.flags};
+        // free the entry before the handler queues new requests
+        this->_cq_head->store(_head + 1, std::memory_order_release);
+        if ((_completion.flags & IORING_CQE_F_MORE) == 0) {
+          // the last completion of a request
+          --this->_in_flight;
+        }
+        if (_completion.user_data == CANCEL_USER_DATA) {
+          continue;
+        }
+        p_handler(_completion);
+      }
+    }
+    return _count;
+  }
+
+  // returns true if the calling thread enabled the ring, only this thread
+  // may submit requests
+  W_API bool is_owner() const noexcept {
+    return this->_owner == std::this_thread::get_id();
+  }
+
+  // returns true if there are completions which were not reaped
+  W_API bool has_completions() const noexcept {
+    return this->_cq_head->load(std::memory_order_relaxed) !=
+           this->_cq_tail->load(std::memory_order_acquire);
+  }
+
+  /*
+   * returns the received bytes of a completion
+   * @param p_completion, a completion with IORING_CQE_F_BUFFER
+   * @returns the bytes, which are valid until recycle_buffer
+   */
+  W_API gsl::span<const std::byte> get_buffer(
+      _In_ const completion &p_completion) const noexcept;
+
+  /*
+   * give the buffer of a completion back to the kernel
+   * @param p_completion, a completion with IORING_CQE_F_BUFFER
+   */
+  W_API void recycle_buffer(_In_ const completion &p_completion) noexcept;
+
+ private:
+  // copy constructor.
+  w_io_uring(const w_io_uring &) = delete;
+  // copy assignment operator.
+  w_io_uring &operator=(const w_io_uring &) = delete;
+  // move constructor.
+  w_io_uring(w_io_uring &&) = delete;
+  // move assignment operator.
+  w_io_uring &operator=(w_io_uring &&) = delete;
+
+  io_uring_sqe *_get_sqe() noexcept;
+  bool _flush_overflow() noexcept;
+  void _close() noexcept;
+
+  boost::asio::posix::stream_descriptor _event;
+  int _fd = -1;
+  // the thread which enabled the ring
+  std::thread::id _owner;
+
+  // the mapped queues
+  void *_rings = nullptr;
+  size_t _rings_size = 0;
+  io_uring_sqe *_sqes = nullptr;
+  size_t _sqes_size = 0;
+
+  std::atomic<uint32_t> *_sq_tail = nullptr;
+  const std::atomic<uint32_t> *_sq_head = nullptr;
+  const std::atomic<uint32_t> *_sq_flags = nullptr;
+  uint32_t *_sq_array = nullptr;
+  uint32_t _sq_mask = 0;
+  uint32_t _sq_entries = 0;
+  // the tail which is not visible to the kernel yet
+  uint32_t _sq_local_tail = 0;
+  uint32_t _sq_submitted = 0;
+  // the submitted requests whose last completion was not reaped yet
+  size_t _in_flight = 0;
+
+  std::atomic<uint32_t> *_cq_head = nullptr;
+  const std::atomic<uint32_t> *_cq_tail = nullptr;
+  const io_uring_cqe *_cqes = nullptr;
+  uint32_t _cq_mask = 0;
+
+  // the provided buffer ring and the pool of its buffers
+  void *_buffer_ring = nullptr;
+  size_t _buffer_ring_size = 0;
+  std::atomic<uint16_t> *_buffer_ring_tail = nullptr;
+  uint16_t _buffer_mask = 0;
+  uint32_t _buffer_size = 0;
+  std::unique_ptr<std::byte[]> _buffers;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_IO_URING
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,121 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <algorithm>
+#include <chrono>
+#include <wolf.hpp>
+
+namespace wolf::system::socket {
+
+/*
+ * the limits of the reader of a session, so one fast or abusive peer can not
+ * starve the other sessions of its io context or grow its write queue without
+ * a bound.
+ */
+struct w_session_limits {
+  // the received bytes and messages per second, zero turns a limit off. a
+  // burst of zero allows the traffic of one second at once
+  uint64_t read_bytes_per_second = 0;
+  uint64_t read_burst_bytes = 0;
+  uint64_t read_messages_per_second = 0;
+  uint64_t read_burst_messages = 0;
+  // the reader pauses once the queued bytes reach the high watermark and
+  // resumes when the writer drained them to the low watermark, a high
+  // watermark of zero only pauses on the number of queued buffers
+  size_t write_high_watermark = 8 * 1024 * 1024;
+  size_t write_low_watermark = 2 * 1024 * 1024;
+};
+
+/*
+ * a token bucket which may be overdrawn. the reader only knows the size of a
+ * receive after it was done, so it takes the tokens afterwards and waits
+ * until the debt is paid back.
+ */
+class w_token_bucket {
+ public:
+  w_token_bucket() noexcept = default;
+
+  /*
+   * @param p_rate, the tokens per second, zero turns the bucket off
+   * @param p_burst, the capacity of the bucket, zero uses the rate
+   */
+  w_token_bucket(_In_ uint64_t p_rate, _In_ uint64_t p_burst) noexcept
+      : _rate(gsl::narrow_cast<double>(p_rate)),
+        _burst(gsl::narrow_cast<double>(p_burst == 0 ? p_rate : p_burst)),
+        _tokens(_burst) {}
+
+  bool is_enabled() const noexcept { return this->_rate > 0.0; }
+
+  /*
+   * take tokens from the bucket
+   * @param p_tokens, the number of tokens
+   * @param p_now, the current time
+   * @returns how long to wait until the bucket is not overdrawn anymore
+   */
+  std::chrono::steady_clock::duration take(
+      _In_ uint64_t p_tokens,
+      _In_ std::chrono::steady_clock::time_point p_now) noexcept {
+    if (!is_enabled()) {
+      return std::chrono::steady_clock::duration::zero();
+    }
+
+    if (this->_last != std::chrono::steady_clock::time_point{}) {
+      const auto _elapsed =
+          std::chrono::duration<double>(p_now - this->_last).count();
+      this->_tokens =
+          std::min(this->_burst, this->_tokens + _elapsed * this->_rate);
+    }
+    this->_last = p_now;
+    this->_tokens -= gsl::narrow_cast<double>(p_tokens);
+    if (this->_tokens >= 0.0) {
+      return std::chrono::steady_clock::duration::zero();
+    }
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(-this->_tokens / this->_rate));
+  }
+
+ private:
+  double _rate = 0.0;
+  double _burst = 0.0;
+  double _tokens = 0.0;
+  std::chrono::steady_clock::time_point _last = {};
+};
+
+// the byte and the message buckets of the reader of a session
+class w_read_limiter {
+ public:
+  explicit w_read_limiter(_In_ const w_session_limits &p_limits) noexcept
+      : _bytes(p_limits.read_bytes_per_second, p_limits.read_burst_bytes),
+        _messages(p_limits.read_messages_per_second,
+                  p_limits.read_burst_messages) {}
+
+  /*
+   * take the tokens of a receive
+   * @param p_bytes, the received bytes
+   * @param p_messages, the received messages
+   * @returns how long the reader should wait before the next receive
+   */
+  std::chrono::steady_clock::duration take(_In_ uint64_t p_bytes,
+                                           _In_ uint64_t p_messages) noexcept {
+    if (!this->_bytes.is_enabled() && !this->_messages.is_enabled()) {
+      return std::chrono::steady_clock::duration::zero();
+    }
+    const auto _now = std::chrono::steady_clock::now();
+    return std::max(this->_bytes.take(p_bytes, _now),
+                    this->_messages.take(p_messages, _now));
+  }
+
+ private:
+  w_token_bucket _bytes;
+  w_token_bucket _messages;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,147 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_socket_metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// NOLINTBEGIN
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : ALL_CODE_ANALYSIS_WARNINGS)
+#endif
+
+#include <boost/asio/error.hpp>
+#ifdef WOLF_SYSTEM_SSL
+#include <boost/asio/ssl/error.hpp>
+#endif
+#ifdef WOLF_SYSTEM_HTTP_WS
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/websocket/error.hpp>
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+// NOLINTEND
+
+using w_error_category = wolf::system::socket::w_error_category;
+using w_latency_histogram = wolf::system::socket::w_latency_histogram;
+using w_server_metrics = wolf::system::socket::w_server_metrics;
+
+w_error_category wolf::system::socket::get_error_category(
+    _In_ const boost::system::error_code &p_code) noexcept {
+  // categories compare by their ids, so a copy of a category in another
+  // shared library matches as well
+  const auto &_category = p_code.category();
+  if (_category == boost::system::system_category() ||
+      _category == boost::system::generic_category()) {
+    return w_error_category::system;
+  }
+  if (_category == boost::asio::error::get_misc_category()) {
+    return w_error_category::asio_misc;
+  }
+  if (_category == boost::asio::error::get_netdb_category() ||
+      _category == boost::asio::error::get_addrinfo_category()) {
+    return w_error_category::asio_resolve;
+  }
+#ifdef WOLF_SYSTEM_SSL
+  if (_category == boost::asio::error::get_ssl_category() ||
+      _category == boost::asio::ssl::error::get_stream_category()) {
+    return w_error_category::ssl;
+  }
+#endif
+#ifdef WOLF_SYSTEM_HTTP_WS
+  if (_category == boost::beast::websocket::make_error_code(
+                       boost::beast::websocket::error::closed)
+                       .category()) {
+    return w_error_category::websocket;
+  }
+  if (_category == boost::beast::http::make_error_code(
+                       boost::beast::http::error::end_of_stream)
+                       .category()) {
+    return w_error_category::http;
+  }
+#endif
+  return w_error_category::other;
+}
+
+uint64_t w_latency_histogram::get_count() const noexcept {
+  uint64_t _count = 0;
+  for (const auto &_bucket : this->_buckets) {
+    _count += _bucket.load(std::memory_order_relaxed);
+  }
+  return _count;
+}
+
+uint64_t w_latency_histogram::get_value_at_percentile(
+    _In_ double p_percentile) const noexcept {
+  std::array<uint64_t, BUCKETS> _counts = {};
+  uint64_t _total = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    _counts[i] = get_bucket(i);
+    _total += _counts[i];
+  }
+  if (_total == 0) {
+    return 0;
+  }
+
+  // the rank of the percentile, at least the first value
+  const auto _percentile = std::clamp(p_percentile, 0.0, 100.0);
+  const auto _rank = std::max<uint64_t>(
+      1, gsl::narrow_cast<uint64_t>(std::ceil(
+             _percentile / 100.0 * gsl::narrow_cast<double>(_total))));
+  uint64_t _seen = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    _seen += _counts[i];
+    if (_seen >= _rank) {
+      return (uint64_t{1} << i) - 1;
+    }
+  }
+  return (uint64_t{1} << (BUCKETS - 1)) - 1;
+}
+
+w_server_metrics::shard &w_server_metrics::local() noexcept {
+  // the threads take the shards in turn, so the threads of a pool, which are
+  // made one after another, get a shard each
+  static std::atomic<size_t> s_next_shard = 0;
+  thread_local const auto s_shard =
+      s_next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+  return this->_shards[s_shard];
+}
+
+w_server_metrics::snapshot w_server_metrics::get_snapshot() const noexcept {
+  constexpr auto _relaxed = std::memory_order_relaxed;
+
+  snapshot _snapshot = {};
+  _snapshot.time = std::chrono::steady_clock::now();
+  for (const auto &_shard : this->_shards) {
+    _snapshot.accepted += _shard.accepted.load(_relaxed);
+    _snapshot.active_sessions += _shard.active_sessions.load(_relaxed);
+    _snapshot.bytes_read += _shard.bytes_read.load(_relaxed);
+    _snapshot.messages_read += _shard.messages_read.load(_relaxed);
+    _snapshot.bytes_written += _shard.bytes_written.load(_relaxed);
+    _snapshot.messages_written += _shard.messages_written.load(_relaxed);
+    _snapshot.sends_dropped += _shard.sends_dropped.load(_relaxed);
+    _snapshot.queued_buffers += _shard.queued_buffers.load(_relaxed);
+    for (size_t i = 0; i < _snapshot.errors.size(); ++i) {
+      _snapshot.errors[i] +=
+          _shard.errors.get(static_cast<w_error_category>(i));
+    }
+    _snapshot.callback_latency.merge(_shard.callback_latency);
+  }
+  return _snapshot;
+}
+
+double w_server_metrics::get_accept_rate(
+    _In_ const snapshot &p_earlier, _In_ const snapshot &p_later) noexcept {
+  const auto _seconds =
+      std::chrono::duration<double>(p_later.time - p_earlier.time).count();
+  if (_seconds <= 0.0) {
+    return 0.0;
+  }
+  return gsl::narrow_cast<double>(p_later.accepted - p_earlier.accepted) /
+         _seconds;
+}
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,245 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <wolf.hpp>
+
+// NOLINTBEGIN
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : ALL_CODE_ANALYSIS_WARNINGS)
+#endif
+
+#include <boost/system/error_code.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+// NOLINTEND
+
+namespace wolf::system::socket {
+
+// the boost::system error categories which the metrics count apart
+enum class w_error_category : size_t {
+  // the system and the generic categories, e.g. a reset or a timeout
+  system = 0,
+  // asio.misc, e.g. eof
+  asio_misc,
+  // asio.netdb and asio.addrinfo, the errors of a resolve
+  asio_resolve,
+  // asio.ssl and asio.ssl.stream
+  ssl,
+  // boost.beast.websocket
+  websocket,
+  // boost.beast.http
+  http,
+  other,
+  count
+};
+
+/*
+ * get the category of an error code
+ * @param p_code, the error code
+ * @returns the category which counts it
+ */
+W_API w_error_category get_error_category(
+    _In_ const boost::system::error_code &p_code) noexcept;
+
+// the errors by their category, which can be counted and read from any thread
+class w_error_counters {
+ public:
+  void record(_In_ const boost::system::error_code &p_code) noexcept {
+    this->_counts[static_cast<size_t>(get_error_category(p_code))].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  uint64_t get(_In_ w_error_category p_category) const noexcept {
+    return this->_counts[static_cast<size_t>(p_category)].load(
+        std::memory_order_relaxed);
+  }
+
+  uint64_t get_total() const noexcept {
+    uint64_t _total = 0;
+    for (const auto &_count : this->_counts) {
+      _total += _count.load(std::memory_order_relaxed);
+    }
+    return _total;
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>,
+             static_cast<size_t>(w_error_category::count)>
+      _counts = {};
+};
+
+/*
+ * a latency histogram with a bucket per power of two nanoseconds. a record
+ * is one relaxed add, so it can be recorded by the sessions and read from
+ * any thread. it is coarser than w_histogram, whose buckets are not atomic,
+ * a percentile is within a factor of two.
+ */
+class w_latency_histogram {
+ public:
+  // the last bucket counts everything from about nine minutes on
+  static constexpr size_t BUCKETS = 40;
+
+  w_latency_histogram() noexcept = default;
+
+  // copy constructor, which copies the counts of the moment
+  w_latency_histogram(const w_latency_histogram &p_other) noexcept {
+    merge(p_other);
+  }
+
+  // copy assignment operator, which copies the counts of the moment
+  w_latency_histogram &operator=(const w_latency_histogram &p_other) noexcept {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      this->_buckets[i].store(p_other.get_bucket(i),
+                              std::memory_order_relaxed);
+    }
+    return *this;
+  }
+
+  void record(_In_ std::chrono::steady_clock::duration p_latency) noexcept {
+    const auto _ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         p_latency)
+                         .count();
+    const auto _bucket = std::min<size_t>(
+        std::bit_width(gsl::narrow_cast<uint64_t>(std::max<int64_t>(_ns, 0))),
+        BUCKETS - 1);
+    this->_buckets[_bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /*
+   * add the counts of another histogram
+   * @param p_other, the other histogram
+   */
+  void merge(_In_ const w_latency_histogram &p_other) noexcept {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      const auto _count = p_other.get_bucket(i);
+      if (_count != 0) {
+        this->_buckets[i].fetch_add(_count, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // returns the count of a bucket, which holds the latencies below 2^index
+  // nanoseconds and from 2^(index - 1) nanoseconds on
+  uint64_t get_bucket(_In_ size_t p_index) const noexcept {
+    return this->_buckets[p_index].load(std::memory_order_relaxed);
+  }
+
+  // returns the number of the recorded latencies
+  W_API uint64_t get_count() const noexcept;
+
+  /*
+   * get the latency which is bigger than or equal to a percent of the
+   * latencies
+   * @param p_percentile, the percentile from 0 to 100, e.g. 99.9
+   * @returns the upper bound of the bucket of the percentile in nanoseconds,
+   * or zero if the histogram is empty
+   */
+  W_API uint64_t get_value_at_percentile(
+      _In_ double p_percentile) const noexcept;
+
+ private:
+  std::array<std::atomic<uint64_t>, BUCKETS> _buckets = {};
+};
+
+/*
+ * the counters of a session. they are updated by the coroutines of the
+ * session and can be read from any thread.
+ */
+struct w_session_metrics {
+  std::atomic<uint64_t> bytes_read = 0;
+  std::atomic<uint64_t> messages_read = 0;
+  std::atomic<uint64_t> bytes_written = 0;
+  std::atomic<uint64_t> messages_written = 0;
+  // the sends which were refused, because the write queue was full
+  std::atomic<uint64_t> sends_dropped = 0;
+  // how often the reader paused for the writer to drain the queue
+  std::atomic<uint64_t> read_pauses = 0;
+  // how often and how long the reader waited for the rate limits
+  std::atomic<uint64_t> read_throttles = 0;
+  std::atomic<uint64_t> read_throttled_ns = 0;
+  // the buffers in the write queue and the most it ever held, a consumer
+  // which does not keep up holds its queue near the peak
+  std::atomic<uint64_t> write_queue_depth = 0;
+  std::atomic<uint64_t> write_queue_peak = 0;
+  // how long the data callbacks took, one record per receive
+  w_latency_histogram callback_latency;
+  // the errors which were reported to the error callback
+  w_error_counters errors;
+};
+
+/*
+ * the counters of a server, which are shared by all of its sessions. every
+ * thread counts into its own cache line, so the io contexts of a pool do not
+ * contend on them. a snapshot sums the lines up.
+ */
+class w_server_metrics {
+ public:
+  struct snapshot {
+    std::chrono::steady_clock::time_point time = {};
+    uint64_t accepted = 0;
+    int64_t active_sessions = 0;
+    uint64_t bytes_read = 0;
+    uint64_t messages_read = 0;
+    uint64_t bytes_written = 0;
+    uint64_t messages_written = 0;
+    uint64_t sends_dropped = 0;
+    // the buffers which wait in the write queues of all sessions
+    int64_t queued_buffers = 0;
+    std::array<uint64_t, static_cast<size_t>(w_error_category::count)>
+        errors = {};
+    w_latency_histogram callback_latency;
+  };
+
+  // the counters of a thread
+  struct alignas(64) shard {
+    std::atomic<uint64_t> accepted = 0;
+    // a session may close on another thread than it opened, so the gauges
+    // of a shard may be negative, only their sum is meaningful
+    std::atomic<int64_t> active_sessions = 0;
+    std::atomic<uint64_t> bytes_read = 0;
+    std::atomic<uint64_t> messages_read = 0;
+    std::atomic<uint64_t> bytes_written = 0;
+    std::atomic<uint64_t> messages_written = 0;
+    std::atomic<uint64_t> sends_dropped = 0;
+    std::atomic<int64_t> queued_buffers = 0;
+    w_latency_histogram callback_latency;
+    w_error_counters errors;
+  };
+
+  static constexpr size_t SHARDS = 16;
+
+  // returns the counters of the calling thread
+  W_API shard &local() noexcept;
+
+  // returns the sum of the counters of all threads
+  W_API snapshot get_snapshot() const noexcept;
+
+  /*
+   * get the accepted connections per second between two snapshots
+   * @param p_earlier, the earlier snapshot
+   * @param p_later, the later snapshot
+   * @returns the accept rate, or zero if no time passed between them
+   */
+  W_API static double get_accept_rate(_In_ const snapshot &p_earlier,
+                                      _In_ const snapshot &p_later) noexcept;
+
+ private:
+  std::array<shard, SHARDS> _shards = {};
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -8,6 +8,7 @@
 #ifdef WOLF_SYSTEM_SOCKET
 
 #include <functional>
+#include <memory>
 #include <random>
 #include <wolf.hpp>
 
@@ -28,8 +29,17 @@
 #endif
 // NOLINTEND
 
+#include "w_session_limits.hpp"
+#include "w_socket_metrics.hpp"
+#ifdef WOLF_SYSTEM_HTTP_WS
+#include "w_ws_deflate.hpp"
+#endif
+
 namespace wolf::system::socket {
 
+// see w_tls_context.hpp, which needs WOLF_SYSTEM_SSL
+class w_tls_context;
+
 inline std::string make_connection_id() {
   constexpr auto _max = 999;
   constexpr auto _min = 100;
@@ -41,13 +51,56 @@ inline std::string make_connection_id() {
   return wolf::format("{}_{}", _now, _rand_gen(_rand_engine));
 }
 
+// the way the tcp servers wait for their sockets
+enum class w_io_backend {
+  // asio readiness notification and a system call per read and write
+  epoll,
+  // io_uring on linux 6.0 or newer, see w_io_uring
+  io_uring
+};
+
+struct w_io_uring_options {
+  // the entries of the submission queue, the completion queue gets four
+  // times more, because a multishot request completes many times
+  uint32_t entries = 1024;
+  // the receive buffers which are registered with the kernel, a power of two
+  uint32_t buffer_count = 1024;
+  uint32_t buffer_size = 4096;
+};
+
 struct w_socket_options {
   bool keep_alive = true;
   bool no_delay = true;
   bool reuse_address = true;
+  // let several acceptors bind the same port, linux balances the incoming
+  // connections between them
+  bool reuse_port = false;
   int max_connections = boost::asio::socket_base::max_listen_connections;
+  // the number of buffers a tcp session may queue for writing, the session
+  // stops reading while its queue is full
+  size_t max_write_queue = 1024;
+  // the rate limits and the write watermarks of tcp and websocket sessions
+  w_session_limits limits = {};
+  // the io backend of the servers with a w_session_on_data_callback, it is
+  // chosen when the server runs
+  w_io_backend io_backend = w_io_backend::epoll;
+  w_io_uring_options io_uring = {};
+  // the tls context of the tcp servers, which serve plain tcp without it.
+  // one context may be shared by several servers, so they resume the
+  // sessions of each other
+  std::shared_ptr<w_tls_context> tls = nullptr;
+  // optional counters of the tcp and websocket servers, which are shared by
+  // all sessions of a server
+  std::shared_ptr<w_server_metrics> metrics = nullptr;
+#ifdef WOLF_SYSTEM_HTTP_WS
+  // the permessage-deflate extension of websocket sessions
+  w_ws_deflate_options ws_deflate = {};
+#endif
 
-  void set_to_socket(_Inout_ boost::asio::ip::tcp::socket &p_socket) {
+  template <typename T>
+  void set_to_socket(
+      _Inout_ boost::asio::basic_stream_socket<boost::asio::ip::tcp, T>
+          &p_socket) const {
     // set acceptor's options
     const auto _keep_alive_option =
         boost::asio::socket_base::keep_alive(this->keep_alive);
@@ -72,14 +125,112 @@ struct w_socket_options {
     const auto _reuse_address_option =
         boost::asio::socket_base::reuse_address(this->reuse_address);
     p_acceptor.set_option(_reuse_address_option);
+
+#ifdef SO_REUSEPORT
+    if (this->reuse_port) {
+      using reuse_port_option =
+          boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+      p_acceptor.set_option(reuse_port_option(true));
+    }
+#endif
+  }
+
+  /*
+   * open, configure, bind and listen an acceptor. the options must be set
+   * before bind, otherwise SO_REUSEPORT has no effect
+   * @param p_acceptor, a closed acceptor
+   * @param p_endpoint, the endpoint to bind
+   */
+  template <typename T>
+  void open_acceptor(_Inout_ boost::asio::basic_socket_acceptor<T> &p_acceptor,
+                     _In_ const typename boost::asio::basic_socket_acceptor<
+                         T>::endpoint_type &p_endpoint) {
+    p_acceptor.open(p_endpoint.protocol());
+    set_to_acceptor(p_acceptor);
+    p_acceptor.bind(p_endpoint);
+    p_acceptor.listen(this->max_connections);
+  }
+};
+
+/*
+ * a DynamicBuffer adaptor over w_buffer, so asio and beast can read
+ * straight into the pooled storage of w_buffer without an extra copy
+ */
+class w_dynamic_buffer {
+ public:
+  using const_buffers_type = boost::asio::const_buffer;
+  using mutable_buffers_type = boost::asio::mutable_buffer;
+
+  explicit w_dynamic_buffer(_Inout_ w_buffer &p_buffer) noexcept
+      : _buffer(p_buffer) {}
+
+  size_t size() const noexcept { return this->_buffer.size(); }
+
+  size_t max_size() const noexcept {
+    return std::numeric_limits<size_t>::max() / 2;
+  }
+
+  size_t capacity() const noexcept { return this->_buffer.capacity(); }
+
+  const_buffers_type data() const noexcept {
+    return {this->_buffer.data(), this->_buffer.size()};
+  }
+
+  mutable_buffers_type prepare(_In_ size_t p_size) {
+    const auto _size = this->_buffer.size();
+    this->_buffer.reserve(_size + p_size);
+    return {this->_buffer.data() + _size, p_size};
+  }
+
+  void commit(_In_ size_t p_size) {
+    const auto _size = std::min(this->_buffer.size() + p_size,
+                                this->_buffer.capacity());
+    this->_buffer.resize(_size);
   }
+
+  void consume(_In_ size_t p_size) { this->_buffer.consume(p_size); }
+
+ private:
+  w_buffer &_buffer;
 };
 
 #ifdef WOLF_SYSTEM_HTTP_WS
-using w_ws_stream = boost::beast::websocket::stream<
-    typename boost::beast::tcp_stream::rebind_executor<
+/*
+ * a beast rate policy which does not limit anything but counts the bytes on
+ * the wire, so the websocket sessions can tell how much deflate saved
+ */
+class w_ws_traffic_counter {
+ public:
+  uint64_t get_read_bytes() const noexcept { return this->_read_bytes; }
+  uint64_t get_written_bytes() const noexcept { return this->_written_bytes; }
+
+ private:
+  friend class boost::beast::rate_policy_access;
+
+  size_t available_read_bytes() const noexcept {
+    return std::numeric_limits<size_t>::max();
+  }
+  size_t available_write_bytes() const noexcept {
+    return std::numeric_limits<size_t>::max();
+  }
+  void transfer_read_bytes(_In_ size_t p_bytes) noexcept {
+    this->_read_bytes += p_bytes;
+  }
+  void transfer_write_bytes(_In_ size_t p_bytes) noexcept {
+    this->_written_bytes += p_bytes;
+  }
+  void on_timer() noexcept {}
+
+  uint64_t _read_bytes = 0;
+  uint64_t _written_bytes = 0;
+};
+
+using w_ws_stream =
+    boost::beast::websocket::stream<boost::beast::basic_stream<
+        boost::asio::ip::tcp,
         typename boost::asio::use_awaitable_t<>::executor_with_default<
-            boost::asio::any_io_executor>>::other>;
+            boost::asio::any_io_executor>,
+        w_ws_traffic_counter>>;
 
 typedef std::function<boost::beast::websocket::close_code(
     _In_ const std::string &p_conn_id, _Inout_ w_buffer &p_mut_data,
@@ -7,10 +7,12 @@
 
 #ifdef WOLF_SYSTEM_SOCKET
 
+#include <array>
 #include <boost/asio.hpp>
 #include <variant>
 #include <wolf.hpp>
 
+#include "w_framing.hpp"
 #include "w_socket_options.hpp"
 
 using tcp = boost::asio::ip::tcp;
@@ -23,6 +25,14 @@ class w_tcp_client {
       : _resolver(std::make_unique<tcp::resolver>(p_io_context)),
         _socket(std::make_unique<tcp::socket>(p_io_context)) {}
 
+  /*
+   * wrap a connected socket, e.g. a connection of w_tcp_client_pool
+   * @param p_socket, the connected socket
+   */
+  W_API explicit w_tcp_client(_In_ tcp::socket &&p_socket) noexcept
+      : _socket(std::make_unique<tcp::socket>(std::move(p_socket))),
+        _resolver(std::make_unique<tcp::resolver>(_socket->get_executor())) {}
+
   // move constructor.
   W_API w_tcp_client(w_tcp_client &&p_other) = default;
   // move assignment operator.
@@ -43,6 +53,12 @@ class w_tcp_client {
     }
   }
 
+  // cancel the pending operations and close the socket
+  W_API void close() noexcept {
+    boost::system::error_code _ignore;
+    std::ignore = this->_socket->close(_ignore);
+  }
+
   /*
    * resolve an endpoint asynchronously
    * @param p_endpoint, the endpoint
@@ -107,12 +123,14 @@ class w_tcp_client {
   boost::asio::awaitable<size_t> async_write(_In_ const w_buffer &p_buffer) {
     const gsl::not_null<tcp::socket *> _socket_nn(this->_socket.get());
 
-    return _socket_nn->async_send(boost::asio::buffer(p_buffer.buf, p_buffer.used_bytes),
-                                  boost::asio::use_awaitable);
+    return boost::asio::async_write(
+        *_socket_nn, boost::asio::buffer(p_buffer.data(), p_buffer.size()),
+        boost::asio::use_awaitable);
   }
 
   /*
-   * read from the socket into the buffer
+   * read from the socket into the buffer. the buffer grows to the bytes which
+   * are already queued on the socket, so a big message needs one receive
    * @param p_mut_buffer, the destination buffer which will contain bytes
    * @returns number of read bytes
    */
@@ -120,8 +138,109 @@ class w_tcp_client {
   boost::asio::awaitable<size_t> async_read(_Inout_ w_buffer &p_mut_buffer) {
     const gsl::not_null<tcp::socket *> _socket_nn(this->_socket.get());
 
-    return _socket_nn->async_receive(boost::asio::buffer(p_mut_buffer.buf),
-                                     boost::asio::use_awaitable);
+    co_await _socket_nn->async_wait(tcp::socket::wait_read,
+                                    boost::asio::use_awaitable);
+    p_mut_buffer.reset(std::max<size_t>(_socket_nn->available(),
+                                        W_MAX_BUFFER_SIZE));
+
+    const auto _bytes = co_await _socket_nn->async_receive(
+        boost::asio::buffer(p_mut_buffer.data(), p_mut_buffer.capacity()),
+        boost::asio::use_awaitable);
+    p_mut_buffer.resize(_bytes);
+    co_return _bytes;
+  }
+
+  /*
+   * call the callback for every complete frame of the frame reader, and
+   * receive once into it only if it holds no complete frame, so many small
+   * frames cost one receive. throws a system_error of bad_message if the
+   * stream can not be framed
+   * @param p_reader, the frame reader of this connection
+   * @param p_on_frame, gets the payload of a frame, which is only valid during
+   * the call, and returns false to stop reading frames
+   * @returns number of frames
+   */
+  W_API
+  boost::asio::awaitable<size_t> async_read_frames(
+      _Inout_ w_frame_reader &p_reader,
+      _In_ std::function<bool(gsl::span<const std::byte>)> p_on_frame) {
+    const gsl::not_null<tcp::socket *> _socket_nn(this->_socket.get());
+
+    const auto _read_frames = [&]() -> size_t {
+      size_t _frames = 0;
+      auto _framed = true;
+      boost::leaf::try_handle_all(
+          [&]() -> boost::leaf::result<void> {
+            BOOST_LEAF_AUTO(_count, p_reader.read_frames(p_on_frame));
+            _frames = _count;
+            return {};
+          },
+          [&] { _framed = false; });
+      if (!_framed) {
+        throw boost::system::system_error(
+            boost::system::errc::make_error_code(
+                boost::system::errc::bad_message));
+      }
+      return _frames;
+    };
+
+    // frames which were left by the previous call, because the callback
+    // stopped early, must not wait for more bytes from the peer
+    const auto _buffered = _read_frames();
+    if (_buffered != 0) {
+      co_return _buffered;
+    }
+
+    co_await _socket_nn->async_wait(tcp::socket::wait_read,
+                                    boost::asio::use_awaitable);
+    const auto _space = p_reader.prepare(
+        std::max<size_t>(_socket_nn->available(), W_MAX_BUFFER_SIZE));
+
+    const auto _bytes = co_await _socket_nn->async_receive(
+        boost::asio::buffer(_space.data(), _space.size()),
+        boost::asio::use_awaitable);
+    p_reader.commit(_bytes);
+
+    co_return _read_frames();
+  }
+
+  /*
+   * write a frame without copying the payload, the header, the payload and
+   * the trailer go out in one gathered write
+   * @param p_codec, the framing codec
+   * @param p_payload, the payload
+   * @returns number of the written bytes
+   */
+  W_API
+  boost::asio::awaitable<size_t> async_write_frame(
+      _In_ const w_frame_codec &p_codec,
+      _In_ gsl::span<const std::byte> p_payload) {
+    const gsl::not_null<tcp::socket *> _socket_nn(this->_socket.get());
+
+    std::array<std::byte, w_frame_codec::MAX_HEADER_SIZE> _header = {};
+    size_t _header_size = 0;
+    auto _encoded = true;
+    boost::leaf::try_handle_all(
+        [&]() -> boost::leaf::result<void> {
+          BOOST_LEAF_AUTO(_size,
+                          p_codec.encode_header(p_payload.size(), _header));
+          _header_size = _size;
+          return {};
+        },
+        [&] { _encoded = false; });
+    if (!_encoded) {
+      throw boost::system::system_error(
+          boost::system::errc::make_error_code(
+              boost::system::errc::message_size));
+    }
+
+    const auto _trailer = p_codec.get_trailer();
+    const std::array<boost::asio::const_buffer, 3> _buffers = {
+        boost::asio::buffer(_header.data(), _header_size),
+        boost::asio::buffer(p_payload.data(), p_payload.size()),
+        boost::asio::buffer(_trailer.data(), _trailer.size())};
+    co_return co_await boost::asio::async_write(*_socket_nn, _buffers,
+                                                boost::asio::use_awaitable);
   }
 
   /*
@@ -135,6 +254,9 @@ class w_tcp_client {
   }
 
  private:
+  // the pool takes the socket back on release
+  friend class w_tcp_client_pool;
+
   // copy constructor
   w_tcp_client(const w_tcp_client &) = delete;
   // copy operator
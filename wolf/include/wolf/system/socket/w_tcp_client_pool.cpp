@@ -0,0 +1,261 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_tcp_client_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+
+using w_tcp_client = wolf::system::socket::w_tcp_client;
+using w_tcp_client_pool = wolf::system::socket::w_tcp_client_pool;
+using w_tcp_client_pool_options =
+    wolf::system::socket::w_tcp_client_pool_options;
+using steady_clock = std::chrono::steady_clock;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+// an idle connection must not be readable, a readable one was closed by the
+// peer or got data which belongs to no request
+bool s_is_alive(_Inout_ tcp::socket &p_socket) noexcept {
+  if (!p_socket.is_open()) {
+    return false;
+  }
+
+  boost::system::error_code _error;
+  std::array<char, 1> _byte = {};
+  std::ignore = p_socket.non_blocking(true, _error);
+  std::ignore = p_socket.receive(boost::asio::buffer(_byte),
+                                 tcp::socket::message_peek, _error);
+  const auto _alive = _error == boost::asio::error::would_block;
+  std::ignore = p_socket.non_blocking(false, _error);
+  return _alive;
+}
+
+void s_close(_Inout_ tcp::socket &p_socket) noexcept {
+  boost::system::error_code _ignore;
+  std::ignore = p_socket.shutdown(tcp::socket::shutdown_both, _ignore);
+  std::ignore = p_socket.close(_ignore);
+}
+
+}  // namespace
+
+w_tcp_client_pool::w_tcp_client_pool(
+    _In_ boost::asio::io_context &p_io_context,
+    _In_ w_tcp_client_pool_options p_options)
+    : _io_context(p_io_context),
+      _options(std::move(p_options)),
+      _probe_timer(std::make_shared<boost::asio::steady_timer>(p_io_context)) {
+  this->_options.max_active = std::max<size_t>(1, this->_options.max_active);
+}
+
+w_tcp_client_pool::~w_tcp_client_pool() noexcept {
+  // the probe holds a weak pointer, so it ends once the timer is cancelled
+  this->_probe_timer->cancel();
+
+  std::scoped_lock _lock(this->_mutex);
+  for (auto &[_key, _state] : this->_endpoints) {
+    for (auto &_idle : _state.idle) {
+      s_close(_idle.socket);
+    }
+  }
+}
+
+boost::asio::awaitable<w_tcp_client_pool::lease> w_tcp_client_pool::acquire(
+    _In_ std::string p_host, _In_ uint16_t p_port) {
+  const auto _self = shared_from_this();
+  const auto _key = wolf::format("{}:{}", p_host, p_port);
+
+  auto _start_probe = false;
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    std::optional<boost::asio::steady_timer> _signal;
+    {
+      std::scoped_lock _lock(this->_mutex);
+      if (!this->_probe_started &&
+          this->_options.probe_interval != steady_clock::duration::zero()) {
+        this->_probe_started = true;
+        _start_probe = true;
+      }
+
+      auto &_state = this->_endpoints[_key];
+      const auto _now = steady_clock::now();
+      while (!_state.idle.empty()) {
+        // the last released connection first
+        auto _idle = std::move(_state.idle.back());
+        _state.idle.pop_back();
+        if (_now - _idle.since < this->_options.idle_timeout &&
+            s_is_alive(_idle.socket)) {
+          _state.active++;
+          co_return lease{
+              _key, std::make_unique<w_tcp_client>(std::move(_idle.socket))};
+        }
+        s_close(_idle.socket);
+      }
+
+      if (_state.active < this->_options.max_active) {
+        _state.active++;
+        break;
+      }
+      _signal.emplace(this->_io_context, steady_clock::time_point::max());
+      _state.waiters.push_back(&*_signal);
+    }
+
+    // wait until a release frees a slot
+    boost::system::error_code _ignore;
+    co_await _signal->async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+
+    std::scoped_lock _lock(this->_mutex);
+    auto &_waiters = this->_endpoints[_key].waiters;
+    const auto _iter = std::find(_waiters.begin(), _waiters.end(), &*_signal);
+    if (_iter != _waiters.end()) {
+      _waiters.erase(_iter);
+    }
+  }
+
+  if (_start_probe) {
+    boost::asio::co_spawn(this->_io_context,
+                          _probe(weak_from_this(), this->_probe_timer,
+                                 this->_options.probe_interval),
+                          boost::asio::detached);
+  }
+
+  try {
+    const auto _endpoints = co_await _resolve(_key, p_host, p_port);
+
+    tcp::socket _socket(this->_io_context);
+    co_await boost::asio::async_connect(_socket, _endpoints,
+                                        boost::asio::use_awaitable);
+    this->_options.socket_options.set_to_socket(_socket);
+
+    co_return lease{_key, std::make_unique<w_tcp_client>(std::move(_socket))};
+  } catch (...) {
+    std::scoped_lock _lock(this->_mutex);
+    _free_slot(this->_endpoints[_key]);
+    throw;
+  }
+}
+
+void w_tcp_client_pool::release(_In_ lease &&p_lease, _In_ bool p_reuse) {
+  if (p_lease.client == nullptr) {
+    return;
+  }
+  auto &_socket = *p_lease.client->_socket;
+
+  std::scoped_lock _lock(this->_mutex);
+
+  const auto _iter = this->_endpoints.find(p_lease.key);
+  if (_iter == this->_endpoints.end()) {
+    s_close(_socket);
+    return;
+  }
+
+  auto &_state = _iter->second;
+  if (p_reuse && _socket.is_open() &&
+      _state.idle.size() < this->_options.max_idle) {
+    _state.idle.push_back({std::move(_socket), steady_clock::now()});
+  } else {
+    s_close(_socket);
+  }
+  _free_slot(_state);
+}
+
+size_t w_tcp_client_pool::get_idle_count() const {
+  std::scoped_lock _lock(this->_mutex);
+
+  size_t _count = 0;
+  for (const auto &[_key, _state] : this->_endpoints) {
+    _count += _state.idle.size();
+  }
+  return _count;
+}
+
+size_t w_tcp_client_pool::get_active_count() const {
+  std::scoped_lock _lock(this->_mutex);
+
+  size_t _count = 0;
+  for (const auto &[_key, _state] : this->_endpoints) {
+    _count += _state.active;
+  }
+  return _count;
+}
+
+void w_tcp_client_pool::_free_slot(_Inout_ endpoint_state &p_state) {
+  if (p_state.active > 0) {
+    p_state.active--;
+  }
+  if (p_state.waiters.empty()) {
+    return;
+  }
+
+  // wake up the oldest waiter on the thread of its timer
+  auto *_waiter = p_state.waiters.front();
+  p_state.waiters.pop_front();
+  boost::asio::post(this->_io_context, [_waiter]() { _waiter->cancel(); });
+}
+
+boost::asio::awaitable<tcp::resolver::results_type> w_tcp_client_pool::_resolve(
+    _In_ const std::string &p_key, _In_ const std::string &p_host,
+    _In_ uint16_t p_port) {
+  {
+    std::scoped_lock _lock(this->_mutex);
+    const auto &_state = this->_endpoints[p_key];
+    if (!_state.endpoints.empty() &&
+        steady_clock::now() < _state.endpoints_expiry) {
+      co_return _state.endpoints;
+    }
+  }
+
+  tcp::resolver _resolver(this->_io_context);
+  auto _endpoints = co_await _resolver.async_resolve(
+      p_host, std::to_string(p_port), boost::asio::use_awaitable);
+
+  std::scoped_lock _lock(this->_mutex);
+  auto &_state = this->_endpoints[p_key];
+  _state.endpoints = _endpoints;
+  _state.endpoints_expiry = steady_clock::now() + this->_options.dns_ttl;
+  co_return _endpoints;
+}
+
+boost::asio::awaitable<void> w_tcp_client_pool::_probe(
+    _In_ std::weak_ptr<w_tcp_client_pool> p_pool,
+    _In_ std::shared_ptr<boost::asio::steady_timer> p_timer,
+    _In_ steady_clock::duration p_interval) noexcept {
+  // the probe does not keep the pool alive, and the timer is shared, because
+  // the pool may go away while the probe waits
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (!p_pool.expired()) {
+    boost::system::error_code _error;
+    p_timer->expires_after(p_interval);
+    co_await p_timer->async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, _error));
+
+    const auto _self = p_pool.lock();
+    if (_self == nullptr || _error == boost::asio::error::operation_aborted) {
+      co_return;
+    }
+
+    std::scoped_lock _lock(this->_mutex);
+    const auto _now = steady_clock::now();
+    for (auto &[_key, _state] : this->_endpoints) {
+      auto &_idle = _state.idle;
+      const auto _end = std::remove_if(
+          _idle.begin(), _idle.end(), [&](idle_connection &p_connection) {
+            if (_now - p_connection.since < this->_options.idle_timeout &&
+                s_is_alive(p_connection.socket)) {
+              return false;
+            }
+            s_close(p_connection.socket);
+            return true;
+          });
+      _idle.erase(_end, _idle.end());
+    }
+  }
+}
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,139 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <wolf.hpp>
+
+#include "w_socket_options.hpp"
+#include "w_tcp_client.hpp"
+
+namespace wolf::system::socket {
+
+struct w_tcp_client_pool_options {
+  // the idle connections which are kept per endpoint
+  size_t max_idle = 8;
+  // the leased and connecting connections per endpoint, acquire waits for a
+  // release when all of them are in use
+  size_t max_active = 64;
+  // an idle connection is closed after this time
+  std::chrono::steady_clock::duration idle_timeout = std::chrono::seconds(60);
+  // the idle connections are checked for a close or unexpected data from the
+  // peer on this interval, zero turns the background probe off. a connection
+  // is always checked before it is handed out
+  std::chrono::steady_clock::duration probe_interval = std::chrono::seconds(5);
+  // how long the resolved endpoints of a host are reused
+  std::chrono::steady_clock::duration dns_ttl = std::chrono::seconds(30);
+  // the options of the new connections
+  w_socket_options socket_options = {};
+};
+
+/*
+ * a pool of keep-alive tcp connections keyed by host and port, so a request
+ * and response client pays the tcp handshake once instead of per request.
+ * the last released connection is handed out first, which keeps the warmest
+ * connections busy and lets the others time out. the pool must be owned by a
+ * std::shared_ptr. its state is guarded by a mutex, but a waiting acquire is
+ * woken up on the io context, so an io context which is run by more than one
+ * thread should call the pool from a strand.
+ */
+class w_tcp_client_pool
+    : public std::enable_shared_from_this<w_tcp_client_pool> {
+ public:
+  // a leased connection, which goes back to the pool by release
+  struct lease {
+    std::string key;
+    std::unique_ptr<w_tcp_client> client;
+  };
+
+  /*
+   * @param p_io_context, the io context of the connections
+   * @param p_options, the limits of the pool
+   */
+  W_API w_tcp_client_pool(_In_ boost::asio::io_context &p_io_context,
+                          _In_ w_tcp_client_pool_options p_options = {});
+
+  // close the idle connections and stop the probe
+  W_API virtual ~w_tcp_client_pool() noexcept;
+
+  /*
+   * get an idle connection or connect a new one. throws a system_error if
+   * the host can not be resolved or connected
+   * @param p_host, the host name or address
+   * @param p_port, the port
+   * @returns a coroutine with the leased connection
+   */
+  W_API boost::asio::awaitable<lease> acquire(_In_ std::string p_host,
+                                              _In_ uint16_t p_port);
+
+  /*
+   * give a connection back to the pool
+   * @param p_lease, the leased connection
+   * @param p_reuse, false if the connection is in an unknown state, e.g.
+   * after an error or a partial response, then it is closed
+   */
+  W_API void release(_In_ lease &&p_lease, _In_ bool p_reuse = true);
+
+  // returns the number of idle connections of all endpoints
+  W_API size_t get_idle_count() const;
+
+  // returns the number of leased and connecting connections of all endpoints
+  W_API size_t get_active_count() const;
+
+ private:
+  // copy constructor.
+  w_tcp_client_pool(const w_tcp_client_pool &) = delete;
+  // copy assignment operator.
+  w_tcp_client_pool &operator=(const w_tcp_client_pool &) = delete;
+  // move constructor.
+  w_tcp_client_pool(w_tcp_client_pool &&) = delete;
+  // move assignment operator.
+  w_tcp_client_pool &operator=(w_tcp_client_pool &&) = delete;
+
+  struct idle_connection {
+    tcp::socket socket;
+    std::chrono::steady_clock::time_point since;
+  };
+
+  struct endpoint_state {
+    // used as a stack, the back is the last released connection
+    std::vector<idle_connection> idle;
+    size_t active = 0;
+    // the acquires which wait for a free slot
+    std::deque<boost::asio::steady_timer *> waiters;
+    tcp::resolver::results_type endpoints;
+    std::chrono::steady_clock::time_point endpoints_expiry = {};
+  };
+
+  boost::asio::awaitable<tcp::resolver::results_type> _resolve(
+      _In_ const std::string &p_key, _In_ const std::string &p_host,
+      _In_ uint16_t p_port);
+  boost::asio::awaitable<void> _probe(
+      _In_ std::weak_ptr<w_tcp_client_pool> p_pool,
+      _In_ std::shared_ptr<boost::asio::steady_timer> p_timer,
+      _In_ std::chrono::steady_clock::duration p_interval) noexcept;
+  void _free_slot(_Inout_ endpoint_state &p_state);
+
+  boost::asio::io_context &_io_context;
+  w_tcp_client_pool_options _options;
+  std::shared_ptr<boost::asio::steady_timer> _probe_timer;
+  bool _probe_started = false;
+
+  mutable std::mutex _mutex;
+  std::map<std::string, endpoint_state, std::less<>> _endpoints;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
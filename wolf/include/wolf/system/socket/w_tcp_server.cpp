@@ -2,7 +2,12 @@
 
 #include "w_tcp_server.hpp"
 
+#include <cstring>
+#include <mutex>
 #include <random>
+#include <unordered_map>
+#include <wolf/system/socket/w_io_uring.hpp>
+#include <wolf/system/w_profiler.hpp>
 
 // NOLINTBEGIN
 #ifdef _MSC_VER
@@ -10,8 +15,10 @@
 #pragma warning(disable : ALL_CODE_ANALYSIS_WARNINGS)
 #endif
 
-#ifdef WOLF_SYSTEM_SSL
-#include <boost/asio/ssl.hpp>
+#ifdef WOLF_SYSTEM_IO_URING
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
 #endif
 
 #ifdef _MSC_VER
@@ -19,139 +26,823 @@
 #endif
 // NOLINTEND
 
+using w_io_context_pool = wolf::system::socket::w_io_context_pool;
 using w_tcp_server = wolf::system::socket::w_tcp_server;
+using w_tcp_session = wolf::system::socket::w_tcp_session;
+using w_tcp_session_on_data_callback =
+    wolf::system::socket::w_tcp_session_on_data_callback;
+using w_tcp_session_on_frame_callback =
+    wolf::system::socket::w_tcp_session_on_frame_callback;
+using w_frame_codec = wolf::system::socket::w_frame_codec;
 using w_session_on_data_callback =
     wolf::system::socket::w_session_on_data_callback;
 using w_session_on_error_callback =
     wolf::system::socket::w_session_on_error_callback;
+using w_session_limits = wolf::system::socket::w_session_limits;
+using w_read_limiter = wolf::system::socket::w_read_limiter;
+using w_io_backend = wolf::system::socket::w_io_backend;
 using w_socket_options = wolf::system::socket::w_socket_options;
+using w_tls_context = wolf::system::socket::w_tls_context;
+using w_server_metrics = wolf::system::socket::w_server_metrics;
 using steady_clock = std::chrono::steady_clock;
 using steady_timer = boost::asio::steady_timer;
 using io_context = boost::asio::io_context;
 using tcp = boost::asio::ip::tcp;
-using time_point = std::chrono::steady_clock::time_point;
+// runs a session after it was accepted
+using session_runner =
+    std::function<boost::asio::awaitable<void>(w_tcp_session &p_session)>;
 
-static boost::asio::awaitable<std::errc> watchdog(
-    _Inout_ const time_point &p_deadline) noexcept {
-  steady_timer _timer(co_await boost::asio::this_coro::executor);
-  auto _now = steady_clock::now();
+static boost::asio::awaitable<void> s_session(
+    tcp::socket p_socket, size_t p_max_write_queue, w_session_limits p_limits,
+    std::shared_ptr<w_tls_context> p_tls,
+    std::shared_ptr<w_server_metrics> p_metrics,
+    session_runner p_run) noexcept {
+  const auto _session = std::make_shared<w_tcp_session>(
+      std::move(p_socket), wolf::system::socket::make_connection_id(),
+      p_max_write_queue, p_limits, std::move(p_tls), std::move(p_metrics));
+  co_await p_run(*_session);
+  co_return;
+}
+
+// the buffer of a successful call is the response, as before sessions had a
+// write queue
+static w_tcp_session_on_data_callback s_respond_with_buffer(
+    _In_ w_session_on_data_callback p_on_data_callback) {
+  return [p_on_data_callback](_Inout_ w_tcp_session &p_session,
+                              _Inout_ w_buffer &p_mut_data) {
+    const auto _res = p_on_data_callback(p_session.get_id(), p_mut_data);
+    if (_res == boost::system::errc::success) {
+      p_session.send(p_mut_data);
+    }
+    return _res;
+  };
+}
+
+static session_runner s_make_runner(
+    _In_ steady_clock::duration p_timeout,
+    _In_ w_tcp_session_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) {
+  return [=](_Inout_ w_tcp_session &p_session) {
+    return p_session.run(p_timeout, p_on_data_callback, p_on_error_callback);
+  };
+}
 
+static session_runner s_make_runner(
+    _In_ steady_clock::duration p_timeout,
+    _In_ std::shared_ptr<const w_frame_codec> p_codec,
+    _In_ w_tcp_session_on_frame_callback p_on_frame_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) {
+  return [=](_Inout_ w_tcp_session &p_session) {
+    return p_session.run(p_timeout, p_codec, p_on_frame_callback,
+                         p_on_error_callback);
+  };
+}
+
+// the coroutine outlives run, so it must own its arguments. with a pool, the
+// accepted sockets are handed to the io contexts of the pool in turn.
+static boost::asio::awaitable<void> s_listen(
+    _In_ const boost::asio::io_context &p_io_context,
+    _In_ tcp::acceptor p_acceptor, _In_ w_socket_options p_socket_options,
+    _In_ session_runner p_run,
+    _In_ w_session_on_error_callback p_on_error_callback,
+    _In_ w_io_context_pool *p_pool) noexcept {
 #ifdef __clang__
 #pragma unroll
 #endif
-  while (p_deadline > _now) {
-    _timer.expires_at(p_deadline);
-    co_await _timer.async_wait(boost::asio::use_awaitable);
-    _now = steady_clock::now();
+  while (!p_io_context.stopped()) {
+    try {
+      auto &_target = p_pool != nullptr
+                          ? p_pool->next()
+                          : const_cast<io_context &>(p_io_context);
+      // the reader and the writer of a session share a strand, in case the
+      // io context is run by more than one thread
+      tcp::socket _socket = co_await p_acceptor.async_accept(
+          boost::asio::make_strand(_target), boost::asio::use_awaitable);
+      p_socket_options.set_to_socket(_socket);
+      if (p_socket_options.metrics != nullptr) {
+        p_socket_options.metrics->local().accepted.fetch_add(
+            1, std::memory_order_relaxed);
+      }
+
+      // spawn a coroutinue for handling session, which runs the tls
+      // handshake on its own io context
+      const auto _executor = _socket.get_executor();
+      co_spawn(_executor,
+               s_session(std::move(_socket), p_socket_options.max_write_queue,
+                         p_socket_options.limits, p_socket_options.tls,
+                         p_socket_options.metrics, p_run),
+               boost::asio::detached);
+    } catch (const boost::system::system_error &p_ex) {
+      if (p_ex.code() == boost::asio::error::operation_aborted) {
+        break;
+      }
+      // e.g. too many open files, keep accepting the next connections
+      if (p_socket_options.metrics != nullptr) {
+        p_socket_options.metrics->local().errors.record(p_ex.code());
+      }
+      p_on_error_callback({}, p_ex);
+    }
   }
-  co_return std::errc::timed_out;
 }
 
-static boost::asio::awaitable<void> on_handle_session(
-    const boost::asio::io_context &p_io_context, tcp::socket &p_socket,
-    const std::string &p_conn_id, time_point &p_deadline,
-    steady_clock::duration p_timeout,
-    const w_session_on_data_callback p_on_data_callback,
-    const w_session_on_error_callback p_on_error_callback) noexcept {
-  w_buffer _buffer = {};
+#ifdef WOLF_SYSTEM_IO_URING
+
+using w_io_uring = wolf::system::socket::w_io_uring;
+using w_timer_wheel = wolf::system::socket::w_timer_wheel;
+
+namespace {
+
+// the requests of a connection are told apart by the low bits of their user
+// data, which are free because a connection is aligned to more than eight
+enum uring_op : uint64_t { ACCEPT = 0, RECEIVE = 1, SEND = 2, CANCEL = 3 };
+constexpr uint64_t s_uring_op_mask = 7;
+
+struct uring_connection {
+  uring_connection(_Inout_ w_timer_wheel &p_wheel,
+                   _In_ const w_session_limits &p_limits)
+      : limiter(p_limits), idle_timer(p_wheel, [this]() {
+          // the wheel is locked, so only shut the socket down. the requests
+          // in flight fail and report the timeout
+          this->timed_out = true;
+          ::shutdown(this->fd, SHUT_RDWR);
+        }) {}
+
+  int fd = -1;
+  std::string id;
+  std::deque<w_buffer> queue;
+  size_t queue_bytes = 0;
+  // the buffers of the send in flight, which must live until it completes
+  std::vector<w_buffer> sending;
+  std::vector<iovec> iovecs;
+  msghdr message = {};
+  // the requests in flight, the connection is freed once it is zero
+  size_t pending = 0;
+  bool receiving = false;
+  bool paused = false;
+  bool throttled = false;
+  bool closing = false;
+  bool timed_out = false;
+  w_read_limiter limiter;
+  std::unique_ptr<steady_timer> throttle;
+  w_timer_wheel::entry idle_timer;
+};
+
+class uring_server;
+
+// the servers whose ring was enabled by a thread
+struct uring_owner {
+  std::mutex mutex;
+  std::vector<uring_server *> servers;
+};
+
+// only the thread which enabled a ring can cancel its requests, so the
+// servers of a thread are shut down on it when it exits, e.g. a thread of
+// w_io_context_pool, instead of later by the destructor of its io context,
+// which may run on any thread
+struct uring_owner_guard {
+  std::shared_ptr<uring_owner> owner = std::make_shared<uring_owner>();
+  ~uring_owner_guard();
+};
+
+thread_local uring_owner_guard s_uring_owner;
+
+/*
+ * the io_uring server of an io context. one multishot accept takes all
+ * connections and one multishot receive per connection takes all of its
+ * data, so a wake up of the io context costs one io_uring_enter for every
+ * receive and send of all connections, instead of a system call each.
+ */
+class uring_server {
+ public:
+  uring_server(_In_ io_context &p_io_context, _In_ tcp::acceptor &&p_acceptor,
+               _In_ steady_clock::duration p_timeout,
+               _In_ const w_socket_options &p_socket_options,
+               _In_ w_session_on_data_callback p_on_data_callback,
+               _In_ w_session_on_error_callback p_on_error_callback)
+      : _io_context(p_io_context),
+        _ring(p_io_context),
+        _wheel(w_timer_wheel::get(p_io_context)),
+        _acceptor(std::move(p_acceptor)),
+        _timeout(p_timeout),
+        _socket_options(p_socket_options),
+        _on_data_callback(std::move(p_on_data_callback)),
+        _on_error_callback(std::move(p_on_error_callback)) {}
+
+  ~uring_server() noexcept {
+    if (this->_owner == nullptr) {
+      stop();
+      return;
+    }
+    // the thread of the ring may be stopping it right now
+    std::scoped_lock _lock(this->_owner->mutex);
+    std::erase(this->_owner->servers, this);
+    stop();
+  }
+
+  // close all connections and cancel the requests of the ring, it only
+  // cancels on the thread which enabled the ring
+  void stop() noexcept {
+    if (std::exchange(this->_stopped, true)) {
+      return;
+    }
+    // the kernel drops the requests of a closed ring later and keeps their
+    // sockets until then, so shut them down to free the port right away,
+    // which also ends their requests
+    ::shutdown(this->_acceptor.native_handle(), SHUT_RDWR);
+    for (const auto &[_ptr, _connection] : this->_connections) {
+      ::shutdown(_connection->fd, SHUT_RDWR);
+    }
+    // a send in flight reads the message and the buffers of its connection,
+    // so the connections are leaked if their requests did not end
+    const auto _drained = this->_ring.cancel_all();
+    for (auto &[_ptr, _connection] : this->_connections) {
+      ::close(_connection->fd);
+      _count_queue(-gsl::narrow_cast<int64_t>(_connection->queue.size()));
+      if (!_drained) {
+        _connection->idle_timer.cancel();
+        std::ignore = _connection.release();
+      }
+    }
+    if (this->_metrics != nullptr) {
+      this->_metrics->active_sessions.fetch_sub(
+          gsl::narrow_cast<int64_t>(this->_connections.size()),
+          std::memory_order_relaxed);
+    }
+    this->_connections.clear();
+  }
+
+  boost::leaf::result<int> open() noexcept {
+    return this->_ring.open(this->_socket_options.io_uring);
+  }
+
+  // the coroutine runs on the thread of the io context, which owns the ring
+  boost::asio::awaitable<void> run() noexcept {
+    const auto _enabled = this->_ring.enable();
+    if (!_enabled) {
+      _on_error({}, ENOTSUP);
+      co_return;
+    }
+    this->_owner = s_uring_owner.owner;
+    {
+      std::scoped_lock _lock(this->_owner->mutex);
+      this->_owner->servers.push_back(this);
+    }
+    this->_ring.accept_multishot(this->_acceptor.native_handle(),
+                                 uring_op::ACCEPT);
+    if (this->_socket_options.metrics != nullptr) {
+      // the ring is only used by this thread, so it keeps to one shard
+      this->_metrics = &this->_socket_options.metrics->local();
+    }
 
 #ifdef __clang__
 #pragma unroll
 #endif
-  while (!p_io_context.stopped()) {
-    p_deadline = steady_clock::now() + p_timeout;
+    while (!this->_io_context.stopped()) {
+      try {
+        co_await this->_ring.async_wait();
+      } catch (const boost::system::system_error &p_ex) {
+        if (p_ex.code() != boost::asio::error::operation_aborted) {
+          _on_error({}, p_ex);
+        }
+        break;
+      }
+      this->_ring.reap([this](_In_ const w_io_uring::completion &p_cqe) {
+        _on_completion(p_cqe);
+      });
+    }
+  }
 
-    try {
-      _buffer.used_bytes = co_await p_socket.async_receive(
-          boost::asio::buffer(_buffer.buf), boost::asio::use_awaitable);
+ private:
+  static uint64_t _user_data(_In_ const uring_connection &p_connection,
+                             _In_ uring_op p_op) noexcept {
+    return reinterpret_cast<uint64_t>(&p_connection) | p_op;
+  }
 
-      // call callback
-      const auto _res = p_on_data_callback(p_conn_id, _buffer);
-      if (_res == boost::system::errc::connection_aborted) {
+  void _on_error(_In_ const std::string &p_conn_id, _In_ int p_errno) {
+    _on_error(p_conn_id,
+              boost::system::system_error(boost::system::error_code(
+                  p_errno, boost::system::system_category())));
+  }
+
+  void _on_error(_In_ const std::string &p_conn_id,
+                 _In_ const boost::system::system_error &p_error) {
+    if (this->_metrics != nullptr) {
+      this->_metrics->errors.record(p_error.code());
+    }
+    this->_on_error_callback(p_conn_id, p_error);
+  }
+
+  void _on_completion(_In_ const w_io_uring::completion &p_cqe) {
+    const auto _op = p_cqe.user_data & s_uring_op_mask;
+    if (_op == uring_op::ACCEPT) {
+      _on_accept(p_cqe);
+      return;
+    }
+
+    auto *_connection = reinterpret_cast<uring_connection *>(
+        p_cqe.user_data & ~s_uring_op_mask);
+    switch (_op) {
+      case uring_op::RECEIVE:
+        _on_receive(*_connection, p_cqe);
+        break;
+      case uring_op::SEND:
+        --_connection->pending;
+        _on_send(*_connection, p_cqe.result);
         break;
+      default:
+        --_connection->pending;
+        break;
+    }
+    _release_if_done(*_connection);
+  }
+
+  void _on_accept(_In_ const w_io_uring::completion &p_cqe) {
+    if ((p_cqe.flags & IORING_CQE_F_MORE) == 0 &&
+        p_cqe.result != -ECANCELED) {
+      this->_ring.accept_multishot(this->_acceptor.native_handle(),
+                                   uring_op::ACCEPT);
+    }
+    if (p_cqe.result < 0) {
+      // e.g. too many open files, keep accepting the next connections
+      if (p_cqe.result != -ECANCELED) {
+        _on_error({}, -p_cqe.result);
       }
-      co_await p_socket.async_send(
-          boost::asio::buffer(_buffer.buf, _buffer.used_bytes),
-          boost::asio::use_awaitable);
-    } catch (const boost::system::system_error &p_ex) {
-      p_on_error_callback(p_conn_id, p_ex);
-      break;
+      return;
+    }
+
+    const int _no_delay = this->_socket_options.no_delay ? 1 : 0;
+    const int _keep_alive = this->_socket_options.keep_alive ? 1 : 0;
+    setsockopt(p_cqe.result, IPPROTO_TCP, TCP_NODELAY, &_no_delay,
+               sizeof(_no_delay));
+    setsockopt(p_cqe.result, SOL_SOCKET, SO_KEEPALIVE, &_keep_alive,
+               sizeof(_keep_alive));
+
+    auto _connection = std::make_unique<uring_connection>(
+        this->_wheel, this->_socket_options.limits);
+    _connection->fd = p_cqe.result;
+    _connection->id = wolf::system::socket::make_connection_id();
+    if (this->_metrics != nullptr) {
+      this->_metrics->accepted.fetch_add(1, std::memory_order_relaxed);
+      this->_metrics->active_sessions.fetch_add(1, std::memory_order_relaxed);
     }
+    _refresh_idle_timer(*_connection);
+    _receive(*_connection);
+    auto *_ptr = _connection.get();
+    this->_connections.emplace(_ptr, std::move(_connection));
   }
-}
 
-static boost::asio::awaitable<void> s_session(
-    const boost::asio::io_context &p_io_context, tcp::socket p_socket,
-    steady_clock::duration p_timeout,
-    w_session_on_data_callback p_on_data_callback,
-    w_session_on_error_callback p_on_error_callback) noexcept {
-  const auto _conn_id = wolf::system::socket::make_connection_id();
+  void _on_receive(_Inout_ uring_connection &p_connection,
+                   _In_ const w_io_uring::completion &p_cqe) {
+    if ((p_cqe.flags & IORING_CQE_F_MORE) == 0) {
+      p_connection.receiving = false;
+      --p_connection.pending;
+    }
 
-  time_point _deadline = {};
-  co_await (
-      on_handle_session(p_io_context, p_socket, _conn_id, _deadline, p_timeout,
-                        p_on_data_callback, p_on_error_callback));
+    if (p_cqe.result > 0) {
+      W_PROFILE_SCOPE("w_tcp_server::session");
+      _refresh_idle_timer(p_connection);
 
-  co_return;
-}
+      // the pooled buffer goes back to the kernel right away, so a slow
+      // callback does not starve the receives of the other connections
+      const auto _data = this->_ring.get_buffer(p_cqe);
+      w_buffer _buffer(_data.size());
+      _buffer.resize(_data.size());
+      std::memcpy(_buffer.data(), _data.data(), _data.size());
+      this->_ring.recycle_buffer(p_cqe);
 
-static boost::asio::awaitable<void> s_listen(
-    _In_ const boost::asio::io_context &p_io_context,
-    _In_ tcp::endpoint &p_endpoint,
-    _In_ const steady_clock::duration &p_timeout,
-    _In_ w_socket_options &p_socket_options,
-    _In_ w_session_on_data_callback p_on_data_callback,
-    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
-  // create acceptor from this coroutine
-  auto _executor = co_await boost::asio::this_coro::executor;
-  tcp::acceptor _acceptor(_executor, p_endpoint);
+      if (!p_connection.closing) {
+        const auto _started = steady_clock::now();
+        const auto _res = this->_on_data_callback(p_connection.id, _buffer);
+        if (this->_metrics != nullptr) {
+          this->_metrics->bytes_read.fetch_add(
+              gsl::narrow_cast<uint64_t>(p_cqe.result),
+              std::memory_order_relaxed);
+          this->_metrics->messages_read.fetch_add(1,
+                                                  std::memory_order_relaxed);
+          this->_metrics->callback_latency.record(steady_clock::now() -
+                                                  _started);
+        }
+        if (_res == boost::system::errc::success) {
+          _queue(p_connection, std::move(_buffer));
+        } else if (_res == boost::system::errc::connection_aborted) {
+          _close(p_connection);
+        }
+
+        const auto _delay = p_connection.limiter.take(
+            gsl::narrow_cast<uint64_t>(p_cqe.result), 1);
+        if (_delay > steady_clock::duration::zero()) {
+          _throttle(p_connection, _delay);
+        }
+      }
+    } else if ((p_cqe.flags & IORING_CQE_F_BUFFER) != 0) {
+      this->_ring.recycle_buffer(p_cqe);
+    }
 
-  // set acceptor's options
-  p_socket_options.set_to_acceptor(_acceptor);
+    if (p_cqe.result == 0 && !p_connection.closing) {
+      if (p_connection.timed_out) {
+        _on_error(p_connection.id, ETIMEDOUT);
+      } else {
+        // the peer closed the connection
+        _on_error(p_connection.id,
+                  boost::system::system_error(boost::asio::error::eof));
+      }
+      _abort(p_connection);
+    } else if (p_cqe.result < 0 && p_cqe.result != -ECANCELED &&
+               p_cqe.result != -ENOBUFS) {
+      if (!p_connection.closing) {
+        _on_error(p_connection.id,
+                  p_connection.timed_out ? ETIMEDOUT : -p_cqe.result);
+      }
+      _abort(p_connection);
+    }
+
+    // a receive also ends when the buffers ran out, then it starts again
+    // after this wake up gave them back
+    if (!p_connection.receiving && !p_connection.paused &&
+        !p_connection.closing) {
+      _receive(p_connection);
+    }
+  }
+
+  void _on_send(_Inout_ uring_connection &p_connection, _In_ int p_result) {
+    if (p_result < 0) {
+      if (!p_connection.closing) {
+        _on_error(p_connection.id,
+                  p_connection.timed_out ? ETIMEDOUT : -p_result);
+      }
+      p_connection.sending.clear();
+      _abort(p_connection);
+      return;
+    }
 
-  // start listening for connections
-  _acceptor.listen(p_socket_options.max_connections);
+    _refresh_idle_timer(p_connection);
 
+    // a partial send continues with the bytes which are left
+    auto _bytes = gsl::narrow_cast<size_t>(p_result);
+    if (this->_metrics != nullptr) {
+      this->_metrics->bytes_written.fetch_add(_bytes,
+                                              std::memory_order_relaxed);
+    }
+    auto &_message = p_connection.message;
 #ifdef __clang__
 #pragma unroll
 #endif
-  while (!p_io_context.stopped()) {
-    tcp::socket _socket =
-        co_await _acceptor.async_accept(boost::asio::use_awaitable);
-    p_socket_options.set_to_socket(_socket);
+    while (_bytes > 0 && _message.msg_iovlen > 0) {
+      auto &_iovec = *_message.msg_iov;
+      const auto _size = std::min(_bytes, _iovec.iov_len);
+      _iovec.iov_base = static_cast<std::byte *>(_iovec.iov_base) + _size;
+      _iovec.iov_len -= _size;
+      _bytes -= _size;
+      if (_iovec.iov_len == 0) {
+        ++_message.msg_iov;
+        --_message.msg_iovlen;
+      }
+    }
+    if (_message.msg_iovlen > 0) {
+      _submit_send(p_connection);
+      return;
+    }
+
+    if (this->_metrics != nullptr) {
+      this->_metrics->messages_written.fetch_add(p_connection.sending.size(),
+                                                 std::memory_order_relaxed);
+    }
+    p_connection.sending.clear();
+    _send(p_connection);
+    if (p_connection.paused && !p_connection.throttled &&
+        _can_resume_reader(p_connection)) {
+      _resume(p_connection);
+    }
+  }
+
+  void _receive(_Inout_ uring_connection &p_connection) {
+    if (this->_ring.receive_multishot(
+            p_connection.fd, _user_data(p_connection, uring_op::RECEIVE))) {
+      p_connection.receiving = true;
+      ++p_connection.pending;
+    }
+  }
+
+  void _queue(_Inout_ uring_connection &p_connection,
+              _In_ w_buffer &&p_buffer) {
+    if (p_buffer.empty()) {
+      return;
+    }
+    p_connection.queue_bytes += p_buffer.size();
+    p_connection.queue.push_back(std::move(p_buffer));
+    _count_queue(1);
+    _send(p_connection);
+    if (_must_pause_reader(p_connection)) {
+      _pause(p_connection);
+    }
+  }
+
+  // one gathered send of the queued buffers, while no send is in flight
+  void _send(_Inout_ uring_connection &p_connection) {
+    if (!p_connection.sending.empty()) {
+      return;
+    }
+    if (p_connection.queue.empty()) {
+      if (p_connection.closing) {
+        // the queue was drained after close, the receive ends with the
+        // shutdown
+        ::shutdown(p_connection.fd, SHUT_RDWR);
+      }
+      return;
+    }
 
-    // auto _ssl_session =
-    // boost::asio::ssl::stream<tcp::socket>(std::move(_socket), _ssl_context);
+    const auto _count = std::min(p_connection.queue.size(),
+                                 w_tcp_session::MAX_GATHER_BUFFERS);
+    p_connection.iovecs.clear();
+    for (size_t i = 0; i < _count; ++i) {
+      auto &_buffer = p_connection.queue.front();
+      p_connection.queue_bytes -= _buffer.size();
+      p_connection.iovecs.push_back(iovec{_buffer.data(), _buffer.size()});
+      p_connection.sending.push_back(std::move(_buffer));
+      p_connection.queue.pop_front();
+    }
+    _count_queue(-gsl::narrow_cast<int64_t>(_count));
+    p_connection.message = {};
+    p_connection.message.msg_iov = p_connection.iovecs.data();
+    p_connection.message.msg_iovlen = p_connection.iovecs.size();
+    _submit_send(p_connection);
+  }
 
-    // spawn a coroutinue for handling session
-    co_spawn(_executor,
-             s_session(p_io_context, std::move(_socket), p_timeout,
-                       p_on_data_callback, p_on_error_callback),
-             boost::asio::detached);
+  void _submit_send(_Inout_ uring_connection &p_connection) {
+    if (this->_ring.send_message(p_connection.fd, &p_connection.message,
+                                 _user_data(p_connection, uring_op::SEND))) {
+      ++p_connection.pending;
+      return;
+    }
+    // the submission queue was full and could not be submitted
+    p_connection.sending.clear();
+    _abort(p_connection);
   }
+
+  bool _must_pause_reader(
+      _In_ const uring_connection &p_connection) const noexcept {
+    const auto &_limits = this->_socket_options.limits;
+    return p_connection.queue.size() >= this->_socket_options.max_write_queue ||
+           (_limits.write_high_watermark != 0 &&
+            p_connection.queue_bytes >= _limits.write_high_watermark);
+  }
+
+  bool _can_resume_reader(
+      _In_ const uring_connection &p_connection) const noexcept {
+    const auto &_limits = this->_socket_options.limits;
+    return p_connection.queue.size() < this->_socket_options.max_write_queue &&
+           (_limits.write_high_watermark == 0 ||
+            p_connection.queue_bytes <= std::min(_limits.write_low_watermark,
+                                                 _limits.write_high_watermark));
+  }
+
+  // a paused connection cancels its receive, the data stays in the kernel
+  void _pause(_Inout_ uring_connection &p_connection) {
+    if (p_connection.paused) {
+      return;
+    }
+    p_connection.paused = true;
+    if (p_connection.receiving &&
+        this->_ring.cancel(_user_data(p_connection, uring_op::RECEIVE),
+                           _user_data(p_connection, uring_op::CANCEL))) {
+      ++p_connection.pending;
+    }
+  }
+
+  void _resume(_Inout_ uring_connection &p_connection) {
+    p_connection.paused = false;
+    if (!p_connection.receiving && !p_connection.closing) {
+      _receive(p_connection);
+    }
+  }
+
+  void _throttle(_Inout_ uring_connection &p_connection,
+                 _In_ steady_clock::duration p_delay) {
+    if (p_connection.throttle == nullptr) {
+      p_connection.throttle = std::make_unique<steady_timer>(this->_io_context);
+    }
+    p_connection.throttled = true;
+    _refresh_idle_timer(p_connection, p_delay);
+    _pause(p_connection);
+    p_connection.throttle->expires_after(p_delay);
+    // a freed connection cancels its timer, so the handler does not run
+    p_connection.throttle->async_wait(
+        [this, _connection = &p_connection](
+            _In_ const boost::system::error_code &p_error) {
+          if (p_error) {
+            return;
+          }
+          _connection->throttled = false;
+          if (_can_resume_reader(*_connection)) {
+            _resume(*_connection);
+          }
+          std::ignore = this->_ring.submit();
+        });
+  }
+
+  // send the queued buffers and close the connection
+  void _close(_Inout_ uring_connection &p_connection) {
+    p_connection.closing = true;
+    _send(p_connection);
+  }
+
+  // a connection which neither receives nor sends for the timeout is shut
+  // down, the timeout is disabled if it is not positive
+  void _refresh_idle_timer(_Inout_ uring_connection &p_connection,
+                           _In_ steady_clock::duration p_extra =
+                               steady_clock::duration::zero()) {
+    if (this->_timeout > steady_clock::duration::zero()) {
+      p_connection.idle_timer.expires_after(this->_timeout + p_extra);
+    }
+  }
+
+  // close the connection and drop its queue
+  void _abort(_Inout_ uring_connection &p_connection) {
+    p_connection.idle_timer.cancel();
+    p_connection.closing = true;
+    _count_queue(-gsl::narrow_cast<int64_t>(p_connection.queue.size()));
+    p_connection.queue.clear();
+    p_connection.queue_bytes = 0;
+    ::shutdown(p_connection.fd, SHUT_RDWR);
+  }
+
+  void _count_queue(_In_ int64_t p_change) noexcept {
+    if (this->_metrics != nullptr && p_change != 0) {
+      this->_metrics->queued_buffers.fetch_add(p_change,
+                                               std::memory_order_relaxed);
+    }
+  }
+
+  void _release_if_done(_Inout_ uring_connection &p_connection) {
+    if (!p_connection.closing || p_connection.pending != 0) {
+      return;
+    }
+    ::close(p_connection.fd);
+    if (this->_metrics != nullptr) {
+      this->_metrics->active_sessions.fetch_sub(1, std::memory_order_relaxed);
+    }
+    this->_connections.erase(&p_connection);
+  }
+
+  io_context &_io_context;
+  w_io_uring _ring;
+  w_timer_wheel &_wheel;
+  tcp::acceptor _acceptor;
+  steady_clock::duration _timeout;
+  w_socket_options _socket_options;
+  w_session_on_data_callback _on_data_callback;
+  w_session_on_error_callback _on_error_callback;
+  // the counters of the thread of the ring, if the server has metrics
+  w_server_metrics::shard *_metrics = nullptr;
+  std::unordered_map<uring_connection *, std::unique_ptr<uring_connection>>
+      _connections;
+  // the servers of the thread which enabled the ring
+  std::shared_ptr<uring_owner> _owner;
+  bool _stopped = false;
+};
+
+uring_owner_guard::~uring_owner_guard() {
+  std::scoped_lock _lock(this->owner->mutex);
+  for (auto *_server : this->owner->servers) {
+    _server->stop();
+  }
+  this->owner->servers.clear();
 }
 
-boost::leaf::result<int> w_tcp_server::run(
-    _In_ boost::asio::io_context &p_io_context,
-    _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
-    _In_ std::chrono::steady_clock::duration &&p_timeout,
-    _In_ w_socket_options &&p_socket_options,
+}  // namespace
+
+static boost::asio::awaitable<void> s_uring_listen(
+    _In_ std::unique_ptr<uring_server> p_server) noexcept {
+  co_await p_server->run();
+}
+
+static boost::leaf::result<std::unique_ptr<uring_server>> s_uring_open(
+    _In_ io_context &p_io_context, _In_ const tcp::endpoint &p_endpoint,
+    _In_ steady_clock::duration p_timeout,
+    _In_ w_socket_options &p_socket_options,
+    _In_ const w_session_on_data_callback &p_on_data_callback,
+    _In_ const w_session_on_error_callback &p_on_error_callback) noexcept {
+  try {
+    tcp::acceptor _acceptor(p_io_context);
+    p_socket_options.open_acceptor(_acceptor, p_endpoint);
+    auto _server = std::make_unique<uring_server>(
+        p_io_context, std::move(_acceptor), p_timeout, p_socket_options,
+        p_on_data_callback, p_on_error_callback);
+    BOOST_LEAF_CHECK(_server->open());
+    return _server;
+  } catch (_In_ const std::exception &p_ex) {
+    return W_FAILURE(
+        std::errc::operation_canceled,
+        "tcp server caught an exception : " + std::string(p_ex.what()));
+  }
+}
+
+#endif  // WOLF_SYSTEM_IO_URING
+
+// a ring per io context, each with its own SO_REUSEPORT listener
+static boost::leaf::result<int> s_run_uring(
+    _In_ gsl::span<io_context *const> p_io_contexts,
+    _In_ const tcp::endpoint &p_endpoint, _In_ steady_clock::duration p_timeout,
+    _In_ w_socket_options &p_socket_options,
     _In_ w_session_on_data_callback p_on_data_callback,
     _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  if (p_socket_options.tls != nullptr) {
+    return W_FAILURE(std::errc::not_supported,
+                     "io_uring does not serve tls, use the epoll backend");
+  }
+#ifdef WOLF_SYSTEM_IO_URING
+  if (p_io_contexts.size() > 1) {
+    p_socket_options.reuse_port = true;
+  }
+
+  // open all rings before running any, so a failure is reported to the caller
+  std::vector<std::unique_ptr<uring_server>> _servers;
+  for (auto *_io_context : p_io_contexts) {
+    BOOST_LEAF_AUTO(_server,
+                    s_uring_open(*_io_context, p_endpoint, p_timeout,
+                                 p_socket_options, p_on_data_callback,
+                                 p_on_error_callback));
+    _servers.push_back(std::move(_server));
+  }
+  for (size_t i = 0; i < _servers.size(); ++i) {
+    boost::asio::co_spawn(*p_io_contexts[i],
+                          s_uring_listen(std::move(_servers[i])),
+                          boost::asio::detached);
+  }
+  return 0;
+#else
+  return W_FAILURE(std::errc::not_supported,
+                   "io_uring was not available when wolf was built");
+#endif  // WOLF_SYSTEM_IO_URING
+}
+
+static boost::leaf::result<int> s_run(
+    _In_ boost::asio::io_context &p_io_context,
+    _In_ const tcp::endpoint &p_endpoint,
+    _In_ w_socket_options &p_socket_options, _In_ session_runner p_run,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  if (p_socket_options.io_backend != w_io_backend::epoll) {
+    return W_FAILURE(std::errc::not_supported,
+                     "io_uring only serves a w_session_on_data_callback");
+  }
   try {
-#ifdef WOLF_SYSTEM_SSL
-    // try create ssl context
-    // auto _ssl = boost::asio::ssl::context(p_socket_options.tls_version);
-    //_ssl.use_certificate_chain_file(p_socket_options.certificate_chain_file.string());
-    //_ssl.use_private_key_file(p_socket_options.private_key_file.string(),
-    //                          boost::asio::ssl::context::pem);
-#endif  // WOLF_SYSTEM_SSL
+    // bind before spawning, so a busy port is reported to the caller
+    tcp::acceptor _acceptor(p_io_context);
+    p_socket_options.open_acceptor(_acceptor, p_endpoint);
 
     // server with coroutines
     boost::asio::co_spawn(
         p_io_context,
-        s_listen(p_io_context, p_endpoint, p_timeout, p_socket_options,
-                 p_on_data_callback, p_on_error_callback),
+        s_listen(p_io_context, std::move(_acceptor), p_socket_options,
+                 std::move(p_run), std::move(p_on_error_callback), nullptr),
+        boost::asio::detached);
+    return 0;
+  } catch (_In_ const std::exception &p_ex) {
+    return W_FAILURE(
+        std::errc::operation_canceled,
+        "tcp server caught an exception : " + std::string(p_ex.what()));
+  }
+}
+
+static boost::leaf::result<int> s_run(
+    _Inout_ w_io_context_pool &p_pool, _In_ const tcp::endpoint &p_endpoint,
+    _In_ w_socket_options &p_socket_options, _In_ session_runner p_run,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  if (p_socket_options.io_backend != w_io_backend::epoll) {
+    return W_FAILURE(std::errc::not_supported,
+                     "io_uring only serves a w_session_on_data_callback");
+  }
+  try {
+    std::vector<tcp::acceptor> _acceptors;
+
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    // an acceptor per io context, the kernel spreads the connections
+    if (p_pool.size() > 1) {
+      p_socket_options.reuse_port = true;
+      for (size_t i = 0; i < p_pool.size(); ++i) {
+        auto &_acceptor = _acceptors.emplace_back(p_pool.get(i));
+        p_socket_options.open_acceptor(_acceptor, p_endpoint);
+      }
+      for (size_t i = 0; i < p_pool.size(); ++i) {
+        auto &_context = p_pool.get(i);
+        boost::asio::co_spawn(
+            _context,
+            s_listen(_context, std::move(_acceptors[i]), p_socket_options,
+                     p_run, p_on_error_callback, nullptr),
+            boost::asio::detached);
+      }
+      return 0;
+    }
+#endif
+
+    // one acceptor, which hands the sockets to the io contexts in turn
+    auto &_context = p_pool.get(0);
+    auto &_acceptor = _acceptors.emplace_back(_context);
+    p_socket_options.open_acceptor(_acceptor, p_endpoint);
+    boost::asio::co_spawn(
+        _context,
+        s_listen(_context, std::move(_acceptor), p_socket_options,
+                 std::move(p_run), std::move(p_on_error_callback), &p_pool),
         boost::asio::detached);
     return 0;
   } catch (_In_ const std::exception &p_ex) {
@@ -161,4 +852,105 @@ boost::leaf::result<int> w_tcp_server::run(
   }
 }
 
+boost::leaf::result<int> w_tcp_server::run(
+    _In_ boost::asio::io_context &p_io_context,
+    _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ std::chrono::steady_clock::duration &&p_timeout,
+    _In_ w_socket_options &&p_socket_options,
+    _In_ w_session_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  if (p_socket_options.io_backend == w_io_backend::io_uring) {
+    io_context *const _io_context = &p_io_context;
+    return s_run_uring(gsl::span(&_io_context, 1), p_endpoint, p_timeout,
+                       p_socket_options, std::move(p_on_data_callback),
+                       std::move(p_on_error_callback));
+  }
+  return s_run(p_io_context, p_endpoint, p_socket_options,
+               s_make_runner(
+                   p_timeout,
+                   s_respond_with_buffer(std::move(p_on_data_callback)),
+                   p_on_error_callback),
+               p_on_error_callback);
+}
+
+boost::leaf::result<int> w_tcp_server::run(
+    _Inout_ w_io_context_pool &p_pool,
+    _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ std::chrono::steady_clock::duration &&p_timeout,
+    _In_ w_socket_options &&p_socket_options,
+    _In_ w_session_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  if (p_socket_options.io_backend == w_io_backend::io_uring) {
+    std::vector<io_context *> _io_contexts;
+    for (size_t i = 0; i < p_pool.size(); ++i) {
+      _io_contexts.push_back(&p_pool.get(i));
+    }
+    return s_run_uring(_io_contexts, p_endpoint, p_timeout, p_socket_options,
+                       std::move(p_on_data_callback),
+                       std::move(p_on_error_callback));
+  }
+  return s_run(p_pool, p_endpoint, p_socket_options,
+               s_make_runner(
+                   p_timeout,
+                   s_respond_with_buffer(std::move(p_on_data_callback)),
+                   p_on_error_callback),
+               p_on_error_callback);
+}
+
+boost::leaf::result<int> w_tcp_server::run(
+    _In_ boost::asio::io_context &p_io_context,
+    _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ std::chrono::steady_clock::duration &&p_timeout,
+    _In_ w_socket_options &&p_socket_options,
+    _In_ w_tcp_session_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  return s_run(p_io_context, p_endpoint, p_socket_options,
+               s_make_runner(p_timeout, std::move(p_on_data_callback),
+                             p_on_error_callback),
+               p_on_error_callback);
+}
+
+boost::leaf::result<int> w_tcp_server::run(
+    _Inout_ w_io_context_pool &p_pool,
+    _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ std::chrono::steady_clock::duration &&p_timeout,
+    _In_ w_socket_options &&p_socket_options,
+    _In_ w_tcp_session_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  return s_run(p_pool, p_endpoint, p_socket_options,
+               s_make_runner(p_timeout, std::move(p_on_data_callback),
+                             p_on_error_callback),
+               p_on_error_callback);
+}
+
+boost::leaf::result<int> w_tcp_server::run(
+    _In_ boost::asio::io_context &p_io_context,
+    _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ std::chrono::steady_clock::duration &&p_timeout,
+    _In_ w_socket_options &&p_socket_options,
+    _In_ std::shared_ptr<const w_frame_codec> p_codec,
+    _In_ w_tcp_session_on_frame_callback p_on_frame_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  return s_run(p_io_context, p_endpoint, p_socket_options,
+               s_make_runner(p_timeout, std::move(p_codec),
+                             std::move(p_on_frame_callback),
+                             p_on_error_callback),
+               p_on_error_callback);
+}
+
+boost::leaf::result<int> w_tcp_server::run(
+    _Inout_ w_io_context_pool &p_pool,
+    _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ std::chrono::steady_clock::duration &&p_timeout,
+    _In_ w_socket_options &&p_socket_options,
+    _In_ std::shared_ptr<const w_frame_codec> p_codec,
+    _In_ w_tcp_session_on_frame_callback p_on_frame_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  return s_run(p_pool, p_endpoint, p_socket_options,
+               s_make_runner(p_timeout, std::move(p_codec),
+                             std::move(p_on_frame_callback),
+                             p_on_error_callback),
+               p_on_error_callback);
+}
+
 #endif  // WOLF_SYSTEM_SOCKET
@@ -8,7 +8,9 @@
 
 #include <wolf.hpp>
 
+#include "w_io_context_pool.hpp"
 #include "w_socket_options.hpp"
+#include "w_tcp_session.hpp"
 
 namespace wolf::system::socket {
 class w_tcp_server {
@@ -16,8 +18,10 @@ class w_tcp_server {
   /*
    * @param p_io_context, the boost io context
    * @param p_endpoint, the endpoint of the server
-   * @param p_timeout, the timeout for connection
-   * @param p_socket_options, the socket options
+   * @param p_timeout, the idle timeout of a connection, which is disabled if
+   * it is not positive
+   * @param p_socket_options, the socket options, its io_backend chooses
+   * between epoll and io_uring and its tls context serves tls over epoll
    * @param p_on_data_callback, on data callback for session
    * @param p_on_error_callback, on error callback for session
    * @returns void
@@ -29,6 +33,114 @@ class w_tcp_server {
       _In_ w_socket_options &&p_socket_options,
       _In_ w_session_on_data_callback p_on_data_callback,
       _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run the server on every io context of a pool. on linux each io context
+   * gets its own SO_REUSEPORT acceptor and keeps the sessions it accepted,
+   * elsewhere one acceptor hands the sessions to the io contexts in turn.
+   * the callbacks are called from all threads of the pool concurrently.
+   * with the io_uring backend each io context gets its own ring.
+   * @param p_pool, the io context pool, which is run by the caller
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the idle timeout of a connection, which is disabled if
+   * it is not positive
+   * @param p_socket_options, the socket options, its io_backend chooses
+   * between epoll and io_uring and its tls context serves tls over epoll
+   * @param p_on_data_callback, on data callback for session
+   * @param p_on_error_callback, on error callback for session
+   * @returns zero on success
+   */
+  W_API static boost::leaf::result<int> run(
+      _Inout_ w_io_context_pool &p_pool,
+      _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+      _In_ std::chrono::steady_clock::duration &&p_timeout,
+      _In_ w_socket_options &&p_socket_options,
+      _In_ w_session_on_data_callback p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run a server with full duplex sessions. the data callback gets the
+   * session, so it may send any number of responses, keep the session with
+   * shared_from_this and push to it later from any thread
+   * @param p_io_context, the boost io context
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the idle timeout of a connection, which is disabled if
+   * it is not positive
+   * @param p_socket_options, the socket options
+   * @param p_on_data_callback, on data callback for session
+   * @param p_on_error_callback, on error callback for session
+   * @returns zero on success
+   */
+  W_API static boost::leaf::result<int> run(
+      _In_ boost::asio::io_context &p_io_context,
+      _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+      _In_ std::chrono::steady_clock::duration &&p_timeout,
+      _In_ w_socket_options &&p_socket_options,
+      _In_ w_tcp_session_on_data_callback p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run a server with full duplex sessions on every io context of a pool
+   * @param p_pool, the io context pool, which is run by the caller
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the idle timeout of a connection, which is disabled if
+   * it is not positive
+   * @param p_socket_options, the socket options
+   * @param p_on_data_callback, on data callback for session
+   * @param p_on_error_callback, on error callback for session
+   * @returns zero on success
+   */
+  W_API static boost::leaf::result<int> run(
+      _Inout_ w_io_context_pool &p_pool,
+      _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+      _In_ std::chrono::steady_clock::duration &&p_timeout,
+      _In_ w_socket_options &&p_socket_options,
+      _In_ w_tcp_session_on_data_callback p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run a server with framed sessions. the stream of every session is split
+   * into frames by the codec and each complete frame is passed to the frame
+   * callback, the responses are framed with w_tcp_session::send_frame
+   * @param p_io_context, the boost io context
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the idle timeout of a connection, which is disabled if
+   * it is not positive
+   * @param p_socket_options, the socket options
+   * @param p_codec, the framing codec, which is shared by all sessions
+   * @param p_on_frame_callback, on frame callback for session
+   * @param p_on_error_callback, on error callback for session
+   * @returns zero on success
+   */
+  W_API static boost::leaf::result<int> run(
+      _In_ boost::asio::io_context &p_io_context,
+      _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+      _In_ std::chrono::steady_clock::duration &&p_timeout,
+      _In_ w_socket_options &&p_socket_options,
+      _In_ std::shared_ptr<const w_frame_codec> p_codec,
+      _In_ w_tcp_session_on_frame_callback p_on_frame_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run a server with framed sessions on every io context of a pool
+   * @param p_pool, the io context pool, which is run by the caller
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the idle timeout of a connection, which is disabled if
+   * it is not positive
+   * @param p_socket_options, the socket options
+   * @param p_codec, the framing codec, which is shared by all sessions
+   * @param p_on_frame_callback, on frame callback for session
+   * @param p_on_error_callback, on error callback for session
+   * @returns zero on success
+   */
+  W_API static boost::leaf::result<int> run(
+      _Inout_ w_io_context_pool &p_pool,
+      _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+      _In_ std::chrono::steady_clock::duration &&p_timeout,
+      _In_ w_socket_options &&p_socket_options,
+      _In_ std::shared_ptr<const w_frame_codec> p_codec,
+      _In_ w_tcp_session_on_frame_callback p_on_frame_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
 };
 }  // namespace wolf::system::socket
 #endif  // WOLF_SYSTEM_SOCKET
\ No newline at end of file
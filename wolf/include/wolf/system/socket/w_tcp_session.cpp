@@ -0,0 +1,720 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_tcp_session.hpp"
+
+#include <wolf/system/w_profiler.hpp>
+
+using w_tcp_session = wolf::system::socket::w_tcp_session;
+using w_frame_codec = wolf::system::socket::w_frame_codec;
+using w_frame_reader = wolf::system::socket::w_frame_reader;
+using w_tcp_session_on_data_callback =
+    wolf::system::socket::w_tcp_session_on_data_callback;
+using w_tcp_session_on_frame_callback =
+    wolf::system::socket::w_tcp_session_on_frame_callback;
+using w_session_on_error_callback =
+    wolf::system::socket::w_session_on_error_callback;
+using w_session_limits = wolf::system::socket::w_session_limits;
+using w_timer_wheel = wolf::system::socket::w_timer_wheel;
+using w_tls_context = wolf::system::socket::w_tls_context;
+using w_server_metrics = wolf::system::socket::w_server_metrics;
+using steady_clock = std::chrono::steady_clock;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+// the session whose data callback runs on this thread. its sends wake up the
+// writer once the callback returns, instead of posting a wake up per send
+thread_local const w_tcp_session *s_reading_session = nullptr;
+
+boost::system::system_error s_timed_out_error() {
+  return boost::system::system_error(
+      boost::system::errc::make_error_code(boost::system::errc::timed_out));
+}
+
+#ifdef WOLF_SYSTEM_SSL
+// a session copies a gathered write into its scratch buffer, which is freed
+// after a bigger write, so an idle session does not keep it
+constexpr size_t s_max_tls_scratch = 64 * 1024;
+
+boost::system::system_error s_ssl_error(_In_ int p_error) {
+  const auto _errno = errno;
+  if (p_error == SSL_ERROR_ZERO_RETURN) {
+    // the peer sent its close_notify
+    return boost::system::system_error(boost::asio::error::eof);
+  }
+  if (p_error == SSL_ERROR_SYSCALL && _errno != 0) {
+    return boost::system::system_error(
+        boost::system::error_code(_errno, boost::system::system_category()));
+  }
+  const auto _code = ERR_get_error();
+  if (_code == 0) {
+    return boost::system::system_error(
+        boost::asio::ssl::error::stream_truncated);
+  }
+  return boost::system::system_error(boost::system::error_code(
+      gsl::narrow_cast<int>(_code), boost::asio::error::get_ssl_category()));
+}
+#endif
+
+}  // namespace
+
+w_tcp_session::w_tcp_session(_In_ tcp::socket &&p_socket,
+                             _In_ std::string p_conn_id,
+                             _In_ size_t p_max_write_queue,
+                             _In_ const w_session_limits &p_limits,
+                             _In_ std::shared_ptr<w_tls_context> p_tls,
+                             _In_ std::shared_ptr<w_server_metrics>
+                                 p_server_metrics) noexcept
+    : _socket(std::move(p_socket)),
+      _conn_id(std::move(p_conn_id)),
+      _max_write_queue(std::max<size_t>(1, p_max_write_queue)),
+      _high_watermark(p_limits.write_high_watermark),
+      _low_watermark(std::min(p_limits.write_low_watermark,
+                              p_limits.write_high_watermark)),
+      _read_limiter(p_limits),
+      _server_metrics(std::move(p_server_metrics)),
+      _tls(std::move(p_tls)),
+      _reader_signal(_socket.get_executor(), steady_clock::time_point::max()),
+      _writer_signal(_socket.get_executor(), steady_clock::time_point::max()),
+      _idle_timer(w_timer_wheel::get(_socket.get_executor()), [this]() {
+        // the wheel is locked, so close the session on its own executor. a
+        // session which is being destroyed waits for the lock in the
+        // destructor of the timer, so it can not be locked here
+        if (auto _self = weak_from_this().lock()) {
+          const auto _executor = this->_socket.get_executor();
+          boost::asio::post(_executor, [_self = std::move(_self)]() {
+            _self->_on_idle_timeout();
+          });
+        }
+      }) {
+  if (this->_server_metrics != nullptr) {
+    this->_server_metrics->local().active_sessions.fetch_add(
+        1, std::memory_order_relaxed);
+  }
+}
+
+w_tcp_session::~w_tcp_session() noexcept {
+  if (this->_server_metrics != nullptr) {
+    auto &_shard = this->_server_metrics->local();
+    _shard.active_sessions.fetch_sub(1, std::memory_order_relaxed);
+    _shard.queued_buffers.fetch_sub(
+        gsl::narrow_cast<int64_t>(this->_queue.size()),
+        std::memory_order_relaxed);
+  }
+}
+
+bool w_tcp_session::send(_In_ w_buffer p_buffer) {
+  if (p_buffer.empty()) {
+    return true;
+  }
+
+  {
+    std::scoped_lock _lock(this->_mutex);
+    if (this->_state != state::OPEN) {
+      return false;
+    }
+    if (this->_queue.size() >= this->_max_write_queue) {
+      this->_metrics.sends_dropped.fetch_add(1, std::memory_order_relaxed);
+      if (this->_server_metrics != nullptr) {
+        this->_server_metrics->local().sends_dropped.fetch_add(
+            1, std::memory_order_relaxed);
+      }
+      return false;
+    }
+    this->_queue_bytes += p_buffer.size();
+    this->_queue.push_back(std::move(p_buffer));
+    _count_queue(1);
+    if (!this->_writer_waiting) {
+      return true;
+    }
+    this->_writer_waiting = false;
+    if (s_reading_session == this) {
+      this->_writer_wake_pending = true;
+      return true;
+    }
+  }
+  _notify(this->_writer_signal);
+  return true;
+}
+
+bool w_tcp_session::send_frame(_In_ gsl::span<const std::byte> p_payload) {
+  if (this->_codec == nullptr) {
+    return false;
+  }
+
+  auto _sent = false;
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        BOOST_LEAF_AUTO(_frame, this->_codec->encode(p_payload));
+        _sent = send(std::move(_frame));
+        return {};
+      },
+      [] {});
+  return _sent;
+}
+
+void w_tcp_session::close() {
+  {
+    std::scoped_lock _lock(this->_mutex);
+    if (this->_state != state::OPEN) {
+      return;
+    }
+    this->_state = state::CLOSING;
+    this->_reader_waiting = false;
+    this->_writer_waiting = false;
+  }
+  // the writer drains the queue and then closes the socket
+  boost::asio::post(this->_socket.get_executor(),
+                    [_self = shared_from_this()]() {
+                      _self->_reader_signal.cancel();
+                      _self->_writer_signal.cancel();
+                    });
+}
+
+size_t w_tcp_session::get_write_queue_size() const {
+  std::scoped_lock _lock(this->_mutex);
+  return this->_queue.size();
+}
+
+size_t w_tcp_session::get_write_queue_bytes() const {
+  std::scoped_lock _lock(this->_mutex);
+  return this->_queue_bytes;
+}
+
+bool w_tcp_session::is_open() const {
+  std::scoped_lock _lock(this->_mutex);
+  return this->_state == state::OPEN;
+}
+
+void w_tcp_session::_notify(_Inout_ boost::asio::steady_timer &p_signal) {
+  boost::asio::post(
+      this->_socket.get_executor(),
+      [_self = shared_from_this(), &p_signal]() { p_signal.cancel(); });
+}
+
+bool w_tcp_session::_must_pause_reader() const noexcept {
+  return this->_queue.size() >= this->_max_write_queue ||
+         (this->_high_watermark != 0 &&
+          this->_queue_bytes >= this->_high_watermark);
+}
+
+bool w_tcp_session::_can_resume_reader() const noexcept {
+  // between the watermarks the reader keeps its state, so it does not flip
+  // on every buffer the writer drains
+  return this->_queue.size() < this->_max_write_queue &&
+         (this->_high_watermark == 0 ||
+          this->_queue_bytes <= this->_low_watermark);
+}
+
+void w_tcp_session::_refresh_idle_timer(
+    _In_ steady_clock::duration p_extra) {
+  if (this->_idle_timeout > steady_clock::duration::zero()) {
+    this->_idle_timer.expires_after(this->_idle_timeout + p_extra);
+  }
+}
+
+void w_tcp_session::_count_queue(_In_ int64_t p_change) noexcept {
+  const auto _depth = gsl::narrow_cast<uint64_t>(this->_queue.size());
+  this->_metrics.write_queue_depth.store(_depth, std::memory_order_relaxed);
+  auto &_peak = this->_metrics.write_queue_peak;
+  if (_depth > _peak.load(std::memory_order_relaxed)) {
+    _peak.store(_depth, std::memory_order_relaxed);
+  }
+  if (this->_server_metrics != nullptr && p_change != 0) {
+    this->_server_metrics->local().queued_buffers.fetch_add(
+        p_change, std::memory_order_relaxed);
+  }
+}
+
+void w_tcp_session::_on_idle_timeout() noexcept {
+  // the pending receive or write fails and reports the timeout
+  this->_timed_out = true;
+  boost::system::error_code _ignore;
+  std::ignore = this->_socket.cancel(_ignore);
+  this->_reader_signal.cancel();
+  this->_writer_signal.cancel();
+}
+
+void w_tcp_session::_on_error(
+    _In_ const w_session_on_error_callback &p_on_error_callback,
+    _In_ const boost::system::system_error &p_error) noexcept {
+  // the reader and the writer may both fail, only the first one reports
+  if (is_open()) {
+    const auto &_error = this->_timed_out ? s_timed_out_error() : p_error;
+    this->_metrics.errors.record(_error.code());
+    if (this->_server_metrics != nullptr) {
+      this->_server_metrics->local().errors.record(_error.code());
+    }
+    p_on_error_callback(this->_conn_id, _error);
+  }
+  _abort();
+}
+
+void w_tcp_session::_abort() noexcept {
+  this->_idle_timer.cancel();
+  {
+    std::scoped_lock _lock(this->_mutex);
+    this->_state = state::CLOSED;
+    const auto _dropped = gsl::narrow_cast<int64_t>(this->_queue.size());
+    this->_queue.clear();
+    this->_queue_bytes = 0;
+    _count_queue(-_dropped);
+    this->_reader_waiting = false;
+    this->_writer_waiting = false;
+  }
+  this->_reader_signal.cancel();
+  this->_writer_signal.cancel();
+
+  boost::system::error_code _ignore;
+  std::ignore = this->_socket.close(_ignore);
+}
+
+boost::asio::awaitable<void> w_tcp_session::run(
+    _In_ steady_clock::duration p_timeout,
+    _In_ w_tcp_session_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  const auto _self = shared_from_this();
+  this->_idle_timeout = p_timeout;
+
+  w_buffer _buffer(W_MAX_BUFFER_SIZE);
+  const auto _prepare = [&](_In_ size_t p_available) {
+    // the previous buffer may still be queued, so reset gets a new storage
+    _buffer.reset(std::max(p_available, _buffer.capacity()));
+    return boost::asio::buffer(_buffer.data(), _buffer.capacity());
+  };
+  const auto _on_receive = [&](_In_ size_t p_bytes) {
+    _buffer.resize(p_bytes);
+    this->_metrics.messages_read.fetch_add(1, std::memory_order_relaxed);
+    return p_on_data_callback(*this, _buffer);
+  };
+
+  if (this->_tls != nullptr && !co_await _handshake(p_on_error_callback)) {
+    co_return;
+  }
+  boost::asio::co_spawn(this->_socket.get_executor(),
+                        _write(p_on_error_callback), boost::asio::detached);
+  co_await _read(_prepare, _on_receive, p_on_error_callback);
+}
+
+boost::asio::awaitable<void> w_tcp_session::run(
+    _In_ steady_clock::duration p_timeout,
+    _In_ std::shared_ptr<const w_frame_codec> p_codec,
+    _In_ w_tcp_session_on_frame_callback p_on_frame_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  const auto _self = shared_from_this();
+  this->_idle_timeout = p_timeout;
+  this->_codec = p_codec;
+
+  w_frame_reader _reader(std::move(p_codec));
+  const auto _prepare = [&](_In_ size_t p_available) {
+    const auto _space =
+        _reader.prepare(std::max<size_t>(p_available, W_MAX_BUFFER_SIZE));
+    return boost::asio::buffer(_space.data(), _space.size());
+  };
+  const auto _on_receive = [&](_In_ size_t p_bytes) {
+    _reader.commit(p_bytes);
+
+    // all frames of a receive go to the callback before the next receive
+    auto _res = boost::system::errc::success;
+    boost::leaf::try_handle_all(
+        [&]() -> boost::leaf::result<void> {
+          BOOST_LEAF_CHECK(
+              _reader.read_frames([&](_In_ gsl::span<const std::byte> p_frame) {
+                this->_metrics.messages_read.fetch_add(
+                    1, std::memory_order_relaxed);
+                _res = p_on_frame_callback(*this, p_frame);
+                return _res == boost::system::errc::success;
+              }));
+          return {};
+        },
+        [&] { _res = boost::system::errc::bad_message; });
+    return _res;
+  };
+
+  if (this->_tls != nullptr && !co_await _handshake(p_on_error_callback)) {
+    co_return;
+  }
+  boost::asio::co_spawn(this->_socket.get_executor(),
+                        _write(p_on_error_callback), boost::asio::detached);
+  co_await _read(_prepare, _on_receive, p_on_error_callback);
+}
+
+boost::asio::awaitable<void> w_tcp_session::_read(
+    _In_ const prepare_handler &p_prepare,
+    _In_ const receive_handler &p_on_receive,
+    _In_ const w_session_on_error_callback &p_on_error_callback) noexcept {
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    if (this->_timed_out) {
+      // the timeout woke up a paused or a throttled reader
+      _on_error(p_on_error_callback, s_timed_out_error());
+      break;
+    }
+
+    auto _wait = false;
+    {
+      std::scoped_lock _lock(this->_mutex);
+      if (this->_state != state::OPEN) {
+        break;
+      }
+      if (_must_pause_reader()) {
+        this->_reader_waiting = true;
+        _wait = true;
+      }
+    }
+
+    if (_wait) {
+      this->_metrics.read_pauses.fetch_add(1, std::memory_order_relaxed);
+      // stop reading until the writer drains the queue, so a peer which does
+      // not read its responses can not grow the queue without a limit
+      boost::system::error_code _ignore;
+      this->_reader_signal.expires_at(steady_clock::time_point::max());
+      co_await this->_reader_signal.async_wait(
+          boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+      continue;
+    }
+
+    _refresh_idle_timer();
+
+    try {
+      size_t _bytes = 0;
+      if (this->_tls == nullptr) {
+        // wait for the socket to become readable, then size the buffer to
+        // the bytes which are already queued, so a big message costs one
+        // receive
+        co_await this->_socket.async_wait(tcp::socket::wait_read,
+                                          boost::asio::use_awaitable);
+        const auto _buffer = p_prepare(this->_socket.available());
+        _bytes = co_await this->_socket.async_receive(
+            _buffer, boost::asio::use_awaitable);
+      } else {
+        _bytes = co_await _tls_receive(p_prepare);
+      }
+      // the profiled scope ends before the throttle, so it only covers the
+      // callback and it ends on the thread which started it
+      uint64_t _received = 0;
+      {
+        W_PROFILE_SCOPE("w_tcp_server::session");
+
+        this->_metrics.bytes_read.fetch_add(_bytes,
+                                            std::memory_order_relaxed);
+        const auto _messages =
+            this->_metrics.messages_read.load(std::memory_order_relaxed);
+
+        // call callback
+        s_reading_session = this;
+        const auto _started = steady_clock::now();
+        const auto _res = p_on_receive(_bytes);
+        const auto _latency = steady_clock::now() - _started;
+        s_reading_session = nullptr;
+
+        _received =
+            this->_metrics.messages_read.load(std::memory_order_relaxed) -
+            _messages;
+        this->_metrics.callback_latency.record(_latency);
+        if (this->_server_metrics != nullptr) {
+          auto &_shard = this->_server_metrics->local();
+          _shard.bytes_read.fetch_add(_bytes, std::memory_order_relaxed);
+          _shard.messages_read.fetch_add(_received,
+                                         std::memory_order_relaxed);
+          _shard.callback_latency.record(_latency);
+        }
+
+        auto _wake_writer = false;
+        {
+          std::scoped_lock _lock(this->_mutex);
+          _wake_writer = std::exchange(this->_writer_wake_pending, false);
+        }
+        if (_wake_writer) {
+          this->_writer_signal.cancel();
+        }
+
+        if (_res == boost::system::errc::bad_message) {
+          // the stream can not be framed anymore
+          throw boost::system::system_error(
+              boost::system::errc::make_error_code(_res));
+        }
+        if (_res == boost::system::errc::connection_aborted) {
+          close();
+          break;
+        }
+      }
+
+      const auto _delay = this->_read_limiter.take(_bytes, _received);
+      if (_delay > steady_clock::duration::zero()) {
+        // the peer sends faster than its limits, so wait before the next
+        // receive. close wakes the reader up early
+        this->_metrics.read_throttles.fetch_add(1, std::memory_order_relaxed);
+        this->_metrics.read_throttled_ns.fetch_add(
+            gsl::narrow_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(_delay)
+                    .count()),
+            std::memory_order_relaxed);
+        _refresh_idle_timer(_delay);
+        boost::system::error_code _ignore;
+        this->_reader_signal.expires_after(_delay);
+        co_await this->_reader_signal.async_wait(
+            boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+      }
+    } catch (const boost::system::system_error &p_ex) {
+      s_reading_session = nullptr;
+      _on_error(p_on_error_callback, p_ex);
+      break;
+    }
+  }
+}
+
+boost::asio::awaitable<void> w_tcp_session::_write(
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  // the writer may outlive the reader
+  const auto _self = shared_from_this();
+
+  std::vector<w_buffer> _batch;
+  std::vector<boost::asio::const_buffer> _buffers;
+  _batch.reserve(MAX_GATHER_BUFFERS);
+  _buffers.reserve(MAX_GATHER_BUFFERS);
+
+  auto _drained = false;
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    auto _done = false;
+    auto _wake_reader = false;
+    {
+      std::scoped_lock _lock(this->_mutex);
+      const auto _count = std::min(this->_queue.size(), MAX_GATHER_BUFFERS);
+      for (size_t i = 0; i < _count; ++i) {
+        this->_queue_bytes -= this->_queue.front().size();
+        _batch.push_back(std::move(this->_queue.front()));
+        this->_queue.pop_front();
+      }
+      _count_queue(-gsl::narrow_cast<int64_t>(_count));
+      if (_batch.empty()) {
+        if (this->_state != state::OPEN) {
+          _done = true;
+        } else {
+          this->_writer_waiting = true;
+        }
+      }
+      if (this->_reader_waiting && _can_resume_reader()) {
+        this->_reader_waiting = false;
+        _wake_reader = true;
+      }
+    }
+
+    if (_wake_reader) {
+      this->_reader_signal.cancel();
+    }
+    if (_done) {
+      _drained = true;
+      break;
+    }
+    if (_batch.empty()) {
+      boost::system::error_code _ignore;
+      this->_writer_signal.expires_at(steady_clock::time_point::max());
+      co_await this->_writer_signal.async_wait(
+          boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+      continue;
+    }
+
+    for (const auto &_buffer : _batch) {
+      _buffers.emplace_back(_buffer.data(), _buffer.size());
+    }
+
+    try {
+      // one gathered write for all queued buffers
+      size_t _bytes = 0;
+      if (this->_tls == nullptr) {
+        _bytes = co_await boost::asio::async_write(
+            this->_socket, _buffers, boost::asio::use_awaitable);
+      } else {
+        _bytes = co_await _tls_send(_buffers);
+      }
+      this->_metrics.bytes_written.fetch_add(_bytes,
+                                             std::memory_order_relaxed);
+      this->_metrics.messages_written.fetch_add(_batch.size(),
+                                                std::memory_order_relaxed);
+      if (this->_server_metrics != nullptr) {
+        auto &_shard = this->_server_metrics->local();
+        _shard.bytes_written.fetch_add(_bytes, std::memory_order_relaxed);
+        _shard.messages_written.fetch_add(_batch.size(),
+                                          std::memory_order_relaxed);
+      }
+      _refresh_idle_timer();
+    } catch (const boost::system::system_error &p_ex) {
+      _on_error(p_on_error_callback, p_ex);
+      break;
+    }
+
+    _batch.clear();
+    _buffers.clear();
+  }
+
+  // the queue was drained after close, so close the connection. the idle
+  // timeout still covers the close_notify of tls
+  if (_drained && this->_tls != nullptr) {
+    _refresh_idle_timer();
+    co_await _tls_shutdown();
+  }
+  this->_idle_timer.cancel();
+  boost::system::error_code _ignore;
+  std::ignore = this->_socket.shutdown(tcp::socket::shutdown_both, _ignore);
+  std::ignore = this->_socket.close(_ignore);
+
+  std::scoped_lock _lock(this->_mutex);
+  this->_state = state::CLOSED;
+}
+
+boost::asio::awaitable<bool> w_tcp_session::_handshake(
+    _In_ const w_session_on_error_callback &p_on_error_callback) noexcept {
+#ifdef WOLF_SYSTEM_SSL
+  // the idle timeout covers the handshake, so a peer can not stall it
+  _refresh_idle_timer();
+  try {
+    auto &_context = this->_tls->get_context();
+    if (this->_tls->use_ktls()) {
+      // openssl uses the socket by itself, so it can hand the keys of the
+      // session to the kernel once the handshake is done
+      this->_ssl.reset(SSL_new(_context.native_handle()));
+      if (this->_ssl == nullptr) {
+        throw s_ssl_error(SSL_ERROR_SSL);
+      }
+      this->_socket.non_blocking(true);
+      SSL_set_fd(this->_ssl.get(),
+                 gsl::narrow_cast<int>(this->_socket.native_handle()));
+      SSL_set_mode(this->_ssl.get(), SSL_MODE_ENABLE_PARTIAL_WRITE |
+                                         SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+      SSL_set_accept_state(this->_ssl.get());
+      co_await _ssl_call(
+          [this]() { return SSL_do_handshake(this->_ssl.get()); });
+      this->_tls->count_handshake(this->_ssl.get());
+    } else {
+      this->_tls_stream = std::make_unique<
+          boost::asio::ssl::stream<boost::asio::ip::tcp::socket &>>(
+          this->_socket, _context);
+      co_await this->_tls_stream->async_handshake(
+          boost::asio::ssl::stream_base::server, boost::asio::use_awaitable);
+      this->_tls->count_handshake(this->_tls_stream->native_handle());
+    }
+    co_return true;
+  } catch (const boost::system::system_error &p_ex) {
+    this->_tls->count_handshake(nullptr);
+    _on_error(p_on_error_callback, p_ex);
+  }
+#endif
+  co_return false;
+}
+
+boost::asio::awaitable<size_t> w_tcp_session::_tls_receive(
+    _In_ const prepare_handler &p_prepare) {
+#ifdef WOLF_SYSTEM_SSL
+  // the bytes of the socket hint at the size of the next record, openssl
+  // returns the records which it read before without a wait
+  boost::system::error_code _ignore;
+  const auto _buffer = p_prepare(this->_socket.available(_ignore));
+  if (this->_tls_stream != nullptr) {
+    co_return co_await this->_tls_stream->async_read_some(
+        _buffer, boost::asio::use_awaitable);
+  }
+
+  size_t _bytes = 0;
+  co_await _ssl_call([&]() {
+    return SSL_read_ex(this->_ssl.get(), _buffer.data(), _buffer.size(),
+                       &_bytes);
+  });
+  co_return _bytes;
+#else
+  co_return 0;
+#endif
+}
+
+boost::asio::awaitable<size_t> w_tcp_session::_tls_send(
+    _In_ const std::vector<boost::asio::const_buffer> &p_buffers) {
+#ifdef WOLF_SYSTEM_SSL
+  auto _buffer = p_buffers.front();
+  if (p_buffers.size() > 1) {
+    this->_tls_scratch.clear();
+    for (const auto &_part : p_buffers) {
+      const auto *_data = static_cast<const std::byte *>(_part.data());
+      this->_tls_scratch.insert(this->_tls_scratch.end(), _data,
+                                _data + _part.size());
+    }
+    _buffer = boost::asio::buffer(this->_tls_scratch);
+  }
+
+  size_t _written = 0;
+  if (this->_tls_stream != nullptr) {
+    _written = co_await boost::asio::async_write(
+        *this->_tls_stream, _buffer, boost::asio::use_awaitable);
+  } else {
+#ifdef __clang__
+#pragma unroll
+#endif
+    while (_written < _buffer.size()) {
+      size_t _bytes = 0;
+      co_await _ssl_call([&]() {
+        return SSL_write_ex(
+            this->_ssl.get(),
+            static_cast<const std::byte *>(_buffer.data()) + _written,
+            _buffer.size() - _written, &_bytes);
+      });
+      _written += _bytes;
+    }
+  }
+
+  if (this->_tls_scratch.capacity() > s_max_tls_scratch) {
+    this->_tls_scratch = {};
+  }
+  co_return _written;
+#else
+  co_return 0;
+#endif
+}
+
+boost::asio::awaitable<void> w_tcp_session::_tls_shutdown() noexcept {
+#ifdef WOLF_SYSTEM_SSL
+  // send the close_notify, but do not wait for the one of the peer
+  if (this->_tls_stream != nullptr) {
+    auto *_ssl = this->_tls_stream->native_handle();
+    SSL_set_shutdown(_ssl, SSL_get_shutdown(_ssl) | SSL_RECEIVED_SHUTDOWN);
+    boost::system::error_code _ignore;
+    co_await this->_tls_stream->async_shutdown(
+        boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+  } else if (this->_ssl != nullptr) {
+    // the socket does not block, so this is one try
+    std::ignore = SSL_shutdown(this->_ssl.get());
+  }
+#endif
+  co_return;
+}
+
+#ifdef WOLF_SYSTEM_SSL
+boost::asio::awaitable<void> w_tcp_session::_ssl_call(
+    _In_ const std::function<int()> &p_call) {
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    ERR_clear_error();
+    const auto _res = p_call();
+    if (_res > 0) {
+      co_return;
+    }
+    const auto _error = SSL_get_error(this->_ssl.get(), _res);
+    if (_error == SSL_ERROR_WANT_READ) {
+      co_await this->_socket.async_wait(tcp::socket::wait_read,
+                                        boost::asio::use_awaitable);
+    } else if (_error == SSL_ERROR_WANT_WRITE) {
+      co_await this->_socket.async_wait(tcp::socket::wait_write,
+                                        boost::asio::use_awaitable);
+    } else {
+      throw s_ssl_error(_error);
+    }
+  }
+}
+#endif
+
+#endif  // WOLF_SYSTEM_SOCKET
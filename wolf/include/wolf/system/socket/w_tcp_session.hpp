@@ -0,0 +1,222 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <wolf.hpp>
+
+#include "w_framing.hpp"
+#include "w_socket_options.hpp"
+#include "w_timer_wheel.hpp"
+#include "w_tls_context.hpp"
+
+namespace wolf::system::socket {
+
+class w_tcp_session;
+
+typedef std::function<boost::system::errc::errc_t(
+    _Inout_ w_tcp_session &p_session, _Inout_ w_buffer &p_mut_data)>
+    w_tcp_session_on_data_callback;
+
+typedef std::function<boost::system::errc::errc_t(
+    _Inout_ w_tcp_session &p_session,
+    _In_ gsl::span<const std::byte> p_frame)>
+    w_tcp_session_on_frame_callback;
+
+/*
+ * a full duplex tcp session. a reader coroutine calls the data callback for
+ * every receive and a writer coroutine drains a bounded queue of outgoing
+ * buffers, so a session may push data at any time and keep many responses in
+ * flight. queued buffers are coalesced into one gathered write. a session
+ * which neither receives nor writes for its timeout is closed, its timeout
+ * lives in the timer wheel of its io context. with a tls context the session
+ * runs the tls handshake first and encrypts all data.
+ */
+class w_tcp_session : public std::enable_shared_from_this<w_tcp_session> {
+ public:
+  // the maximum number of buffers of one gathered write
+  static constexpr size_t MAX_GATHER_BUFFERS = 64;
+
+  /*
+   * @param p_socket, the connected socket, which should have a strand executor
+   * if its io context is run by more than one thread
+   * @param p_conn_id, the connection id
+   * @param p_max_write_queue, the maximum number of queued buffers
+   * @param p_limits, the rate limits and the write watermarks of the reader
+   * @param p_tls, the tls context, or nullptr for plain tcp
+   * @param p_server_metrics, the optional counters of the server
+   */
+  W_API w_tcp_session(
+      _In_ boost::asio::ip::tcp::socket &&p_socket, _In_ std::string p_conn_id,
+      _In_ size_t p_max_write_queue, _In_ const w_session_limits &p_limits = {},
+      _In_ std::shared_ptr<w_tls_context> p_tls = nullptr,
+      _In_ std::shared_ptr<w_server_metrics> p_server_metrics =
+          nullptr) noexcept;
+
+  // destructor
+  W_API virtual ~w_tcp_session() noexcept;
+
+  /*
+   * queue a buffer for writing, it can be called from any thread. the buffer
+   * shares its storage, so it must not be modified after it was queued
+   * @param p_buffer, the buffer to write
+   * @returns false if the session is closing or the queue is full
+   */
+  W_API bool send(_In_ w_buffer p_buffer);
+
+  /*
+   * frame a payload with the codec of the session and queue it for writing
+   * @param p_payload, the payload
+   * @returns false if the session is not framed, closing or the queue is full
+   */
+  W_API bool send_frame(_In_ gsl::span<const std::byte> p_payload);
+
+  // write the queued buffers and close the session, it can be called from any
+  // thread
+  W_API void close();
+
+  // returns the connection id
+  W_API const std::string &get_id() const noexcept { return this->_conn_id; }
+
+  // returns the number of queued buffers
+  W_API size_t get_write_queue_size() const;
+
+  // returns the number of queued bytes
+  W_API size_t get_write_queue_bytes() const;
+
+  // returns the counters of the session
+  W_API const w_session_metrics &get_metrics() const noexcept {
+    return this->_metrics;
+  }
+
+  // returns true until close was called or the connection was lost
+  W_API bool is_open() const;
+
+  /*
+   * run the reader and the writer until the session is closed
+   * @param p_timeout, the idle timeout, which is disabled if it is not
+   * positive
+   * @param p_on_data_callback, on data callback for session
+   * @param p_on_error_callback, on error callback for session
+   */
+  W_API boost::asio::awaitable<void> run(
+      _In_ std::chrono::steady_clock::duration p_timeout,
+      _In_ w_tcp_session_on_data_callback p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run the reader and the writer until the session is closed. the reader
+   * reassembles the frames of the stream and calls the frame callback for
+   * every complete frame, a frame is only valid during the call
+   * @param p_timeout, the idle timeout, which is disabled if it is not
+   * positive
+   * @param p_codec, the framing codec
+   * @param p_on_frame_callback, on frame callback for session
+   * @param p_on_error_callback, on error callback for session
+   */
+  W_API boost::asio::awaitable<void> run(
+      _In_ std::chrono::steady_clock::duration p_timeout,
+      _In_ std::shared_ptr<const w_frame_codec> p_codec,
+      _In_ w_tcp_session_on_frame_callback p_on_frame_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+ private:
+  // copy constructor.
+  w_tcp_session(const w_tcp_session &) = delete;
+  // copy assignment operator.
+  w_tcp_session &operator=(const w_tcp_session &) = delete;
+  // move constructor.
+  w_tcp_session(w_tcp_session &&) = delete;
+  // move assignment operator.
+  w_tcp_session &operator=(w_tcp_session &&) = delete;
+
+  enum class state { OPEN, CLOSING, CLOSED };
+
+  // gets the number of readable bytes and returns the receive buffer
+  using prepare_handler =
+      std::function<boost::asio::mutable_buffer(_In_ size_t p_available)>;
+  // gets the number of received bytes and calls the user callbacks
+  using receive_handler =
+      std::function<boost::system::errc::errc_t(_In_ size_t p_bytes)>;
+
+  boost::asio::awaitable<void> _read(
+      _In_ const prepare_handler &p_prepare,
+      _In_ const receive_handler &p_on_receive,
+      _In_ const w_session_on_error_callback &p_on_error_callback) noexcept;
+  boost::asio::awaitable<void> _write(
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+  boost::asio::awaitable<bool> _handshake(
+      _In_ const w_session_on_error_callback &p_on_error_callback) noexcept;
+  boost::asio::awaitable<size_t> _tls_receive(
+      _In_ const prepare_handler &p_prepare);
+  boost::asio::awaitable<size_t> _tls_send(
+      _In_ const std::vector<boost::asio::const_buffer> &p_buffers);
+  boost::asio::awaitable<void> _tls_shutdown() noexcept;
+#ifdef WOLF_SYSTEM_SSL
+  // call openssl until the call did not wait for the socket
+  boost::asio::awaitable<void> _ssl_call(
+      _In_ const std::function<int()> &p_call);
+#endif
+  void _notify(_Inout_ boost::asio::steady_timer &p_signal);
+  bool _must_pause_reader() const noexcept;
+  bool _can_resume_reader() const noexcept;
+  void _refresh_idle_timer(_In_ std::chrono::steady_clock::duration p_extra =
+                               std::chrono::steady_clock::duration::zero());
+  void _on_idle_timeout() noexcept;
+  void _on_error(_In_ const w_session_on_error_callback &p_on_error_callback,
+                 _In_ const boost::system::system_error &p_error) noexcept;
+  void _abort() noexcept;
+  // the queue changed by a number of buffers, the mutex must be locked
+  void _count_queue(_In_ int64_t p_change) noexcept;
+
+  boost::asio::ip::tcp::socket _socket;
+  std::string _conn_id;
+  size_t _max_write_queue;
+  size_t _high_watermark;
+  size_t _low_watermark;
+  w_read_limiter _read_limiter;
+  w_session_metrics _metrics;
+  std::shared_ptr<w_server_metrics> _server_metrics;
+  std::shared_ptr<const w_frame_codec> _codec;
+
+  // the tls of the session is an asio stream over the socket, or with kTLS
+  // an ssl object which uses the socket by itself
+  std::shared_ptr<w_tls_context> _tls;
+#ifdef WOLF_SYSTEM_SSL
+  std::unique_ptr<boost::asio::ssl::stream<boost::asio::ip::tcp::socket &>>
+      _tls_stream;
+  std::unique_ptr<SSL, decltype(&SSL_free)> _ssl = {nullptr, &SSL_free};
+  // the buffers of a gathered write are copied into one, so openssl fills
+  // its records up instead of making a record per buffer
+  std::vector<std::byte> _tls_scratch;
+#endif
+
+  // the timers are never expired, a cancel wakes up the waiting coroutine
+  boost::asio::steady_timer _reader_signal;
+  boost::asio::steady_timer _writer_signal;
+
+  // the reader and the writer refresh the idle timer, which are on the
+  // executor of the socket just like the expiry of the timer
+  std::chrono::steady_clock::duration _idle_timeout = {};
+  w_timer_wheel::entry _idle_timer;
+  bool _timed_out = false;
+
+  mutable std::mutex _mutex;
+  std::deque<w_buffer> _queue;
+  size_t _queue_bytes = 0;
+  state _state = state::OPEN;
+  bool _reader_waiting = false;
+  bool _writer_waiting = false;
+  bool _writer_wake_pending = false;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,226 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_timer_wheel.hpp"
+
+using w_timer_wheel = wolf::system::socket::w_timer_wheel;
+using steady_clock = std::chrono::steady_clock;
+
+boost::asio::io_context::id w_timer_wheel::id;
+
+namespace {
+
+// the ticks which the levels cover, an entry beyond them waits in the last
+// level and moves down once its slot is due
+constexpr uint64_t s_max_ticks = uint64_t{1}
+                                 << (w_timer_wheel::SLOT_BITS *
+                                     w_timer_wheel::LEVELS);
+constexpr uint64_t s_slot_mask = w_timer_wheel::SLOTS - 1;
+
+}  // namespace
+
+w_timer_wheel::entry::entry(_Inout_ w_timer_wheel &p_wheel,
+                            _In_ std::function<void()> p_on_expired) noexcept
+    : _wheel(p_wheel), _on_expired(std::move(p_on_expired)) {}
+
+void w_timer_wheel::entry::expires_after(
+    _In_ steady_clock::duration p_timeout) {
+  std::scoped_lock _lock(this->_wheel._mutex);
+  if (this->_wheel._shutdown) {
+    return;
+  }
+
+  // round up, so the entry never expires before its timeout
+  const auto _tick =
+      std::chrono::duration_cast<steady_clock::duration>(TICK);
+  const auto _deadline =
+      steady_clock::now() + std::max(p_timeout, steady_clock::duration{0});
+  const auto _expiry = gsl::narrow_cast<uint64_t>(
+      (_deadline - this->_wheel._origin + _tick - steady_clock::duration{1}) /
+      _tick);
+
+  if (this->_slot != nullptr) {
+    if (_expiry >= this->_expiry) {
+      this->_expiry = _expiry;
+      return;
+    }
+    this->_wheel._unlink(*this);
+  }
+  this->_expiry = _expiry;
+  this->_wheel._link(*this);
+  this->_wheel._schedule();
+}
+
+void w_timer_wheel::entry::cancel() noexcept {
+  std::scoped_lock _lock(this->_wheel._mutex);
+  this->_wheel._unlink(*this);
+}
+
+w_timer_wheel::w_timer_wheel(_Inout_ boost::asio::io_context &p_io_context)
+    : boost::asio::io_context::service(p_io_context),
+      _timer(p_io_context),
+      _origin(steady_clock::now()) {}
+
+w_timer_wheel &w_timer_wheel::get(
+    _Inout_ boost::asio::io_context &p_io_context) {
+  return boost::asio::use_service<w_timer_wheel>(p_io_context);
+}
+
+w_timer_wheel &w_timer_wheel::get(
+    _In_ const boost::asio::any_io_executor &p_executor) {
+  // the sockets of wolf always run on an io context
+  auto &_context =
+      boost::asio::query(p_executor, boost::asio::execution::context);
+  return get(static_cast<boost::asio::io_context &>(_context));
+}
+
+size_t w_timer_wheel::size() const {
+  std::scoped_lock _lock(this->_mutex);
+  return this->_size;
+}
+
+void w_timer_wheel::shutdown() {
+  std::scoped_lock _lock(this->_mutex);
+  this->_shutdown = true;
+  for (auto &_slot : this->_slots) {
+    while (_slot != nullptr) {
+      _unlink(*_slot);
+    }
+  }
+  boost::system::error_code _ignore;
+  this->_timer.cancel(_ignore);
+}
+
+uint64_t w_timer_wheel::_now_tick() const noexcept {
+  return gsl::narrow_cast<uint64_t>((steady_clock::now() - this->_origin) /
+                                    TICK);
+}
+
+void w_timer_wheel::_link(_Inout_ entry &p_entry) noexcept {
+  if (this->_size == 0) {
+    // an empty wheel did not tick, so it starts from now
+    this->_current = _now_tick();
+  }
+
+  auto _expiry = std::max(p_entry._expiry, this->_current);
+  if (_expiry - this->_current >= s_max_ticks) {
+    _expiry = this->_current + s_max_ticks - 1;
+  }
+
+  size_t _level = 0;
+  const auto _delta = _expiry - this->_current;
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (_level + 1 < LEVELS &&
+         _delta >= (uint64_t{1} << (SLOT_BITS * (_level + 1)))) {
+    ++_level;
+  }
+  const auto _index = (_expiry >> (SLOT_BITS * _level)) & s_slot_mask;
+  auto &_head = this->_slots[_level * SLOTS + _index];
+
+  p_entry._prev = nullptr;
+  p_entry._next = _head;
+  if (_head != nullptr) {
+    _head->_prev = &p_entry;
+  }
+  _head = &p_entry;
+  p_entry._slot = &_head;
+  ++this->_size;
+}
+
+void w_timer_wheel::_unlink(_Inout_ entry &p_entry) noexcept {
+  if (p_entry._slot == nullptr) {
+    return;
+  }
+  if (p_entry._prev != nullptr) {
+    p_entry._prev->_next = p_entry._next;
+  } else {
+    *p_entry._slot = p_entry._next;
+  }
+  if (p_entry._next != nullptr) {
+    p_entry._next->_prev = p_entry._prev;
+  }
+  p_entry._prev = nullptr;
+  p_entry._next = nullptr;
+  p_entry._slot = nullptr;
+  --this->_size;
+}
+
+void w_timer_wheel::_cascade(_In_ size_t p_level,
+                             _In_ uint64_t p_tick) noexcept {
+  const auto _index = (p_tick >> (SLOT_BITS * p_level)) & s_slot_mask;
+  auto *_entry =
+      std::exchange(this->_slots[p_level * SLOTS + _index], nullptr);
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (_entry != nullptr) {
+    auto *_next = _entry->_next;
+    _entry->_slot = nullptr;
+    --this->_size;
+    _link(*_entry);
+    _entry = _next;
+  }
+}
+
+void w_timer_wheel::_expire(_In_ uint64_t p_tick) noexcept {
+  auto *_entry = std::exchange(this->_slots[p_tick & s_slot_mask], nullptr);
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (_entry != nullptr) {
+    auto *_next = _entry->_next;
+    _entry->_slot = nullptr;
+    _entry->_prev = nullptr;
+    _entry->_next = nullptr;
+    --this->_size;
+    if (_entry->_expiry > p_tick) {
+      // the entry was refreshed after it was linked
+      _link(*_entry);
+    } else {
+      _entry->_on_expired();
+    }
+    _entry = _next;
+  }
+}
+
+void w_timer_wheel::_schedule() noexcept {
+  if (this->_size == 0 || this->_scheduled || this->_shutdown) {
+    return;
+  }
+  this->_scheduled = true;
+  this->_timer.expires_at(this->_origin + this->_current * TICK);
+  this->_timer.async_wait(
+      [this](_In_ const boost::system::error_code &p_error) {
+        _on_tick(p_error);
+      });
+}
+
+void w_timer_wheel::_on_tick(
+    _In_ const boost::system::error_code &p_error) noexcept {
+  if (p_error) {
+    return;
+  }
+
+  std::scoped_lock _lock(this->_mutex);
+  this->_scheduled = false;
+  const auto _now = _now_tick();
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (this->_current <= _now && this->_size != 0) {
+    const auto _tick = this->_current;
+    // a level moves down when the level below it wrapped around
+    for (size_t _level = 1; _level < LEVELS; ++_level) {
+      if (((_tick >> (SLOT_BITS * (_level - 1))) & s_slot_mask) != 0) {
+        break;
+      }
+      _cascade(_level, _tick);
+    }
+    _expire(_tick);
+    ++this->_current;
+  }
+  _schedule();
+}
+
+#endif  // WOLF_SYSTEM_SOCKET
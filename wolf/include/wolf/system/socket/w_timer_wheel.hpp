@@ -0,0 +1,150 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <wolf.hpp>
+
+#include "w_socket_options.hpp"
+
+namespace wolf::system::socket {
+
+/*
+ * a hierarchical timing wheel which is shared by all timeouts of an io
+ * context. it has four levels of 64 slots, a slot of the first level is one
+ * tick and a slot of every next level covers the whole level before it. an
+ * entry is linked into one slot, so arming and canceling it is O(1) and a
+ * tick only touches the entries which are due or move one level down.
+ * instead of a steady_timer per session, the wheel runs one steady_timer
+ * while it has entries.
+ */
+class w_timer_wheel : public boost::asio::io_context::service {
+ public:
+  // the key of the service
+  W_API static boost::asio::io_context::id id;
+
+  // the resolution of the wheel, a timeout fires up to a tick late
+  static constexpr auto TICK = std::chrono::milliseconds(100);
+  static constexpr size_t LEVELS = 4;
+  static constexpr size_t SLOT_BITS = 6;
+  static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+
+  /*
+   * a timeout which is usually a member of a session, so arming it does not
+   * allocate. it is canceled when it is destroyed.
+   */
+  class entry {
+   public:
+    /*
+     * @param p_wheel, the wheel of the io context
+     * @param p_on_expired, called on the thread of the io context while the
+     * wheel is locked, so it must not arm or cancel an entry, e.g. it should
+     * post the work to the executor of the session
+     */
+    W_API entry(_Inout_ w_timer_wheel &p_wheel,
+                _In_ std::function<void()> p_on_expired) noexcept;
+
+    // destructor
+    W_API ~entry() noexcept { cancel(); }
+
+    /*
+     * arm the entry or move its expiry. moving it later only stores the new
+     * expiry, the wheel moves the entry when its old slot is due, so a
+     * session may refresh its timeout on every read for the cost of a lock
+     * @param p_timeout, the time from now
+     */
+    W_API void expires_after(
+        _In_ std::chrono::steady_clock::duration p_timeout);
+
+    // disarm the entry
+    W_API void cancel() noexcept;
+
+   private:
+    // copy constructor.
+    entry(const entry &) = delete;
+    // copy assignment operator.
+    entry &operator=(const entry &) = delete;
+    // move constructor.
+    entry(entry &&) = delete;
+    // move assignment operator.
+    entry &operator=(entry &&) = delete;
+
+    friend class w_timer_wheel;
+
+    w_timer_wheel &_wheel;
+    std::function<void()> _on_expired;
+    // guarded by the mutex of the wheel
+    entry *_prev = nullptr;
+    entry *_next = nullptr;
+    entry **_slot = nullptr;
+    uint64_t _expiry = 0;
+  };
+
+  /*
+   * @param p_io_context, the io context which owns the service
+   */
+  W_API explicit w_timer_wheel(_Inout_ boost::asio::io_context &p_io_context);
+
+  // destructor
+  W_API ~w_timer_wheel() noexcept override = default;
+
+  /*
+   * get the wheel of an io context, it is created on first use
+   * @param p_io_context, the io context
+   * @returns the wheel
+   */
+  W_API static w_timer_wheel &get(
+      _Inout_ boost::asio::io_context &p_io_context);
+
+  /*
+   * get the wheel of the io context of an executor, e.g. of a socket
+   * @param p_executor, an executor of an io context
+   * @returns the wheel
+   */
+  W_API static w_timer_wheel &get(
+      _In_ const boost::asio::any_io_executor &p_executor);
+
+  // returns the number of armed entries
+  W_API size_t size() const;
+
+ private:
+  // copy constructor.
+  w_timer_wheel(const w_timer_wheel &) = delete;
+  // copy assignment operator.
+  w_timer_wheel &operator=(const w_timer_wheel &) = delete;
+  // move constructor.
+  w_timer_wheel(w_timer_wheel &&) = delete;
+  // move assignment operator.
+  w_timer_wheel &operator=(w_timer_wheel &&) = delete;
+
+  void shutdown() override;
+
+  uint64_t _now_tick() const noexcept;
+  void _link(_Inout_ entry &p_entry) noexcept;
+  void _unlink(_Inout_ entry &p_entry) noexcept;
+  void _cascade(_In_ size_t p_level, _In_ uint64_t p_tick) noexcept;
+  void _expire(_In_ uint64_t p_tick) noexcept;
+  void _schedule() noexcept;
+  void _on_tick(_In_ const boost::system::error_code &p_error) noexcept;
+
+  mutable std::mutex _mutex;
+  boost::asio::steady_timer _timer;
+  std::chrono::steady_clock::time_point _origin;
+  // the next tick which is expired
+  uint64_t _current = 0;
+  size_t _size = 0;
+  bool _scheduled = false;
+  bool _shutdown = false;
+  std::array<entry *, LEVELS * SLOTS> _slots = {};
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,274 @@
+#if defined(WOLF_SYSTEM_SOCKET) && defined(WOLF_SYSTEM_SSL)
+
+#include "w_tls_context.hpp"
+
+#include <cstring>
+
+// NOLINTBEGIN
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : ALL_CODE_ANALYSIS_WARNINGS)
+#endif
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+// NOLINTEND
+
+using w_tls_context = wolf::system::socket::w_tls_context;
+using w_tls_options = wolf::system::socket::w_tls_options;
+using w_tls_cipher_preference = wolf::system::socket::w_tls_cipher_preference;
+using steady_clock = std::chrono::steady_clock;
+using ssl_context = boost::asio::ssl::context;
+
+namespace {
+
+// the tls 1.3 suites and the tls 1.2 ciphers, both with forward secrecy
+constexpr auto s_aes_suites =
+    "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384:"
+    "TLS_CHACHA20_POLY1305_SHA256";
+constexpr auto s_chacha_suites =
+    "TLS_CHACHA20_POLY1305_SHA256:TLS_AES_128_GCM_SHA256:"
+    "TLS_AES_256_GCM_SHA384";
+constexpr auto s_aes_ciphers =
+    "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:"
+    "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384:"
+    "ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305";
+constexpr auto s_chacha_ciphers =
+    "ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305:"
+    "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:"
+    "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384";
+
+// the index of the w_tls_context of an SSL_CTX, the app data of an SSL_CTX
+// belongs to asio
+int s_ex_data_index() noexcept {
+  static const int _index =
+      SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  return _index;
+}
+
+}  // namespace
+
+namespace wolf::system::socket {
+
+// encrypts and decrypts the session tickets with the keys of the context
+struct tls_ticket_callback {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  static int call(_In_ SSL *p_ssl, _Inout_ unsigned char *p_key_name,
+                  _Inout_ unsigned char *p_iv,
+                  _Inout_ EVP_CIPHER_CTX *p_cipher,
+                  _Inout_ EVP_MAC_CTX *p_mac, _In_ int p_encrypt) noexcept {
+    auto *_self = static_cast<w_tls_context *>(
+        SSL_CTX_get_ex_data(SSL_get_SSL_CTX(p_ssl), s_ex_data_index()));
+    if (_self == nullptr) {
+      return -1;
+    }
+
+    std::scoped_lock _lock(_self->_ticket_mutex);
+    if (!_self->_rotate_ticket_keys()) {
+      return -1;
+    }
+
+    const w_tls_context::ticket_key *_key = nullptr;
+    auto _result = 1;
+    if (p_encrypt == 1) {
+      _key = &_self->_ticket_key;
+      std::memcpy(p_key_name, _key->name.data(), _key->name.size());
+      if (RAND_bytes(p_iv, EVP_MAX_IV_LENGTH) != 1 ||
+          EVP_EncryptInit_ex(p_cipher, EVP_aes_256_cbc(), nullptr,
+                             _key->aes_key.data(), p_iv) != 1) {
+        return -1;
+      }
+    } else {
+      // a key which was not made yet has no name
+      const auto _is = [p_key_name](_In_ const auto &p_key) {
+        return p_key.created != steady_clock::time_point{} &&
+               std::memcmp(p_key_name, p_key.name.data(),
+                           p_key.name.size()) == 0;
+      };
+      if (_is(_self->_ticket_key)) {
+        _key = &_self->_ticket_key;
+      } else if (_is(_self->_previous_ticket_key)) {
+        // the ticket is still valid, but the client gets a new one
+        _key = &_self->_previous_ticket_key;
+        _result = 2;
+      } else {
+        // the ticket is older than the keys, so a full handshake follows
+        return 0;
+      }
+      if (EVP_DecryptInit_ex(p_cipher, EVP_aes_256_cbc(), nullptr,
+                             _key->aes_key.data(), p_iv) != 1) {
+        return -1;
+      }
+    }
+
+    char _digest[] = "SHA256";
+    OSSL_PARAM _params[] = {
+        OSSL_PARAM_construct_octet_string(
+            OSSL_MAC_PARAM_KEY,
+            const_cast<unsigned char *>(_key->hmac_key.data()),
+            _key->hmac_key.size()),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, _digest, 0),
+        OSSL_PARAM_construct_end()};
+    if (EVP_MAC_CTX_set_params(p_mac, _params) != 1) {
+      return -1;
+    }
+    return _result;
+  }
+#endif
+};
+
+}  // namespace wolf::system::socket
+
+w_tls_context::w_tls_context(_In_ ssl_context &&p_context,
+                             _In_ const w_tls_options &p_options) noexcept
+    : _context(std::move(p_context)),
+      _session_timeout(p_options.session_timeout),
+      _ktls(p_options.ktls) {}
+
+w_tls_context::~w_tls_context() noexcept {
+  SSL_CTX_set_ex_data(this->_context.native_handle(), s_ex_data_index(),
+                      nullptr);
+}
+
+boost::leaf::result<std::shared_ptr<w_tls_context>> w_tls_context::make(
+    _In_ const w_tls_options &p_options) noexcept {
+#ifndef SSL_OP_ENABLE_KTLS
+  if (p_options.ktls) {
+    return W_FAILURE(std::errc::not_supported,
+                     "kTLS needs openssl 3.0 or newer");
+  }
+#endif
+
+  try {
+    ssl_context _context(ssl_context::tls_server);
+    _context.set_options(ssl_context::default_workarounds |
+                         ssl_context::no_sslv2 | ssl_context::no_sslv3 |
+                         ssl_context::no_tlsv1 | ssl_context::no_tlsv1_1 |
+                         ssl_context::single_dh_use);
+    _context.use_certificate_chain_file(
+        p_options.certificate_chain_file.string());
+    _context.use_private_key_file(p_options.private_key_file.string(),
+                                  ssl_context::pem);
+
+    auto *_handle = _context.native_handle();
+
+    // the server picks the cipher, so the client can not choose a slow one.
+    // with automatic, openssl only moves chacha20 up for a client which
+    // lists it first
+    const auto _chacha =
+        p_options.cipher_preference == w_tls_cipher_preference::chacha20;
+    if (SSL_CTX_set_ciphersuites(_handle,
+                                 _chacha ? s_chacha_suites : s_aes_suites) !=
+            1 ||
+        SSL_CTX_set_cipher_list(_handle,
+                                _chacha ? s_chacha_ciphers : s_aes_ciphers) !=
+            1) {
+      return W_FAILURE(std::errc::invalid_argument,
+                       "could not set the tls ciphers");
+    }
+    auto _ssl_options = uint64_t{SSL_OP_CIPHER_SERVER_PREFERENCE};
+    if (p_options.cipher_preference == w_tls_cipher_preference::automatic) {
+      _ssl_options |= SSL_OP_PRIORITIZE_CHACHA;
+    }
+    if (!p_options.session_tickets) {
+      // tls 1.3 then sends tickets which refer to the session cache
+      _ssl_options |= SSL_OP_NO_TICKET;
+    }
+#ifdef SSL_OP_ENABLE_KTLS
+    if (p_options.ktls) {
+      _ssl_options |= SSL_OP_ENABLE_KTLS;
+    }
+#endif
+    SSL_CTX_set_options(_handle, _ssl_options);
+
+    // one cache for the sessions of all threads, openssl locks it
+    constexpr unsigned char _session_id_context[] = "wolf";
+    SSL_CTX_set_session_cache_mode(_handle, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(_handle, p_options.session_cache_size);
+    SSL_CTX_set_timeout(_handle,
+                        gsl::narrow_cast<long>(
+                            p_options.session_timeout.count()));
+    SSL_CTX_set_session_id_context(_handle, _session_id_context,
+                                   sizeof(_session_id_context) - 1);
+    SSL_CTX_set_num_tickets(_handle, p_options.tickets_per_handshake);
+
+    auto _tls = std::shared_ptr<w_tls_context>(
+        new w_tls_context(std::move(_context), p_options));
+    if (p_options.session_tickets) {
+      BOOST_LEAF_CHECK(_tls->_init_ticket_keys());
+    }
+    return _tls;
+  } catch (const std::exception &p_ex) {
+    return W_FAILURE(
+        std::errc::operation_canceled,
+        "could not make the tls context because " + std::string(p_ex.what()));
+  }
+}
+
+void w_tls_context::count_handshake(_In_opt_ const SSL *p_ssl) noexcept {
+  if (p_ssl == nullptr) {
+    this->_metrics.failed_handshakes.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  this->_metrics.handshakes.fetch_add(1, std::memory_order_relaxed);
+  if (SSL_session_reused(p_ssl) == 1) {
+    this->_metrics.resumed_handshakes.fetch_add(1, std::memory_order_relaxed);
+  }
+  // openssl before 3.0 has no kTLS, and make refuses it there
+#ifdef SSL_OP_ENABLE_KTLS
+  if (BIO_get_ktls_send(SSL_get_wbio(p_ssl)) == 1) {
+    this->_metrics.ktls_send_sessions.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (BIO_get_ktls_recv(SSL_get_rbio(p_ssl)) == 1) {
+    this->_metrics.ktls_receive_sessions.fetch_add(1,
+                                                   std::memory_order_relaxed);
+  }
+#endif
+}
+
+boost::leaf::result<void> w_tls_context::_init_ticket_keys() noexcept {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  {
+    std::scoped_lock _lock(this->_ticket_mutex);
+    if (!_rotate_ticket_keys()) {
+      return W_FAILURE(std::errc::operation_canceled,
+                       "could not make the tls ticket keys");
+    }
+  }
+  auto *_handle = this->_context.native_handle();
+  SSL_CTX_set_ex_data(_handle, s_ex_data_index(), this);
+  SSL_CTX_set_tlsext_ticket_key_evp_cb(_handle, &tls_ticket_callback::call);
+#endif
+  // before openssl 3.0 the context keeps the keys which it made at start
+  return {};
+}
+
+bool w_tls_context::_rotate_ticket_keys() noexcept {
+  const auto _now = steady_clock::now();
+  if (this->_ticket_key.created != steady_clock::time_point{} &&
+      _now - this->_ticket_key.created < this->_session_timeout) {
+    return true;
+  }
+
+  ticket_key _key;
+  if (RAND_bytes(_key.name.data(), gsl::narrow_cast<int>(_key.name.size())) !=
+          1 ||
+      RAND_bytes(_key.aes_key.data(),
+                 gsl::narrow_cast<int>(_key.aes_key.size())) != 1 ||
+      RAND_bytes(_key.hmac_key.data(),
+                 gsl::narrow_cast<int>(_key.hmac_key.size())) != 1) {
+    return false;
+  }
+  _key.created = _now;
+  this->_previous_ticket_key = std::exchange(this->_ticket_key, _key);
+  return true;
+}
+
+#endif  // WOLF_SYSTEM_SOCKET && WOLF_SYSTEM_SSL
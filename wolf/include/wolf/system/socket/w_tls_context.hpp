@@ -0,0 +1,160 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#if defined(WOLF_SYSTEM_SOCKET) && defined(WOLF_SYSTEM_SSL)
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <wolf.hpp>
+
+// NOLINTBEGIN
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : ALL_CODE_ANALYSIS_WARNINGS)
+#endif
+
+#include <boost/asio/ssl.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+// NOLINTEND
+
+namespace wolf::system::socket {
+
+// the order of the aead ciphers which the server prefers
+enum class w_tls_cipher_preference {
+  // aes-gcm, unless the client puts chacha20 first, which a client without
+  // aes instructions does
+  automatic,
+  // aes-gcm, which is the fastest on cpus with aes-ni
+  aes_gcm,
+  // chacha20-poly1305, which is the fastest without aes instructions
+  chacha20
+};
+
+struct w_tls_options {
+  // the pem files of the certificate chain and its private key
+  std::filesystem::path certificate_chain_file;
+  std::filesystem::path private_key_file;
+  w_tls_cipher_preference cipher_preference =
+      w_tls_cipher_preference::automatic;
+  // the sessions which are kept in the server side cache, which resumes the
+  // sessions of tls 1.2 session ids and of tls 1.3 without tickets
+  long session_cache_size = 20480;
+  // how long a session can be resumed, the ticket keys rotate at this
+  // interval as well
+  std::chrono::seconds session_timeout = std::chrono::hours(2);
+  // resume the sessions by tickets, so the server keeps no state for them
+  bool session_tickets = true;
+  // the tickets which a tls 1.3 handshake sends, a client which reconnects
+  // one connection at a time needs only one
+  size_t tickets_per_handshake = 1;
+  // let the kernel encrypt and decrypt the records on linux, if it was built
+  // with kTLS. then openssl uses the socket by itself instead of an asio
+  // stream, so the records are sent without a copy to user space. a session
+  // whose cipher the kernel does not support falls back to user space
+  bool ktls = false;
+};
+
+/*
+ * the counters of a tls context, they are updated by all sessions of the
+ * context and can be read from any thread.
+ */
+struct w_tls_metrics {
+  std::atomic<uint64_t> handshakes = 0;
+  // the handshakes which resumed a session by a ticket or the session cache
+  std::atomic<uint64_t> resumed_handshakes = 0;
+  std::atomic<uint64_t> failed_handshakes = 0;
+  // the sessions whose records the kernel sends or receives
+  std::atomic<uint64_t> ktls_send_sessions = 0;
+  std::atomic<uint64_t> ktls_receive_sessions = 0;
+};
+
+/*
+ * the tls context of servers. all sessions of a context share its session
+ * cache and its ticket keys, so a client resumes its session on any thread
+ * of an io context pool, or on any server which uses the same context. the
+ * ticket keys are kept in memory only and rotate, so a leaked key does not
+ * reveal the sessions of earlier intervals.
+ */
+class w_tls_context {
+ public:
+  /*
+   * make a tls context
+   * @param p_options, the options of the context
+   * @returns the context, which is shared by the servers which use it
+   */
+  W_API static boost::leaf::result<std::shared_ptr<w_tls_context>> make(
+      _In_ const w_tls_options &p_options) noexcept;
+
+  // destructor
+  W_API virtual ~w_tls_context() noexcept;
+
+  // returns the asio context
+  W_API boost::asio::ssl::context &get_context() noexcept {
+    return this->_context;
+  }
+
+  // returns true if the sessions should let the kernel handle the records
+  W_API bool use_ktls() const noexcept { return this->_ktls; }
+
+  // returns the counters of the context
+  W_API const w_tls_metrics &get_metrics() const noexcept {
+    return this->_metrics;
+  }
+
+  /*
+   * count a finished handshake of a session
+   * @param p_ssl, the session, or nullptr if the handshake failed
+   */
+  W_API void count_handshake(_In_opt_ const SSL *p_ssl) noexcept;
+
+ private:
+  // copy constructor.
+  w_tls_context(const w_tls_context &) = delete;
+  // copy assignment operator.
+  w_tls_context &operator=(const w_tls_context &) = delete;
+  // move constructor.
+  w_tls_context(w_tls_context &&) = delete;
+  // move assignment operator.
+  w_tls_context &operator=(w_tls_context &&) = delete;
+
+  struct ticket_key {
+    std::array<unsigned char, 16> name = {};
+    std::array<unsigned char, 32> aes_key = {};
+    std::array<unsigned char, 32> hmac_key = {};
+    std::chrono::steady_clock::time_point created = {};
+  };
+
+  w_tls_context(_In_ boost::asio::ssl::context &&p_context,
+                _In_ const w_tls_options &p_options) noexcept;
+
+  boost::leaf::result<void> _init_ticket_keys() noexcept;
+  bool _rotate_ticket_keys() noexcept;
+
+  boost::asio::ssl::context _context;
+  std::chrono::seconds _session_timeout;
+  bool _ktls;
+  w_tls_metrics _metrics;
+
+  // the key which encrypts new tickets and the one before it, which still
+  // decrypts the tickets of the last interval
+  std::mutex _ticket_mutex;
+  ticket_key _ticket_key;
+  ticket_key _previous_ticket_key;
+
+  friend struct tls_ticket_callback;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET && WOLF_SYSTEM_SSL
@@ -0,0 +1,66 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <string>
+#include <wolf.hpp>
+
+#include "w_udp_socket.hpp"
+
+namespace wolf::system::socket {
+
+/*
+ * a udp socket which is connected to one server, so the kernel filters the
+ * packets of other peers and the packets need no endpoints
+ */
+class w_udp_client : public w_udp_socket {
+ public:
+  /*
+   * @param p_io_context, the io context of the client
+   * @param p_options, the batching and the kernel options
+   */
+  W_API explicit w_udp_client(_In_ boost::asio::io_context &p_io_context,
+                              _In_ const w_udp_options &p_options = {})
+      : w_udp_socket(p_io_context, p_options), _resolver(p_io_context) {}
+
+  /*
+   * resolve a host and connect to its first endpoint. throws a system_error
+   * on failure
+   * @param p_host, the host name or address
+   * @param p_port, the port
+   * @returns a coroutine
+   */
+  W_API boost::asio::awaitable<void> async_connect(_In_ std::string p_host,
+                                                   _In_ uint16_t p_port) {
+    const auto _endpoints = co_await this->_resolver.async_resolve(
+        p_host, std::to_string(p_port), boost::asio::use_awaitable);
+    if (_endpoints.empty()) {
+      throw boost::system::system_error(boost::asio::error::host_not_found);
+    }
+
+    auto _connected = false;
+    boost::leaf::try_handle_all(
+        [&]() -> boost::leaf::result<void> {
+          BOOST_LEAF_CHECK(connect(_endpoints.begin()->endpoint()));
+          _connected = true;
+          return {};
+        },
+        [] {});
+    if (!_connected) {
+      throw boost::system::system_error(
+          boost::asio::error::connection_refused);
+    }
+  }
+
+ private:
+  boost::asio::ip::udp::resolver _resolver;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,104 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_udp_server.hpp"
+
+#include <wolf/system/w_profiler.hpp>
+
+using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+using w_udp_on_error_callback =
+    wolf::system::socket::w_udp_on_error_callback;
+using w_udp_on_packets_callback =
+    wolf::system::socket::w_udp_on_packets_callback;
+using w_udp_options = wolf::system::socket::w_udp_options;
+using w_udp_server = wolf::system::socket::w_udp_server;
+using w_udp_socket = wolf::system::socket::w_udp_socket;
+using io_context = boost::asio::io_context;
+using udp = boost::asio::ip::udp;
+
+// the coroutine outlives run, so it must own its arguments
+static boost::asio::awaitable<void> s_receive(
+    _In_ const io_context &p_io_context,
+    _In_ std::unique_ptr<w_udp_socket> p_socket,
+    _In_ w_udp_on_packets_callback p_on_packets_callback,
+    _In_ w_udp_on_error_callback p_on_error_callback) noexcept {
+  auto _batch = p_socket->make_batch();
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (!p_io_context.stopped()) {
+    try {
+      co_await p_socket->async_receive(_batch);
+      W_PROFILE_SCOPE("w_udp_server::receive");
+      p_on_packets_callback(*p_socket, _batch.get_packets());
+    } catch (const boost::system::system_error &p_ex) {
+      if (p_ex.code() == boost::asio::error::operation_aborted) {
+        break;
+      }
+      // e.g. a port unreachable of a previous send, keep receiving
+      p_on_error_callback(p_ex);
+    }
+  }
+}
+
+static boost::leaf::result<std::unique_ptr<w_udp_socket>> s_bind(
+    _In_ io_context &p_io_context, _In_ const udp::endpoint &p_endpoint,
+    _In_ const w_udp_options &p_options) noexcept {
+  try {
+    auto _socket = std::make_unique<w_udp_socket>(p_io_context, p_options);
+    BOOST_LEAF_CHECK(_socket->bind(p_endpoint));
+    return _socket;
+  } catch (const std::exception &p_ex) {
+    return W_FAILURE(
+        std::errc::operation_canceled,
+        "udp server caught an exception : " + std::string(p_ex.what()));
+  }
+}
+
+boost::leaf::result<int> w_udp_server::run(
+    _In_ io_context &p_io_context, _In_ udp::endpoint &&p_endpoint,
+    _In_ w_udp_options &&p_options,
+    _In_ w_udp_on_packets_callback p_on_packets_callback,
+    _In_ w_udp_on_error_callback p_on_error_callback) noexcept {
+  // bind before spawning, so a busy port is reported to the caller
+  BOOST_LEAF_AUTO(_socket, s_bind(p_io_context, p_endpoint, p_options));
+  boost::asio::co_spawn(
+      p_io_context,
+      s_receive(p_io_context, std::move(_socket),
+                std::move(p_on_packets_callback),
+                std::move(p_on_error_callback)),
+      boost::asio::detached);
+  return 0;
+}
+
+boost::leaf::result<int> w_udp_server::run(
+    _Inout_ w_io_context_pool &p_pool, _In_ udp::endpoint &&p_endpoint,
+    _In_ w_udp_options &&p_options,
+    _In_ w_udp_on_packets_callback p_on_packets_callback,
+    _In_ w_udp_on_error_callback p_on_error_callback) noexcept {
+  auto _count = size_t{1};
+#if defined(__linux__) && defined(SO_REUSEPORT)
+  // a socket per io context, the kernel spreads the peers
+  if (p_pool.size() > 1) {
+    p_options.reuse_port = true;
+    _count = p_pool.size();
+  }
+#endif
+
+  std::vector<std::unique_ptr<w_udp_socket>> _sockets;
+  for (size_t i = 0; i < _count; ++i) {
+    BOOST_LEAF_AUTO(_socket, s_bind(p_pool.get(i), p_endpoint, p_options));
+    _sockets.push_back(std::move(_socket));
+  }
+  for (size_t i = 0; i < _count; ++i) {
+    auto &_context = p_pool.get(i);
+    boost::asio::co_spawn(_context,
+                          s_receive(_context, std::move(_sockets[i]),
+                                    p_on_packets_callback,
+                                    p_on_error_callback),
+                          boost::asio::detached);
+  }
+  return 0;
+}
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,65 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <wolf.hpp>
+
+#include "w_io_context_pool.hpp"
+#include "w_udp_socket.hpp"
+
+namespace wolf::system::socket {
+
+typedef std::function<void(_Inout_ w_udp_socket &p_socket,
+                           _In_ gsl::span<const w_udp_packet> p_packets)>
+    w_udp_on_packets_callback;
+
+typedef std::function<void(_In_ const boost::system::system_error &p_error)>
+    w_udp_on_error_callback;
+
+class w_udp_server {
+ public:
+  /*
+   * run a udp server, which receives batches of packets. the packets of a
+   * batch are only valid during the callback, which may answer them with
+   * w_udp_socket::send, the endpoint of a packet is its sender
+   * @param p_io_context, the boost io context
+   * @param p_endpoint, the endpoint of the server
+   * @param p_options, the batching and the kernel options
+   * @param p_on_packets_callback, on packets callback
+   * @param p_on_error_callback, on error callback
+   * @returns zero on success
+   */
+  W_API static boost::leaf::result<int> run(
+      _In_ boost::asio::io_context &p_io_context,
+      _In_ boost::asio::ip::udp::endpoint &&p_endpoint,
+      _In_ w_udp_options &&p_options,
+      _In_ w_udp_on_packets_callback p_on_packets_callback,
+      _In_ w_udp_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run the server on every io context of a pool. on linux each io context
+   * gets its own SO_REUSEPORT socket and the kernel keeps the packets of a
+   * peer on one of them, elsewhere only the first io context receives.
+   * @param p_pool, the io context pool, which is run by the caller
+   * @param p_endpoint, the endpoint of the server
+   * @param p_options, the batching and the kernel options
+   * @param p_on_packets_callback, on packets callback
+   * @param p_on_error_callback, on error callback
+   * @returns zero on success
+   */
+  W_API static boost::leaf::result<int> run(
+      _Inout_ w_io_context_pool &p_pool,
+      _In_ boost::asio::ip::udp::endpoint &&p_endpoint,
+      _In_ w_udp_options &&p_options,
+      _In_ w_udp_on_packets_callback p_on_packets_callback,
+      _In_ w_udp_on_error_callback p_on_error_callback) noexcept;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
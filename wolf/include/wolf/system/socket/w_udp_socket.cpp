@@ -0,0 +1,449 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_udp_socket.hpp"
+
+#include <cstring>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
+using w_udp_batch = wolf::system::socket::w_udp_batch;
+using w_udp_options = wolf::system::socket::w_udp_options;
+using w_udp_packet = wolf::system::socket::w_udp_packet;
+using w_udp_socket = wolf::system::socket::w_udp_socket;
+using udp = boost::asio::ip::udp;
+
+namespace {
+
+// a coalesced packet of gro holds up to 64KiB
+constexpr size_t s_gro_packet_size = 64 * 1024;
+// the limits of the kernel for one segmented or coalesced message
+constexpr size_t s_max_segments = 64;
+
+#ifdef __linux__
+// a bit below the 64KiB of a datagram, which leaves room for the headers
+constexpr size_t s_max_segmented_bytes = 63 * 1024;
+// room for the UDP_SEGMENT or the UDP_GRO control message
+const size_t s_control_size = CMSG_SPACE(sizeof(int));
+
+boost::system::error_code s_last_error() noexcept {
+  return {errno, boost::asio::error::get_system_category()};
+}
+#endif
+
+}  // namespace
+
+w_udp_batch::w_udp_batch(_In_ size_t p_max_packets, _In_ size_t p_packet_size,
+                         _In_ size_t p_max_segments)
+    : _max_packets(std::max<size_t>(1, p_max_packets)),
+      _packet_size(std::max<size_t>(1, p_packet_size)),
+      _storage(_max_packets * _packet_size),
+      _packets(_max_packets * std::max<size_t>(1, p_max_segments)) {
+#ifdef __linux__
+  this->_headers.resize(this->_max_packets);
+  this->_iovecs.resize(this->_max_packets);
+  this->_addresses.resize(this->_max_packets);
+  this->_controls.resize(this->_max_packets * s_control_size);
+#endif
+}
+
+w_udp_socket::w_udp_socket(_In_ boost::asio::io_context &p_io_context,
+                           _In_ const w_udp_options &p_options)
+    : _socket(p_io_context), _options(p_options) {
+  this->_options.max_batch = std::max<size_t>(1, this->_options.max_batch);
+  this->_options.packet_size = std::max<size_t>(1, this->_options.packet_size);
+
+#ifdef __linux__
+  const auto _max_batch = this->_options.max_batch;
+  this->_headers.resize(_max_batch);
+  this->_iovecs.resize(this->_options.gso ? _max_batch * s_max_segments
+                                          : _max_batch);
+  this->_controls.resize(_max_batch * s_control_size);
+  this->_segments.resize(_max_batch);
+#endif
+}
+
+boost::leaf::result<int> w_udp_socket::open(
+    _In_ const udp &p_protocol) noexcept {
+  boost::system::error_code _error;
+  std::ignore = this->_socket.open(p_protocol, _error);
+  if (!_error) {
+    _set_options(_error);
+  }
+  if (_error) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "could not open udp socket because: " + _error.message());
+  }
+  return 0;
+}
+
+boost::leaf::result<int> w_udp_socket::bind(
+    _In_ const udp::endpoint &p_endpoint) noexcept {
+  if (!this->_socket.is_open()) {
+    BOOST_LEAF_CHECK(open(p_endpoint.protocol()));
+  }
+
+  boost::system::error_code _error;
+  std::ignore = this->_socket.bind(p_endpoint, _error);
+  if (_error) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     wolf::format("could not bind udp socket to {}:{} "
+                                  "because: {}",
+                                  p_endpoint.address().to_string(),
+                                  p_endpoint.port(), _error.message()));
+  }
+  return 0;
+}
+
+boost::leaf::result<int> w_udp_socket::connect(
+    _In_ const udp::endpoint &p_endpoint) noexcept {
+  if (!this->_socket.is_open()) {
+    BOOST_LEAF_CHECK(open(p_endpoint.protocol()));
+  }
+
+  boost::system::error_code _error;
+  std::ignore = this->_socket.connect(p_endpoint, _error);
+  if (_error) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     wolf::format("could not connect udp socket to {}:{} "
+                                  "because: {}",
+                                  p_endpoint.address().to_string(),
+                                  p_endpoint.port(), _error.message()));
+  }
+  this->_connected = true;
+  return 0;
+}
+
+void w_udp_socket::_set_options(
+    _Inout_ boost::system::error_code &p_error) noexcept {
+  if (this->_options.receive_buffer_size > 0) {
+    std::ignore = this->_socket.set_option(
+        udp::socket::receive_buffer_size(this->_options.receive_buffer_size),
+        p_error);
+  }
+  if (!p_error && this->_options.send_buffer_size > 0) {
+    std::ignore = this->_socket.set_option(
+        udp::socket::send_buffer_size(this->_options.send_buffer_size),
+        p_error);
+  }
+#ifdef SO_REUSEPORT
+  if (!p_error && this->_options.reuse_port) {
+    using reuse_port_option =
+        boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+    std::ignore = this->_socket.set_option(reuse_port_option(true), p_error);
+  }
+#endif
+  if (!p_error) {
+    // the batches are read and written until the socket would block
+    std::ignore = this->_socket.non_blocking(true, p_error);
+  }
+
+#ifdef __linux__
+  // the offloads are optional, an older kernel just does not have them
+  const auto _fd = this->_socket.native_handle();
+  if (this->_options.gso) {
+    int _segment = 0;
+    socklen_t _size = sizeof(_segment);
+    this->_gso =
+        ::getsockopt(_fd, SOL_UDP, UDP_SEGMENT, &_segment, &_size) == 0;
+  }
+  if (this->_options.gro) {
+    const int _enable = 1;
+    this->_gro = ::setsockopt(_fd, SOL_UDP, UDP_GRO, &_enable,
+                              sizeof(_enable)) == 0;
+  }
+#endif
+}
+
+w_udp_batch w_udp_socket::make_batch() const {
+  // a slot of gro may hold as many segments as the kernel coalesces, so the
+  // packets are sized once for all of them
+  if (this->_gro) {
+    return w_udp_batch(this->_options.max_batch,
+                       std::max(s_gro_packet_size, this->_options.packet_size),
+                       s_max_segments);
+  }
+  return w_udp_batch(this->_options.max_batch, this->_options.packet_size);
+}
+
+size_t w_udp_socket::receive(
+    _Inout_ w_udp_batch &p_batch,
+    _Out_ boost::system::error_code &p_error) noexcept {
+  p_error = {};
+  p_batch._count = 0;
+
+  const auto _slot_size = p_batch._packet_size;
+  auto *const _storage = p_batch._storage.data();
+
+#ifdef __linux__
+  const auto _max_packets = p_batch._max_packets;
+  for (size_t i = 0; i < _max_packets; ++i) {
+    auto &_iovec = p_batch._iovecs[i];
+    _iovec.iov_base = _storage + i * _slot_size;
+    _iovec.iov_len = _slot_size;
+
+    auto &_header = p_batch._headers[i].msg_hdr;
+    _header.msg_name = &p_batch._addresses[i];
+    _header.msg_namelen = sizeof(sockaddr_storage);
+    _header.msg_iov = &_iovec;
+    _header.msg_iovlen = 1;
+    _header.msg_control = this->_gro
+                              ? p_batch._controls.data() + i * s_control_size
+                              : nullptr;
+    _header.msg_controllen = this->_gro ? s_control_size : 0;
+    _header.msg_flags = 0;
+  }
+
+  // one system call for all queued packets
+  const auto _received =
+      ::recvmmsg(this->_socket.native_handle(), p_batch._headers.data(),
+                 gsl::narrow_cast<unsigned int>(_max_packets), MSG_DONTWAIT,
+                 nullptr);
+  if (_received < 0) {
+    p_error = s_last_error();
+    return 0;
+  }
+
+  size_t _count = 0;
+  for (size_t i = 0; i < gsl::narrow_cast<size_t>(_received); ++i) {
+    auto &_header = p_batch._headers[i];
+    if ((_header.msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+      this->_truncated++;
+      continue;
+    }
+
+    const size_t _size = _header.msg_len;
+    size_t _segment = _size;
+    if (this->_gro) {
+      // a coalesced packet carries the size of its segments
+      for (auto *_cmsg = CMSG_FIRSTHDR(&_header.msg_hdr); _cmsg != nullptr;
+           _cmsg = CMSG_NXTHDR(&_header.msg_hdr, _cmsg)) {
+        if (_cmsg->cmsg_level == SOL_UDP && _cmsg->cmsg_type == UDP_GRO) {
+          int _gro_size = 0;
+          std::memcpy(&_gro_size, CMSG_DATA(_cmsg), sizeof(_gro_size));
+          _segment = _gro_size > 0 ? gsl::narrow_cast<size_t>(_gro_size)
+                                   : _size;
+        }
+      }
+    }
+
+    udp::endpoint _endpoint;
+    _endpoint.resize(_header.msg_hdr.msg_namelen);
+    std::memcpy(_endpoint.data(), &p_batch._addresses[i],
+                _header.msg_hdr.msg_namelen);
+
+    // split a coalesced packet into its segments, an empty packet is
+    // delivered as well
+    const auto *const _slot = _storage + i * _slot_size;
+    size_t _offset = 0;
+    do {
+      if (_count == p_batch._packets.size()) {
+        // the batch was not made for gro, drop the rest of the segments
+        // instead of allocating
+        const auto _step = std::max<size_t>(1, _segment);
+        this->_truncated += (_size - _offset + _step - 1) / _step;
+        break;
+      }
+      const auto _length = std::min(_segment, _size - _offset);
+      p_batch._packets[_count++] = {gsl::span(_slot + _offset, _length),
+                                    _endpoint};
+      _offset += _length;
+    } while (_offset < _size);
+  }
+  p_batch._count = _count;
+  return _count;
+#else
+  // a call per packet, until the socket would block
+  size_t _count = 0;
+  for (; _count < p_batch._max_packets; ++_count) {
+    auto &_packet = p_batch._packets[_count];
+    auto *const _slot = _storage + _count * _slot_size;
+    const auto _size = this->_socket.receive_from(
+        boost::asio::buffer(_slot, _slot_size), _packet.endpoint, 0, p_error);
+    if (p_error) {
+      break;
+    }
+    _packet.data = gsl::span<const std::byte>(_slot, _size);
+  }
+  if (_count != 0) {
+    p_error = {};
+  }
+  p_batch._count = _count;
+  return _count;
+#endif
+}
+
+boost::asio::awaitable<size_t> w_udp_socket::async_receive(
+    _Inout_ w_udp_batch &p_batch) {
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    boost::system::error_code _error;
+    const auto _count = receive(p_batch, _error);
+    if (_count != 0) {
+      co_return _count;
+    }
+    if (_error && _error != boost::asio::error::would_block) {
+      throw boost::system::system_error(_error);
+    }
+    co_await this->_socket.async_wait(udp::socket::wait_read,
+                                      boost::asio::use_awaitable);
+  }
+}
+
+size_t w_udp_socket::send(_In_ gsl::span<const w_udp_packet> p_packets,
+                          _Out_ boost::system::error_code &p_error) noexcept {
+  p_error = {};
+  size_t _sent = 0;
+
+#ifdef __linux__
+  const auto _max_batch = this->_options.max_batch;
+  const auto _max_segments =
+      this->_gso ? std::min(s_max_segments, this->_iovecs.size() / _max_batch)
+                 : 1;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (_sent < p_packets.size()) {
+    size_t _messages = 0;
+    size_t _iovecs = 0;
+    auto _segmented = false;
+    for (auto i = _sent; i < p_packets.size() && _messages < _max_batch;) {
+      const auto &_first = p_packets[i];
+      const auto _segment = _first.data.size();
+
+      // a run of packets to the same peer, which are as big as the first one
+      // but the last, go out as one segmented message
+      size_t _count = 1;
+      auto _bytes = _segment;
+      if (_max_segments > 1 && _segment != 0) {
+        while (i + _count < p_packets.size() && _count < _max_segments) {
+          const auto &_next = p_packets[i + _count];
+          const auto _size = _next.data.size();
+          if (_size == 0 || _size > _segment ||
+              _bytes + _size > s_max_segmented_bytes ||
+              (!this->_connected && _next.endpoint != _first.endpoint)) {
+            break;
+          }
+          _count++;
+          _bytes += _size;
+          if (_size < _segment) {
+            break;
+          }
+        }
+      }
+
+      for (size_t j = 0; j < _count; ++j) {
+        const auto &_data = p_packets[i + j].data;
+        this->_iovecs[_iovecs + j] = {
+            const_cast<std::byte *>(_data.data()), _data.size()};
+      }
+
+      auto &_header = this->_headers[_messages].msg_hdr;
+      _header = {};
+      if (!this->_connected) {
+        _header.msg_name = const_cast<void *>(
+            static_cast<const void *>(_first.endpoint.data()));
+        _header.msg_namelen =
+            gsl::narrow_cast<socklen_t>(_first.endpoint.size());
+      }
+      _header.msg_iov = &this->_iovecs[_iovecs];
+      _header.msg_iovlen = _count;
+      if (_count > 1) {
+        auto *const _control =
+            this->_controls.data() + _messages * s_control_size;
+        _header.msg_control = _control;
+        _header.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+        auto *const _cmsg = CMSG_FIRSTHDR(&_header);
+        _cmsg->cmsg_level = SOL_UDP;
+        _cmsg->cmsg_type = UDP_SEGMENT;
+        _cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        const auto _segment_size = gsl::narrow_cast<uint16_t>(_segment);
+        std::memcpy(CMSG_DATA(_cmsg), &_segment_size, sizeof(_segment_size));
+        _segmented = true;
+      }
+
+      this->_segments[_messages++] = _count;
+      _iovecs += _count;
+      i += _count;
+    }
+
+    // one system call for the whole batch
+    const auto _result =
+        ::sendmmsg(this->_socket.native_handle(), this->_headers.data(),
+                   gsl::narrow_cast<unsigned int>(_messages), MSG_DONTWAIT);
+    if (_result < 0) {
+      const auto _error = s_last_error();
+      if (_segmented && _error.value() == EIO) {
+        // the device can not segment, so send each packet from now on
+        this->_gso = false;
+        return _sent + send(p_packets.subspan(_sent), p_error);
+      }
+      p_error = _error;
+      break;
+    }
+    for (size_t i = 0; i < gsl::narrow_cast<size_t>(_result); ++i) {
+      _sent += this->_segments[i];
+    }
+    if (gsl::narrow_cast<size_t>(_result) < _messages) {
+      // the send buffer is full
+      p_error = boost::asio::error::would_block;
+      break;
+    }
+  }
+#else
+  for (; _sent < p_packets.size(); ++_sent) {
+    const auto &_packet = p_packets[_sent];
+    const auto _buffer =
+        boost::asio::buffer(_packet.data.data(), _packet.data.size());
+    if (this->_connected) {
+      std::ignore = this->_socket.send(_buffer, 0, p_error);
+    } else {
+      std::ignore =
+          this->_socket.send_to(_buffer, _packet.endpoint, 0, p_error);
+    }
+    if (p_error) {
+      break;
+    }
+  }
+#endif
+  return _sent;
+}
+
+boost::asio::awaitable<size_t> w_udp_socket::async_send(
+    _In_ gsl::span<const w_udp_packet> p_packets) {
+  size_t _sent = 0;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (_sent < p_packets.size()) {
+    boost::system::error_code _error;
+    _sent += send(p_packets.subspan(_sent), _error);
+    if (!_error) {
+      continue;
+    }
+    if (_error != boost::asio::error::would_block) {
+      throw boost::system::system_error(_error);
+    }
+    co_await this->_socket.async_wait(udp::socket::wait_write,
+                                      boost::asio::use_awaitable);
+  }
+  co_return _sent;
+}
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,232 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <cstddef>
+#include <vector>
+#include <wolf.hpp>
+
+#include "w_socket_options.hpp"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace wolf::system::socket {
+
+struct w_udp_options {
+  // the number of packets of one receive or send system call
+  size_t max_batch = 64;
+  // the size of a pooled packet buffer, bigger packets are dropped
+  size_t packet_size = 2048;
+  // send runs of equal sized packets to the same peer as one segmented
+  // message (UDP_SEGMENT), if the kernel supports it
+  bool gso = true;
+  // let the kernel coalesce received packets of a peer (UDP_GRO). a pooled
+  // buffer then holds up to 64KiB of segments, so it costs more memory
+  bool gro = false;
+  // the kernel buffers of the socket, zero keeps the system default
+  int receive_buffer_size = 4 * 1024 * 1024;
+  int send_buffer_size = 4 * 1024 * 1024;
+  // let several sockets bind the same port, linux balances the packets
+  // between them by the address of the peer
+  bool reuse_port = false;
+};
+
+// a packet of a batch, the data is only valid until the next receive
+struct w_udp_packet {
+  gsl::span<const std::byte> data;
+  // the peer, which is ignored when a connected socket sends
+  boost::asio::ip::udp::endpoint endpoint;
+};
+
+/*
+ * the pooled buffers of batched receives. the packets are received straight
+ * into fixed size slots of one allocation, which is reused by every receive,
+ * so receiving never allocates.
+ */
+class w_udp_batch {
+ public:
+  /*
+   * @param p_max_packets, the number of slots
+   * @param p_packet_size, the size of a slot
+   * @param p_max_segments, the number of packets which a slot may hold, more
+   * than one if the kernel coalesces the received packets
+   */
+  W_API w_udp_batch(_In_ size_t p_max_packets, _In_ size_t p_packet_size,
+                    _In_ size_t p_max_segments = 1);
+
+  // returns the packets of the last receive
+  gsl::span<const w_udp_packet> get_packets() const noexcept {
+    return gsl::span(this->_packets.data(), this->_count);
+  }
+
+  // returns the number of packets of the last receive
+  size_t size() const noexcept { return this->_count; }
+
+  // returns the number of slots
+  size_t get_max_packets() const noexcept { return this->_max_packets; }
+
+  // returns the size of a slot
+  size_t get_packet_size() const noexcept { return this->_packet_size; }
+
+ private:
+  friend class w_udp_socket;
+
+  size_t _max_packets;
+  size_t _packet_size;
+  size_t _count = 0;
+  std::vector<std::byte> _storage;
+  std::vector<w_udp_packet> _packets;
+#ifdef __linux__
+  std::vector<mmsghdr> _headers;
+  std::vector<iovec> _iovecs;
+  std::vector<sockaddr_storage> _addresses;
+  std::vector<std::byte> _controls;
+#endif
+};
+
+/*
+ * a udp socket which receives and sends batches of packets. on linux a batch
+ * costs one recvmmsg or sendmmsg call and may use the segmentation offloads
+ * of the kernel, elsewhere it falls back to a call per packet. a socket is
+ * used by one thread at a time, like the other asio sockets.
+ */
+class w_udp_socket {
+ public:
+  /*
+   * @param p_io_context, the io context of the socket
+   * @param p_options, the batching and the kernel options
+   */
+  W_API w_udp_socket(_In_ boost::asio::io_context &p_io_context,
+                     _In_ const w_udp_options &p_options);
+
+  // destructor
+  W_API virtual ~w_udp_socket() noexcept = default;
+
+  /*
+   * open the socket for a protocol and set its options
+   * @param p_protocol, v4 or v6
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> open(
+      _In_ const boost::asio::ip::udp &p_protocol) noexcept;
+
+  /*
+   * open the socket, if it was not opened, and bind it
+   * @param p_endpoint, the local endpoint
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> bind(
+      _In_ const boost::asio::ip::udp::endpoint &p_endpoint) noexcept;
+
+  /*
+   * open the socket, if it was not opened, and set its default peer. then
+   * sends ignore the endpoints of the packets
+   * @param p_endpoint, the peer
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> connect(
+      _In_ const boost::asio::ip::udp::endpoint &p_endpoint) noexcept;
+
+  /*
+   * receive the packets which are already queued, without blocking
+   * @param p_batch, the batch which gets the packets
+   * @param p_error, would_block if no packet was queued
+   * @returns the number of packets
+   */
+  W_API size_t receive(_Inout_ w_udp_batch &p_batch,
+                       _Out_ boost::system::error_code &p_error) noexcept;
+
+  /*
+   * wait for packets and receive a batch. throws a system_error on failure
+   * @param p_batch, the batch which gets the packets
+   * @returns a coroutine with the number of packets
+   */
+  W_API boost::asio::awaitable<size_t> async_receive(
+      _Inout_ w_udp_batch &p_batch);
+
+  /*
+   * send packets without blocking, it may stop early when the send buffer of
+   * the socket is full
+   * @param p_packets, the packets
+   * @param p_error, would_block if the send buffer was full
+   * @returns the number of sent packets
+   */
+  W_API size_t send(_In_ gsl::span<const w_udp_packet> p_packets,
+                    _Out_ boost::system::error_code &p_error) noexcept;
+
+  /*
+   * send all packets and wait while the send buffer of the socket is full.
+   * throws a system_error on failure
+   * @param p_packets, the packets
+   * @returns a coroutine with the number of sent packets
+   */
+  W_API boost::asio::awaitable<size_t> async_send(
+      _In_ gsl::span<const w_udp_packet> p_packets);
+
+  // returns the options of the socket
+  W_API const w_udp_options &get_options() const noexcept {
+    return this->_options;
+  }
+
+  // returns true if the kernel segments the sent packets
+  W_API bool has_gso() const noexcept { return this->_gso; }
+
+  // returns true if the kernel coalesces the received packets
+  W_API bool has_gro() const noexcept { return this->_gro; }
+
+  // returns the number of received packets which did not fit a slot, or the
+  // packets of the batch
+  W_API uint64_t get_truncated_count() const noexcept {
+    return this->_truncated;
+  }
+
+  // returns the asio socket
+  W_API boost::asio::ip::udp::socket &get_socket() noexcept {
+    return this->_socket;
+  }
+
+  /*
+   * create a batch whose slots fit this socket, it must be called after the
+   * socket was opened, so the slots fit the packets of gro
+   * @returns the batch
+   */
+  W_API w_udp_batch make_batch() const;
+
+ private:
+  // copy constructor.
+  w_udp_socket(const w_udp_socket &) = delete;
+  // copy assignment operator.
+  w_udp_socket &operator=(const w_udp_socket &) = delete;
+  // move constructor.
+  w_udp_socket(w_udp_socket &&) = delete;
+  // move assignment operator.
+  w_udp_socket &operator=(w_udp_socket &&) = delete;
+
+  void _set_options(_Inout_ boost::system::error_code &p_error) noexcept;
+
+  boost::asio::ip::udp::socket _socket;
+  w_udp_options _options;
+  bool _connected = false;
+  bool _gso = false;
+  bool _gro = false;
+  uint64_t _truncated = 0;
+
+#ifdef __linux__
+  // the scratch of send, which is reused by every call
+  std::vector<mmsghdr> _headers;
+  std::vector<iovec> _iovecs;
+  std::vector<std::byte> _controls;
+  std::vector<size_t> _segments;
+#endif
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
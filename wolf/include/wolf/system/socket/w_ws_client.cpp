@@ -3,6 +3,7 @@
 #include "w_ws_client.hpp"
 
 using w_ws_client = wolf::system::socket::w_ws_client;
+using w_ws_deflate_stats = wolf::system::socket::w_ws_deflate_stats;
 using tcp = boost::asio::ip::tcp;
 
 w_ws_client::w_ws_client(boost::asio::io_context &p_io_context) noexcept
@@ -43,12 +44,13 @@ boost::asio::awaitable<void> w_ws_client::async_connect(
     _In_ const boost::asio::ip::tcp::endpoint &p_endpoint,
     _In_ const w_socket_options &p_socket_options) {
   this->_ws =
-      std::make_unique<w_ws_stream>(boost::asio::use_awaitable.as_default_on(
-          boost::beast::websocket::stream<boost::beast::tcp_stream>(
-              co_await boost::asio::this_coro::executor)));
+      std::make_unique<w_ws_stream>(co_await boost::asio::this_coro::executor);
+  this->_stats = p_socket_options.ws_deflate.stats;
 
   co_await boost::beast::get_lowest_layer(*this->_ws)
       .async_connect(p_endpoint, boost::asio::use_awaitable);
+  p_socket_options.set_to_socket(
+      boost::beast::get_lowest_layer(*this->_ws).socket());
 
   // turn off the timeout on the tcp_stream, because
   // the websocket stream has its own timeout system.
@@ -59,6 +61,9 @@ boost::asio::awaitable<void> w_ws_client::async_connect(
       boost::beast::websocket::stream_base::timeout::suggested(
           boost::beast::role_type::client));
 
+  // offer permessage-deflate in the handshake
+  p_socket_options.ws_deflate.set_to_stream(*this->_ws);
+
   // set a decorator to change the User-Agent of the handshake
   this->_ws->set_option(boost::beast::websocket::stream_base::decorator(
       [](boost::beast::websocket::request_type &req) {
@@ -77,25 +82,50 @@ boost::asio::awaitable<size_t> w_ws_client::async_write(
   } else {
     this->_ws->text(true);
   }
-  co_await this->_ws->async_write(
-      boost::asio::const_buffer(p_buffer.buf.data(), p_buffer.used_bytes));
+  if (this->_stats == nullptr) {
+    co_return co_await this->_ws->async_write(
+        boost::asio::const_buffer(p_buffer.data(), p_buffer.size()));
+  }
+
+  const auto &_traffic = this->_ws->next_layer().rate_policy();
+  const auto _wire_bytes = _traffic.get_written_bytes();
+  const auto _cpu_time = w_ws_deflate_stats::get_thread_cpu_time();
+
+  const auto _bytes = co_await this->_ws->async_write(
+      boost::asio::const_buffer(p_buffer.data(), p_buffer.size()));
+
+  this->_stats->record_send(_bytes, _traffic.get_written_bytes() - _wire_bytes,
+                            _cpu_time);
+  co_return _bytes;
 }
 
 boost::asio::awaitable<size_t> w_ws_client::async_read(
     _Inout_ w_buffer &p_mut_buffer) {
-  boost::beast::flat_buffer _buffer = {};
-  co_await this->_ws->async_read(_buffer);
-
-  // an extra copy just for having a stable ABI
-  const auto _size = std::min(_buffer.cdata().size(), p_mut_buffer.buf.size());
-  std::memcpy(p_mut_buffer.buf.data(),
-              static_cast<char const *>(_buffer.cdata().data()), _size);
-  co_return _size;
+  // read the whole message straight into the pooled buffer
+  p_mut_buffer.reset(std::max<size_t>(p_mut_buffer.capacity(),
+                                      W_MAX_BUFFER_SIZE));
+  auto _dynamic_buffer =
+      wolf::system::socket::w_dynamic_buffer(p_mut_buffer);
+  co_return co_await _read(_dynamic_buffer);
 }
 
 boost::asio::awaitable<size_t> w_ws_client::async_read(
     _Inout_ boost::beast::flat_buffer &p_mut_buffer) {
-  co_await this->_ws->async_read(p_mut_buffer);
+  co_return co_await _read(p_mut_buffer);
+}
+
+template <typename B>
+boost::asio::awaitable<size_t> w_ws_client::_read(_Inout_ B &p_mut_buffer) {
+  const auto &_traffic = this->_ws->next_layer().rate_policy();
+  const auto _wire_bytes = _traffic.get_read_bytes();
+
+  const auto _bytes = co_await this->_ws->async_read(p_mut_buffer);
+
+  if (this->_stats != nullptr) {
+    this->_stats->record_receive(_bytes,
+                                 _traffic.get_read_bytes() - _wire_bytes);
+  }
+  co_return _bytes;
 }
 
 boost::asio::awaitable<void> w_ws_client::async_close(
@@ -106,6 +136,12 @@ boost::asio::awaitable<void> w_ws_client::async_close(
   co_await this->_ws->async_close(p_close_reason);
 }
 
+void w_ws_client::close() noexcept {
+  if (this->_ws != nullptr) {
+    boost::beast::get_lowest_layer(*this->_ws).close();
+  }
+}
+
 bool w_ws_client::is_open() const {
   if (this->_ws == nullptr) {
     return false;
@@ -44,7 +44,8 @@ class w_ws_client {
   /*
    * open a websocket and handshake with the endpoint asynchronously
    * @param p_endpoint, the endpoint of the server
-   * @param p_socket_options, the socket options
+   * @param p_socket_options, the socket options, which also contain the
+   * permessage-deflate options and counters
    * @returns a coroutine
    */
   W_API
@@ -87,6 +88,10 @@ class w_ws_client {
   boost::asio::awaitable<void> async_close(
       _In_ const boost::beast::websocket::close_reason &p_close_reason);
 
+  // cancel the pending operations and close the socket without a close
+  // handshake
+  W_API void close() noexcept;
+
   /*
    * get whether websocket is open or not
    * @returns true if socket was open
@@ -99,8 +104,13 @@ class w_ws_client {
   // copy operator
   w_ws_client &operator=(const w_ws_client &) = delete;
 
+  // read a message and count it
+  template <typename B>
+  boost::asio::awaitable<size_t> _read(_Inout_ B &p_mut_buffer);
+
   std::unique_ptr<w_ws_stream> _ws;
   std::unique_ptr<boost::asio::ip::tcp::resolver> _resolver;
+  std::shared_ptr<w_ws_deflate_stats> _stats;
 };
 }  // namespace wolf::system::socket
 
@@ -0,0 +1,40 @@
+#if defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
+
+#include "w_ws_deflate.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <ctime>
+#endif
+
+using w_ws_deflate_stats = wolf::system::socket::w_ws_deflate_stats;
+
+uint64_t w_ws_deflate_stats::get_thread_cpu_time_ns() noexcept {
+#ifdef _WIN32
+  FILETIME _creation = {};
+  FILETIME _exit = {};
+  FILETIME _kernel = {};
+  FILETIME _user = {};
+  if (GetThreadTimes(GetCurrentThread(), &_creation, &_exit, &_kernel,
+                     &_user) == FALSE) {
+    return 0;
+  }
+  // the times are in 100 nanoseconds
+  const auto _to_ns = [](_In_ const FILETIME &p_time) {
+    return ((static_cast<uint64_t>(p_time.dwHighDateTime) << 32) |
+            p_time.dwLowDateTime) *
+           100;
+  };
+  return _to_ns(_kernel) + _to_ns(_user);
+#else
+  timespec _time = {};
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &_time) != 0) {
+    return 0;
+  }
+  return gsl::narrow_cast<uint64_t>(_time.tv_sec) * 1000000000 +
+         gsl::narrow_cast<uint64_t>(_time.tv_nsec);
+#endif
+}
+
+#endif  // defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
@@ -0,0 +1,198 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#if defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <wolf.hpp>
+
+// NOLINTBEGIN
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : ALL_CODE_ANALYSIS_WARNINGS)
+#endif
+
+#include <boost/beast/websocket.hpp>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+// NOLINTEND
+
+namespace wolf::system::socket {
+
+/*
+ * the counters of the websocket messages of a server or a client, so the
+ * bandwidth which deflate saves can be weighed against its cpu cost. the wire
+ * bytes contain the frame headers, a ratio above one means the messages were
+ * compressed.
+ */
+struct w_ws_deflate_stats {
+  std::atomic<uint64_t> messages_sent = 0;
+  std::atomic<uint64_t> payload_bytes_sent = 0;
+  std::atomic<uint64_t> wire_bytes_sent = 0;
+  // the cpu time of the thread while the messages were written, which covers
+  // deflate. beast compresses inside the write, so it also contains the work
+  // of the other sessions which ran on that thread while the write was
+  // suspended. it is only exact when a thread runs one session at a time
+  std::atomic<uint64_t> send_cpu_time_ns = 0;
+  // the writes which were sampled in send_cpu_time_ns, a write which resumed
+  // on another thread is not sampled
+  std::atomic<uint64_t> send_cpu_samples = 0;
+
+  std::atomic<uint64_t> messages_received = 0;
+  std::atomic<uint64_t> payload_bytes_received = 0;
+  std::atomic<uint64_t> wire_bytes_received = 0;
+
+  // a reading of the cpu time clock of a thread
+  struct cpu_time {
+    std::thread::id thread_id;
+    uint64_t ns = 0;
+  };
+
+  /*
+   * record a sent message, it must be called on the thread which resumed
+   * after the write
+   * @param p_payload_bytes, the size of the message
+   * @param p_wire_bytes, the bytes which were written to the socket
+   * @param p_started, the cpu time which was taken before the write
+   */
+  void record_send(_In_ uint64_t p_payload_bytes, _In_ uint64_t p_wire_bytes,
+                   _In_ const cpu_time &p_started) noexcept {
+    this->messages_sent.fetch_add(1, std::memory_order_relaxed);
+    this->payload_bytes_sent.fetch_add(p_payload_bytes,
+                                       std::memory_order_relaxed);
+    this->wire_bytes_sent.fetch_add(p_wire_bytes, std::memory_order_relaxed);
+
+    // the clocks of two threads can not be subtracted
+    if (p_started.thread_id != std::this_thread::get_id()) {
+      return;
+    }
+    const auto _now = get_thread_cpu_time_ns();
+    if (_now < p_started.ns) {
+      return;
+    }
+    this->send_cpu_time_ns.fetch_add(_now - p_started.ns,
+                                     std::memory_order_relaxed);
+    this->send_cpu_samples.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void record_receive(_In_ uint64_t p_payload_bytes,
+                      _In_ uint64_t p_wire_bytes) noexcept {
+    this->messages_received.fetch_add(1, std::memory_order_relaxed);
+    this->payload_bytes_received.fetch_add(p_payload_bytes,
+                                           std::memory_order_relaxed);
+    this->wire_bytes_received.fetch_add(p_wire_bytes,
+                                        std::memory_order_relaxed);
+  }
+
+  // returns the payload bytes per wire byte of the sent messages
+  double get_send_ratio() const noexcept {
+    return s_ratio(this->payload_bytes_sent, this->wire_bytes_sent);
+  }
+
+  // returns the payload bytes per wire byte of the received messages
+  double get_receive_ratio() const noexcept {
+    return s_ratio(this->payload_bytes_received, this->wire_bytes_received);
+  }
+
+  // returns the average cpu time of a sampled write in nanoseconds
+  double get_send_cpu_time_per_message_ns() const noexcept {
+    return s_ratio(this->send_cpu_time_ns, this->send_cpu_samples);
+  }
+
+  // returns the cpu time of the calling thread in nanoseconds
+  W_API static uint64_t get_thread_cpu_time_ns() noexcept;
+
+  // returns the cpu time of the calling thread and the thread id
+  static cpu_time get_thread_cpu_time() noexcept {
+    return {std::this_thread::get_id(), get_thread_cpu_time_ns()};
+  }
+
+ private:
+  static double s_ratio(_In_ const std::atomic<uint64_t> &p_payload,
+                        _In_ const std::atomic<uint64_t> &p_wire) noexcept {
+    const auto _wire = p_wire.load(std::memory_order_relaxed);
+    return _wire == 0 ? 0.0
+                      : gsl::narrow_cast<double>(
+                            p_payload.load(std::memory_order_relaxed)) /
+                            gsl::narrow_cast<double>(_wire);
+  }
+};
+
+// whether the permessage_deflate of boost can skip the small messages
+template <typename T>
+constexpr bool w_ws_has_msg_size_threshold =
+    requires(T &p_pmd) { p_pmd.msg_size_threshold; };
+
+/*
+ * the permessage-deflate extension (rfc 7692) of a websocket server or
+ * client. it is negotiated in the handshake, so it is only used when both
+ * sides enable it. smaller windows and memory levels cost less memory per
+ * connection, no context takeover costs ratio but drops the zlib state
+ * between messages.
+ */
+struct w_ws_deflate_options {
+  // false if this boost version compresses every message and ignores min_size
+  static constexpr bool SUPPORTS_MIN_SIZE =
+      w_ws_has_msg_size_threshold<boost::beast::websocket::permessage_deflate>;
+
+  bool enabled = false;
+  // the LZ77 window of the server and of the client, from 9 to 15 bits
+  int server_max_window_bits = 15;
+  int client_max_window_bits = 15;
+  // reset the zlib state of the server or of the client after each message
+  bool server_no_context_takeover = false;
+  bool client_no_context_takeover = false;
+  // the zlib memory level from 1 to 9 and the compression level from 0 to 9
+  int mem_level = 4;
+  int compression_level = 6;
+  // the smaller messages are sent as they are, which needs a boost version
+  // whose permessage_deflate has msg_size_threshold, see SUPPORTS_MIN_SIZE
+  size_t min_size = 256;
+  // optional counters, which are shared by all sessions of a server
+  std::shared_ptr<w_ws_deflate_stats> stats;
+
+  /*
+   * set the options to a websocket stream before its handshake
+   * @param p_ws, the websocket stream
+   */
+  template <typename S>
+  void set_to_stream(_Inout_ S &p_ws) const {
+    boost::beast::websocket::permessage_deflate _pmd;
+    _pmd.server_enable = this->enabled;
+    _pmd.client_enable = this->enabled;
+    _pmd.server_max_window_bits =
+        std::clamp(this->server_max_window_bits, 9, 15);
+    _pmd.client_max_window_bits =
+        std::clamp(this->client_max_window_bits, 9, 15);
+    _pmd.server_no_context_takeover = this->server_no_context_takeover;
+    _pmd.client_no_context_takeover = this->client_no_context_takeover;
+    _pmd.memLevel = std::clamp(this->mem_level, 1, 9);
+    _pmd.compLevel = std::clamp(this->compression_level, 0, 9);
+    s_set_min_size(_pmd, this->min_size);
+    p_ws.set_option(_pmd);
+  }
+
+ private:
+  template <typename T>
+  static void s_set_min_size(_Inout_ T &p_pmd, _In_ size_t p_min_size) {
+    if constexpr (w_ws_has_msg_size_threshold<T>) {
+      p_pmd.msg_size_threshold = p_min_size;
+    } else {
+      std::ignore = p_pmd;
+      std::ignore = p_min_size;
+    }
+  }
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
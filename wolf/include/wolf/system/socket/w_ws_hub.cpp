@@ -0,0 +1,175 @@
+#if defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
+
+#include "w_ws_hub.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include <wolf/system/w_profiler.hpp>
+
+using w_ws_hub = wolf::system::socket::w_ws_hub;
+using w_ws_session = wolf::system::socket::w_ws_session;
+
+void w_ws_hub::add_session(_In_ std::shared_ptr<w_ws_session> p_session) {
+  if (p_session == nullptr) {
+    return;
+  }
+
+  std::unique_lock _lock(this->_mutex);
+  auto &_entry = this->_sessions[p_session.get()];
+  _entry.session = std::move(p_session);
+}
+
+void w_ws_hub::remove_session(_In_ const w_ws_session &p_session) {
+  std::unique_lock _lock(this->_mutex);
+
+  const auto _iter = this->_sessions.find(&p_session);
+  if (_iter == this->_sessions.end()) {
+    return;
+  }
+  for (const auto &_topic : _iter->second.topics) {
+    std::ignore = _unsubscribe(p_session, _topic);
+  }
+  this->_sessions.erase(_iter);
+}
+
+bool w_ws_hub::subscribe(_In_ const std::shared_ptr<w_ws_session> &p_session,
+                         _In_ std::string_view p_topic) {
+  if (p_session == nullptr) {
+    return false;
+  }
+
+  std::unique_lock _lock(this->_mutex);
+
+  // the server removes a session after it stopped being open, so checking it
+  // under the lock keeps a late subscribe from tracking a closed session
+  if (!p_session->is_open()) {
+    return false;
+  }
+
+  auto &_entry = this->_sessions[p_session.get()];
+  if (std::find(_entry.topics.cbegin(), _entry.topics.cend(), p_topic) !=
+      _entry.topics.cend()) {
+    return false;
+  }
+  _entry.session = p_session;
+  _entry.topics.emplace_back(p_topic);
+
+  auto _iter = this->_topics.find(p_topic);
+  if (_iter == this->_topics.end()) {
+    _iter = this->_topics.emplace(std::string(p_topic),
+                                  std::vector<std::shared_ptr<w_ws_session>>())
+                .first;
+  }
+  _iter->second.push_back(p_session);
+  return true;
+}
+
+bool w_ws_hub::unsubscribe(_In_ const w_ws_session &p_session,
+                           _In_ std::string_view p_topic) {
+  std::unique_lock _lock(this->_mutex);
+
+  const auto _iter = this->_sessions.find(&p_session);
+  if (_iter == this->_sessions.end()) {
+    return false;
+  }
+  auto &_topics = _iter->second.topics;
+  const auto _topic = std::find(_topics.begin(), _topics.end(), p_topic);
+  if (_topic == _topics.end()) {
+    return false;
+  }
+  _topics.erase(_topic);
+  return _unsubscribe(p_session, p_topic);
+}
+
+bool w_ws_hub::_unsubscribe(_In_ const w_ws_session &p_session,
+                            _In_ std::string_view p_topic) {
+  const auto _iter = this->_topics.find(p_topic);
+  if (_iter == this->_topics.end()) {
+    return false;
+  }
+
+  // the order of subscribers does not matter, so swap with the last one
+  auto &_subscribers = _iter->second;
+  const auto _subscriber =
+      std::find_if(_subscribers.begin(), _subscribers.end(),
+                   [&](const auto &p_subscriber) {
+                     return p_subscriber.get() == &p_session;
+                   });
+  if (_subscriber == _subscribers.end()) {
+    return false;
+  }
+  std::iter_swap(_subscriber, _subscribers.end() - 1);
+  _subscribers.pop_back();
+
+  if (_subscribers.empty()) {
+    this->_topics.erase(_iter);
+  }
+  return true;
+}
+
+size_t w_ws_hub::publish(_In_ std::string_view p_topic,
+                         _In_ const w_buffer &p_message,
+                         _In_ bool p_is_binary) {
+  W_PROFILE_SCOPE("w_ws_hub::publish");
+
+  std::shared_lock _lock(this->_mutex);
+
+  const auto _iter = this->_topics.find(p_topic);
+  if (_iter == this->_topics.end()) {
+    return 0;
+  }
+
+  size_t _count = 0;
+  for (const auto &_session : _iter->second) {
+    // every session gets a reference to the same storage
+    if (_session->send(p_message, p_is_binary)) {
+      _count++;
+    }
+  }
+  return _count;
+}
+
+boost::leaf::result<size_t> w_ws_hub::publish(
+    _In_ std::string_view p_topic, _In_ gsl::span<const std::byte> p_message,
+    _In_ bool p_is_binary) {
+  try {
+    const auto _message = w_buffer(std::string_view(
+        reinterpret_cast<const char *>(p_message.data()), p_message.size()));
+    return publish(p_topic, _message, p_is_binary);
+  } catch (const std::exception &e) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("could not publish a message of {} bytes "
+                                  "because: {}",
+                                  p_message.size(), e.what()));
+  }
+}
+
+size_t w_ws_hub::broadcast(_In_ const w_buffer &p_message,
+                           _In_ bool p_is_binary) {
+  W_PROFILE_SCOPE("w_ws_hub::broadcast");
+
+  std::shared_lock _lock(this->_mutex);
+
+  size_t _count = 0;
+  for (const auto &[_ptr, _entry] : this->_sessions) {
+    if (_entry.session->send(p_message, p_is_binary)) {
+      _count++;
+    }
+  }
+  return _count;
+}
+
+size_t w_ws_hub::get_subscriber_count(_In_ std::string_view p_topic) const {
+  std::shared_lock _lock(this->_mutex);
+
+  const auto _iter = this->_topics.find(p_topic);
+  return _iter != this->_topics.end() ? _iter->second.size() : 0;
+}
+
+size_t w_ws_hub::get_session_count() const {
+  std::shared_lock _lock(this->_mutex);
+  return this->_sessions.size();
+}
+
+#endif  // defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
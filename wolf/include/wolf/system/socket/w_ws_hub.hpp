@@ -0,0 +1,136 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#if defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <wolf.hpp>
+
+#include "w_ws_session.hpp"
+
+namespace wolf::system::socket {
+
+/*
+ * fans messages out to the sessions of a websocket server. a published
+ * message is one immutable w_buffer which is queued on every subscriber, so
+ * the payload is never copied per session. publishing only takes a shared
+ * lock, so many threads can publish at the same time. the server removes a
+ * session when it ends, the sessions which are still open hold objects of
+ * their io context, so the hub must not outlive the io context.
+ */
+class w_ws_hub {
+ public:
+  // default constructor
+  W_API w_ws_hub() noexcept = default;
+
+  // destructor
+  W_API virtual ~w_ws_hub() noexcept = default;
+
+  /*
+   * track a session for broadcast, the server calls it for every session
+   * @param p_session, the session
+   */
+  W_API void add_session(_In_ std::shared_ptr<w_ws_session> p_session);
+
+  /*
+   * forget a session and all of its subscriptions, the server calls it when
+   * the session ends
+   * @param p_session, the session
+   */
+  W_API void remove_session(_In_ const w_ws_session &p_session);
+
+  /*
+   * subscribe a session to a topic
+   * @param p_session, the session
+   * @param p_topic, the topic
+   * @returns false if the session was already subscribed or is not open
+   */
+  W_API bool subscribe(_In_ const std::shared_ptr<w_ws_session> &p_session,
+                       _In_ std::string_view p_topic);
+
+  /*
+   * unsubscribe a session from a topic
+   * @param p_session, the session
+   * @param p_topic, the topic
+   * @returns false if the session was not subscribed
+   */
+  W_API bool unsubscribe(_In_ const w_ws_session &p_session,
+                         _In_ std::string_view p_topic);
+
+  /*
+   * queue a message on all subscribers of a topic. the buffer is shared by
+   * all sessions, so it must not be modified after it was published
+   * @param p_topic, the topic
+   * @param p_message, the message
+   * @param p_is_binary, send a binary or a text message
+   * @returns the number of sessions which queued the message, a session with
+   * a full queue drops it
+   */
+  W_API size_t publish(_In_ std::string_view p_topic,
+                       _In_ const w_buffer &p_message, _In_ bool p_is_binary);
+
+  /*
+   * copy a payload once into a shared buffer and publish it
+   * @param p_topic, the topic
+   * @param p_message, the message
+   * @param p_is_binary, send a binary or a text message
+   * @returns the number of sessions which queued the message
+   */
+  W_API boost::leaf::result<size_t> publish(
+      _In_ std::string_view p_topic, _In_ gsl::span<const std::byte> p_message,
+      _In_ bool p_is_binary);
+
+  /*
+   * queue a message on all sessions
+   * @param p_message, the message
+   * @param p_is_binary, send a binary or a text message
+   * @returns the number of sessions which queued the message
+   */
+  W_API size_t broadcast(_In_ const w_buffer &p_message,
+                         _In_ bool p_is_binary);
+
+  // returns the number of subscribers of a topic
+  W_API size_t get_subscriber_count(_In_ std::string_view p_topic) const;
+
+  // returns the number of tracked sessions
+  W_API size_t get_session_count() const;
+
+ private:
+  // copy constructor.
+  w_ws_hub(const w_ws_hub &) = delete;
+  // copy assignment operator.
+  w_ws_hub &operator=(const w_ws_hub &) = delete;
+  // move constructor.
+  w_ws_hub(w_ws_hub &&) = delete;
+  // move assignment operator.
+  w_ws_hub &operator=(w_ws_hub &&) = delete;
+
+  struct entry {
+    std::shared_ptr<w_ws_session> session;
+    std::vector<std::string> topics;
+  };
+
+  bool _unsubscribe(_In_ const w_ws_session &p_session,
+                    _In_ std::string_view p_topic);
+
+  mutable std::shared_mutex _mutex;
+  std::unordered_map<const w_ws_session *, entry> _sessions;
+  // a vector per topic, which is the fastest to walk on publish
+  std::map<std::string, std::vector<std::shared_ptr<w_ws_session>>,
+           std::less<>>
+      _topics;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
@@ -2,72 +2,54 @@
 
 #include "w_ws_server.hpp"
 
+#include <wolf/system/w_profiler.hpp>
+
 using w_ws_server = wolf::system::socket::w_ws_server;
 using w_session_ws_on_data_callback =
     wolf::system::socket::w_session_ws_on_data_callback;
 using w_session_on_error_callback =
     wolf::system::socket::w_session_on_error_callback;
+using w_ws_deflate_stats = wolf::system::socket::w_ws_deflate_stats;
+using w_session_limits = wolf::system::socket::w_session_limits;
+using w_server_metrics = wolf::system::socket::w_server_metrics;
+using w_ws_hub = wolf::system::socket::w_ws_hub;
+using w_ws_session = wolf::system::socket::w_ws_session;
+using w_ws_session_on_message_callback =
+    wolf::system::socket::w_ws_session_on_message_callback;
+using w_io_backend = wolf::system::socket::w_io_backend;
 using w_socket_options = wolf::system::socket::w_socket_options;
 using io_context = boost::asio::io_context;
 using w_ws_stream = wolf::system::socket::w_ws_stream;
 using tcp = boost::asio::ip::tcp;
 
-static boost::asio::awaitable<void> s_session(
-    _In_ const boost::asio::io_context &p_io_context, _In_ w_ws_stream &&p_ws,
-    _In_ const std::string p_conn_id,
-    _In_ w_session_ws_on_data_callback p_on_data_callback,
-    _In_ w_session_on_error_callback p_on_error_callback) {
-  // accept the websocket handshake
-  co_await p_ws.async_accept();
+using session_runner =
+    std::function<boost::asio::awaitable<void>(w_ws_session &p_session)>;
 
-  w_buffer _mut_buffer = {};
-  // incoming message
-  boost::beast::flat_buffer _buffer;
-
-  while (!p_io_context.stopped()) {
-    try {
-      // This buffer will hold the incoming message
-
-      // Read a message
-      _mut_buffer.used_bytes = co_await p_ws.async_read(_buffer);
-
-      // an extra copy just for having stable ABI
-      const auto _size =
-          std::min(_mut_buffer.buf.size(), _mut_buffer.used_bytes);
-      std::memcpy(_mut_buffer.buf.data(),
-                  static_cast<char const *>(_buffer.cdata().data()), _size);
-
-      // call callback
-      auto _is_binary = p_ws.got_binary();
-      const auto _code = p_on_data_callback(p_conn_id, _mut_buffer, _is_binary);
-      if (_code != boost::beast::websocket::close_code::none) {
-        break;
-      }
-
-      // Echo the message back
-      if (_is_binary) {
-        p_ws.binary(true);
-      } else {
-        p_ws.text(true);
-      }
-      co_await p_ws.async_write(
-          boost::asio::buffer(_mut_buffer.buf, _mut_buffer.used_bytes));
-
-    } catch (const boost::system::system_error &p_exc) {
-      if (p_exc.code() != boost::beast::websocket::error::closed) {
-        p_on_error_callback(p_conn_id, p_exc);
-      }
-    }
+static boost::asio::awaitable<void> s_session(
+    _In_ w_ws_stream p_ws, _In_ size_t p_max_write_queue,
+    _In_ std::shared_ptr<w_ws_deflate_stats> p_stats,
+    _In_ w_session_limits p_limits,
+    _In_ std::shared_ptr<w_server_metrics> p_metrics,
+    _In_ std::shared_ptr<w_ws_hub> p_hub, _In_ session_runner p_run) {
+  const auto _session = std::make_shared<w_ws_session>(
+      std::move(p_ws), wolf::system::socket::make_connection_id(),
+      p_max_write_queue, std::move(p_stats), p_limits, std::move(p_metrics));
+  if (p_hub != nullptr) {
+    p_hub->add_session(_session);
+  }
+  co_await p_run(*_session);
+  if (p_hub != nullptr) {
+    p_hub->remove_session(*_session);
   }
 }
 
+// the coroutine outlives run, so it must own its arguments
 static boost::asio::awaitable<void> s_listen(
     _In_ const boost::asio::io_context &p_io_context,
-    _In_ const tcp::endpoint &p_endpoint,
-    _In_ const boost::beast::websocket::stream_base::timeout &p_timeout,
-    _In_ w_socket_options &p_socket_options,
-    _In_ w_session_ws_on_data_callback p_on_data_callback,
-    _In_ w_session_on_error_callback p_on_error_callback) {
+    _In_ tcp::endpoint p_endpoint,
+    _In_ boost::beast::websocket::stream_base::timeout p_timeout,
+    _In_ w_socket_options p_socket_options,
+    _In_ std::shared_ptr<w_ws_hub> p_hub, _In_ session_runner p_run) {
   // create acceptor from this coroutine
   auto _executor = co_await boost::asio::this_coro::executor;
   auto _acceptor =
@@ -90,37 +72,56 @@ static boost::asio::awaitable<void> s_listen(
 #pragma unroll
 #endif
   while (!p_io_context.stopped()) {
-    auto _ws = w_ws_stream(co_await _acceptor.async_accept());
+    // the reader, the writer and the wake ups which are posted by send and
+    // close share a strand, in case the io context is run by more than one
+    // thread
+    auto _ws = w_ws_stream(
+        co_await _acceptor.async_accept(boost::asio::make_strand(_executor)));
+    p_socket_options.set_to_socket(_ws.next_layer().socket());
+    if (p_socket_options.metrics != nullptr) {
+      p_socket_options.metrics->local().accepted.fetch_add(
+          1, std::memory_order_relaxed);
+    }
     // set timeout settings for the websocket
     _ws.set_option(p_timeout);
+    // offer permessage-deflate in the handshake
+    p_socket_options.ws_deflate.set_to_stream(_ws);
     // set a decorator to change the Server of the handshake
     _ws.set_option(boost::beast::websocket::stream_base::decorator(
         [](boost::beast::websocket::response_type &res) {
           res.set(boost::beast::http::field::server,
                   std::string(BOOST_BEAST_VERSION_STRING) + "wolf-ws-server");
         }));
-    const auto _conn_id = wolf::system::socket::make_connection_id();
 
-    boost::asio::co_spawn(_acceptor.get_executor(),
-                          s_session(p_io_context, std::move(_ws), _conn_id,
-                                    p_on_data_callback, p_on_error_callback));
+    const auto _session_executor = _ws.get_executor();
+    boost::asio::co_spawn(_session_executor,
+                          s_session(std::move(_ws),
+                                    p_socket_options.max_write_queue,
+                                    p_socket_options.ws_deflate.stats,
+                                    p_socket_options.limits,
+                                    p_socket_options.metrics, p_hub, p_run),
+                          boost::asio::detached);
   }
 }
 
-boost::leaf::result<int> w_ws_server::run(
+static boost::leaf::result<int> s_run(
     _In_ boost::asio::io_context &p_io_context,
-    _In_ const boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ const tcp::endpoint &p_endpoint,
     _In_ const boost::beast::websocket::stream_base::timeout &p_timeout,
-    _In_ w_socket_options &&p_socket_options,
-    _In_ w_session_ws_on_data_callback p_on_data_callback,
-    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+    _In_ w_socket_options &p_socket_options,
+    _In_ std::shared_ptr<w_ws_hub> p_hub, _In_ session_runner p_run) noexcept {
+  if (p_socket_options.io_backend != w_io_backend::epoll) {
+    // beast streams need an asio socket
+    return W_FAILURE(std::errc::not_supported,
+                     "ws server only supports the epoll io backend");
+  }
   try {
     // server with coroutines
-    boost::asio::co_spawn(
-        p_io_context,
-        s_listen(p_io_context, p_endpoint, p_timeout, p_socket_options,
-                 std::move(p_on_data_callback), std::move(p_on_error_callback)),
-        boost::asio::detached);
+    boost::asio::co_spawn(p_io_context,
+                          s_listen(p_io_context, p_endpoint, p_timeout,
+                                   p_socket_options, std::move(p_hub),
+                                   std::move(p_run)),
+                          boost::asio::detached);
     return 0;
 
   } catch (_In_ const std::exception &p_ex) {
@@ -130,4 +131,35 @@ boost::leaf::result<int> w_ws_server::run(
   }
 }
 
+boost::leaf::result<int> w_ws_server::run(
+    _In_ boost::asio::io_context &p_io_context,
+    _In_ const boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ const boost::beast::websocket::stream_base::timeout &p_timeout,
+    _In_ w_socket_options &&p_socket_options,
+    _In_ w_session_ws_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  // the buffer of the data callback is sent back, as before sessions had a
+  // write queue
+  auto _run = [=](_Inout_ w_ws_session &p_session) {
+    return p_session.run(p_on_data_callback, p_on_error_callback);
+  };
+  return s_run(p_io_context, p_endpoint, p_timeout, p_socket_options, nullptr,
+               std::move(_run));
+}
+
+boost::leaf::result<int> w_ws_server::run(
+    _In_ boost::asio::io_context &p_io_context,
+    _In_ const boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ const boost::beast::websocket::stream_base::timeout &p_timeout,
+    _In_ w_socket_options &&p_socket_options,
+    _In_ std::shared_ptr<w_ws_hub> p_hub,
+    _In_ w_ws_session_on_message_callback p_on_message_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  auto _run = [=](_Inout_ w_ws_session &p_session) {
+    return p_session.run(p_on_message_callback, p_on_error_callback);
+  };
+  return s_run(p_io_context, p_endpoint, p_timeout, p_socket_options,
+               std::move(p_hub), std::move(_run));
+}
+
 #endif  // defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
@@ -5,6 +5,8 @@
 #include <wolf.hpp>
 
 #include "w_socket_options.hpp"
+#include "w_ws_hub.hpp"
+#include "w_ws_session.hpp"
 
 namespace wolf::system::socket {
 class w_ws_server {
@@ -26,6 +28,28 @@ class w_ws_server {
       _In_ w_socket_options &&p_socket_options,
       _In_ w_session_ws_on_data_callback p_on_data_callback,
       _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run a server whose sessions get every message as a span of the receive
+   * buffer and can be pushed to through a hub
+   * @param p_io_context, the boost io context
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the timeout for connection
+   * @param p_socket_options, the socket options
+   * @param p_hub, the hub which tracks the sessions for publish and broadcast,
+   * it may be nullptr
+   * @param p_on_message_callback, on message callback for session
+   * @param p_on_error_callback, on error callback for session
+   * @returns void
+   */
+  W_API static boost::leaf::result<int> run(
+      _In_ boost::asio::io_context &p_io_context,
+      _In_ const boost::asio::ip::tcp::endpoint &&p_endpoint,
+      _In_ const boost::beast::websocket::stream_base::timeout &p_timeout,
+      _In_ w_socket_options &&p_socket_options,
+      _In_ std::shared_ptr<w_ws_hub> p_hub,
+      _In_ w_ws_session_on_message_callback p_on_message_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
 };
 }  // namespace wolf::system::socket
 
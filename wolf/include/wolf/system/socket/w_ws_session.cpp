@@ -0,0 +1,441 @@
+#if defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
+
+#include "w_ws_session.hpp"
+
+#include <wolf/system/w_profiler.hpp>
+
+using w_ws_session = wolf::system::socket::w_ws_session;
+using w_ws_session_on_message_callback =
+    wolf::system::socket::w_ws_session_on_message_callback;
+using w_session_ws_on_data_callback =
+    wolf::system::socket::w_session_ws_on_data_callback;
+using w_session_on_error_callback =
+    wolf::system::socket::w_session_on_error_callback;
+using w_dynamic_buffer = wolf::system::socket::w_dynamic_buffer;
+using w_ws_deflate_stats = wolf::system::socket::w_ws_deflate_stats;
+using w_session_limits = wolf::system::socket::w_session_limits;
+using w_server_metrics = wolf::system::socket::w_server_metrics;
+using w_ws_stream = wolf::system::socket::w_ws_stream;
+using close_code = boost::beast::websocket::close_code;
+using steady_clock = std::chrono::steady_clock;
+
+namespace {
+
+// the session whose message callback runs on this thread. its sends wake up
+// the writer once the callback returns, instead of posting a wake up per send
+thread_local const w_ws_session *s_reading_session = nullptr;
+
+}  // namespace
+
+w_ws_session::w_ws_session(
+    _In_ w_ws_stream &&p_ws, _In_ std::string p_conn_id,
+    _In_ size_t p_max_write_queue,
+    _In_ std::shared_ptr<w_ws_deflate_stats> p_stats,
+    _In_ const w_session_limits &p_limits,
+    _In_ std::shared_ptr<w_server_metrics> p_server_metrics) noexcept
+    : _ws(std::move(p_ws)),
+      _conn_id(std::move(p_conn_id)),
+      _max_write_queue(std::max<size_t>(1, p_max_write_queue)),
+      _stats(std::move(p_stats)),
+      _high_watermark(p_limits.write_high_watermark),
+      _low_watermark(std::min(p_limits.write_low_watermark,
+                              p_limits.write_high_watermark)),
+      _read_limiter(p_limits),
+      _server_metrics(std::move(p_server_metrics)),
+      _reader_signal(_ws.get_executor(), steady_clock::time_point::max()),
+      _writer_signal(_ws.get_executor(), steady_clock::time_point::max()) {
+  if (this->_server_metrics != nullptr) {
+    this->_server_metrics->local().active_sessions.fetch_add(
+        1, std::memory_order_relaxed);
+  }
+}
+
+w_ws_session::~w_ws_session() noexcept {
+  if (this->_server_metrics != nullptr) {
+    auto &_shard = this->_server_metrics->local();
+    _shard.active_sessions.fetch_sub(1, std::memory_order_relaxed);
+    _shard.queued_buffers.fetch_sub(
+        gsl::narrow_cast<int64_t>(this->_queue.size()),
+        std::memory_order_relaxed);
+  }
+}
+
+bool w_ws_session::send(_In_ w_buffer p_message, _In_ bool p_is_binary) {
+  {
+    std::scoped_lock _lock(this->_mutex);
+    if (this->_state != state::OPEN) {
+      return false;
+    }
+    if (this->_queue.size() >= this->_max_write_queue) {
+      this->_metrics.sends_dropped.fetch_add(1, std::memory_order_relaxed);
+      if (this->_server_metrics != nullptr) {
+        this->_server_metrics->local().sends_dropped.fetch_add(
+            1, std::memory_order_relaxed);
+      }
+      return false;
+    }
+    this->_queue_bytes += p_message.size();
+    this->_queue.push_back({std::move(p_message), p_is_binary});
+    _count_queue(1);
+    if (!this->_writer_waiting) {
+      return true;
+    }
+    this->_writer_waiting = false;
+    if (s_reading_session == this) {
+      this->_writer_wake_pending = true;
+      return true;
+    }
+  }
+  boost::asio::post(this->_ws.get_executor(), [_self = shared_from_this()]() {
+    _self->_writer_signal.cancel();
+  });
+  return true;
+}
+
+void w_ws_session::close(_In_ close_code p_code) {
+  {
+    std::scoped_lock _lock(this->_mutex);
+    if (this->_state != state::OPEN) {
+      return;
+    }
+    this->_state = state::CLOSING;
+    this->_close_code = p_code;
+    this->_reader_waiting = false;
+    this->_writer_waiting = false;
+  }
+  // the writer drains the queue and then sends the close frame
+  boost::asio::post(this->_ws.get_executor(), [_self = shared_from_this()]() {
+    _self->_reader_signal.cancel();
+    _self->_writer_signal.cancel();
+  });
+}
+
+size_t w_ws_session::get_write_queue_size() const {
+  std::scoped_lock _lock(this->_mutex);
+  return this->_queue.size();
+}
+
+size_t w_ws_session::get_write_queue_bytes() const {
+  std::scoped_lock _lock(this->_mutex);
+  return this->_queue_bytes;
+}
+
+bool w_ws_session::is_open() const {
+  std::scoped_lock _lock(this->_mutex);
+  return this->_state == state::OPEN;
+}
+
+void w_ws_session::_on_error(
+    _In_ const w_session_on_error_callback &p_on_error_callback,
+    _In_ const boost::system::system_error &p_error) noexcept {
+  this->_metrics.errors.record(p_error.code());
+  if (this->_server_metrics != nullptr) {
+    this->_server_metrics->local().errors.record(p_error.code());
+  }
+  p_on_error_callback(this->_conn_id, p_error);
+}
+
+void w_ws_session::_abort() noexcept {
+  {
+    std::scoped_lock _lock(this->_mutex);
+    this->_state = state::CLOSED;
+    const auto _dropped = gsl::narrow_cast<int64_t>(this->_queue.size());
+    this->_queue.clear();
+    this->_queue_bytes = 0;
+    _count_queue(-_dropped);
+    this->_reader_waiting = false;
+    this->_writer_waiting = false;
+  }
+  this->_reader_signal.cancel();
+  this->_writer_signal.cancel();
+  this->_ws.next_layer().close();
+}
+
+void w_ws_session::_count_queue(_In_ int64_t p_change) noexcept {
+  const auto _depth = gsl::narrow_cast<uint64_t>(this->_queue.size());
+  this->_metrics.write_queue_depth.store(_depth, std::memory_order_relaxed);
+  auto &_peak = this->_metrics.write_queue_peak;
+  if (_depth > _peak.load(std::memory_order_relaxed)) {
+    _peak.store(_depth, std::memory_order_relaxed);
+  }
+  if (this->_server_metrics != nullptr && p_change != 0) {
+    this->_server_metrics->local().queued_buffers.fetch_add(
+        p_change, std::memory_order_relaxed);
+  }
+}
+
+bool w_ws_session::_must_pause_reader() const noexcept {
+  return this->_queue.size() >= this->_max_write_queue ||
+         (this->_high_watermark != 0 &&
+          this->_queue_bytes >= this->_high_watermark);
+}
+
+bool w_ws_session::_can_resume_reader() const noexcept {
+  return this->_queue.size() < this->_max_write_queue &&
+         (this->_high_watermark == 0 ||
+          this->_queue_bytes <= this->_low_watermark);
+}
+
+boost::asio::awaitable<void> w_ws_session::run(
+    _In_ w_ws_session_on_message_callback p_on_message_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  // the message goes to the callback as a span of the received buffer
+  const auto _on_receive = [&](_Inout_ w_buffer &p_message,
+                               _In_ bool p_is_binary) {
+    return p_on_message_callback(
+        *this,
+        gsl::span(reinterpret_cast<const std::byte *>(p_message.data()),
+                  p_message.size()),
+        p_is_binary);
+  };
+  co_await _run(_on_receive, p_on_error_callback);
+}
+
+boost::asio::awaitable<void> w_ws_session::run(
+    _In_ w_session_ws_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  const auto _on_receive = [&](_Inout_ w_buffer &p_message,
+                               _In_ bool p_is_binary) {
+    auto _is_binary = p_is_binary;
+    const auto _code =
+        p_on_data_callback(this->_conn_id, p_message, _is_binary);
+    if (_code == close_code::none) {
+      // echo the message back
+      send(p_message, _is_binary);
+    }
+    return _code;
+  };
+  co_await _run(_on_receive, p_on_error_callback);
+}
+
+boost::asio::awaitable<void> w_ws_session::_run(
+    _In_ const receive_handler &p_on_receive,
+    _In_ const w_session_on_error_callback &p_on_error_callback) noexcept {
+  const auto _self = shared_from_this();
+
+  try {
+    // accept the websocket handshake
+    co_await this->_ws.async_accept();
+  } catch (const boost::system::system_error &p_ex) {
+    _on_error(p_on_error_callback, p_ex);
+    _abort();
+    co_return;
+  }
+
+  boost::asio::co_spawn(this->_ws.get_executor(), _write(p_on_error_callback),
+                        boost::asio::detached);
+  co_await _read(p_on_receive, p_on_error_callback);
+}
+
+boost::asio::awaitable<void> w_ws_session::_read(
+    _In_ const receive_handler &p_on_receive,
+    _In_ const w_session_on_error_callback &p_on_error_callback) noexcept {
+  w_buffer _buffer(W_MAX_BUFFER_SIZE);
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    auto _wait = false;
+    {
+      std::scoped_lock _lock(this->_mutex);
+      if (this->_state != state::OPEN) {
+        break;
+      }
+      if (_must_pause_reader()) {
+        this->_reader_waiting = true;
+        _wait = true;
+      }
+    }
+
+    if (_wait) {
+      this->_metrics.read_pauses.fetch_add(1, std::memory_order_relaxed);
+      // stop reading until the writer drains the queue
+      boost::system::error_code _ignore;
+      this->_reader_signal.expires_at(steady_clock::time_point::max());
+      co_await this->_reader_signal.async_wait(
+          boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+      continue;
+    }
+
+    try {
+      // read a message straight into the pooled buffer, it grows to the size
+      // of the whole message. the previous message may still be queued, so
+      // reset gets a new storage
+      _buffer.reset(_buffer.capacity());
+      auto _dynamic_buffer = w_dynamic_buffer(_buffer);
+      const auto &_traffic = this->_ws.next_layer().rate_policy();
+      const auto _wire_bytes = _traffic.get_read_bytes();
+      co_await this->_ws.async_read(_dynamic_buffer);
+      // the profiled scope ends before the throttle, so it only covers the
+      // callback and it ends on the thread which started it
+      {
+        W_PROFILE_SCOPE("w_ws_server::session");
+        this->_metrics.bytes_read.fetch_add(_buffer.size(),
+                                            std::memory_order_relaxed);
+        this->_metrics.messages_read.fetch_add(1, std::memory_order_relaxed);
+
+        if (this->_stats != nullptr) {
+          this->_stats->record_receive(
+              _buffer.size(), _traffic.get_read_bytes() - _wire_bytes);
+        }
+
+        // call callback
+        s_reading_session = this;
+        const auto _started = steady_clock::now();
+        const auto _code = p_on_receive(_buffer, this->_ws.got_binary());
+        const auto _latency = steady_clock::now() - _started;
+        s_reading_session = nullptr;
+
+        this->_metrics.callback_latency.record(_latency);
+        if (this->_server_metrics != nullptr) {
+          auto &_shard = this->_server_metrics->local();
+          _shard.bytes_read.fetch_add(_buffer.size(),
+                                      std::memory_order_relaxed);
+          _shard.messages_read.fetch_add(1, std::memory_order_relaxed);
+          _shard.callback_latency.record(_latency);
+        }
+
+        auto _wake_writer = false;
+        {
+          std::scoped_lock _lock(this->_mutex);
+          _wake_writer = std::exchange(this->_writer_wake_pending, false);
+        }
+        if (_wake_writer) {
+          this->_writer_signal.cancel();
+        }
+
+        if (_code != close_code::none) {
+          close(_code);
+          break;
+        }
+      }
+
+      const auto _delay = this->_read_limiter.take(_buffer.size(), 1);
+      if (_delay > steady_clock::duration::zero()) {
+        // the peer sends faster than its limits, so wait before the next
+        // message. close wakes the reader up early
+        this->_metrics.read_throttles.fetch_add(1, std::memory_order_relaxed);
+        this->_metrics.read_throttled_ns.fetch_add(
+            gsl::narrow_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(_delay)
+                    .count()),
+            std::memory_order_relaxed);
+        boost::system::error_code _ignore;
+        this->_reader_signal.expires_after(_delay);
+        co_await this->_reader_signal.async_wait(
+            boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+      }
+    } catch (const boost::system::system_error &p_ex) {
+      s_reading_session = nullptr;
+      if (p_ex.code() != boost::beast::websocket::error::closed &&
+          is_open()) {
+        _on_error(p_on_error_callback, p_ex);
+      }
+      _abort();
+      break;
+    }
+  }
+}
+
+boost::asio::awaitable<void> w_ws_session::_write(
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  // the writer may outlive the reader
+  const auto _self = shared_from_this();
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    auto _done = false;
+    auto _wake_reader = false;
+    auto _has_message = false;
+    message _message = {};
+    {
+      std::scoped_lock _lock(this->_mutex);
+      if (!this->_queue.empty()) {
+        _message = std::move(this->_queue.front());
+        this->_queue.pop_front();
+        this->_queue_bytes -= _message.buffer.size();
+        _count_queue(-1);
+        _has_message = true;
+      } else if (this->_state != state::OPEN) {
+        _done = true;
+      } else {
+        this->_writer_waiting = true;
+      }
+      if (this->_reader_waiting && _can_resume_reader()) {
+        this->_reader_waiting = false;
+        _wake_reader = true;
+      }
+    }
+
+    if (_wake_reader) {
+      this->_reader_signal.cancel();
+    }
+    if (_done) {
+      break;
+    }
+    if (!_has_message) {
+      boost::system::error_code _ignore;
+      this->_writer_signal.expires_at(steady_clock::time_point::max());
+      co_await this->_writer_signal.async_wait(
+          boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+      continue;
+    }
+
+    try {
+      // the payload is written from the shared buffer, beast only adds the
+      // frame header of this session
+      const auto &_traffic = this->_ws.next_layer().rate_policy();
+      const auto _wire_bytes = _traffic.get_written_bytes();
+      const auto _cpu_time =
+          this->_stats != nullptr ? w_ws_deflate_stats::get_thread_cpu_time()
+                                  : w_ws_deflate_stats::cpu_time{};
+
+      this->_ws.binary(_message.is_binary);
+      co_await this->_ws.async_write(
+          boost::asio::buffer(_message.buffer.data(), _message.buffer.size()));
+      this->_metrics.bytes_written.fetch_add(_message.buffer.size(),
+                                             std::memory_order_relaxed);
+      this->_metrics.messages_written.fetch_add(1, std::memory_order_relaxed);
+      if (this->_server_metrics != nullptr) {
+        auto &_shard = this->_server_metrics->local();
+        _shard.bytes_written.fetch_add(_message.buffer.size(),
+                                       std::memory_order_relaxed);
+        _shard.messages_written.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      if (this->_stats != nullptr) {
+        this->_stats->record_send(_message.buffer.size(),
+                                  _traffic.get_written_bytes() - _wire_bytes,
+                                  _cpu_time);
+      }
+    } catch (const boost::system::system_error &p_ex) {
+      if (p_ex.code() != boost::beast::websocket::error::closed &&
+          is_open()) {
+        _on_error(p_on_error_callback, p_ex);
+      }
+      _abort();
+      break;
+    }
+  }
+
+  auto _close = false;
+  auto _code = close_code::normal;
+  {
+    std::scoped_lock _lock(this->_mutex);
+    _close = this->_state == state::CLOSING;
+    _code = this->_close_code;
+    this->_state = state::CLOSED;
+  }
+  if (_close) {
+    // the queue was drained after close, so send the close frame
+    boost::system::error_code _ignore;
+    co_await this->_ws.async_close(
+        _code,
+        boost::asio::redirect_error(boost::asio::use_awaitable, _ignore));
+  }
+}
+
+#endif  // defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
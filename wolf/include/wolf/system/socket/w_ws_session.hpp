@@ -0,0 +1,172 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#if defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <wolf.hpp>
+
+#include "w_socket_options.hpp"
+
+namespace wolf::system::socket {
+
+class w_ws_session;
+
+typedef std::function<boost::beast::websocket::close_code(
+    _Inout_ w_ws_session &p_session, _In_ gsl::span<const std::byte> p_message,
+    _In_ bool p_is_binary)>
+    w_ws_session_on_message_callback;
+
+/*
+ * a websocket session with a reader coroutine and a writer coroutine. the
+ * writer drains a bounded queue of messages, so the session can be pushed to
+ * from any thread, e.g. by w_ws_hub. a queued message shares the storage of
+ * its w_buffer, so the same message can be queued on many sessions without a
+ * copy.
+ */
+class w_ws_session : public std::enable_shared_from_this<w_ws_session> {
+ public:
+  /*
+   * @param p_ws, the websocket stream before the handshake
+   * @param p_conn_id, the connection id
+   * @param p_max_write_queue, the maximum number of queued messages
+   * @param p_stats, the optional message counters
+   * @param p_limits, the rate limits and the write watermarks of the reader
+   * @param p_server_metrics, the optional counters of the server
+   */
+  W_API w_ws_session(
+      _In_ w_ws_stream &&p_ws, _In_ std::string p_conn_id,
+      _In_ size_t p_max_write_queue,
+      _In_ std::shared_ptr<w_ws_deflate_stats> p_stats = nullptr,
+      _In_ const w_session_limits &p_limits = {},
+      _In_ std::shared_ptr<w_server_metrics> p_server_metrics =
+          nullptr) noexcept;
+
+  // destructor
+  W_API virtual ~w_ws_session() noexcept;
+
+  /*
+   * queue a message for writing, it can be called from any thread. the buffer
+   * must not be modified after it was queued
+   * @param p_message, the message
+   * @param p_is_binary, send a binary or a text message
+   * @returns false if the session is closing or the queue is full
+   */
+  W_API bool send(_In_ w_buffer p_message, _In_ bool p_is_binary);
+
+  /*
+   * write the queued messages and close the websocket, it can be called from
+   * any thread
+   * @param p_code, the close code
+   */
+  W_API void close(_In_ boost::beast::websocket::close_code p_code =
+                       boost::beast::websocket::close_code::normal);
+
+  // returns the connection id
+  W_API const std::string &get_id() const noexcept { return this->_conn_id; }
+
+  // returns the number of queued messages
+  W_API size_t get_write_queue_size() const;
+
+  // returns the number of queued payload bytes
+  W_API size_t get_write_queue_bytes() const;
+
+  // returns the counters of the session
+  W_API const w_session_metrics &get_metrics() const noexcept {
+    return this->_metrics;
+  }
+
+  // returns true until close was called or the connection was lost
+  W_API bool is_open() const;
+
+  /*
+   * accept the handshake and run the reader and the writer until the session
+   * is closed. the message is only valid during the callback
+   * @param p_on_message_callback, on message callback for session
+   * @param p_on_error_callback, on error callback for session
+   */
+  W_API boost::asio::awaitable<void> run(
+      _In_ w_ws_session_on_message_callback p_on_message_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * accept the handshake and run the session with a data callback, whose
+   * buffer is sent back unless the callback returns a close code
+   * @param p_on_data_callback, on data callback for session
+   * @param p_on_error_callback, on error callback for session
+   */
+  W_API boost::asio::awaitable<void> run(
+      _In_ w_session_ws_on_data_callback p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+ private:
+  // copy constructor.
+  w_ws_session(const w_ws_session &) = delete;
+  // copy assignment operator.
+  w_ws_session &operator=(const w_ws_session &) = delete;
+  // move constructor.
+  w_ws_session(w_ws_session &&) = delete;
+  // move assignment operator.
+  w_ws_session &operator=(w_ws_session &&) = delete;
+
+  enum class state { OPEN, CLOSING, CLOSED };
+
+  struct message {
+    w_buffer buffer;
+    bool is_binary = false;
+  };
+
+  // gets a received message and calls the user callbacks
+  using receive_handler = std::function<boost::beast::websocket::close_code(
+      _Inout_ w_buffer &p_message, _In_ bool p_is_binary)>;
+
+  boost::asio::awaitable<void> _run(
+      _In_ const receive_handler &p_on_receive,
+      _In_ const w_session_on_error_callback &p_on_error_callback) noexcept;
+  boost::asio::awaitable<void> _read(
+      _In_ const receive_handler &p_on_receive,
+      _In_ const w_session_on_error_callback &p_on_error_callback) noexcept;
+  boost::asio::awaitable<void> _write(
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+  void _on_error(_In_ const w_session_on_error_callback &p_on_error_callback,
+                 _In_ const boost::system::system_error &p_error) noexcept;
+  void _abort() noexcept;
+  // the queue changed by a number of messages, the mutex must be locked
+  void _count_queue(_In_ int64_t p_change) noexcept;
+  bool _must_pause_reader() const noexcept;
+  bool _can_resume_reader() const noexcept;
+
+  w_ws_stream _ws;
+  std::string _conn_id;
+  size_t _max_write_queue;
+  std::shared_ptr<w_ws_deflate_stats> _stats;
+  size_t _high_watermark;
+  size_t _low_watermark;
+  w_read_limiter _read_limiter;
+  w_session_metrics _metrics;
+  std::shared_ptr<w_server_metrics> _server_metrics;
+
+  // the timers are never expired, a cancel wakes up the waiting coroutine
+  boost::asio::steady_timer _reader_signal;
+  boost::asio::steady_timer _writer_signal;
+
+  mutable std::mutex _mutex;
+  std::deque<message> _queue;
+  size_t _queue_bytes = 0;
+  state _state = state::OPEN;
+  boost::beast::websocket::close_code _close_code =
+      boost::beast::websocket::close_code::normal;
+  bool _reader_waiting = false;
+  bool _writer_waiting = false;
+  bool _writer_wake_pending = false;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // defined(WOLF_SYSTEM_HTTP_WS) && defined(WOLF_SYSTEM_SOCKET)
@@ -0,0 +1,69 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_TEST) && defined(WOLF_SYSTEM_ALLOC_PROFILER)
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <wolf/system/w_leak_detector.hpp>
+#include <wolf/wolf.hpp>
+
+BOOST_AUTO_TEST_CASE(alloc_profiler_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'alloc_profiler_test'" << std::endl;
+
+  using w_alloc_profiler = wolf::system::w_alloc_profiler;
+
+  constexpr auto _size = 12345;
+  const auto _find = [](_In_ const auto &p_sites) {
+    return std::find_if(
+        p_sites.cbegin(), p_sites.cend(),
+        [](const auto &p_stats) { return p_stats.bytes == 3 * _size; });
+  };
+
+  w_alloc_profiler::reset();
+  w_alloc_profiler::enable(true);
+
+  // allocate on another thread and free on this one
+  char *_ptr = nullptr;
+  std::thread([&]() {
+    for (auto i = 0; i < 3; ++i) {
+      auto *_next = new char[_size];
+      delete[] _ptr;
+      _ptr = _next;
+    }
+  }).join();
+
+  auto _sites = w_alloc_profiler::snapshot();
+  auto _iter = _find(_sites);
+  BOOST_REQUIRE(_iter != _sites.cend());
+  BOOST_REQUIRE(_iter->count == 3);
+  BOOST_REQUIRE(_iter->frees == 2);
+  BOOST_REQUIRE(_iter->bytes == 3 * _size);
+  BOOST_REQUIRE(_iter->live_bytes == _size);
+  BOOST_REQUIRE(_iter->peak_live_bytes == 2 * _size);
+
+  delete[] _ptr;
+  w_alloc_profiler::enable(false);
+
+  _sites = w_alloc_profiler::snapshot();
+  _iter = _find(_sites);
+  BOOST_REQUIRE(_iter != _sites.cend());
+  BOOST_REQUIRE(_iter->live_bytes == 0);
+
+  const auto _flat = w_alloc_profiler::to_flat_profile(10);
+  BOOST_REQUIRE(_flat.find("peak") != std::string::npos);
+
+  const auto _json = w_alloc_profiler::to_json(10);
+  BOOST_REQUIRE(_json.starts_with("{\"sites\":["));
+  BOOST_REQUIRE(_json.find("\"bytes\":37035") != std::string::npos);
+
+  std::cout << _flat << std::endl;
+
+  std::cout << "leaving test case 'alloc_profiler_test'" << std::endl;
+}
+
+#endif
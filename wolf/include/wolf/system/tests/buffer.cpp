@@ -0,0 +1,52 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_TEST)
+
+#include <boost/test/unit_test.hpp>
+#include <wolf/system/w_buffer.hpp>
+#include <wolf/system/w_leak_detector.hpp>
+#include <wolf/wolf.hpp>
+
+BOOST_AUTO_TEST_CASE(buffer_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'buffer_test'" << std::endl;
+
+  // a small message fits in the smallest size class
+  auto _buffer = w_buffer("hello");
+  BOOST_REQUIRE(_buffer.size() == 5);
+  BOOST_REQUIRE(_buffer.capacity() == W_MAX_BUFFER_SIZE);
+  BOOST_REQUIRE(_buffer.to_string() == "hello");
+
+  // copies share the storage until one of them grows
+  auto _shared = _buffer;
+  BOOST_REQUIRE(_buffer.use_count() == 2);
+  BOOST_REQUIRE(_shared.data() == _buffer.data());
+
+  _shared.append(" wolf");
+  BOOST_REQUIRE(_buffer.use_count() == 1);
+  BOOST_REQUIRE(_buffer.to_string() == "hello");
+  BOOST_REQUIRE(_shared.to_string() == "hello wolf");
+
+  // messages bigger than 1 KiB are not truncated anymore
+  const auto _big = std::string(5000, 'w');
+  _buffer.append(_big);
+  BOOST_REQUIRE(_buffer.size() == 5005);
+  BOOST_REQUIRE(_buffer.capacity() >= 5005);
+
+  _buffer.consume(5);
+  BOOST_REQUIRE(_buffer.to_string() == _big);
+
+  // a released block is recycled by the pool
+  const auto *_ptr = _buffer.data();
+  _buffer = w_buffer();
+  const auto _recycled = w_buffer(_big.size());
+  BOOST_REQUIRE(_recycled.data() == _ptr);
+
+  std::cout << "leaving test case 'buffer_test'" << std::endl;
+}
+
+#endif  // WOLF_TEST
@@ -5,7 +5,13 @@
 
 #ifdef WOLF_TEST
 
+#include <algorithm>
 #include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <wolf/system/compression/w_chunked.hpp>
+#include <wolf/system/compression/w_compressor.hpp>
 #include <wolf/system/compression/w_lz4.hpp>
 #include <wolf/system/compression/w_lzma.hpp>
 #include <wolf/system/w_leak_detector.hpp>
@@ -46,6 +52,55 @@ BOOST_AUTO_TEST_CASE(compress_lz4_test) {
                         lz4::decompress(_compress_fast, _max_retry));
         BOOST_REQUIRE(_decompress_fast.size() == _bytes_len);
 
+        // the sized block is decompressed in one pass
+        BOOST_LEAF_AUTO(_sized, lz4::compress_sized(_bytes));
+        BOOST_LEAF_AUTO(_original_size, lz4::get_decompressed_size(_sized));
+        BOOST_REQUIRE(_original_size == _bytes_len);
+
+        BOOST_LEAF_AUTO(_decompress_sized, lz4::decompress_sized(_sized));
+        BOOST_REQUIRE(_decompress_sized.size() == _bytes_len);
+        BOOST_REQUIRE(std::equal(_bytes.begin(), _bytes.end(),
+                                 _decompress_sized.begin()));
+
+        // the caller owned buffers
+        auto _compressed = std::vector<std::byte>(
+            lz4::get_compress_sized_bound(_bytes_len));
+        BOOST_LEAF_AUTO(_compressed_size,
+                        lz4::compress_sized(_bytes, _compressed, 8));
+        auto _decompressed = std::vector<std::byte>(_bytes_len);
+        BOOST_LEAF_AUTO(
+            _decompressed_size,
+            lz4::decompress_sized(
+                gsl::span<const std::byte>(_compressed).first(_compressed_size),
+                _decompressed));
+        BOOST_REQUIRE(_decompressed_size == _bytes_len);
+        BOOST_REQUIRE(std::equal(_bytes.begin(), _bytes.end(),
+                                 _decompressed.begin()));
+
+        // a too small destination must not be written past
+        auto _small = std::vector<std::byte>(_bytes_len - 1);
+        BOOST_REQUIRE(!lz4::decompress_sized(_sized, _small));
+
+        // a corrupted size header is rejected before anything is allocated
+        auto _corrupted = _sized;
+        std::fill_n(_corrupted.begin(), lz4::SIZE_HEADER_BYTES,
+                    std::byte{0xFF});
+        BOOST_REQUIRE(!lz4::decompress_sized(_corrupted));
+
+        // a plain block through the caller owned buffers
+        auto _block = std::vector<std::byte>(gsl::narrow_cast<size_t>(
+            lz4::get_compress_bound(gsl::narrow_cast<int>(_bytes_len))));
+        BOOST_LEAF_AUTO(_block_size, lz4::compress_fast(_bytes, _block, 8));
+        auto _plain = std::vector<std::byte>(_bytes_len);
+        BOOST_LEAF_AUTO(
+            _plain_size,
+            lz4::decompress(
+                gsl::span<const std::byte>(_block).first(_block_size),
+                _plain));
+        BOOST_REQUIRE(_plain_size == _bytes_len);
+        BOOST_REQUIRE(
+            std::equal(_bytes.begin(), _bytes.end(), _plain.begin()));
+
         return {};
       },
       [](const w_trace &p_trace) {
@@ -58,6 +113,199 @@ BOOST_AUTO_TEST_CASE(compress_lz4_test) {
   std::cout << "leaving test case 'compress_lz4_test'" << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(compress_lz4_frame_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_lz4_frame_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_lz4_frame = wolf::system::compression::w_lz4_frame;
+        using w_lz4_frame_compressor =
+            wolf::system::compression::w_lz4_frame_compressor;
+        using w_lz4_frame_decompressor =
+            wolf::system::compression::w_lz4_frame_decompressor;
+        using w_lz4_frame_options =
+            wolf::system::compression::w_lz4_frame_options;
+
+        // a few hundred kilobytes of semi compressible data
+        auto _src = std::vector<std::byte>(300 * 1024);
+        for (size_t i = 0; i < _src.size(); ++i) {
+          _src[i] = gsl::narrow_cast<std::byte>((i * 7) ^ (i >> 9));
+        }
+
+        // compress in uneven chunks with linked blocks
+        w_lz4_frame_options _opts = {};
+        _opts.block_independent = false;
+        _opts.block_checksum = true;
+        auto _compressor = w_lz4_frame_compressor(_opts);
+
+        constexpr auto _chunk_size = size_t{10000};
+        auto _out = std::vector<std::byte>(
+            _compressor.get_compress_bound(_chunk_size));
+        auto _compressed = std::vector<std::byte>();
+        const auto _append = [&](size_t p_size) {
+          _compressed.insert(_compressed.end(), _out.cbegin(),
+                             _out.cbegin() + gsl::narrow_cast<long>(p_size));
+        };
+
+        BOOST_LEAF_AUTO(_header, _compressor.begin(_out));
+        _append(_header);
+        for (size_t i = 0; i < _src.size(); i += _chunk_size) {
+          const auto _chunk = gsl::span<const std::byte>(_src).subspan(
+              i, std::min(_chunk_size, _src.size() - i));
+          BOOST_LEAF_AUTO(_bytes, _compressor.update(_chunk, _out));
+          _append(_bytes);
+        }
+        BOOST_LEAF_AUTO(_end, _compressor.finish(_out));
+        _append(_end);
+        BOOST_REQUIRE(_compressed.size() < _src.size());
+
+        // decompress into a tiny buffer
+        auto _decompressor = w_lz4_frame_decompressor();
+        auto _tiny = std::vector<std::byte>(1000);
+        auto _decompressed = std::vector<std::byte>();
+        auto _remaining = gsl::span<const std::byte>(_compressed);
+        bool _finished = false;
+        while (!_finished) {
+          BOOST_LEAF_AUTO(_progress, _decompressor.update(_remaining, _tiny));
+          BOOST_REQUIRE(_progress.produced <= _tiny.size());
+          _decompressed.insert(
+              _decompressed.end(), _tiny.cbegin(),
+              _tiny.cbegin() + gsl::narrow_cast<long>(_progress.produced));
+          _remaining = _remaining.subspan(_progress.consumed);
+          _finished = _progress.finished;
+        }
+        BOOST_REQUIRE(_remaining.empty());
+        BOOST_REQUIRE(_decompressed == _src);
+
+        // the stream helpers
+        auto _src_str = std::string(
+            reinterpret_cast<const char *>(_src.data()), _src.size());
+        std::istringstream _input(_src_str);
+        std::stringstream _frame;
+        BOOST_LEAF_AUTO(_compressed_size,
+                        w_lz4_frame::compress(_input, _frame));
+        BOOST_REQUIRE(_compressed_size == _frame.str().size());
+
+        std::ostringstream _output;
+        BOOST_LEAF_AUTO(_decompressed_size,
+                        w_lz4_frame::decompress(_frame, _output));
+        BOOST_REQUIRE(_decompressed_size == _src.size());
+        BOOST_REQUIRE(_output.str() == _src_str);
+
+        // a truncated frame must fail
+        auto _truncated = _compressed;
+        _truncated.resize(_truncated.size() / 2);
+        std::istringstream _truncated_input(
+            std::string(reinterpret_cast<const char *>(_truncated.data()),
+                        _truncated.size()));
+        std::ostringstream _ignored;
+        const auto _truncated_res =
+            w_lz4_frame::decompress(_truncated_input, _ignored);
+        BOOST_REQUIRE(!_truncated_res);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "compress_lz4_frame_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_lz4_frame_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_lz4_frame_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(compress_lz4_dictionary_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_lz4_dictionary_test'"
+            << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_lz4 = wolf::system::compression::w_lz4;
+        using w_lz4_dictionary = wolf::system::compression::w_lz4_dictionary;
+
+        // small control packets which share their keys but not their values
+        const auto _make_message = [](size_t p_index) {
+          return wolf::format(
+              R"({{"type":"heartbeat","session_id":"{:08x}","sequence":{},)"
+              R"("timestamp":{},"status":"connected","latency_ms":{}}})",
+              p_index * 2654435761U, p_index, 1700000000000 + p_index * 37,
+              p_index % 97);
+        };
+        const auto _as_bytes = [](const std::string &p_str) {
+          return gsl::span<const std::byte>(
+              reinterpret_cast<const std::byte *>(p_str.data()),
+              p_str.size());
+        };
+
+        std::vector<std::string> _messages;
+        std::vector<gsl::span<const std::byte>> _samples;
+        for (size_t i = 0; i < 200; ++i) {
+          _messages.push_back(_make_message(i));
+        }
+        for (const auto &_msg : _messages) {
+          _samples.push_back(_as_bytes(_msg));
+        }
+
+        BOOST_LEAF_AUTO(_dictionary, w_lz4_dictionary::train(_samples, 4096));
+        BOOST_REQUIRE(!_dictionary.get_content().empty());
+        BOOST_REQUIRE(_dictionary.get_content().size() <= 4096);
+
+        // a message which was not a sample
+        const auto _message = _make_message(1000);
+        const auto _src = _as_bytes(_message);
+        BOOST_LEAF_AUTO(_compressed, _dictionary.compress(_src));
+        BOOST_LEAF_AUTO(_plain, w_lz4::compress_default(_src));
+        BOOST_REQUIRE(_compressed.size() < _plain.size());
+
+        BOOST_LEAF_AUTO(_id, w_lz4_dictionary::get_dictionary_id(_compressed));
+        BOOST_REQUIRE(_id == _dictionary.get_id());
+
+        BOOST_LEAF_AUTO(_decompressed, _dictionary.decompress(_compressed));
+        BOOST_REQUIRE(std::equal(_src.begin(), _src.end(),
+                                 _decompressed.begin(), _decompressed.end()));
+
+        // persist and restore the dictionary
+        const auto _path =
+            std::filesystem::temp_directory_path() / "wolf_lz4_dictionary.bin";
+        BOOST_LEAF_CHECK(_dictionary.save(_path));
+        BOOST_LEAF_AUTO(_loaded, w_lz4_dictionary::load(_path));
+        std::filesystem::remove(_path);
+        BOOST_REQUIRE(_loaded.get_id() == _dictionary.get_id());
+
+        auto _dst = std::vector<std::byte>(_src.size());
+        BOOST_LEAF_AUTO(_bytes, _loaded.decompress(_compressed, _dst));
+        BOOST_REQUIRE(_bytes == _src.size());
+        BOOST_REQUIRE(std::equal(_src.begin(), _src.end(), _dst.begin()));
+
+        // another dictionary must reject the message, even when its size
+        // header claims a huge original size
+        BOOST_LEAF_AUTO(_other,
+                        w_lz4_dictionary::from_content(_samples.front(), 7));
+        BOOST_REQUIRE(!_other.decompress(_compressed));
+        auto _forged = _compressed;
+        std::fill_n(_forged.begin() + 4, 3, std::byte{0});
+        _forged[7] = std::byte{0x40};
+        BOOST_REQUIRE(!_other.decompress(_forged));
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("compress_lz4_dictionary_test got an error : {}",
+                         p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_lz4_dictionary_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_lz4_dictionary_test'"
+            << std::endl;
+}
+
 #endif  // WOLF_SYSTEM_LZ4
 
 #ifdef WOLF_SYSTEM_LZMA
@@ -89,6 +337,18 @@ BOOST_AUTO_TEST_CASE(compress_lzma_test) {
 
         BOOST_LEAF_AUTO(_decompress_lzm2,
                         lzma::decompress_lzma2(_compress_lzm2));
+        BOOST_REQUIRE(_decompress_lzm2.size() == _bytes_len);
+
+        // a stream bigger than the destination is not decoded
+        auto _small = std::vector<std::byte>(_bytes_len - 1);
+        BOOST_REQUIRE(!lzma::decompress_lzma2(_compress_lzm2, _small));
+
+        auto _exact = std::vector<std::byte>(_bytes_len);
+        BOOST_LEAF_AUTO(_exact_size,
+                        lzma::decompress_lzma2(_compress_lzm2, _exact));
+        BOOST_REQUIRE(_exact_size == _bytes_len);
+        BOOST_REQUIRE(
+            std::equal(_bytes.begin(), _bytes.end(), _exact.begin()));
 
         return {};
       },
@@ -104,4 +364,182 @@ BOOST_AUTO_TEST_CASE(compress_lzma_test) {
 
 #endif  // WOLF_SYSTEM_LZMA
 
+#if defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
+
+BOOST_AUTO_TEST_CASE(compress_chunked_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_chunked_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_chunked = wolf::system::compression::w_chunked;
+        using w_chunked_codec = wolf::system::compression::w_chunked_codec;
+        using w_chunked_options =
+            wolf::system::compression::w_chunked_options;
+
+        // the last block is a partial one
+        auto _src = std::vector<std::byte>(1000 * 1000 + 123);
+        for (size_t i = 0; i < _src.size(); ++i) {
+          _src[i] = gsl::narrow_cast<std::byte>((i % 251) ^ (i >> 12));
+        }
+
+        w_chunked_options _opts = {};
+#ifdef WOLF_SYSTEM_LZ4
+        _opts.codec = w_chunked_codec::LZ4;
+#else
+        _opts.codec = w_chunked_codec::LZMA2;
+        _opts.level = 1;
+#endif
+        _opts.block_size = 64 * 1024;
+        _opts.threads = 4;
+
+        BOOST_LEAF_AUTO(_container, w_chunked::compress(_src, _opts));
+        BOOST_LEAF_AUTO(_index, w_chunked::read_index(_container));
+        BOOST_REQUIRE(_index.original_size == _src.size());
+        BOOST_REQUIRE(_index.blocks.size() == 16);
+        BOOST_REQUIRE(_index.blocks.back().original_size ==
+                      _src.size() - 15 * _opts.block_size);
+
+        BOOST_LEAF_AUTO(_decompressed, w_chunked::decompress(_container, 3));
+        BOOST_REQUIRE(_decompressed == _src);
+
+        // random access to a single block
+        auto _block = std::vector<std::byte>(_opts.block_size);
+        BOOST_LEAF_AUTO(_bytes,
+                        w_chunked::decompress_block(_container, _index, 7,
+                                                    _block));
+        BOOST_REQUIRE(_bytes == _opts.block_size);
+        BOOST_REQUIRE(std::equal(
+            _block.cbegin(), _block.cend(),
+            _src.cbegin() + gsl::narrow_cast<long>(7 * _opts.block_size)));
+
+        // a corrupted block fails the whole decompression
+        auto _corrupted = _container;
+        const auto &_entry = _index.blocks[5];
+        std::fill_n(_corrupted.begin() + gsl::narrow_cast<long>(_entry.offset),
+                    _entry.compressed_size, std::byte{0xFF});
+        BOOST_REQUIRE(!w_chunked::decompress(_corrupted));
+
+        // the original size in the header is checked against the limit
+        BOOST_REQUIRE(!w_chunked::decompress(_container, 1, _src.size() - 1));
+
+        // a truncated container is rejected by the index
+        _corrupted = _container;
+        _corrupted.resize(_corrupted.size() - 1);
+        BOOST_REQUIRE(!w_chunked::read_index(_corrupted));
+
+#ifdef WOLF_SYSTEM_LZMA
+        // the lzma2 blocks are decoded straight into the output
+        w_chunked_options _lzma_opts = {};
+        _lzma_opts.codec = w_chunked_codec::LZMA2;
+        _lzma_opts.level = 1;
+        _lzma_opts.block_size = 64 * 1024;
+        const auto _lzma_src =
+            gsl::span<const std::byte>(_src).first(3 * 64 * 1024 + 77);
+        BOOST_LEAF_AUTO(_lzma_container,
+                        w_chunked::compress(_lzma_src, _lzma_opts));
+        BOOST_LEAF_AUTO(_lzma_decompressed,
+                        w_chunked::decompress(_lzma_container, 2));
+        BOOST_REQUIRE(std::equal(_lzma_src.begin(), _lzma_src.end(),
+                                 _lzma_decompressed.begin(),
+                                 _lzma_decompressed.end()));
+#endif
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "compress_chunked_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_chunked_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_chunked_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(compress_adaptive_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_adaptive_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_codec = wolf::system::compression::w_codec;
+        using w_compression_target =
+            wolf::system::compression::w_compression_target;
+        using w_compressor = wolf::system::compression::w_compressor;
+        using w_compressor_options =
+            wolf::system::compression::w_compressor_options;
+
+        // a repetitive text
+        std::string _text;
+        for (size_t i = 0; _text.size() < 100 * 1024; ++i) {
+          _text += wolf::format("line {} of the wolf engine log\n", i % 50);
+        }
+        const auto _text_bytes = gsl::span<const std::byte>(
+            reinterpret_cast<const std::byte *>(_text.data()), _text.size());
+
+        // a noise, which stands for an already compressed payload
+        auto _noise = std::vector<std::byte>(100 * 1024);
+        uint64_t _state = 88172645463325252ULL;
+        for (auto &_byte : _noise) {
+          _state ^= _state << 13;
+          _state ^= _state >> 7;
+          _state ^= _state << 17;
+          _byte = gsl::narrow_cast<std::byte>(_state & 0xFF);
+        }
+
+        const auto _text_sample = w_compressor::analyze(_text_bytes, 4096);
+        const auto _noise_sample = w_compressor::analyze(_noise, 4096);
+        BOOST_REQUIRE(_text_sample.entropy < _noise_sample.entropy);
+        BOOST_REQUIRE(_text_sample.repetition > _noise_sample.repetition);
+
+        // the noise is stored without spending time on a codec
+        BOOST_REQUIRE(w_compressor::choose(_noise).codec == w_codec::STORE);
+        BOOST_LEAF_AUTO(_stored, w_compressor::compress(_noise));
+        BOOST_REQUIRE(_stored.size() ==
+                      _noise.size() + w_compressor::HEADER_SIZE);
+        BOOST_LEAF_AUTO(_stored_codec, w_compressor::get_codec(_stored));
+        BOOST_REQUIRE(_stored_codec == w_codec::STORE);
+        BOOST_LEAF_AUTO(_restored, w_compressor::decompress(_stored));
+        BOOST_REQUIRE(_restored == _noise);
+
+        // the text is compressed with every target
+        for (const auto _target : {w_compression_target::THROUGHPUT,
+                                   w_compression_target::BALANCED,
+                                   w_compression_target::RATIO}) {
+          w_compressor_options _opts = {};
+          _opts.target = _target;
+          BOOST_REQUIRE(w_compressor::choose(_text_bytes, _opts).codec !=
+                        w_codec::STORE);
+
+          BOOST_LEAF_AUTO(_compressed,
+                          w_compressor::compress(_text_bytes, _opts));
+          BOOST_REQUIRE(_compressed.size() < _text.size() / 4);
+          BOOST_LEAF_AUTO(_decompressed,
+                          w_compressor::decompress(_compressed));
+          BOOST_REQUIRE(std::equal(_text_bytes.begin(), _text_bytes.end(),
+                                   _decompressed.begin(),
+                                   _decompressed.end()));
+        }
+
+        // an unknown codec is rejected
+        auto _unknown = std::vector<std::byte>{std::byte{0x7F}, std::byte{0}};
+        BOOST_REQUIRE(!w_compressor::decompress(_unknown));
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "compress_adaptive_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_adaptive_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_adaptive_test'" << std::endl;
+}
+
+#endif  // defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_LZMA)
+
 #endif  // WOLF_TESTS
\ No newline at end of file
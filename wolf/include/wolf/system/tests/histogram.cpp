@@ -0,0 +1,67 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_TEST)
+
+#include <boost/test/unit_test.hpp>
+#include <wolf/system/w_histogram.hpp>
+#include <wolf/system/w_leak_detector.hpp>
+#include <wolf/wolf.hpp>
+
+BOOST_AUTO_TEST_CASE(histogram_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'histogram_test'" << std::endl;
+
+  using w_histogram = wolf::system::w_histogram;
+
+  auto _histogram = w_histogram();
+  BOOST_REQUIRE(_histogram.get_count() == 0);
+  BOOST_REQUIRE(_histogram.get_value_at_percentile(99.0) == 0);
+
+  // 1us to 100ms in nanoseconds, so the values span many powers of two
+  for (uint64_t i = 1; i <= 100'000; ++i) {
+    _histogram.record(i * 1000);
+  }
+  BOOST_REQUIRE(_histogram.get_count() == 100'000);
+  BOOST_REQUIRE(_histogram.get_min() == 1000);
+  BOOST_REQUIRE(_histogram.get_max() == 100'000'000);
+
+  // every percentile keeps three significant digits
+  const auto _near = [](uint64_t p_value, uint64_t p_expected) {
+    const auto _error = p_value > p_expected ? p_value - p_expected
+                                             : p_expected - p_value;
+    return _error * 1000 <= p_expected;
+  };
+  BOOST_REQUIRE(_near(_histogram.get_value_at_percentile(50.0), 50'000'000));
+  BOOST_REQUIRE(_near(_histogram.get_value_at_percentile(99.0), 99'000'000));
+  BOOST_REQUIRE(_near(_histogram.get_value_at_percentile(99.9), 99'900'000));
+  BOOST_REQUIRE(_histogram.get_value_at_percentile(100.0) == 100'000'000);
+  BOOST_REQUIRE(_near(
+      gsl::narrow_cast<uint64_t>(_histogram.get_mean()), 50'000'500));
+
+  // a value above the highest trackable one is counted as the highest
+  auto _small = w_histogram(1'000'000, 2);
+  _small.record(5'000'000, 10);
+  BOOST_REQUIRE(_small.get_max() == 1'000'000);
+
+  // histograms of threads are merged, also with another precision
+  auto _merged = w_histogram();
+  _merged.record(10);
+  _merged.merge(_histogram);
+  _merged.merge(_small);
+  BOOST_REQUIRE(_merged.get_count() == 100'011);
+  BOOST_REQUIRE(_merged.get_min() == 10);
+  BOOST_REQUIRE(_merged.get_max() == 100'000'000);
+  BOOST_REQUIRE(_near(_merged.get_value_at_percentile(50.0), 50'000'000));
+
+  _merged.reset();
+  BOOST_REQUIRE(_merged.get_count() == 0);
+  BOOST_REQUIRE(_merged.get_max() == 0);
+
+  std::cout << "leaving test case 'histogram_test'" << std::endl;
+}
+
+#endif  // WOLF_TEST
@@ -1,9 +1,13 @@
 target_sources(${TEST_PROJECT_NAME}
     PRIVATE
-        # ${SYSTEM_PATH}/tests/compress.cpp
+        ${SYSTEM_PATH}/tests/alloc_profiler.cpp
+        ${SYSTEM_PATH}/tests/buffer.cpp
+        ${SYSTEM_PATH}/tests/compress.cpp
         # ${SYSTEM_PATH}/tests/coroutine.cpp
         # ${SYSTEM_PATH}/tests/gamepad.cpp
         ${SYSTEM_PATH}/tests/gametime.cpp
+        ${SYSTEM_PATH}/tests/histogram.cpp
+        ${SYSTEM_PATH}/tests/profiler.cpp
         #${SYSTEM_PATH}/tests/log.cpp
         # lua.cpp
         # postgresql.cpp
@@ -11,7 +15,10 @@ target_sources(${TEST_PROJECT_NAME}
         # python.cpp
         # redis.cpp
         # signal_slot.cpp
-        # tcp.cpp
-        # trace.cpp
-        # ws.cpp
+        ${SYSTEM_PATH}/tests/tcp.cpp
+        ${SYSTEM_PATH}/tests/trace.cpp
+        ${SYSTEM_PATH}/tests/udp.cpp
+        ${SYSTEM_PATH}/tests/ws.cpp
 )
+
+include(${SYSTEM_PATH}/../media/tests/CMakeLists.txt)
@@ -0,0 +1,80 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_TEST)
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <wolf/system/w_leak_detector.hpp>
+#include <wolf/system/w_profiler.hpp>
+#include <wolf/wolf.hpp>
+
+BOOST_AUTO_TEST_CASE(profiler_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'profiler_test'" << std::endl;
+
+  using w_profiler = wolf::system::w_profiler;
+
+  const auto _path =
+      std::filesystem::temp_directory_path() / "wolf_profiler_test.json";
+
+  // nothing is recorded before start
+  { W_PROFILE_SCOPE("before_start"); }
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        BOOST_LEAF_CHECK(w_profiler::start(_path));
+        BOOST_REQUIRE(w_profiler::is_enabled());
+
+        // a second start must fail
+        BOOST_REQUIRE(!w_profiler::start(_path));
+
+        auto _worker = std::thread([]() {
+          w_profiler::set_thread_name("worker");
+          for (auto i = 0; i < 100; ++i) {
+            W_PROFILE_SCOPE("worker_scope");
+          }
+        });
+        { W_PROFILE_SCOPE("main_scope"); }
+        _worker.join();
+
+        w_profiler::stop();
+        BOOST_REQUIRE(!w_profiler::is_enabled());
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("profiler_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("profiler_test got an error!"); });
+
+  std::ifstream _file(_path);
+  std::stringstream _stream;
+  _stream << _file.rdbuf();
+  const auto _json = _stream.str();
+
+  BOOST_REQUIRE(_json.starts_with("{\"traceEvents\":["));
+  BOOST_REQUIRE(_json.find("\"main_scope\"") != std::string::npos);
+  BOOST_REQUIRE(_json.find("\"worker\"") != std::string::npos);
+  BOOST_REQUIRE(_json.find("before_start") == std::string::npos);
+  BOOST_REQUIRE(w_profiler::dropped_events() == 0);
+
+  size_t _count = 0;
+  for (auto _pos = _json.find("\"worker_scope\""); _pos != std::string::npos;
+       _pos = _json.find("\"worker_scope\"", _pos + 1)) {
+    ++_count;
+  }
+  BOOST_REQUIRE(_count == 100);
+
+  std::filesystem::remove(_path);
+
+  std::cout << "leaving test case 'profiler_test'" << std::endl;
+}
+
+#endif
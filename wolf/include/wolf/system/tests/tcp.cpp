@@ -6,12 +6,23 @@
 #if defined(WOLF_TEST) && defined(WOLF_SYSTEM_SOCKET)
 
 #include <boost/test/unit_test.hpp>
+#include <future>
+#include <system/socket/w_framing.hpp>
+#include <system/socket/w_io_context_pool.hpp>
 #include <system/socket/w_tcp_client.hpp>
+#include <system/socket/w_tcp_client_pool.hpp>
 #include <system/socket/w_tcp_server.hpp>
+#include <system/socket/w_tcp_session.hpp>
 #include <system/w_leak_detector.hpp>
 #include <system/w_time.hpp>
 #include <wolf.hpp>
 
+#ifdef WOLF_SYSTEM_SSL
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <system/socket/w_tls_context.hpp>
+#endif
+
 BOOST_AUTO_TEST_CASE(tcp_server_timeout_test) {
   const wolf::system::w_leak_detector _detector = {};
 
@@ -41,7 +52,7 @@ BOOST_AUTO_TEST_CASE(tcp_server_timeout_test) {
                 [](const std::string &p_conn_id, w_buffer &p_mut_data) -> auto {
                   std::cout << "tcp server just got: /'"
                             << p_mut_data.to_string() << "/'"
-                            << " and " << p_mut_data.used_bytes
+                            << " and " << p_mut_data.size()
                             << " bytes from connection id: " << p_conn_id
                             << std::endl;
                   return boost::system::errc::connection_aborted;
@@ -78,36 +89,64 @@ BOOST_AUTO_TEST_CASE(tcp_client_timeout_test) {
   using w_tcp_client = wolf::system::socket::w_tcp_client;
   using w_socket_options = wolf::system::socket::w_socket_options;
   using w_timer = wolf::system::w_timer;
+  using namespace std::chrono_literals;
 
   auto _io = boost::asio::io_context();
+  const auto _loopback = boost::asio::ip::address_v4::loopback();
+
+  // a listener which never accepts, the kernel still completes the
+  // handshake, so the client gets a connection which never sends anything
+  auto _acceptor = tcp::acceptor(_io, {_loopback, 0});
+  const auto _endpoint = _acceptor.local_endpoint();
+
+  // a local port without any listener
+  auto _closed_endpoint = tcp::endpoint();
+  {
+    auto _closed = tcp::acceptor(_io, {_loopback, 0});
+    _closed_endpoint = _closed.local_endpoint();
+  }
 
   w_socket_options _opts = {};
-  tcp::endpoint _endpoint = {tcp::v4(), 8000};
 
   boost::asio::co_spawn(
       _io,
       [&]() -> boost::asio::awaitable<void> {
-        // create a tcp client
         auto _client = w_tcp_client(_io);
-        // create a timer with 1 nanosecond interval
         auto _timer = w_timer(_io);
-        _timer.expires_after(std::chrono::nanoseconds(1));
 
-        // run a coroutine
-        const auto &_ret1 =
+        // a numeric address is resolved without any dns server
+        _timer.expires_after(5s);
+        const auto &_resolve_res =
             co_await (_timer.async_wait(boost::asio::use_awaitable) ||
-                      _client.async_resolve(_endpoint));
-        // expect timeout
-        BOOST_REQUIRE(_ret1.index() == 0);
+                      _client.async_resolve("127.0.0.1", _endpoint.port()));
+        // expect resolving
+        BOOST_REQUIRE(_resolve_res.index() == 1);
 
-        // run timer with 5 seconds interval
-        _timer.cancel();
-        _timer.expires_after(std::chrono::seconds(5));
-        const auto &_ret2 =
+        _timer.expires_after(5s);
+        const auto &_conn_res =
             co_await (_timer.async_wait(boost::asio::use_awaitable) ||
-                      _client.async_resolve("google.com", 443));
-        // expect resolving
-        BOOST_REQUIRE(_ret2.index() == 1);
+                      _client.async_connect(_endpoint, _opts));
+        // expect the connection
+        BOOST_REQUIRE(_conn_res.index() == 1);
+
+        // nothing is sent, so the read must time out
+        w_buffer _recv_buffer{};
+        _timer.expires_after(10ms);
+        const auto &_read_res =
+            co_await (_timer.async_wait(boost::asio::use_awaitable) ||
+                      _client.async_read(_recv_buffer));
+        // expect timeout
+        BOOST_REQUIRE(_read_res.index() == 0);
+
+        // a refused connection is reported instead of hanging
+        auto _refused = w_tcp_client(_io);
+        auto _refused_error = boost::system::error_code();
+        try {
+          co_await _refused.async_connect(_closed_endpoint, _opts);
+        } catch (const boost::system::system_error &p_error) {
+          _refused_error = p_error.code();
+        }
+        BOOST_REQUIRE(_refused_error == boost::asio::error::connection_refused);
 
         _io.stop();
 
@@ -179,9 +218,9 @@ BOOST_AUTO_TEST_CASE(tcp_read_write_test) {
                            _client.async_read(_recv_buffer));
           // expect the connection
           BOOST_REQUIRE(_res.index() == 1);
-          _recv_buffer.used_bytes = std::get<1>(_res);
+          BOOST_REQUIRE(std::get<1>(_res) == _recv_buffer.size());
 
-          BOOST_REQUIRE(_recv_buffer.used_bytes == 10);  // hello-back
+          BOOST_REQUIRE(_recv_buffer.size() == 10);  // hello-back
           BOOST_REQUIRE(_recv_buffer.to_string() ==
                         "hello-back");  // hello-back
         }
@@ -205,12 +244,7 @@ BOOST_AUTO_TEST_CASE(tcp_read_write_test) {
       _io, std::move(_endpoint), _timeout, std::move(_opts),
       [](_In_ const std::string &p_conn_id,
          _Inout_ w_buffer &p_mut_data) -> auto {
-        // close on overflow
-        if (p_mut_data.used_bytes > 1025) {
-          return boost::system::errc::connection_aborted;
-        }
-
-        auto _reply = std::string(p_mut_data.buf.data(), p_mut_data.used_bytes);
+        auto _reply = p_mut_data.to_string();
 
         std::cout << "tcp server just got: \"" << _reply
                   << "\" from connection id: " << p_conn_id << std::endl;
@@ -235,4 +269,1187 @@ BOOST_AUTO_TEST_CASE(tcp_read_write_test) {
   std::cout << "leaving test case 'tcp_read_write_test'" << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(tcp_server_pool_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_server_pool_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using namespace std::chrono_literals;
+
+        constexpr auto _clients = 8;
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8090);
+
+        auto _pool = w_io_context_pool({.size = 2});
+        BOOST_LEAF_AUTO(
+            _run_res,
+            w_tcp_server::run(
+                _pool, tcp::endpoint(_endpoint), 10s, w_socket_options{},
+                [](_In_ const std::string &p_conn_id,
+                   _Inout_ w_buffer &p_mut_data) -> auto {
+                  auto _reply = p_mut_data.to_string();
+                  if (_reply == "exit") {
+                    return boost::system::errc::connection_aborted;
+                  }
+                  _reply += "-back";
+                  p_mut_data.from_string(_reply);
+                  return boost::system::errc::success;
+                },
+                [](const std::string &p_conn_id,
+                   const boost::system::system_error &p_error) {}));
+        BOOST_REQUIRE(_run_res == 0);
+        BOOST_LEAF_CHECK(_pool.run());
+
+        // the clients connect concurrently, so both io contexts get sessions
+        std::atomic<int> _echoes = 0;
+        {
+          std::vector<std::jthread> _threads;
+          for (auto i = 0; i < _clients; ++i) {
+            _threads.emplace_back([&]() {
+              boost::asio::io_context _io;
+              tcp::socket _socket(_io);
+              boost::system::error_code _error;
+              _socket.connect(_endpoint, _error);
+              if (_error) {
+                return;
+              }
+
+              auto _reply = std::string(10, '\0');
+              for (auto j = 0; j < 5; ++j) {
+                boost::asio::write(_socket, boost::asio::buffer("hello", 5),
+                                   _error);
+                if (!_error) {
+                  boost::asio::read(_socket, boost::asio::buffer(_reply),
+                                    _error);
+                }
+                if (_error || _reply != "hello-back") {
+                  return;
+                }
+              }
+              boost::asio::write(_socket, boost::asio::buffer("exit", 4),
+                                 _error);
+              _echoes++;
+            });
+          }
+        }
+        _pool.stop();
+
+        BOOST_REQUIRE(_echoes == _clients);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "tcp_server_pool_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_server_pool_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_server_pool_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_session_push_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_session_push_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_tcp_session = wolf::system::socket::w_tcp_session;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using namespace std::chrono_literals;
+
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8091);
+
+        auto _io = boost::asio::io_context();
+        auto _work = boost::asio::make_work_guard(_io);
+
+        // the session and the results of its sends, the checks run on this
+        // thread, because a failed check can not abort the server thread
+        struct answered_session {
+          std::shared_ptr<w_tcp_session> session;
+          bool sent = false;
+        };
+        std::promise<answered_session> _session;
+        auto _answered = _session.get_future();
+
+        // only touched by the server thread, "hello" might arrive in pieces
+        std::string _request;
+        auto _replied = false;
+
+        BOOST_LEAF_AUTO(
+            _run_res,
+            w_tcp_server::run(
+                _io, tcp::endpoint(_endpoint), 10s, w_socket_options{},
+                [&](_Inout_ w_tcp_session &p_session,
+                    _Inout_ w_buffer &p_mut_data) -> auto {
+                  _request += p_mut_data.to_string();
+                  if (!_replied) {
+                    if (_request.size() < 5) {
+                      return boost::system::errc::success;
+                    }
+                    _replied = true;
+                    _request.erase(0, 5);
+
+                    // many responses for one request
+                    auto _sent = p_session.send(w_buffer("one"));
+                    _sent = p_session.send(w_buffer("two")) && _sent;
+                    _sent = p_session.send(w_buffer("three")) && _sent;
+                    _session.set_value({p_session.shared_from_this(), _sent});
+                  }
+                  if (_request == "exit") {
+                    return boost::system::errc::connection_aborted;
+                  }
+                  return boost::system::errc::success;
+                },
+                [](const std::string &p_conn_id,
+                   const boost::system::system_error &p_error) {}));
+        BOOST_REQUIRE(_run_res == 0);
+
+        auto _server = std::jthread([&]() { _io.run(); });
+
+        boost::asio::io_context _client_io;
+        tcp::socket _socket(_client_io);
+        _socket.connect(_endpoint);
+        boost::asio::write(_socket, boost::asio::buffer("hello", 5));
+
+        const auto _pushed = _answered.get();
+        BOOST_REQUIRE(_pushed.sent);
+
+        auto _reply = std::string(11, '\0');
+        boost::asio::read(_socket, boost::asio::buffer(_reply));
+        BOOST_REQUIRE(_reply == "onetwothree");
+
+        // push from another thread without any request
+        BOOST_REQUIRE(_pushed.session->send(w_buffer("push")));
+        _reply.resize(4);
+        boost::asio::read(_socket, boost::asio::buffer(_reply));
+        BOOST_REQUIRE(_reply == "push");
+
+        // the server closes the session after exit
+        boost::asio::write(_socket, boost::asio::buffer("exit", 4));
+        boost::system::error_code _error;
+        const auto _bytes =
+            boost::asio::read(_socket, boost::asio::buffer(_reply), _error);
+        BOOST_REQUIRE(_bytes == 0 && _error == boost::asio::error::eof);
+        BOOST_REQUIRE(!_pushed.session->is_open());
+        BOOST_REQUIRE(!_pushed.session->send(w_buffer("late")));
+
+        _work.reset();
+        _io.stop();
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "tcp_session_push_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_session_push_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_session_push_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_framing_codec_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_framing_codec_test'" << std::endl;
+
+  using w_frame_codec = wolf::system::socket::w_frame_codec;
+  using w_frame_reader = wolf::system::socket::w_frame_reader;
+
+  const auto _as_bytes = [](std::string_view p_str) {
+    return gsl::span(reinterpret_cast<const std::byte *>(p_str.data()),
+                     p_str.size());
+  };
+  const auto _as_string = [](gsl::span<const std::byte> p_bytes) {
+    return std::string(reinterpret_cast<const char *>(p_bytes.data()),
+                       p_bytes.size());
+  };
+
+  const std::vector<std::string> _payloads = {
+      "", "a", "hello", std::string(300, 'x'), std::string(70000, 'y')};
+
+  const std::vector<std::shared_ptr<const w_frame_codec>> _codecs = {
+      std::make_shared<wolf::system::socket::w_varint_frame_codec>(),
+      std::make_shared<wolf::system::socket::w_fixed32_frame_codec>(),
+      std::make_shared<wolf::system::socket::w_delimiter_frame_codec>("\r\n")};
+
+  for (const auto &_codec : _codecs) {
+    // encode all frames into one stream
+    std::string _stream;
+    for (const auto &_payload : _payloads) {
+      boost::leaf::try_handle_all(
+          [&]() -> boost::leaf::result<void> {
+            BOOST_LEAF_AUTO(_frame, _codec->encode(_as_bytes(_payload)));
+            _stream += _frame.to_string();
+            return {};
+          },
+          [] { BOOST_ERROR("tcp_framing_codec_test could not encode!"); });
+    }
+
+    // feed the stream in chunks of different sizes, which split headers,
+    // payloads and delimiters
+    for (const size_t _chunk : {size_t{1}, size_t{3}, size_t{1000},
+                                _stream.size()}) {
+      w_frame_reader _reader(_codec, 16);
+      std::vector<std::string> _frames;
+      for (size_t _offset = 0; _offset < _stream.size(); _offset += _chunk) {
+        const auto _size = std::min(_chunk, _stream.size() - _offset);
+        const auto _space = _reader.prepare(_size);
+        BOOST_REQUIRE(_space.size() >= _size);
+        std::memcpy(_space.data(), _stream.data() + _offset, _size);
+        _reader.commit(_size);
+
+        boost::leaf::try_handle_all(
+            [&]() -> boost::leaf::result<void> {
+              BOOST_LEAF_CHECK(_reader.read_frames([&](auto p_frame) {
+                _frames.push_back(_as_string(p_frame));
+                return true;
+              }));
+              return {};
+            },
+            [] { BOOST_ERROR("tcp_framing_codec_test could not decode!"); });
+      }
+      BOOST_REQUIRE(_frames == _payloads);
+    }
+  }
+
+  // a frame over the limit is an error, before its payload arrives
+  const auto _small =
+      std::make_shared<wolf::system::socket::w_fixed32_frame_codec>(1024);
+  w_frame_reader _reader(_small);
+  const auto _header = std::string("\x00\x01\x00\x00", 4);
+  const auto _space = _reader.prepare(_header.size());
+  std::memcpy(_space.data(), _header.data(), _header.size());
+  _reader.commit(_header.size());
+  auto _failed = false;
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        BOOST_LEAF_CHECK(_reader.read_frames([](auto) { return true; }));
+        return {};
+      },
+      [&] { _failed = true; });
+  BOOST_REQUIRE(_failed);
+
+  // an incomplete line reports the searched bytes, and the next decode
+  // resumes there, also when the delimiter straddles both receives
+  const auto _lines =
+      wolf::system::socket::w_delimiter_frame_codec("\r\n");
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        BOOST_LEAF_AUTO(_partial, _lines.decode(_as_bytes("hello\r"), 0));
+        BOOST_REQUIRE(_partial.frame_size == 0);
+        BOOST_REQUIRE(_partial.scanned == 6);
+
+        BOOST_LEAF_AUTO(_line, _lines.decode(_as_bytes("hello\r\n"),
+                                             _partial.scanned));
+        BOOST_REQUIRE(_line.frame_size == 7);
+        BOOST_REQUIRE(_as_string(_line.payload) == "hello");
+        return {};
+      },
+      [] { BOOST_ERROR("tcp_framing_codec_test could not resume!"); });
+
+  std::cout << "leaving test case 'tcp_framing_codec_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_framed_server_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_framed_server_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_tcp_client = wolf::system::socket::w_tcp_client;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_tcp_session = wolf::system::socket::w_tcp_session;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using namespace std::chrono_literals;
+
+        constexpr auto _count = 100;
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8092);
+        const auto _codec =
+            std::make_shared<wolf::system::socket::w_varint_frame_codec>();
+
+        auto _io = boost::asio::io_context();
+
+        // echo every frame with a prefix
+        BOOST_LEAF_AUTO(
+            _run_res,
+            w_tcp_server::run(
+                _io, tcp::endpoint(_endpoint), 10s, w_socket_options{},
+                _codec,
+                [](_Inout_ w_tcp_session &p_session,
+                   _In_ gsl::span<const std::byte> p_frame) -> auto {
+                  auto _reply = std::string("re:");
+                  _reply.append(reinterpret_cast<const char *>(p_frame.data()),
+                                p_frame.size());
+                  if (_reply == "re:exit") {
+                    return boost::system::errc::connection_aborted;
+                  }
+                  p_session.send_frame(gsl::span(
+                      reinterpret_cast<const std::byte *>(_reply.data()),
+                      _reply.size()));
+                  return boost::system::errc::success;
+                },
+                [](const std::string &p_conn_id,
+                   const boost::system::system_error &p_error) {}));
+        BOOST_REQUIRE(_run_res == 0);
+
+        auto _replies = std::vector<std::string>();
+        boost::asio::co_spawn(
+            _io,
+            [&]() -> boost::asio::awaitable<void> {
+              auto _client = w_tcp_client(_io);
+              co_await _client.async_connect(_endpoint, w_socket_options{});
+
+              // many frames are written before any reply is read
+              for (auto i = 0; i < _count; ++i) {
+                const auto _msg = std::to_string(i);
+                co_await _client.async_write_frame(
+                    *_codec,
+                    gsl::span(reinterpret_cast<const std::byte *>(_msg.data()),
+                              _msg.size()));
+              }
+
+              auto _reader = wolf::system::socket::w_frame_reader(_codec);
+              while (_replies.size() < _count) {
+                co_await _client.async_read_frames(
+                    _reader, [&](gsl::span<const std::byte> p_frame) {
+                      _replies.emplace_back(
+                          reinterpret_cast<const char *>(p_frame.data()),
+                          p_frame.size());
+                      return true;
+                    });
+              }
+
+              const auto _exit = std::string("exit");
+              co_await _client.async_write_frame(
+                  *_codec,
+                  gsl::span(reinterpret_cast<const std::byte *>(_exit.data()),
+                            _exit.size()));
+              _io.stop();
+            },
+            boost::asio::detached);
+
+        _io.run();
+
+        BOOST_REQUIRE(_replies.size() == _count);
+        for (auto i = 0; i < _count; ++i) {
+          BOOST_REQUIRE(_replies[i] == "re:" + std::to_string(i));
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "tcp_framed_server_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_framed_server_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_framed_server_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_client_buffered_frames_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_client_buffered_frames_test'"
+            << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_tcp_client = wolf::system::socket::w_tcp_client;
+        using w_frame_codec = wolf::system::socket::w_frame_codec;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using w_timer = wolf::system::w_timer;
+        using namespace std::chrono_literals;
+
+        const auto _codec =
+            std::make_shared<wolf::system::socket::w_varint_frame_codec>();
+
+        // two frames which go out in one write
+        auto _wire = std::vector<std::byte>();
+        for (const auto _msg : {std::string_view("first"),
+                                std::string_view("second")}) {
+          std::array<std::byte, w_frame_codec::MAX_HEADER_SIZE> _header = {};
+          BOOST_LEAF_AUTO(_header_size,
+                          _codec->encode_header(_msg.size(), _header));
+          _wire.insert(_wire.end(), _header.begin(),
+                       _header.begin() + _header_size);
+          const auto _payload = reinterpret_cast<const std::byte *>(_msg.data());
+          _wire.insert(_wire.end(), _payload, _payload + _msg.size());
+          const auto _trailer = _codec->get_trailer();
+          _wire.insert(_wire.end(), _trailer.begin(), _trailer.end());
+        }
+
+        auto _io = boost::asio::io_context();
+        auto _acceptor =
+            tcp::acceptor(_io, {boost::asio::ip::address_v4::loopback(), 0});
+
+        auto _frames = std::vector<std::string>();
+        auto _timed_out = false;
+        boost::asio::co_spawn(
+            _io,
+            [&]() -> boost::asio::awaitable<void> {
+              auto _client = w_tcp_client(_io);
+              co_await _client.async_connect(_acceptor.local_endpoint(),
+                                             w_socket_options{});
+              auto _peer =
+                  co_await _acceptor.async_accept(boost::asio::use_awaitable);
+              co_await boost::asio::async_write(
+                  _peer, boost::asio::buffer(_wire.data(), _wire.size()),
+                  boost::asio::use_awaitable);
+
+              // stop after every frame, the peer sends nothing more, so the
+              // second frame must come from the bytes of the first receive
+              auto _reader = wolf::system::socket::w_frame_reader(_codec);
+              auto _timer = w_timer(_io);
+              for (auto i = 0; i < 2; ++i) {
+                _timer.expires_after(5s);
+                const auto _res = co_await (
+                    _timer.async_wait(boost::asio::use_awaitable) ||
+                    _client.async_read_frames(
+                        _reader, [&](gsl::span<const std::byte> p_frame) {
+                          _frames.emplace_back(
+                              reinterpret_cast<const char *>(p_frame.data()),
+                              p_frame.size());
+                          return false;
+                        }));
+                _timed_out = _timed_out || _res.index() == 0;
+              }
+              _io.stop();
+            },
+            boost::asio::detached);
+
+        _io.run();
+
+        BOOST_REQUIRE(!_timed_out);
+        BOOST_REQUIRE(_frames.size() == 2);
+        BOOST_REQUIRE(_frames[0] == "first");
+        BOOST_REQUIRE(_frames[1] == "second");
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("tcp_client_buffered_frames_test got an error : {}",
+                         p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_client_buffered_frames_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_client_buffered_frames_test'"
+            << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_client_pool_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_client_pool_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_tcp_client_pool = wolf::system::socket::w_tcp_client_pool;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using namespace std::chrono_literals;
+
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8093);
+
+        auto _io = boost::asio::io_context();
+
+        BOOST_LEAF_AUTO(
+            _run_res,
+            w_tcp_server::run(
+                _io, tcp::endpoint(_endpoint), 10s, w_socket_options{},
+                [](_In_ const std::string &p_conn_id,
+                   _Inout_ w_buffer &p_mut_data) -> auto {
+                  auto _reply = p_mut_data.to_string();
+                  if (_reply == "exit") {
+                    return boost::system::errc::connection_aborted;
+                  }
+                  p_mut_data.from_string(_reply + "-back");
+                  return boost::system::errc::success;
+                },
+                [](const std::string &p_conn_id,
+                   const boost::system::system_error &p_error) {}));
+        BOOST_REQUIRE(_run_res == 0);
+
+        // one connection at most, so a second acquire has to wait
+        auto _pool = std::make_shared<w_tcp_client_pool>(
+            _io, wolf::system::socket::w_tcp_client_pool_options{
+                     .max_idle = 1,
+                     .max_active = 1,
+                     .probe_interval = std::chrono::seconds(0)});
+
+        const auto _ping = [](w_tcp_client_pool::lease &p_lease)
+            -> boost::asio::awaitable<std::string> {
+          w_buffer _recv_buffer{};
+          co_await p_lease.client->async_write(w_buffer("ping"));
+          co_await p_lease.client->async_read(_recv_buffer);
+          co_return _recv_buffer.to_string();
+        };
+
+        auto _waiter_done = false;
+        boost::asio::co_spawn(
+            _io,
+            [&]() -> boost::asio::awaitable<void> {
+              auto _lease = co_await _pool->acquire("127.0.0.1", 8093);
+              BOOST_REQUIRE(co_await _ping(_lease) == "ping-back");
+              _pool->release(std::move(_lease));
+              BOOST_REQUIRE(_pool->get_idle_count() == 1);
+              BOOST_REQUIRE(_pool->get_active_count() == 0);
+
+              // the idle connection is reused
+              _lease = co_await _pool->acquire("127.0.0.1", 8093);
+              BOOST_REQUIRE(_pool->get_idle_count() == 0);
+              BOOST_REQUIRE(_pool->get_active_count() == 1);
+
+              boost::asio::co_spawn(
+                  _io,
+                  [&]() -> boost::asio::awaitable<void> {
+                    auto _lease = co_await _pool->acquire("127.0.0.1", 8093);
+                    BOOST_REQUIRE(co_await _ping(_lease) == "ping-back");
+                    _pool->release(std::move(_lease));
+                    _waiter_done = true;
+                  },
+                  boost::asio::detached);
+
+              auto _timer = boost::asio::steady_timer(_io);
+              _timer.expires_after(100ms);
+              co_await _timer.async_wait(boost::asio::use_awaitable);
+              BOOST_REQUIRE(!_waiter_done);
+
+              BOOST_REQUIRE(co_await _ping(_lease) == "ping-back");
+              _pool->release(std::move(_lease));
+              while (!_waiter_done) {
+                _timer.expires_after(10ms);
+                co_await _timer.async_wait(boost::asio::use_awaitable);
+              }
+              BOOST_REQUIRE(_pool->get_idle_count() == 1);
+
+              // a connection which is not reused is closed
+              _lease = co_await _pool->acquire("127.0.0.1", 8093);
+              co_await _lease.client->async_write(w_buffer("exit"));
+              _pool->release(std::move(_lease), false);
+              BOOST_REQUIRE(_pool->get_idle_count() == 0);
+              BOOST_REQUIRE(_pool->get_active_count() == 0);
+
+              _pool.reset();
+              _io.stop();
+            },
+            boost::asio::detached);
+
+        _io.run();
+
+        BOOST_REQUIRE(_waiter_done);
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "tcp_client_pool_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_client_pool_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_client_pool_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_session_limits_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_session_limits_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_tcp_client = wolf::system::socket::w_tcp_client;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_tcp_session = wolf::system::socket::w_tcp_session;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using namespace std::chrono_literals;
+
+        constexpr auto _count = 5;
+        constexpr size_t _response_size = 256 * 1024;
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8094);
+
+        // one request per 50ms, and a response is bigger than the high
+        // watermark, so the reader pauses while it is not throttled
+        auto _opts = w_socket_options{};
+        _opts.limits.read_messages_per_second = 20;
+        _opts.limits.read_burst_messages = 1;
+        _opts.limits.write_high_watermark = 64 * 1024;
+        _opts.limits.write_low_watermark = 16 * 1024;
+
+        auto _io = boost::asio::io_context();
+
+        uint64_t _messages_read = 0;
+        uint64_t _bytes_written = 0;
+        uint64_t _read_pauses = 0;
+        uint64_t _read_throttles = 0;
+        BOOST_LEAF_AUTO(
+            _run_res,
+            w_tcp_server::run(
+                _io, tcp::endpoint(_endpoint), 10s, std::move(_opts),
+                [&](_Inout_ w_tcp_session &p_session,
+                    _Inout_ w_buffer &p_mut_data) -> auto {
+                  if (p_mut_data.to_string() == "exit") {
+                    const auto &_metrics = p_session.get_metrics();
+                    _messages_read = _metrics.messages_read;
+                    _bytes_written = _metrics.bytes_written;
+                    _read_pauses = _metrics.read_pauses;
+                    _read_throttles = _metrics.read_throttles;
+                    _io.stop();
+                    return boost::system::errc::connection_aborted;
+                  }
+                  p_session.send(w_buffer(std::string(_response_size, 'w')));
+                  return boost::system::errc::success;
+                },
+                [](const std::string &p_conn_id,
+                   const boost::system::system_error &p_error) {}));
+        BOOST_REQUIRE(_run_res == 0);
+
+        auto _elapsed = std::chrono::steady_clock::duration::zero();
+        boost::asio::co_spawn(
+            _io,
+            [&]() -> boost::asio::awaitable<void> {
+              auto _client = w_tcp_client(_io);
+              co_await _client.async_connect(_endpoint, w_socket_options{});
+
+              const auto _begin = std::chrono::steady_clock::now();
+              w_buffer _response{};
+              for (auto i = 0; i < _count; ++i) {
+                co_await _client.async_write(w_buffer("ping"));
+                size_t _received = 0;
+                while (_received < _response_size) {
+                  _received += co_await _client.async_read(_response);
+                }
+              }
+              _elapsed = std::chrono::steady_clock::now() - _begin;
+
+              co_await _client.async_write(w_buffer("exit"));
+            },
+            boost::asio::detached);
+
+        _io.run();
+
+        // a throttled reader waits before its next receive, so the responses
+        // of the last three requests wait 50ms each
+        BOOST_REQUIRE(_elapsed >= 100ms);
+        BOOST_REQUIRE(_messages_read == _count + 1);
+        BOOST_REQUIRE(_bytes_written == _count * _response_size);
+        BOOST_REQUIRE(_read_pauses >= 1);
+        BOOST_REQUIRE(_read_throttles >= _count - 1);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "tcp_session_limits_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_session_limits_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_session_limits_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_io_uring_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_io_uring_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_io_backend = wolf::system::socket::w_io_backend;
+        using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using namespace std::chrono_literals;
+
+        constexpr auto _clients = 8;
+        // bigger than a receive buffer, so it takes many receives and sends
+        constexpr size_t _big_size = 256 * 1024;
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8097);
+
+        auto _pool = w_io_context_pool({.size = 2});
+        const auto _run_res = w_tcp_server::run(
+            _pool, tcp::endpoint(_endpoint), 10s,
+            w_socket_options{.io_backend = w_io_backend::io_uring},
+            [](_In_ const std::string &p_conn_id,
+               _Inout_ w_buffer &p_mut_data) -> auto {
+              auto _reply = p_mut_data.to_string();
+              if (_reply == "exit") {
+                return boost::system::errc::connection_aborted;
+              }
+              if (_reply == "hello") {
+                p_mut_data.from_string("hello-back");
+              }
+              return boost::system::errc::success;
+            },
+            [](const std::string &p_conn_id,
+               const boost::system::system_error &p_error) {});
+        if (!_run_res) {
+          // e.g. an older kernel or a container which forbids io_uring
+          std::cout << "io_uring is not available, skipped" << std::endl;
+          return {};
+        }
+        BOOST_LEAF_CHECK(_pool.run());
+
+        std::atomic<int> _echoes = 0;
+        {
+          std::vector<std::jthread> _threads;
+          for (auto i = 0; i < _clients; ++i) {
+            _threads.emplace_back([&]() {
+              boost::asio::io_context _io;
+              tcp::socket _socket(_io);
+              boost::system::error_code _error;
+              _socket.connect(_endpoint, _error);
+              if (_error) {
+                return;
+              }
+
+              auto _reply = std::string(10, '\0');
+              for (auto j = 0; j < 5; ++j) {
+                boost::asio::write(_socket, boost::asio::buffer("hello", 5),
+                                   _error);
+                if (!_error) {
+                  boost::asio::read(_socket, boost::asio::buffer(_reply),
+                                    _error);
+                }
+                if (_error || _reply != "hello-back") {
+                  return;
+                }
+              }
+
+              const auto _big = std::string(_big_size, 'w');
+              auto _echo = std::string(_big_size, '\0');
+              boost::asio::write(_socket, boost::asio::buffer(_big), _error);
+              if (!_error) {
+                boost::asio::read(_socket, boost::asio::buffer(_echo),
+                                  _error);
+              }
+              if (_error || _echo != _big) {
+                return;
+              }
+
+              // the server closes the connection after exit
+              boost::asio::write(_socket, boost::asio::buffer("exit", 4),
+                                 _error);
+              char _byte = 0;
+              boost::asio::read(_socket, boost::asio::buffer(&_byte, 1),
+                                _error);
+              if (_error == boost::asio::error::eof) {
+                _echoes++;
+              }
+            });
+          }
+        }
+        _pool.stop();
+
+        BOOST_REQUIRE(_echoes == _clients);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("tcp_io_uring_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_io_uring_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_io_uring_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_server_idle_timeout_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_server_idle_timeout_test'"
+            << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_io_backend = wolf::system::socket::w_io_backend;
+        using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using namespace std::chrono_literals;
+
+        constexpr auto _timeout = 300ms;
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8098);
+
+        for (const auto _backend :
+             {w_io_backend::epoll, w_io_backend::io_uring}) {
+          std::atomic<int> _timeouts = 0;
+          std::atomic<bool> _chatty_done = false;
+          auto _pool = w_io_context_pool({.size = 1});
+          const auto _run_res = w_tcp_server::run(
+              _pool, tcp::endpoint(_endpoint), _timeout,
+              w_socket_options{.io_backend = _backend},
+              [](_In_ const std::string &p_conn_id,
+                 _Inout_ w_buffer &p_mut_data) -> auto {
+                return boost::system::errc::success;
+              },
+              [&](const std::string &p_conn_id,
+                  const boost::system::system_error &p_error) {
+                if (p_error.code() == boost::system::errc::timed_out) {
+                  _timeouts++;
+                }
+              });
+          if (!_run_res && _backend == w_io_backend::io_uring) {
+            std::cout << "io_uring is not available, skipped" << std::endl;
+            continue;
+          }
+          BOOST_REQUIRE(_run_res);
+          BOOST_LEAF_CHECK(_pool.run());
+
+          // a client which sends more often than the timeout stays connected
+          auto _chatty = std::jthread([&]() {
+            boost::asio::io_context _io;
+            tcp::socket _socket(_io);
+            boost::system::error_code _error;
+            _socket.connect(_endpoint, _error);
+
+            auto _echo = std::string(4, '\0');
+            for (auto i = 0; i < 10 && !_error; ++i) {
+              std::this_thread::sleep_for(_timeout / 3);
+              boost::asio::write(_socket, boost::asio::buffer("ping", 4),
+                                 _error);
+              if (!_error) {
+                boost::asio::read(_socket, boost::asio::buffer(_echo), _error);
+              }
+            }
+            _chatty_done = !_error && _echo == "ping";
+          });
+
+          // an idle client is closed by the server after the timeout
+          boost::asio::io_context _io;
+          tcp::socket _socket(_io);
+          const auto _begin = std::chrono::steady_clock::now();
+          _socket.connect(_endpoint);
+
+          auto _elapsed = std::chrono::steady_clock::duration::max();
+          boost::system::error_code _error;
+          char _byte = 0;
+          boost::asio::async_read(
+              _socket, boost::asio::buffer(&_byte, 1),
+              [&](const boost::system::error_code &p_error, size_t) {
+                _error = p_error;
+                _elapsed = std::chrono::steady_clock::now() - _begin;
+              });
+          _io.run_for(5s);
+          _chatty.join();
+          _pool.stop();
+
+          BOOST_REQUIRE(_error == boost::asio::error::eof);
+          BOOST_REQUIRE(_elapsed >= _timeout);
+          BOOST_REQUIRE(_elapsed < 5s);
+          BOOST_REQUIRE(_timeouts >= 1);
+          BOOST_REQUIRE(_chatty_done);
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("tcp_server_idle_timeout_test got an error : {}",
+                         p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_server_idle_timeout_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_server_idle_timeout_test'"
+            << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_server_metrics_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_server_metrics_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_error_category = wolf::system::socket::w_error_category;
+        using w_io_backend = wolf::system::socket::w_io_backend;
+        using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+        using w_latency_histogram = wolf::system::socket::w_latency_histogram;
+        using w_server_metrics = wolf::system::socket::w_server_metrics;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using namespace std::chrono_literals;
+
+        // the buckets are powers of two nanoseconds
+        w_latency_histogram _histogram;
+        BOOST_REQUIRE(_histogram.get_value_at_percentile(50.0) == 0);
+        for (auto i = 0; i < 99; ++i) {
+          _histogram.record(1000ns);
+        }
+        _histogram.record(1s);
+        BOOST_REQUIRE(_histogram.get_count() == 100);
+        BOOST_REQUIRE(_histogram.get_value_at_percentile(50.0) == 1023);
+        BOOST_REQUIRE(_histogram.get_value_at_percentile(100.0) >= 1000000000);
+
+        BOOST_REQUIRE(wolf::system::socket::get_error_category(
+                          boost::asio::error::eof) ==
+                      w_error_category::asio_misc);
+        BOOST_REQUIRE(wolf::system::socket::get_error_category(
+                          boost::asio::error::connection_reset) ==
+                      w_error_category::system);
+
+        constexpr auto _clients = 3;
+        constexpr auto _pings = 4;
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8100);
+
+        for (const auto _backend :
+             {w_io_backend::epoll, w_io_backend::io_uring}) {
+          const auto _metrics = std::make_shared<w_server_metrics>();
+          const auto _begin = _metrics->get_snapshot();
+
+          auto _pool = w_io_context_pool({.size = 2});
+          const auto _run_res = w_tcp_server::run(
+              _pool, tcp::endpoint(_endpoint), 5s,
+              w_socket_options{.io_backend = _backend, .metrics = _metrics},
+              [](_In_ const std::string &p_conn_id,
+                 _Inout_ w_buffer &p_mut_data) -> auto {
+                return boost::system::errc::success;
+              },
+              [](const std::string &p_conn_id,
+                 const boost::system::system_error &p_error) {});
+          if (!_run_res && _backend == w_io_backend::io_uring) {
+            std::cout << "io_uring is not available, skipped" << std::endl;
+            continue;
+          }
+          BOOST_REQUIRE(_run_res);
+          BOOST_LEAF_CHECK(_pool.run());
+
+          for (auto i = 0; i < _clients; ++i) {
+            boost::asio::io_context _io;
+            tcp::socket _socket(_io);
+            _socket.connect(_endpoint);
+            auto _echo = std::string(4, '\0');
+            for (auto j = 0; j < _pings; ++j) {
+              boost::asio::write(_socket, boost::asio::buffer("ping", 4));
+              boost::asio::read(_socket, boost::asio::buffer(_echo));
+            }
+          }
+
+          // the sessions end once the server saw the clients close
+          auto _snapshot = _metrics->get_snapshot();
+          for (auto i = 0; i < 200 && _snapshot.active_sessions != 0; ++i) {
+            std::this_thread::sleep_for(10ms);
+            _snapshot = _metrics->get_snapshot();
+          }
+          _pool.stop();
+
+          BOOST_REQUIRE(_snapshot.accepted == _clients);
+          BOOST_REQUIRE(_snapshot.active_sessions == 0);
+          BOOST_REQUIRE(_snapshot.queued_buffers == 0);
+          BOOST_REQUIRE(_snapshot.messages_read == _clients * _pings);
+          BOOST_REQUIRE(_snapshot.messages_written == _clients * _pings);
+          BOOST_REQUIRE(_snapshot.bytes_read == _clients * _pings * 4);
+          BOOST_REQUIRE(_snapshot.bytes_written == _clients * _pings * 4);
+          BOOST_REQUIRE(_snapshot.callback_latency.get_count() ==
+                        _clients * _pings);
+          // every client ended its session with an eof
+          const auto _eofs = _snapshot.errors[static_cast<size_t>(
+              w_error_category::asio_misc)];
+          BOOST_REQUIRE(_eofs == _clients);
+          BOOST_REQUIRE(w_server_metrics::get_accept_rate(_begin, _snapshot) >
+                        0.0);
+        }
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "tcp_server_metrics_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_server_metrics_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_server_metrics_test'" << std::endl;
+}
+
+#ifdef WOLF_SYSTEM_SSL
+
+// write a self signed certificate of localhost and its key
+static void s_write_test_certificate(
+    _In_ const std::filesystem::path &p_certificate_file,
+    _In_ const std::filesystem::path &p_private_key_file) {
+  auto *_key = EVP_EC_gen("P-256");
+  auto *_certificate = X509_new();
+  ASN1_INTEGER_set(X509_get_serialNumber(_certificate), 1);
+  X509_gmtime_adj(X509_getm_notBefore(_certificate), 0);
+  X509_gmtime_adj(X509_getm_notAfter(_certificate), 3600);
+  X509_set_pubkey(_certificate, _key);
+  auto *_name = X509_get_subject_name(_certificate);
+  X509_NAME_add_entry_by_txt(
+      _name, "CN", MBSTRING_ASC,
+      reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0);
+  X509_set_issuer_name(_certificate, _name);
+  X509_sign(_certificate, _key, EVP_sha256());
+
+  auto *_file = BIO_new_file(p_certificate_file.string().c_str(), "w");
+  PEM_write_bio_X509(_file, _certificate);
+  BIO_free(_file);
+  _file = BIO_new_file(p_private_key_file.string().c_str(), "w");
+  PEM_write_bio_PrivateKey(_file, _key, nullptr, nullptr, 0, nullptr,
+                           nullptr);
+  BIO_free(_file);
+
+  X509_free(_certificate);
+  EVP_PKEY_free(_key);
+}
+
+BOOST_AUTO_TEST_CASE(tcp_server_tls_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_server_tls_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using tcp = boost::asio::ip::tcp;
+        using w_io_context_pool = wolf::system::socket::w_io_context_pool;
+        using w_tcp_server = wolf::system::socket::w_tcp_server;
+        using w_tcp_session = wolf::system::socket::w_tcp_session;
+        using w_socket_options = wolf::system::socket::w_socket_options;
+        using w_tls_context = wolf::system::socket::w_tls_context;
+        using w_tls_options = wolf::system::socket::w_tls_options;
+        using w_tls_cipher_preference =
+            wolf::system::socket::w_tls_cipher_preference;
+        using namespace std::chrono_literals;
+
+        const auto _dir = std::filesystem::temp_directory_path();
+        const auto _certificate_file = _dir / "wolf_tls_test_cert.pem";
+        const auto _private_key_file = _dir / "wolf_tls_test_key.pem";
+        s_write_test_certificate(_certificate_file, _private_key_file);
+
+        const auto _endpoint =
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 8099);
+
+        // a connection sends a ping, waits for its echo and returns its
+        // session, so the next connection can resume it
+        boost::asio::ssl::context _client_context(
+            boost::asio::ssl::context::tls_client);
+        _client_context.set_verify_mode(boost::asio::ssl::verify_none);
+        const auto _ping = [&](_In_opt_ SSL_SESSION *p_session,
+                               _Out_ bool &p_resumed) {
+          boost::asio::io_context _io;
+          boost::asio::ssl::stream<tcp::socket> _stream(_io, _client_context);
+          if (p_session != nullptr) {
+            SSL_set_session(_stream.native_handle(), p_session);
+          }
+          _stream.lowest_layer().connect(_endpoint);
+          _stream.handshake(boost::asio::ssl::stream_base::client);
+          boost::asio::write(_stream, boost::asio::buffer("ping", 4));
+          auto _echo = std::string(4, '\0');
+          boost::asio::read(_stream, boost::asio::buffer(_echo));
+          BOOST_REQUIRE(_echo == "ping");
+          p_resumed = SSL_session_reused(_stream.native_handle()) == 1;
+          return SSL_get1_session(_stream.native_handle());
+        };
+
+        // stateless tickets, the session cache without tickets and kTLS,
+        // which falls back to user space if the kernel has no tls module
+        for (const auto &_options : {
+                 w_tls_options{.certificate_chain_file = _certificate_file,
+                               .private_key_file = _private_key_file},
+                 w_tls_options{.certificate_chain_file = _certificate_file,
+                               .private_key_file = _private_key_file,
+                               .cipher_preference =
+                                   w_tls_cipher_preference::chacha20,
+                               .session_tickets = false},
+                 w_tls_options{.certificate_chain_file = _certificate_file,
+                               .private_key_file = _private_key_file,
+                               .ktls = true}}) {
+          BOOST_LEAF_AUTO(_tls, w_tls_context::make(_options));
+
+          // the two io contexts share the session cache and the tickets
+          auto _pool = w_io_context_pool({.size = 2});
+          const auto _run_res = w_tcp_server::run(
+              _pool, tcp::endpoint(_endpoint), 5s,
+              w_socket_options{.tls = _tls},
+              [](_Inout_ w_tcp_session &p_session,
+                 _Inout_ w_buffer &p_mut_data) -> auto {
+                p_session.send(p_mut_data);
+                return boost::system::errc::success;
+              },
+              [](const std::string &p_conn_id,
+                 const boost::system::system_error &p_error) {});
+          BOOST_REQUIRE(_run_res);
+          BOOST_LEAF_CHECK(_pool.run());
+
+          auto _resumed = false;
+          auto *_session = _ping(nullptr, _resumed);
+          BOOST_REQUIRE(!_resumed);
+          BOOST_REQUIRE(_session != nullptr);
+          for (auto i = 0; i < 4; ++i) {
+            auto *_next = _ping(_session, _resumed);
+            BOOST_REQUIRE(_resumed);
+            SSL_SESSION_free(_session);
+            _session = _next;
+          }
+          SSL_SESSION_free(_session);
+          _pool.stop();
+
+          const auto &_metrics = _tls->get_metrics();
+          BOOST_REQUIRE(_metrics.handshakes == 5);
+          BOOST_REQUIRE(_metrics.resumed_handshakes == 4);
+          BOOST_REQUIRE(_metrics.failed_handshakes == 0);
+        }
+
+        // io_uring does not serve tls
+        BOOST_LEAF_AUTO(_tls, w_tls_context::make(w_tls_options{
+                                  .certificate_chain_file = _certificate_file,
+                                  .private_key_file = _private_key_file}));
+        auto _io = boost::asio::io_context();
+        const auto _uring_res = w_tcp_server::run(
+            _io, tcp::endpoint(_endpoint), 5s,
+            w_socket_options{
+                .io_backend = wolf::system::socket::w_io_backend::io_uring,
+                .tls = _tls},
+            [](_In_ const std::string &p_conn_id,
+               _Inout_ w_buffer &p_mut_data) -> auto {
+              return boost::system::errc::success;
+            },
+            [](const std::string &p_conn_id,
+               const boost::system::system_error &p_error) {});
+        BOOST_REQUIRE(!_uring_res);
+
+        std::filesystem::remove(_certificate_file);
+        std::filesystem::remove(_private_key_file);
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format(
+            "tcp_server_tls_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_server_tls_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_server_tls_test'" << std::endl;
+}
+
+#endif  // WOLF_SYSTEM_SSL
+
 #endif  // defined(WOLF_TEST) && defined(WOLF_SYSTEM_SOCKET)
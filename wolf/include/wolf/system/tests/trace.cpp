@@ -6,6 +6,7 @@
 #if defined(WOLF_TEST)
 
 #include <boost/test/unit_test.hpp>
+#include <cstdio>
 #include <wolf/system/w_leak_detector.hpp>
 #include <wolf/wolf.hpp>
 
@@ -40,4 +41,56 @@ BOOST_AUTO_TEST_CASE(trace_test) {
   std::cout << "leaving test case 'trace_test'" << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(trace_deferred_message_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'trace_deferred_message_test'"
+            << std::endl;
+
+  constexpr size_t _retries = 3;
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        return W_FAILURE(std::errc::timed_out, "timed out after {} retries",
+                         _retries);
+      },
+      [](const w_trace &p_trace) {
+        // the message is only formatted here
+        const auto _str = p_trace.to_string();
+        BOOST_REQUIRE(_str.find("timed out after 3 retries") !=
+                      std::string::npos);
+        BOOST_REQUIRE(_str.find("trace.cpp") != std::string::npos);
+      },
+      [] { BOOST_ERROR("trace_deferred_message_test caught an error!"); });
+
+  std::cout << "leaving test case 'trace_deferred_message_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(trace_local_buffer_message_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'trace_local_buffer_message_test'"
+            << std::endl;
+
+  // a message in a local buffer must be copied, not kept as a pointer
+  const auto _fail = []() noexcept -> boost::leaf::result<void> {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+    char _msg[32] = {};
+    std::snprintf(_msg, sizeof(_msg), "local error %d", 7);
+    return W_FAILURE(std::errc::bad_message, _msg);
+  };
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> { return _fail(); },
+      [](const w_trace &p_trace) {
+        const auto _str = p_trace.to_string();
+        BOOST_REQUIRE(_str.find("local error 7") != std::string::npos);
+      },
+      [] {
+        BOOST_ERROR("trace_local_buffer_message_test caught an error!");
+      });
+
+  std::cout << "leaving test case 'trace_local_buffer_message_test'"
+            << std::endl;
+}
+
 #endif  // WOLF_TESTS
\ No newline at end of file
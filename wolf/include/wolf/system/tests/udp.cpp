@@ -0,0 +1,117 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#if defined(WOLF_TEST) && defined(WOLF_SYSTEM_SOCKET)
+
+#include <boost/test/unit_test.hpp>
+#include <system/socket/w_udp_client.hpp>
+#include <system/socket/w_udp_server.hpp>
+#include <system/w_leak_detector.hpp>
+#include <wolf.hpp>
+
+BOOST_AUTO_TEST_CASE(udp_batch_echo_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'udp_batch_echo_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using udp = boost::asio::ip::udp;
+        using w_udp_client = wolf::system::socket::w_udp_client;
+        using w_udp_options = wolf::system::socket::w_udp_options;
+        using w_udp_packet = wolf::system::socket::w_udp_packet;
+        using w_udp_server = wolf::system::socket::w_udp_server;
+        using w_udp_socket = wolf::system::socket::w_udp_socket;
+        using namespace std::chrono_literals;
+
+        constexpr size_t _count = 1000;
+        constexpr size_t _size = 100;
+
+        // once without and once with the receive offload of the kernel
+        for (const auto _gro : {false, true}) {
+          const auto _port = gsl::narrow_cast<uint16_t>(_gro ? 8096 : 8095);
+          auto _io = boost::asio::io_context();
+
+          // echo every batch at once
+          size_t _batches = 0;
+          BOOST_LEAF_AUTO(
+              _run_res,
+              w_udp_server::run(
+                  _io,
+                  udp::endpoint(boost::asio::ip::make_address("127.0.0.1"),
+                                _port),
+                  w_udp_options{.gro = _gro},
+                  [&](_Inout_ w_udp_socket &p_socket,
+                      _In_ gsl::span<const w_udp_packet> p_packets) {
+                    _batches++;
+                    boost::system::error_code _error;
+                    BOOST_REQUIRE(p_socket.send(p_packets, _error) ==
+                                  p_packets.size());
+                  },
+                  [](const boost::system::system_error &p_error) {
+                    BOOST_ERROR(p_error.what());
+                  }));
+          BOOST_REQUIRE(_run_res == 0);
+
+          // every packet carries its index
+          std::vector<std::array<std::byte, _size>> _payloads(_count);
+          std::vector<w_udp_packet> _packets(_count);
+          for (size_t i = 0; i < _count; ++i) {
+            std::memcpy(_payloads[i].data(), &i, sizeof(i));
+            _packets[i].data = _payloads[i];
+          }
+
+          std::vector<bool> _received(_count, false);
+          size_t _received_count = 0;
+          boost::asio::co_spawn(
+              _io,
+              [&]() -> boost::asio::awaitable<void> {
+                auto _client = w_udp_client(_io);
+                co_await _client.async_connect("127.0.0.1", _port);
+                BOOST_REQUIRE(co_await _client.async_send(_packets) ==
+                              _count);
+
+                auto _batch = _client.make_batch();
+                while (_received_count < _count) {
+                  co_await _client.async_receive(_batch);
+                  for (const auto &_packet : _batch.get_packets()) {
+                    BOOST_REQUIRE(_packet.data.size() == _size);
+                    size_t _index = 0;
+                    std::memcpy(&_index, _packet.data.data(), sizeof(_index));
+                    BOOST_REQUIRE(_index < _count && !_received[_index]);
+                    _received[_index] = true;
+                    _received_count++;
+                  }
+                }
+                _io.stop();
+              },
+              boost::asio::detached);
+
+          // loopback does not drop packets at this rate, but a lost packet
+          // must not hang the test
+          auto _timeout = boost::asio::steady_timer(_io, 10s);
+          _timeout.async_wait(
+              [&](const boost::system::error_code &) { _io.stop(); });
+
+          _io.run();
+
+          BOOST_REQUIRE(_received_count == _count);
+          // the packets were received in batches, not one by one
+          BOOST_REQUIRE(_batches < _count);
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("udp_batch_echo_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("udp_batch_echo_test got an error!"); });
+
+  std::cout << "leaving test case 'udp_batch_echo_test'" << std::endl;
+}
+
+#endif  // defined(WOLF_TEST) && defined(WOLF_SYSTEM_SOCKET)
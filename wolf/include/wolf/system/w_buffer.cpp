@@ -0,0 +1,290 @@
+#include "w_buffer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+
+using w_buffer_pool = wolf::system::w_buffer_pool;
+
+namespace {
+// keep the payload aligned for any type
+constexpr auto s_header_size =
+    (sizeof(w_buffer_pool::block) + alignof(std::max_align_t) - 1) &
+    ~(alignof(std::max_align_t) - 1);
+
+constexpr auto s_block_size(_In_ size_t p_class) noexcept -> size_t {
+  return w_buffer_pool::MIN_BLOCK_SIZE << p_class;
+}
+
+auto s_find_class(_In_ size_t p_capacity) noexcept -> uint32_t {
+  if (p_capacity > w_buffer_pool::MAX_BLOCK_SIZE) {
+    return w_buffer_pool::NOT_POOLED;
+  }
+  const auto _blocks = std::max<size_t>(
+      (p_capacity + w_buffer_pool::MIN_BLOCK_SIZE - 1) /
+          w_buffer_pool::MIN_BLOCK_SIZE,
+      1);
+  return gsl::narrow_cast<uint32_t>(std::bit_width(_blocks - 1));
+}
+}  // namespace
+
+char *w_buffer_pool::block::data() noexcept {
+  // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<char *>(this) + s_header_size;
+  // NOLINTEND
+}
+
+w_buffer_pool &w_buffer_pool::instance() noexcept {
+  static w_buffer_pool s_pool;
+  return s_pool;
+}
+
+w_buffer_pool::~w_buffer_pool() noexcept {
+  for (auto &_class : this->_classes) {
+    for (auto *_slab : _class.slabs) {
+      ::operator delete(_slab);
+    }
+    _class.slabs.clear();
+    _class.free_list = nullptr;
+  }
+}
+
+w_buffer_pool::block *w_buffer_pool::acquire(_In_ size_t p_capacity) noexcept {
+  const auto _class_index = s_find_class(p_capacity);
+  if (_class_index == NOT_POOLED) {
+    auto *_mem = ::operator new(s_header_size + p_capacity, std::nothrow);
+    if (_mem == nullptr) {
+      return nullptr;
+    }
+    auto *_block = new (_mem) block{};
+    _block->size_class = NOT_POOLED;
+    _block->capacity = p_capacity;
+    return _block;
+  }
+
+  auto &_class = gsl::at(this->_classes, _class_index);
+  const auto _block_size = s_block_size(_class_index);
+  const auto _stride = s_header_size + _block_size;
+
+  std::scoped_lock _lock(_class.mutex);
+  if (_class.free_list == nullptr) {
+    // carve a new slab into blocks of this class
+    const auto _count = std::max<size_t>(SLAB_SIZE / _stride, 1);
+    try {
+      _class.slabs.reserve(_class.slabs.size() + 1);
+    } catch (...) {
+      return nullptr;
+    }
+    auto *_slab = ::operator new(_count * _stride, std::nothrow);
+    if (_slab == nullptr) {
+      return nullptr;
+    }
+    _class.slabs.push_back(_slab);
+
+    auto *_bytes = static_cast<std::byte *>(_slab);
+    for (size_t i = 0; i < _count; ++i) {
+      auto *_block = new (_bytes + i * _stride) block{};
+      _block->size_class = _class_index;
+      _block->capacity = _block_size;
+      _block->next = _class.free_list;
+      _class.free_list = _block;
+    }
+  }
+
+  auto *_block = _class.free_list;
+  _class.free_list = _block->next;
+  _block->next = nullptr;
+  _block->ref_count.store(1, std::memory_order_relaxed);
+  return _block;
+}
+
+void w_buffer_pool::release(_In_ block *p_block) noexcept {
+  if (p_block == nullptr) {
+    return;
+  }
+  if (p_block->size_class == NOT_POOLED) {
+    p_block->~block();
+    ::operator delete(p_block);
+    return;
+  }
+
+  auto &_class = gsl::at(this->_classes, p_block->size_class);
+  std::scoped_lock _lock(_class.mutex);
+  p_block->next = _class.free_list;
+  _class.free_list = p_block;
+}
+
+void w_buffer_pool::trim() noexcept {
+  for (size_t i = 0; i < SIZE_CLASSES; ++i) {
+    auto &_class = gsl::at(this->_classes, i);
+    const auto _stride = s_header_size + s_block_size(i);
+    const auto _count = std::max<size_t>(SLAB_SIZE / _stride, 1);
+
+    std::scoped_lock _lock(_class.mutex);
+    if (_class.slabs.empty()) {
+      continue;
+    }
+
+    // count the free blocks of each slab
+    std::vector<size_t> _free;
+    try {
+      _free.resize(_class.slabs.size(), 0);
+    } catch (...) {
+      return;
+    }
+    std::sort(_class.slabs.begin(), _class.slabs.end(), std::less<>());
+    const auto _slab_of = [&](_In_ const block *p_block) noexcept {
+      const auto _it =
+          std::upper_bound(_class.slabs.begin(), _class.slabs.end(),
+                           static_cast<const void *>(p_block), std::less<>());
+      return gsl::narrow_cast<size_t>(_it - _class.slabs.begin()) - 1;
+    };
+    for (auto *_block = _class.free_list; _block != nullptr;
+         _block = _block->next) {
+      ++_free[_slab_of(_block)];
+    }
+
+    // unlink the blocks of the idle slabs, then free them
+    auto **_link = &_class.free_list;
+    while (*_link != nullptr) {
+      if (_free[_slab_of(*_link)] == _count) {
+        *_link = (*_link)->next;
+      } else {
+        _link = &(*_link)->next;
+      }
+    }
+    size_t _kept = 0;
+    for (size_t j = 0; j < _class.slabs.size(); ++j) {
+      if (_free[j] == _count) {
+        ::operator delete(_class.slabs[j]);
+      } else {
+        _class.slabs[_kept++] = _class.slabs[j];
+      }
+    }
+    _class.slabs.resize(_kept);
+    if (_kept == 0) {
+      // the list itself is heap memory too
+      std::vector<void *>().swap(_class.slabs);
+    }
+  }
+}
+
+w_buffer::w_buffer(_In_ size_t p_capacity) { reserve(p_capacity); }
+
+w_buffer::w_buffer(_In_ std::string_view p_str) { from_string(p_str); }
+
+w_buffer::w_buffer(const w_buffer &p_other) noexcept
+    : _block(p_other._block), _size(p_other._size) {
+  if (this->_block != nullptr) {
+    this->_block->ref_count.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+w_buffer &w_buffer::operator=(const w_buffer &p_other) noexcept {
+  if (this != &p_other) {
+    w_buffer _tmp(p_other);
+    *this = std::move(_tmp);
+  }
+  return *this;
+}
+
+w_buffer::w_buffer(w_buffer &&p_other) noexcept
+    : _block(std::exchange(p_other._block, nullptr)),
+      _size(std::exchange(p_other._size, 0)) {}
+
+w_buffer &w_buffer::operator=(w_buffer &&p_other) noexcept {
+  if (this != &p_other) {
+    _release();
+    this->_block = std::exchange(p_other._block, nullptr);
+    this->_size = std::exchange(p_other._size, 0);
+  }
+  return *this;
+}
+
+void w_buffer::reserve(_In_ size_t p_capacity) {
+  if (p_capacity <= capacity() && use_count() <= 1) {
+    return;
+  }
+
+  auto *_block = wolf::system::w_buffer_pool::instance().acquire(
+      std::max(p_capacity, capacity()));
+  if (_block == nullptr) {
+    throw std::bad_alloc();
+  }
+  const auto _size = this->_size;
+  if (_size != 0) {
+    std::memcpy(_block->data(), data(), _size);
+  }
+  _release();
+  this->_block = _block;
+  this->_size = _size;
+}
+
+void w_buffer::resize(_In_ size_t p_size) {
+  reserve(p_size);
+  this->_size = p_size;
+}
+
+void w_buffer::reset(_In_ size_t p_capacity) {
+  this->_size = 0;
+  reserve(p_capacity);
+}
+
+void w_buffer::append(_In_ std::string_view p_bytes) {
+  if (p_bytes.empty()) {
+    return;
+  }
+  const auto _old_size = this->_size;
+  const auto _new_size = _old_size + p_bytes.size();
+  if (_new_size > capacity()) {
+    // grow geometrically to keep appends amortized
+    reserve(std::max(_new_size, capacity() * 2));
+  } else {
+    reserve(_new_size);
+  }
+  std::memcpy(data() + _old_size, p_bytes.data(), p_bytes.size());
+  this->_size = _new_size;
+}
+
+void w_buffer::consume(_In_ size_t p_size) {
+  if (p_size >= this->_size) {
+    this->_size = 0;
+    return;
+  }
+  // do not touch the bytes which are still seen by other owners
+  reserve(this->_size);
+  std::memmove(data(), data() + p_size, this->_size - p_size);
+  this->_size -= p_size;
+}
+
+w_buffer w_buffer::clone() const {
+  w_buffer _copy(this->_size);
+  _copy.append(std::string_view(data(), this->_size));
+  return _copy;
+}
+
+void w_buffer::from_string(_In_ std::string_view p_str) {
+  reset(p_str.size());
+  append(p_str);
+}
+
+std::string w_buffer::to_string() const {
+  if (this->_size == 0) {
+    return {};
+  }
+  return {data(), this->_size};
+}
+
+void w_buffer::_release() noexcept {
+  if (this->_block == nullptr) {
+    return;
+  }
+  if (this->_block->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    wolf::system::w_buffer_pool::instance().release(this->_block);
+  }
+  this->_block = nullptr;
+  this->_size = 0;
+}
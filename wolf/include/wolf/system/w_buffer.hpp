@@ -0,0 +1,205 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <wolf/wolf.hpp>
+
+namespace wolf::system {
+
+/*
+ * a slab allocator which recycles the memory blocks of w_buffer.
+ * blocks are grouped into power of two size classes, starting from
+ * W_MAX_BUFFER_SIZE. a released block goes back to the free list of its class,
+ * so a hot socket path reuses the same memory instead of hitting the heap.
+ * requests bigger than the biggest class are served directly from the heap.
+ */
+class w_buffer_pool {
+ public:
+  struct block {
+    // number of w_buffer instances which share this block
+    std::atomic<uint32_t> ref_count = 1;
+    // index of the size class, or NOT_POOLED
+    uint32_t size_class = 0;
+    // usable bytes after the header
+    size_t capacity = 0;
+    // link of the free list
+    block *next = nullptr;
+
+    char *data() noexcept;
+  };
+
+  static constexpr uint32_t NOT_POOLED = UINT32_MAX;
+  static constexpr size_t MIN_BLOCK_SIZE = W_MAX_BUFFER_SIZE;
+  static constexpr size_t SIZE_CLASSES = 11;  // 1 KiB ... 1 MiB
+  static constexpr size_t MAX_BLOCK_SIZE = MIN_BLOCK_SIZE
+                                           << (SIZE_CLASSES - 1);
+  static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+  // get the process wide pool
+  W_API static w_buffer_pool &instance() noexcept;
+
+  /*
+   * acquire a block with at least the requested capacity
+   * @param p_capacity, the minimum capacity in bytes
+   * @returns a block with one reference, or nullptr when out of memory
+   */
+  W_API block *acquire(_In_ size_t p_capacity) noexcept;
+
+  /*
+   * give the block back to its size class
+   * @param p_block, the block which does not have any reference anymore
+   */
+  W_API void release(_In_ block *p_block) noexcept;
+
+  /*
+   * give the slabs whose blocks are all free back to the heap. the pool lives
+   * until the process exits, so a scope which checks for leaks trims it
+   * before taking each snapshot of the heap
+   */
+  W_API void trim() noexcept;
+
+  // destructor
+  W_API ~w_buffer_pool() noexcept;
+
+  // copy constructor.
+  w_buffer_pool(const w_buffer_pool &) = delete;
+  // copy assignment operator.
+  w_buffer_pool &operator=(const w_buffer_pool &) = delete;
+  // move constructor.
+  w_buffer_pool(w_buffer_pool &&) = delete;
+  // move assignment operator.
+  w_buffer_pool &operator=(w_buffer_pool &&) = delete;
+
+ private:
+  w_buffer_pool() noexcept = default;
+
+  struct size_class {
+    std::mutex mutex;
+    block *free_list = nullptr;
+    std::vector<void *> slabs;
+  };
+
+  std::array<size_class, SIZE_CLASSES> _classes = {};
+};
+
+}  // namespace wolf::system
+
+/*
+ * a growable and reference counted byte buffer which is used on all socket
+ * paths. the storage comes from wolf::system::w_buffer_pool, copies share the
+ * same storage and the last reference gives it back to the pool.
+ */
+class w_buffer {
+ public:
+  // default constructor
+  w_buffer() noexcept = default;
+
+  // create a buffer with at least p_capacity bytes of storage
+  W_API explicit w_buffer(_In_ size_t p_capacity);
+
+  // create a buffer from a string
+  W_API explicit w_buffer(_In_ std::string_view p_str);
+
+  // copy constructor, shares the storage
+  W_API w_buffer(const w_buffer &p_other) noexcept;
+  // copy assignment operator, shares the storage
+  W_API w_buffer &operator=(const w_buffer &p_other) noexcept;
+
+  // move constructor.
+  W_API w_buffer(w_buffer &&p_other) noexcept;
+  // move assignment operator.
+  W_API w_buffer &operator=(w_buffer &&p_other) noexcept;
+
+  // destructor
+  W_API ~w_buffer() noexcept { _release(); }
+
+  /*
+   * make sure the buffer can hold p_capacity bytes without losing the
+   * current content. throws std::bad_alloc on failure
+   * @param p_capacity, the requested capacity
+   */
+  W_API void reserve(_In_ size_t p_capacity);
+
+  /*
+   * change the number of used bytes, grows the storage if needed
+   * @param p_size, the new size
+   */
+  W_API void resize(_In_ size_t p_size);
+
+  /*
+   * drop the content and make sure this instance is the only owner of a
+   * storage with at least p_capacity bytes. use it before reading into a
+   * buffer which might still be shared with a previous consumer
+   * @param p_capacity, the requested capacity
+   */
+  W_API void reset(_In_ size_t p_capacity);
+
+  /*
+   * append bytes at the end of the buffer
+   * @param p_bytes, the source bytes
+   */
+  W_API void append(_In_ std::string_view p_bytes);
+
+  /*
+   * remove bytes from the front of the buffer
+   * @param p_size, the number of bytes
+   */
+  W_API void consume(_In_ size_t p_size);
+
+  // make a deep copy which does not share the storage
+  W_API w_buffer clone() const;
+
+  // replace the content with a string
+  W_API void from_string(_In_ std::string_view p_str);
+
+  // returns a copy of the content as a string
+  W_API std::string to_string() const;
+
+  void clear() noexcept { this->_size = 0; }
+
+  char *data() noexcept {
+    return this->_block != nullptr ? this->_block->data() : nullptr;
+  }
+
+  const char *data() const noexcept {
+    return this->_block != nullptr ? this->_block->data() : nullptr;
+  }
+
+  size_t size() const noexcept { return this->_size; }
+
+  size_t capacity() const noexcept {
+    return this->_block != nullptr ? this->_block->capacity : 0;
+  }
+
+  bool empty() const noexcept { return this->_size == 0; }
+
+  // returns the number of w_buffer instances which share the storage
+  uint32_t use_count() const noexcept {
+    return this->_block != nullptr
+               ? this->_block->ref_count.load(std::memory_order_acquire)
+               : 0;
+  }
+
+  // the used bytes
+  std::span<char> span() noexcept { return {data(), this->_size}; }
+  std::span<const char> span() const noexcept { return {data(), this->_size}; }
+
+ private:
+  void _release() noexcept;
+
+  wolf::system::w_buffer_pool::block *_block = nullptr;
+  size_t _size = 0;
+};
@@ -0,0 +1,120 @@
+#include "w_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+using w_histogram = wolf::system::w_histogram;
+
+w_histogram::w_histogram(_In_ uint64_t p_highest_value,
+                         _In_ uint32_t p_significant_digits)
+    : _highest_value(std::max<uint64_t>(p_highest_value, 2)) {
+  const auto _digits = std::clamp<uint32_t>(p_significant_digits, 1, 5);
+
+  // a bucket of 2 * 10^digits linear sub buckets keeps the digits of every
+  // value which falls into it
+  uint64_t _largest_single_unit = 2;
+  for (uint32_t i = 0; i < _digits; ++i) {
+    _largest_single_unit *= 10;
+  }
+  this->_sub_bucket_bits = gsl::narrow_cast<uint32_t>(
+      std::bit_width(_largest_single_unit - 1));
+  this->_sub_bucket_half_count = uint64_t{1} << (this->_sub_bucket_bits - 1);
+  this->_counts.resize(_index_of(this->_highest_value) + 1);
+}
+
+size_t w_histogram::_index_of(_In_ uint64_t p_value) const noexcept {
+  // the values below the first power of two of a bucket share its linear
+  // scale, every next power of two doubles the width of the sub buckets
+  const auto _magnitude = std::bit_width(p_value);
+  const auto _shift =
+      _magnitude > this->_sub_bucket_bits
+          ? gsl::narrow_cast<uint32_t>(_magnitude) - this->_sub_bucket_bits
+          : 0;
+  return gsl::narrow_cast<size_t>(_shift * this->_sub_bucket_half_count +
+                                  (p_value >> _shift));
+}
+
+uint64_t w_histogram::_highest_equivalent_value(
+    _In_ size_t p_index) const noexcept {
+  const auto _bucket = p_index / this->_sub_bucket_half_count;
+  const auto _shift = _bucket > 1 ? _bucket - 1 : 0;
+  const auto _sub_bucket = p_index - _shift * this->_sub_bucket_half_count;
+  return ((_sub_bucket + 1) << _shift) - 1;
+}
+
+void w_histogram::record(_In_ uint64_t p_value,
+                         _In_ uint64_t p_count) noexcept {
+  if (p_count == 0) {
+    return;
+  }
+  const auto _value = std::min(p_value, this->_highest_value);
+  this->_counts[_index_of(_value)] += p_count;
+  this->_count += p_count;
+  this->_min = std::min(this->_min, _value);
+  this->_max = std::max(this->_max, _value);
+  this->_sum += gsl::narrow_cast<double>(_value) *
+                gsl::narrow_cast<double>(p_count);
+}
+
+void w_histogram::merge(_In_ const w_histogram &p_other) noexcept {
+  if (p_other._count == 0) {
+    return;
+  }
+  if (p_other._sub_bucket_bits == this->_sub_bucket_bits &&
+      p_other._counts.size() <= this->_counts.size()) {
+    for (size_t i = 0; i < p_other._counts.size(); ++i) {
+      this->_counts[i] += p_other._counts[i];
+    }
+    this->_count += p_other._count;
+    this->_min = std::min(this->_min, p_other._min);
+    this->_max = std::max(this->_max, p_other._max);
+    this->_sum += p_other._sum;
+    return;
+  }
+
+  // another precision or range, so the buckets are recorded by their values
+  for (size_t i = 0; i < p_other._counts.size(); ++i) {
+    if (p_other._counts[i] != 0) {
+      record(std::min(p_other._highest_equivalent_value(i), p_other._max),
+             p_other._counts[i]);
+    }
+  }
+}
+
+void w_histogram::reset() noexcept {
+  std::fill(this->_counts.begin(), this->_counts.end(), 0);
+  this->_count = 0;
+  this->_min = UINT64_MAX;
+  this->_max = 0;
+  this->_sum = 0.0;
+}
+
+uint64_t w_histogram::get_value_at_percentile(
+    _In_ double p_percentile) const noexcept {
+  if (this->_count == 0) {
+    return 0;
+  }
+
+  const auto _percentile = std::clamp(p_percentile, 0.0, 100.0);
+  const auto _target = std::max<uint64_t>(
+      1, gsl::narrow_cast<uint64_t>(std::ceil(
+             _percentile / 100.0 * gsl::narrow_cast<double>(this->_count))));
+
+  uint64_t _seen = 0;
+  for (size_t i = 0; i < this->_counts.size(); ++i) {
+    _seen += this->_counts[i];
+    if (_seen >= _target) {
+      // the bucket may be wider than the recorded values
+      return std::clamp(_highest_equivalent_value(i), this->_min, this->_max);
+    }
+  }
+  return this->_max;
+}
+
+double w_histogram::get_mean() const noexcept {
+  if (this->_count == 0) {
+    return 0.0;
+  }
+  return this->_sum / gsl::narrow_cast<double>(this->_count);
+}
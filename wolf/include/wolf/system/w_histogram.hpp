@@ -0,0 +1,105 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <wolf/wolf.hpp>
+
+namespace wolf::system {
+
+/*
+ * a high dynamic range histogram of integer values, e.g. latencies in
+ * nanoseconds. the buckets are linear within each power of two, so every
+ * value is kept with the given number of significant decimal digits, from
+ * one up to the highest trackable value, for a fixed memory footprint and an
+ * O(1) record. a histogram is not thread safe, threads record into their own
+ * histograms and merge them afterwards.
+ */
+class w_histogram {
+ public:
+  /*
+   * @param p_highest_value, the highest trackable value, a bigger value is
+   * counted as the highest one
+   * @param p_significant_digits, the precision of the values from 1 to 5
+   */
+  W_API explicit w_histogram(_In_ uint64_t p_highest_value = 3'600'000'000'000,
+                             _In_ uint32_t p_significant_digits = 3);
+
+  // destructor
+  W_API virtual ~w_histogram() noexcept = default;
+
+  // copy constructor.
+  W_API w_histogram(const w_histogram &) = default;
+  // copy assignment operator.
+  W_API w_histogram &operator=(const w_histogram &) = default;
+  // move constructor.
+  W_API w_histogram(w_histogram &&) noexcept = default;
+  // move assignment operator.
+  W_API w_histogram &operator=(w_histogram &&) noexcept = default;
+
+  /*
+   * count a value
+   * @param p_value, the value
+   * @param p_count, the number of times the value was seen
+   */
+  W_API void record(_In_ uint64_t p_value, _In_ uint64_t p_count = 1) noexcept;
+
+  /*
+   * add the counts of another histogram, which may have another precision
+   * @param p_other, the other histogram
+   */
+  W_API void merge(_In_ const w_histogram &p_other) noexcept;
+
+  // remove all counts
+  W_API void reset() noexcept;
+
+  /*
+   * get the value which is bigger than or equal to a percent of the values
+   * @param p_percentile, the percentile from 0 to 100, e.g. 99.9
+   * @returns the highest value which is equivalent to the bucket of the
+   * percentile, or zero if the histogram is empty
+   */
+  W_API uint64_t get_value_at_percentile(
+      _In_ double p_percentile) const noexcept;
+
+  // returns the number of the recorded values
+  W_API uint64_t get_count() const noexcept { return this->_count; }
+
+  // returns the smallest recorded value, or zero if it is empty
+  W_API uint64_t get_min() const noexcept {
+    return this->_count == 0 ? 0 : this->_min;
+  }
+
+  // returns the biggest recorded value, or zero if it is empty
+  W_API uint64_t get_max() const noexcept { return this->_max; }
+
+  // returns the mean of the recorded values, or zero if it is empty
+  W_API double get_mean() const noexcept;
+
+  // returns the highest trackable value
+  W_API uint64_t get_highest_value() const noexcept {
+    return this->_highest_value;
+  }
+
+ private:
+  size_t _index_of(_In_ uint64_t p_value) const noexcept;
+  uint64_t _highest_equivalent_value(_In_ size_t p_index) const noexcept;
+
+  uint64_t _highest_value;
+  // a power of two which keeps the significant digits
+  uint32_t _sub_bucket_bits;
+  uint64_t _sub_bucket_half_count;
+  std::vector<uint64_t> _counts;
+  uint64_t _count = 0;
+  uint64_t _min = UINT64_MAX;
+  uint64_t _max = 0;
+  // the sum is a double, so it does not overflow for long runs
+  double _sum = 0.0;
+};
+
+}  // namespace wolf::system
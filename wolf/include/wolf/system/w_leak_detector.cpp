@@ -1 +1,343 @@
-#include "w_leak_detector.hpp"
\ No newline at end of file
+#include "w_leak_detector.hpp"
+
+#ifdef WOLF_SYSTEM_ALLOC_PROFILER
+
+#ifdef WOLF_SYSTEM_MIMALLOC
+#error "WOLF_SYSTEM_ALLOC_PROFILER can not be used with WOLF_SYSTEM_MIMALLOC"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <sstream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+using w_alloc_profiler = wolf::system::w_alloc_profiler;
+using w_alloc_site_stats = wolf::system::w_alloc_site_stats;
+
+namespace {
+
+// the counters of one call site, only the owner thread inserts and allocates,
+// the other threads might free so all the counters are atomic
+struct site_entry {
+  std::atomic<uintptr_t> site = 0;
+  std::atomic<uint64_t> count = 0;
+  std::atomic<uint64_t> frees = 0;
+  std::atomic<uint64_t> bytes = 0;
+  std::atomic<int64_t> live = 0;
+  std::atomic<int64_t> peak = 0;
+};
+
+constexpr size_t MAX_SITES = 1024;  // per thread, must be a power of two
+constexpr size_t MAX_THREADS = 64;  // the last table is shared by the rest
+
+// an open addressing table, the first slot collects the overflowed sites
+struct site_table {
+  std::array<site_entry, MAX_SITES> entries = {};
+};
+
+// the header which is placed in front of each profiled allocation, it keeps
+// the payload aligned to __STDCPP_DEFAULT_NEW_ALIGNMENT__
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) alloc_header {
+  site_entry *entry;
+  size_t size;
+};
+
+// static storage, so the tables outlive their threads and the hooks never
+// allocate
+std::array<site_table, MAX_THREADS> s_tables = {};
+std::atomic<size_t> s_tables_used = 0;
+std::atomic<bool> s_enabled = false;
+thread_local site_table *t_table = nullptr;
+
+auto s_get_table() noexcept -> site_table * {
+  if (t_table == nullptr) {
+    const auto _index = s_tables_used.fetch_add(1, std::memory_order_relaxed);
+    t_table = &s_tables[std::min(_index, MAX_THREADS - 1)];
+  }
+  return t_table;
+}
+
+auto s_find_entry(_In_ uintptr_t p_site) noexcept -> site_entry * {
+  auto *_table = s_get_table();
+  // fibonacci hashing of the return address
+  auto _index = static_cast<size_t>((p_site * 0x9E3779B97F4A7C15ull) >> 54) &
+                (MAX_SITES - 1);
+  for (size_t i = 0; i < MAX_SITES; ++i) {
+    auto &_entry = _table->entries[_index];
+    auto _site = _entry.site.load(std::memory_order_acquire);
+    if (_site == p_site) {
+      return &_entry;
+    }
+    // the shared table might be raced by other threads
+    if (_site == 0 && _index != 0 &&
+        (_entry.site.compare_exchange_strong(_site, p_site,
+                                             std::memory_order_acq_rel) ||
+         _site == p_site)) {
+      return &_entry;
+    }
+    _index = (_index + 1) & (MAX_SITES - 1);
+  }
+  // the table is full, use the overflow slot
+  return &_table->entries[0];
+}
+
+void s_on_alloc(_Inout_ alloc_header *p_header, _In_ size_t p_size,
+                _In_ uintptr_t p_site) noexcept {
+  p_header->size = p_size;
+  p_header->entry = nullptr;
+  if (!s_enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  auto *_entry = s_find_entry(p_site);
+  p_header->entry = _entry;
+
+  const auto _size = static_cast<int64_t>(p_size);
+  _entry->count.fetch_add(1, std::memory_order_relaxed);
+  _entry->bytes.fetch_add(p_size, std::memory_order_relaxed);
+  const auto _live =
+      _entry->live.fetch_add(_size, std::memory_order_relaxed) + _size;
+  auto _peak = _entry->peak.load(std::memory_order_relaxed);
+  while (_live > _peak && !_entry->peak.compare_exchange_weak(
+                              _peak, _live, std::memory_order_relaxed)) {
+  }
+}
+
+auto s_alloc(_In_ size_t p_size, _In_ uintptr_t p_site) noexcept -> void * {
+  auto *_header = static_cast<alloc_header *>(
+      std::malloc(sizeof(alloc_header) + std::max<size_t>(p_size, 1)));
+  if (_header == nullptr) {
+    return nullptr;
+  }
+  s_on_alloc(_header, p_size, p_site);
+  return _header + 1;
+}
+
+void s_free(_In_ void *p_ptr) noexcept {
+  if (p_ptr == nullptr) {
+    return;
+  }
+  auto *_header = static_cast<alloc_header *>(p_ptr) - 1;
+  // the allocation is accounted to the thread which made it
+  if (_header->entry != nullptr) {
+    _header->entry->frees.fetch_add(1, std::memory_order_relaxed);
+    _header->entry->live.fetch_sub(static_cast<int64_t>(_header->size),
+                                   std::memory_order_relaxed);
+  }
+  std::free(_header);
+}
+
+auto s_alloc_or_throw(_In_ size_t p_size, _In_ uintptr_t p_site) -> void * {
+  for (;;) {
+    auto *_ptr = s_alloc(p_size, p_site);
+    if (_ptr != nullptr) {
+      return _ptr;
+    }
+    auto _handler = std::get_new_handler();
+    if (_handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    _handler();
+  }
+}
+
+auto s_symbol(_In_ uintptr_t p_site) -> std::string {
+  if (p_site == 0) {
+    return "<overflow>";
+  }
+#ifndef _MSC_VER
+  Dl_info _info{};
+  // NOLINTBEGIN (performance-no-int-to-ptr)
+  if (dladdr(reinterpret_cast<void *>(p_site), &_info) != 0) {
+    // NOLINTEND
+    if (_info.dli_sname != nullptr) {
+      auto _status = 0;
+      auto *_demangled =
+          abi::__cxa_demangle(_info.dli_sname, nullptr, nullptr, &_status);
+      const auto _name = std::string(_status == 0 && _demangled != nullptr
+                                         ? _demangled
+                                         : _info.dli_sname);
+      std::free(_demangled);
+      return wolf::format(
+          "{}+{:#x}", _name,
+          p_site - reinterpret_cast<uintptr_t>(_info.dli_saddr));
+    }
+    if (_info.dli_fname != nullptr) {
+      return wolf::format(
+          "{}+{:#x}", _info.dli_fname,
+          p_site - reinterpret_cast<uintptr_t>(_info.dli_fbase));
+    }
+  }
+#endif
+  return wolf::format("{:#x}", p_site);
+}
+
+auto s_escape_json(_In_ const std::string &p_str) -> std::string {
+  std::string _escaped;
+  _escaped.reserve(p_str.size());
+  for (const auto _c : p_str) {
+    if (_c == '"' || _c == '\\') {
+      _escaped.push_back('\\');
+      _escaped.push_back(_c);
+    } else if (static_cast<unsigned char>(_c) < 0x20) {
+      _escaped += wolf::format("\\u{:04x}", static_cast<int>(_c));
+    } else {
+      _escaped.push_back(_c);
+    }
+  }
+  return _escaped;
+}
+
+}  // namespace
+
+#ifdef _MSC_VER
+#define W_CALL_SITE reinterpret_cast<uintptr_t>(_ReturnAddress())
+#else
+#define W_CALL_SITE reinterpret_cast<uintptr_t>(__builtin_return_address(0))
+#endif
+
+// NOLINTBEGIN (cppcoreguidelines-no-malloc, misc-new-delete-overloads)
+void *operator new(size_t p_size) {
+  return s_alloc_or_throw(p_size, W_CALL_SITE);
+}
+
+void *operator new[](size_t p_size) {
+  return s_alloc_or_throw(p_size, W_CALL_SITE);
+}
+
+void *operator new(size_t p_size, const std::nothrow_t &) noexcept {
+  return s_alloc(p_size, W_CALL_SITE);
+}
+
+void *operator new[](size_t p_size, const std::nothrow_t &) noexcept {
+  return s_alloc(p_size, W_CALL_SITE);
+}
+
+void operator delete(void *p_ptr) noexcept { s_free(p_ptr); }
+
+void operator delete[](void *p_ptr) noexcept { s_free(p_ptr); }
+
+void operator delete(void *p_ptr, size_t) noexcept { s_free(p_ptr); }
+
+void operator delete[](void *p_ptr, size_t) noexcept { s_free(p_ptr); }
+
+void operator delete(void *p_ptr, const std::nothrow_t &) noexcept {
+  s_free(p_ptr);
+}
+
+void operator delete[](void *p_ptr, const std::nothrow_t &) noexcept {
+  s_free(p_ptr);
+}
+// NOLINTEND
+
+#undef W_CALL_SITE
+
+void w_alloc_profiler::enable(_In_ bool p_enable) noexcept {
+  s_enabled.store(p_enable, std::memory_order_relaxed);
+}
+
+bool w_alloc_profiler::is_enabled() noexcept {
+  return s_enabled.load(std::memory_order_relaxed);
+}
+
+void w_alloc_profiler::reset() noexcept {
+  const auto _used =
+      std::min(s_tables_used.load(std::memory_order_acquire), MAX_THREADS);
+  for (size_t i = 0; i < _used; ++i) {
+    for (auto &_entry : s_tables[i].entries) {
+      _entry.count.store(0, std::memory_order_relaxed);
+      _entry.frees.store(0, std::memory_order_relaxed);
+      _entry.bytes.store(0, std::memory_order_relaxed);
+      _entry.peak.store(_entry.live.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    }
+  }
+}
+
+std::vector<w_alloc_site_stats> w_alloc_profiler::snapshot() {
+  // copy the counters first, the map below allocates too
+  std::map<uintptr_t, w_alloc_site_stats> _sites;
+
+  const auto _used =
+      std::min(s_tables_used.load(std::memory_order_acquire), MAX_THREADS);
+  for (size_t i = 0; i < _used; ++i) {
+    for (size_t j = 0; j < MAX_SITES; ++j) {
+      const auto &_entry = s_tables[i].entries[j];
+      const auto _site = _entry.site.load(std::memory_order_acquire);
+      const auto _count = _entry.count.load(std::memory_order_relaxed);
+      if ((_site == 0 && j != 0) || _count == 0) {
+        continue;
+      }
+      auto &_stats = _sites[_site];
+      _stats.site = _site;
+      _stats.count += _count;
+      _stats.frees += _entry.frees.load(std::memory_order_relaxed);
+      _stats.bytes += _entry.bytes.load(std::memory_order_relaxed);
+      _stats.live_bytes += _entry.live.load(std::memory_order_relaxed);
+      _stats.peak_live_bytes += _entry.peak.load(std::memory_order_relaxed);
+    }
+  }
+
+  std::vector<w_alloc_site_stats> _result;
+  _result.reserve(_sites.size());
+  for (auto &[_site, _stats] : _sites) {
+    _stats.symbol = s_symbol(_site);
+    _result.push_back(std::move(_stats));
+  }
+  std::sort(_result.begin(), _result.end(),
+            [](const auto &p_lhs, const auto &p_rhs) {
+              return p_lhs.bytes > p_rhs.bytes;
+            });
+  return _result;
+}
+
+std::string w_alloc_profiler::to_flat_profile(_In_ size_t p_top) {
+  auto _sites = snapshot();
+  if (p_top != 0 && _sites.size() > p_top) {
+    _sites.resize(p_top);
+  }
+
+  std::ostringstream _out;
+  _out << wolf::format("{:>12} {:>14} {:>12} {:>14} {:>14}  {}\n", "count",
+                       "bytes", "frees", "live", "peak", "site");
+  for (const auto &_stats : _sites) {
+    _out << wolf::format("{:>12} {:>14} {:>12} {:>14} {:>14}  {}\n",
+                         _stats.count, _stats.bytes, _stats.frees,
+                         _stats.live_bytes, _stats.peak_live_bytes,
+                         _stats.symbol);
+  }
+  return _out.str();
+}
+
+std::string w_alloc_profiler::to_json(_In_ size_t p_top) {
+  auto _sites = snapshot();
+  if (p_top != 0 && _sites.size() > p_top) {
+    _sites.resize(p_top);
+  }
+
+  std::ostringstream _out;
+  _out << "{\"sites\":[";
+  for (size_t i = 0; i < _sites.size(); ++i) {
+    const auto &_stats = _sites[i];
+    _out << wolf::format(
+        "{}{{\"site\":\"{:#x}\",\"symbol\":\"{}\",\"count\":{},\"bytes\":{},"
+        "\"frees\":{},\"live_bytes\":{},\"peak_live_bytes\":{}}}",
+        i == 0 ? "" : ",", _stats.site, s_escape_json(_stats.symbol),
+        _stats.count, _stats.bytes, _stats.frees, _stats.live_bytes,
+        _stats.peak_live_bytes);
+  }
+  _out << "]}";
+  return _out.str();
+}
+
+#endif  // WOLF_SYSTEM_ALLOC_PROFILER
@@ -11,7 +11,77 @@
 
 #include <wolf/wolf.hpp>
 
+#ifdef WOLF_SYSTEM_ALLOC_PROFILER
+#include <cstdint>
+#include <string>
+#include <vector>
+#endif
+
 namespace wolf::system {
+
+#ifdef WOLF_SYSTEM_ALLOC_PROFILER
+
+// the allocation statistics of one call site, aggregated over all threads
+struct w_alloc_site_stats {
+  // the return address of the caller of operator new
+  uintptr_t site = 0;
+  // the resolved symbol of the call site, if any
+  std::string symbol;
+  // number of allocations
+  uint64_t count = 0;
+  // number of deallocations
+  uint64_t frees = 0;
+  // total allocated bytes
+  uint64_t bytes = 0;
+  // bytes which are still alive
+  int64_t live_bytes = 0;
+  // the sum of the per thread peaks of live bytes, an upper bound of the peak
+  int64_t peak_live_bytes = 0;
+};
+
+/*
+ * an opt-in allocation profiler, which is compiled in via
+ * WOLF_SYSTEM_ALLOC_PROFILER. it replaces the global operator new/delete and
+ * keeps lock-free per thread counters keyed by call site. malloc is not
+ * interposed, only the C++ allocations are profiled.
+ */
+class w_alloc_profiler {
+ public:
+  /*
+   * start or stop counting, the hooks stay installed either way
+   * @param p_enable, true to start counting
+   */
+  W_API static void enable(_In_ bool p_enable) noexcept;
+
+  // returns true if counting is enabled
+  W_API static bool is_enabled() noexcept;
+
+  // reset the counters, the live bytes are kept
+  W_API static void reset() noexcept;
+
+  /*
+   * aggregate the counters of all threads
+   * @returns the call sites sorted by allocated bytes
+   */
+  W_API static std::vector<w_alloc_site_stats> snapshot();
+
+  /*
+   * dump a flat profile as text
+   * @param p_top, the number of call sites, zero means all of them
+   * @returns the flat profile
+   */
+  W_API static std::string to_flat_profile(_In_ size_t p_top = 0);
+
+  /*
+   * dump the profile as json
+   * @param p_top, the number of call sites, zero means all of them
+   * @returns the json document
+   */
+  W_API static std::string to_json(_In_ size_t p_top = 0);
+};
+
+#endif  // WOLF_SYSTEM_ALLOC_PROFILER
+
 class w_leak_detector {
  public:
   // default constructor
@@ -20,6 +90,8 @@ class w_leak_detector {
       : _mem_state()
 #endif
   {
+    // the pooled blocks of w_buffer are cached for the process lifetime
+    w_buffer_pool::instance().trim();
 #if defined(WIN64) && defined(_DEBUG)
     // take a snapshot from memory
     _CrtMemCheckpoint(&this->_mem_state);
@@ -28,6 +100,7 @@ class w_leak_detector {
 
   // destructor
   W_API virtual ~w_leak_detector() noexcept {
+    w_buffer_pool::instance().trim();
 #if defined(WIN64) && defined(_DEBUG)
     try {
       // take a snapshot from memory
@@ -0,0 +1,244 @@
+#include "w_profiler.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using w_profiler = wolf::system::w_profiler;
+
+std::atomic<bool> w_profiler::_enabled = false;
+
+namespace {
+
+struct event {
+  const char *name;
+  uint64_t begin_ns;
+  uint64_t end_ns;
+};
+
+// a single producer, single consumer ring of one thread
+struct thread_buffer {
+  std::array<event, w_profiler::RING_SIZE> events = {};
+  // written by the owner thread
+  std::atomic<uint64_t> head = 0;
+  // written by the flusher
+  std::atomic<uint64_t> tail = 0;
+  std::atomic<bool> alive = true;
+  uint32_t tid = 0;
+  // guarded by the registry mutex
+  std::string name;
+  bool name_written = false;
+};
+
+struct registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<thread_buffer>> buffers;
+  uint32_t next_tid = 1;
+
+  // the flusher
+  std::mutex flusher_mutex;
+  std::condition_variable flusher_cv;
+  std::thread flusher;
+  bool running = false;
+  std::ofstream file;
+  bool first_event = true;
+  uint64_t origin_ns = 0;
+  std::atomic<uint64_t> dropped = 0;
+};
+
+auto s_registry() -> registry & {
+  static registry s_instance;
+  return s_instance;
+}
+
+// marks the buffer as dead once its thread exits, so the flusher can drop it
+struct thread_buffer_holder {
+  std::shared_ptr<thread_buffer> buffer;
+
+  ~thread_buffer_holder() {
+    if (this->buffer) {
+      this->buffer->alive.store(false, std::memory_order_release);
+    }
+  }
+};
+
+thread_local thread_buffer_holder t_holder;
+
+auto s_thread_buffer() -> thread_buffer * {
+  if (!t_holder.buffer) {
+    auto _buffer = std::make_shared<thread_buffer>();
+    auto &_registry = s_registry();
+    std::scoped_lock _lock(_registry.mutex);
+    _buffer->tid = _registry.next_tid++;
+    _registry.buffers.push_back(_buffer);
+    t_holder.buffer = std::move(_buffer);
+  }
+  return t_holder.buffer.get();
+}
+
+void s_write_json_string(_Inout_ std::ofstream &p_file,
+                         _In_ std::string_view p_str) {
+  p_file.put('"');
+  for (const auto _c : p_str) {
+    if (_c == '"' || _c == '\\') {
+      p_file.put('\\');
+      p_file.put(_c);
+    } else if (static_cast<unsigned char>(_c) >= 0x20) {
+      p_file.put(_c);
+    }
+  }
+  p_file.put('"');
+}
+
+void s_write_separator(_Inout_ registry &p_registry) {
+  if (!p_registry.first_event) {
+    p_registry.file << ",\n";
+  }
+  p_registry.first_event = false;
+}
+
+// drain all the rings into the file, must be called by the flusher only
+void s_drain(_Inout_ registry &p_registry) {
+  std::vector<std::shared_ptr<thread_buffer>> _buffers;
+  {
+    std::scoped_lock _lock(p_registry.mutex);
+    _buffers = p_registry.buffers;
+    for (auto &_buffer : _buffers) {
+      if (!_buffer->name.empty() && !_buffer->name_written) {
+        s_write_separator(p_registry);
+        p_registry.file << R"({"name":"thread_name","ph":"M","pid":1,"tid":)"
+                        << _buffer->tid << R"(,"args":{"name":)";
+        s_write_json_string(p_registry.file, _buffer->name);
+        p_registry.file << "}}";
+        _buffer->name_written = true;
+      }
+    }
+  }
+
+  for (auto &_buffer : _buffers) {
+    const auto _alive = _buffer->alive.load(std::memory_order_acquire);
+    const auto _head = _buffer->head.load(std::memory_order_acquire);
+    auto _tail = _buffer->tail.load(std::memory_order_relaxed);
+    for (; _tail != _head; ++_tail) {
+      const auto &_event =
+          _buffer->events[_tail & (w_profiler::RING_SIZE - 1)];
+      const auto _begin = _event.begin_ns > p_registry.origin_ns
+                              ? _event.begin_ns - p_registry.origin_ns
+                              : 0;
+      const auto _dur = _event.end_ns - _event.begin_ns;
+      s_write_separator(p_registry);
+      p_registry.file << R"({"name":)";
+      s_write_json_string(p_registry.file, _event.name);
+      p_registry.file << wolf::format(
+          R"(,"cat":"wolf","ph":"X","ts":{}.{:03},"dur":{}.{:03},"pid":1,"tid":{}}})",
+          _begin / 1000, _begin % 1000, _dur / 1000, _dur % 1000,
+          _buffer->tid);
+    }
+    _buffer->tail.store(_tail, std::memory_order_release);
+
+    if (!_alive) {
+      std::scoped_lock _lock(p_registry.mutex);
+      std::erase(p_registry.buffers, _buffer);
+    }
+  }
+  p_registry.file.flush();
+}
+
+}  // namespace
+
+boost::leaf::result<int> w_profiler::start(
+    _In_ const std::filesystem::path &p_path,
+    _In_ std::chrono::milliseconds p_flush_interval) {
+  auto &_registry = s_registry();
+
+  std::unique_lock _lock(_registry.flusher_mutex);
+  if (_registry.running) {
+    return W_FAILURE(std::errc::operation_in_progress,
+                     "profiler has already been started");
+  }
+
+  _registry.file.open(p_path, std::ios::out | std::ios::trunc);
+  if (!_registry.file.is_open()) {
+    return W_FAILURE(std::errc::io_error,
+                     "could not open the trace file: " + p_path.string());
+  }
+  _registry.file << "{\"traceEvents\":[\n";
+  _registry.first_event = true;
+  _registry.origin_ns = now_ns();
+  _registry.dropped.store(0, std::memory_order_relaxed);
+  _registry.running = true;
+
+  _registry.flusher = std::thread([&_registry, p_flush_interval]() {
+    std::unique_lock _flusher_lock(_registry.flusher_mutex);
+    while (_registry.running) {
+      _registry.flusher_cv.wait_for(_flusher_lock, p_flush_interval);
+      s_drain(_registry);
+    }
+  });
+
+  _enabled.store(true, std::memory_order_release);
+  return 0;
+}
+
+void w_profiler::stop() noexcept {
+  auto &_registry = s_registry();
+  _enabled.store(false, std::memory_order_release);
+
+  try {
+    {
+      std::scoped_lock _lock(_registry.flusher_mutex);
+      if (!_registry.running) {
+        return;
+      }
+      _registry.running = false;
+    }
+    _registry.flusher_cv.notify_all();
+    _registry.flusher.join();
+
+    // the events which were recorded after the last flush
+    s_drain(_registry);
+    _registry.file << "\n]}\n";
+    _registry.file.close();
+  } catch (...) {
+  }
+}
+
+void w_profiler::set_thread_name(_In_ std::string_view p_name) {
+  auto *_buffer = s_thread_buffer();
+  auto &_registry = s_registry();
+  std::scoped_lock _lock(_registry.mutex);
+  _buffer->name = p_name;
+  _buffer->name_written = false;
+}
+
+void w_profiler::record(_In_ const char *p_name, _In_ uint64_t p_begin_ns,
+                        _In_ uint64_t p_end_ns) noexcept {
+  if (!is_enabled()) {
+    return;
+  }
+
+  thread_buffer *_buffer = nullptr;
+  try {
+    _buffer = s_thread_buffer();
+  } catch (...) {
+    return;
+  }
+
+  const auto _head = _buffer->head.load(std::memory_order_relaxed);
+  const auto _tail = _buffer->tail.load(std::memory_order_acquire);
+  if (_head - _tail >= RING_SIZE) {
+    s_registry().dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  _buffer->events[_head & (RING_SIZE - 1)] = {p_name, p_begin_ns, p_end_ns};
+  _buffer->head.store(_head + 1, std::memory_order_release);
+}
+
+uint64_t w_profiler::dropped_events() noexcept {
+  return s_registry().dropped.load(std::memory_order_relaxed);
+}
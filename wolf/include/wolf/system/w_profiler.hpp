@@ -0,0 +1,121 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfSource/wolf
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include <wolf/wolf.hpp>
+
+namespace wolf::system {
+
+/*
+ * a low overhead tracer for hot paths. each thread records complete events
+ * into its own lock-free ring buffer and a background thread flushes them as
+ * chrome trace-event json, which can be opened by chrome://tracing or
+ * ui.perfetto.dev. while the profiler is not started, a scope costs one
+ * predictable branch.
+ */
+class w_profiler {
+ public:
+  // number of events which a thread can buffer between two flushes
+  static constexpr size_t RING_SIZE = 16 * 1024;
+
+  /*
+   * start recording and flushing the events into a trace file
+   * @param p_path, the path of the json trace file
+   * @param p_flush_interval, the interval of the background flusher
+   * @returns zero on success
+   */
+  W_API static boost::leaf::result<int> start(
+      _In_ const std::filesystem::path &p_path,
+      _In_ std::chrono::milliseconds p_flush_interval =
+          std::chrono::milliseconds(100));
+
+  // stop recording, flush the remaining events and close the trace file
+  W_API static void stop() noexcept;
+
+  // returns true if the profiler is recording
+  static bool is_enabled() noexcept {
+    return _enabled.load(std::memory_order_relaxed);
+  }
+
+  /*
+   * name the calling thread in the trace
+   * @param p_name, the name of the thread
+   */
+  W_API static void set_thread_name(_In_ std::string_view p_name);
+
+  /*
+   * record a complete event on the calling thread
+   * @param p_name, the name of the event, which must outlive the profiler
+   * @param p_begin_ns, the begin timestamp from now_ns
+   * @param p_end_ns, the end timestamp from now_ns
+   */
+  W_API static void record(_In_ const char *p_name, _In_ uint64_t p_begin_ns,
+                           _In_ uint64_t p_end_ns) noexcept;
+
+  // returns the number of events which were dropped because of a full ring
+  W_API static uint64_t dropped_events() noexcept;
+
+  // returns the timestamp in nanoseconds
+  static uint64_t now_ns() noexcept {
+    return gsl::narrow_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+ private:
+  W_API static std::atomic<bool> _enabled;
+};
+
+// records the lifetime of a scope as one event
+class w_profile_scope {
+ public:
+  explicit w_profile_scope(_In_ const char *p_name) noexcept {
+    if (w_profiler::is_enabled()) {
+      this->_name = p_name;
+      this->_begin_ns = w_profiler::now_ns();
+    }
+  }
+
+  ~w_profile_scope() noexcept {
+    if (this->_name != nullptr) {
+      w_profiler::record(this->_name, this->_begin_ns, w_profiler::now_ns());
+    }
+  }
+
+  // move constructor
+  w_profile_scope(w_profile_scope &&p_src) noexcept = delete;
+  // move assignment operator.
+  auto operator=(w_profile_scope &&p_src) noexcept
+      -> w_profile_scope & = delete;
+  // copy constructor.
+  w_profile_scope(const w_profile_scope &) = delete;
+  // copy assignment operator.
+  auto operator=(const w_profile_scope &) -> w_profile_scope & = delete;
+
+ private:
+  const char *_name = nullptr;
+  uint64_t _begin_ns = 0;
+};
+
+}  // namespace wolf::system
+
+#define W_PROFILE_CONCAT_IMPL(p_a, p_b) p_a##p_b
+#define W_PROFILE_CONCAT(p_a, p_b) W_PROFILE_CONCAT_IMPL(p_a, p_b)
+
+// profile the current scope, the name must be a string literal
+#define W_PROFILE_SCOPE(p_name)                                          \
+  const wolf::system::w_profile_scope W_PROFILE_CONCAT(_profile_scope_, \
+                                                       __LINE__)(p_name)
+
+// profile the current function
+#define W_PROFILE_FUNCTION() W_PROFILE_SCOPE(__func__)
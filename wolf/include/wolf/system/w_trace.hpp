@@ -7,13 +7,17 @@
 
 #include <stdint.h>
 
+#include <array>
 #include <boost/leaf.hpp>
-#include <deque>
+#include <cstddef>
 #include <gsl/gsl>
 #include <iostream>
+#include <new>
 #include <ostream>
+#include <sstream>
 #include <string>
 #include <thread>
+#include <type_traits>
 
 #if WIN64
 #include <Windows.h>
@@ -21,81 +25,180 @@
 
 #include <wolf/wolf.hpp>
 
+/*
+ * w_trace is the error object of wolf, which is carried by boost::leaf.
+ * creating one never allocates for the common cases: the source location is
+ * interned per call site, a literal message is kept as a pointer, the
+ * arguments of a deferred message are kept in a small inline payload and the
+ * message is only formatted when to_string() is called.
+ */
 class w_trace {
  public:
+  // an interned source location, there is one static instance per call site
+  struct location {
+    const char *source_file = nullptr;
+    int source_file_line = 0;
+  };
+
+  // the maximum number of stacks which are kept, the rest will be dropped
+  static constexpr size_t MAX_STACKS = 4;
+  // the inline capacity for the arguments of a deferred message
+  static constexpr size_t PAYLOAD_SIZE = 32;
+
   struct stack {
     friend std::ostream &operator<<(std::ostream &p_os,
                                     stack const &p_trace) noexcept {
       try {
         p_os << "|tid:" << p_trace.thread_id << "|code:" << p_trace.err_code
-             << "|msg:" << p_trace.err_msg << "|src:" << p_trace.source_file
-             << "(" << p_trace.source_file_line << ")" << std::endl;
+             << "|msg:" << p_trace.message() << "|src:"
+             << (p_trace.source != nullptr ? p_trace.source->source_file : "")
+             << "("
+             << (p_trace.source != nullptr ? p_trace.source->source_file_line
+                                           : 0)
+             << ")" << std::endl;
       } catch (...) {
       }
       return p_os;
     }
+
+    // format the message of this stack
+    std::string message() const {
+      if (this->err_msg == nullptr) {
+        return this->dynamic_err_msg;
+      }
+      if (this->formatter == nullptr) {
+        return this->err_msg;
+      }
+      try {
+        return this->formatter(this->err_msg, this->payload.data());
+      } catch (...) {
+        // keep the raw format string on a bad format
+        return this->err_msg;
+      }
+    }
+
     std::thread::id thread_id;
     int64_t err_code = 0;
-    std::string err_msg;
-    std::string source_file;
-    int source_file_line = 0;
-  } W_ALIGNMENT_128;
+    const location *source = nullptr;
+    // a literal message, or the format string of a deferred message
+    const char *err_msg = nullptr;
+    // a message which was built at runtime and moved in
+    std::string dynamic_err_msg;
+    // formats err_msg with the arguments which are stored in payload
+    std::string (*formatter)(const char *, const std::byte *) = nullptr;
+    alignas(std::max_align_t) std::array<std::byte, PAYLOAD_SIZE> payload = {};
+  };
+
+  /*
+   * a message or a format string with static storage duration, which is kept
+   * as a pointer. it can only be made from a string literal at compile time,
+   * so a local char array never ends up here.
+   */
+  class literal {
+   public:
+    template <size_t N>
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    consteval literal(_In_ const char (&p_str)[N]) noexcept : _str(p_str) {}
+
+    constexpr const char *c_str() const noexcept { return this->_str; }
+
+   private:
+    const char *_str = nullptr;
+  };
+
+  // only a const char array may be a string literal, any other array, e.g. a
+  // local char buffer, is copied
+  template <typename Msg>
+  static constexpr bool s_is_literal =
+      std::is_same_v<std::remove_cvref_t<Msg>, literal> ||
+      (std::is_array_v<std::remove_reference_t<Msg>> &&
+       std::is_same_v<std::remove_extent_t<std::remove_reference_t<Msg>>,
+                      const char>);
 
   w_trace() noexcept = default;
 
-  explicit w_trace(_In_ stack &&p_stack) noexcept {
-    try {
-      this->_stacks.emplace_front(p_stack);
-    } catch (...) {
-    }
+  /*
+   * @param p_err_code, the error code
+   * @param p_location, the interned location of the call site
+   * @param p_msg, a literal or a format string literal
+   * @param p_args, the arithmetic arguments of a deferred message
+   */
+  template <typename T, typename... Args>
+  w_trace(_In_ T p_err_code, _In_ const location &p_location,
+          _In_ literal p_msg, _In_ Args &&...p_args) noexcept {
+    push(p_err_code, p_location, p_msg, std::forward<Args>(p_args)...);
   }
 
-  w_trace(_In_ int64_t p_err_code, _In_ std::string p_err_msg,
-          _In_ const char *p_source_file,
-          _In_ int p_source_file_line) noexcept {
-    try {
-      this->_stacks.emplace_front(stack{std::this_thread::get_id(), p_err_code,
-                                        std::move(p_err_msg), p_source_file,
-                                        p_source_file_line});
-    } catch (...) {
-    }
+  /*
+   * @param p_err_code, the error code
+   * @param p_location, the interned location of the call site
+   * @param p_msg, a runtime string, which will be copied or moved
+   */
+  template <typename T, typename Msg, typename... Args>
+    requires(!s_is_literal<Msg>)
+  w_trace(_In_ T p_err_code, _In_ const location &p_location,
+          _In_ Msg &&p_msg, _In_ Args &&...p_args) noexcept {
+    push(p_err_code, p_location, std::forward<Msg>(p_msg),
+         std::forward<Args>(p_args)...);
   }
 
-  w_trace(_In_ std::errc p_err_code, _In_ std::string p_err_msg,
-          _In_ const char *p_source_file,
-          _In_ int p_source_file_line) noexcept {
-    try {
-      this->_stacks.emplace_front(stack{
-          std::this_thread::get_id(), gsl::narrow_cast<int64_t>(p_err_code),
-          std::move(p_err_msg), p_source_file, p_source_file_line});
-    } catch (...) {
+  template <typename T, typename... Args>
+  void push(_In_ T p_err_code, _In_ const location &p_location,
+            _In_ literal p_msg, _In_ Args &&...p_args) noexcept {
+    auto *_stack = next_stack(p_err_code, p_location);
+    if (_stack == nullptr) {
+      return;
+    }
+
+    _stack->err_msg = p_msg.c_str();
+    if constexpr (sizeof...(Args) > 0) {
+      static_assert((std::is_arithmetic_v<std::decay_t<Args>> && ...),
+                    "only arithmetic arguments can be deferred, format "
+                    "other arguments at the call site");
+      using args_type = deferred_args<std::decay_t<Args>...>;
+      static_assert(sizeof(args_type) <= PAYLOAD_SIZE,
+                    "too many arguments for the inline payload");
+
+      new (_stack->payload.data()) args_type{std::forward<Args>(p_args)...};
+      _stack->formatter = &s_format<args_type>;
     }
   }
 
-  void push(_In_ int64_t p_err_code, _In_ std::string p_err_msg,
-            _In_ const char *p_source_file,
-            _In_ int p_source_file_line) noexcept {
+  template <typename T, typename Msg, typename... Args>
+    requires(!s_is_literal<Msg>)
+  void push(_In_ T p_err_code, _In_ const location &p_location,
+            _In_ Msg &&p_msg, _In_ Args &&...p_args) noexcept {
+    static_assert(sizeof...(Args) == 0,
+                  "a deferred message needs a format string literal");
+
+    auto *_stack = next_stack(p_err_code, p_location);
+    if (_stack == nullptr) {
+      return;
+    }
+
     try {
-      this->_stacks.emplace_front(stack{std::this_thread::get_id(), p_err_code,
-                                        std::move(p_err_msg), p_source_file,
-                                        p_source_file_line});
+      // a runtime string or a char array, which may not outlive the caller,
+      // move or copy it
+      _stack->dynamic_err_msg = std::string(std::forward<Msg>(p_msg));
     } catch (...) {
     }
   }
 
   std::string to_string() const {
     std::stringstream ss;
-    for (const auto &_stack : this->_stacks) {
-      ss << _stack;
-    }
+    ss << *this;
     return ss.str();
   }
 
   friend std::ostream &operator<<(std::ostream &p_os,
                                   w_trace const &p_trace) noexcept {
     try {
-      for (const auto &index : p_trace._stacks) {
-        p_os << index;
+      // the latest stack comes first
+      for (auto i = p_trace._size; i > 0; --i) {
+        p_os << p_trace._stacks.at(i - 1);
+      }
+      if (p_trace._dropped > 0) {
+        p_os << "|dropped:" << p_trace._dropped << std::endl;
       }
     } catch (...) {
     }
@@ -103,9 +206,73 @@ class w_trace {
   }
 
  private:
-  std::deque<stack> _stacks = {};
+  // claim the next stack, or count it as dropped when they are all taken
+  template <typename T>
+  stack *next_stack(_In_ T p_err_code,
+                    _In_ const location &p_location) noexcept {
+    if (this->_size == MAX_STACKS) {
+      this->_dropped++;
+      return nullptr;
+    }
+
+    auto &_stack = this->_stacks.at(this->_size++);
+    _stack.thread_id = std::this_thread::get_id();
+    _stack.err_code = static_cast<int64_t>(p_err_code);
+    _stack.source = &p_location;
+    return &_stack;
+  }
+
+  // a trivially copyable list of the deferred arguments
+  template <typename... Args>
+  struct deferred_args {};
+
+  template <typename T, typename... Args>
+  struct deferred_args<T, Args...> {
+    T first;
+    deferred_args<Args...> rest;
+  };
+
+  template <typename... Done>
+  static std::string s_apply(_In_ const char *p_fmt,
+                             _In_ const deferred_args<> &p_args,
+                             _In_ const Done &...p_done) {
+    std::ignore = p_args;
+#ifdef _MSC_VER
+    return std::vformat(p_fmt, std::make_format_args(p_done...));
+#else
+    return fmt::vformat(p_fmt, fmt::make_format_args(p_done...));
+#endif
+  }
+
+  template <typename T, typename... Args, typename... Done>
+  static std::string s_apply(_In_ const char *p_fmt,
+                             _In_ const deferred_args<T, Args...> &p_args,
+                             _In_ const Done &...p_done) {
+    return s_apply(p_fmt, p_args.rest, p_done..., p_args.first);
+  }
+
+  template <typename Args>
+  static std::string s_format(_In_ const char *p_fmt,
+                              _In_ const std::byte *p_payload) {
+    // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto &_args = *std::launder(reinterpret_cast<const Args *>(p_payload));
+    // NOLINTEND
+    return s_apply(p_fmt, _args);
+  }
+
+  std::array<stack, MAX_STACKS> _stacks = {};
+  size_t _size = 0;
+  size_t _dropped = 0;
 };
 
+// the interned location of the current call site
+#define W_TRACE_LOCATION                                       \
+  []() noexcept -> const w_trace::location & {                 \
+    static constexpr w_trace::location s_location = {__FILE__, \
+                                                     __LINE__}; \
+    return s_location;                                         \
+  }()
+
 template <typename T>
 #ifndef __clang__
   requires std::movable<T>
@@ -114,8 +281,14 @@ constexpr inline boost::leaf::result<T> W_SUCCESS(T &p_param) noexcept {
   return boost::leaf::result<T>(std::move(p_param));
 }
 
-#define W_FAILURE(p_code, p_msg) \
-  boost::leaf::new_error(w_trace(p_code, p_msg, __FILE__, __LINE__))
+/*
+ * make a new error
+ * e.g. W_FAILURE(std::errc::invalid_argument, "the source is empty")
+ * or with a deferred message, which will be formatted on to_string()
+ * e.g. W_FAILURE(std::errc::timed_out, "timed out after {} ms", _ms)
+ */
+#define W_FAILURE(p_code, ...) \
+  boost::leaf::new_error(w_trace(p_code, W_TRACE_LOCATION, __VA_ARGS__))
 
 #ifdef WIN64
 
@@ -71,34 +71,6 @@ constexpr auto W_MAX_BUFFER_SIZE = 1024;
 
 #define DEFER auto _ = std::shared_ptr<void>(nullptr, [&](...)
 
-struct wolf_buffer {
-    wolf_buffer() noexcept = default;
-
-  explicit wolf_buffer(const std::string_view p_str) { from_string(p_str); }
-
-  wolf_buffer(std::array<char, W_MAX_BUFFER_SIZE> &&p_array,
-           const size_t p_used_bytes) noexcept {
-    this->buf = std::move(p_array);
-    this->used_bytes = p_used_bytes;
-  }
-
-  void from_string(const std::string_view p_str) {
-    const auto _size = p_str.size();
-    this->used_bytes = _size > 1024 ? 1024 : _size;
-    std::copy(p_str.cbegin(), p_str.cbegin() + this->used_bytes, buf.begin());
-  }
-
-  std::string to_string() {
-    if (this->buf.size() && this->used_bytes) {
-      return std::string(this->buf.data(), this->used_bytes);
-    }
-    return std::string();
-  }
-
-  std::array<char, W_MAX_BUFFER_SIZE> buf = {0};
-  size_t used_bytes = 0;
-};
-
 // #ifdef __clang__
 // #define W_ALIGNMENT_16 __attribute__((packed)) __attribute__((aligned(16)))
 // #define W_ALIGNMENT_32 __attribute__((packed)) __attribute__((aligned(32)))
@@ -134,11 +106,13 @@ struct wolf_buffer {
 #endif
 
 #include <wolf/system/invocable.hpp>
+#include <wolf/system/w_buffer.hpp>
 #include <wolf/system/w_trace.hpp>
 
 namespace wolf {
-template <class T>
-using w_function = ofats::any_invocable<T>;
+template <class T,
+          std::size_t Size = ofats::any_detail::default_buffer_size>
+using w_function = ofats::any_invocable<T, Size>;
 using w_binary = std::vector<std::byte>;
 
 /**